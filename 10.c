@@ -1,54 +1,95 @@
+#include <errno.h>
 #include <stdio.h>
-#include <sys/select.h>
-#include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "reactor.h"
+
+/* Build: gcc -o 10 10.c reactor.c */
+
 #define TIMEOUT 30
 #define BUF_LEN 1024
 
-int main(void) {
-    struct timeval tv;
-    fd_set readfds;
+struct state {
     int ret;
+};
 
-    FD_ZERO(&readfds);
-    FD_SET(STDIN_FILENO, &readfds);
+static void on_timeout(struct reactor *r, int timer_id, void *arg) {
+    struct state *st = arg;
+    (void)timer_id;
 
-    tv.tv_sec = TIMEOUT;
-    tv.tv_usec = 0;
+    printf("%d seconds elapsed.\n", TIMEOUT);
+    st->ret = 0;
+    reactor_stop(r);
+}
 
-    ret = select(STDIN_FILENO + 1, &readfds, NULL, NULL, &tv); // (0 ~ nfds - 1)
+/**
+ * File descriptor 에서 즉시 읽기가 가능함.
+ */
+static void on_stdin(struct reactor *r, int fd, uint32_t events, void *arg) {
+    struct state *st = arg;
+    char buf[BUF_LEN + 1];
+    int len;
 
-    if (ret == -1) {
-        perror("select");
-        return 1;
-    } else if (!ret) {
-        printf("%d seconds elapsed.\n", TIMEOUT);
-        return 0;
+    if (!(events & (EPOLLIN | EPOLLHUP))) {
+        fprintf(stderr, "No input available.\n");
+        st->ret = 1;
+        reactor_stop(r);
+        return;
     }
 
-    /**
-     * File descriptor 에서 즉시 읽기가 가능함.
-     */
-    if (FD_ISSET(STDIN_FILENO, &readfds)) {
-        char buf[BUF_LEN + 1];
-        int len;
+    len = read(fd, buf, BUF_LEN);
+    if (len == -1) {
+        perror("read");
+        st->ret = 1;
+        reactor_stop(r);
+        return;
+    }
+
+    if (len) {
+        buf[len] = '\0'; // null character
+        printf("Read %d bytes: %s\n", len, buf);
+    }
+
+    st->ret = 0;
+    reactor_stop(r);
+}
+
+int main(void) {
+    struct state st = { .ret = 1 };
+    struct reactor *r;
+
+    r = reactor_create();
+    if (!r) {
+        perror("reactor_create");
+        return 1;
+    }
 
-        len = read(STDIN_FILENO, buf, BUF_LEN);
-        if (len == -1) {
-            perror("read");
+    // select() 의 fd_set + timeval 대신 epoll + timerfd 로 감시
+    if (reactor_add(r, STDIN_FILENO, EPOLLIN, 0, on_stdin, &st) == -1) {
+        if (errno != EPERM) {
+            perror("reactor_add");
+            reactor_destroy(r);
             return 1;
         }
+        // 일반 파일은 epoll 대상이 아님 (EPERM) - 항상 읽기 가능하므로 바로 읽는다
+        on_stdin(r, STDIN_FILENO, EPOLLIN, &st);
+        reactor_destroy(r);
+        return st.ret;
+    }
 
-        if (len) {
-            buf[len] = '\0'; // null character
-            printf("Read %d bytes: %s\n", len, buf);
-        }
+    if (reactor_add_timer(r, TIMEOUT * 1000, 0, on_timeout, &st) == -1) {
+        perror("reactor_add_timer");
+        reactor_destroy(r);
+        return 1;
+    }
 
-        return 0;
+    if (reactor_run(r) == -1) {
+        perror("epoll_wait");
+        reactor_destroy(r);
+        return 1;
     }
 
-    fprintf(stderr, "No input available.\n");
-    return 1;
+    reactor_destroy(r);
+    return st.ret;
 }
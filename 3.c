@@ -21,6 +21,8 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    // 일반 파일에는 O_NONBLOCK 이 무시되어 read() 가 디스크를 기다리며 막힌다.
+    // 이벤트 루프를 막지 않으려면 async_file.h 의 worker pool 로 넘긴다.
     fd = open(argv[1], O_RDONLY | O_NONBLOCK);
     if (fd == -1) {
         if (errno == EINTR) {
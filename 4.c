@@ -5,60 +5,120 @@
 #include <stdio.h>
 #include <unistd.h>
 
-int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <fifo_path>\n", argv[0]);
-        return 1;
-    }
+#include "reactor.h"
+
+/* Build: gcc -o 4 4.c reactor.c */
 
+static int open_fifo(const char *path) {
     // Open with O_RDWR so that read() blocks (or returns EAGAIN) instead of returning 0
     // when no other writer is connected.
-    int fd = open(argv[1], O_RDWR | O_NONBLOCK);
+    int fd = open(path, O_RDWR | O_NONBLOCK);
     if (fd == -1) {
         if (errno == ENOENT) {
             // FIFO doesn't exist, create it
-            if (mkfifo(argv[1], 0666) == -1) {
+            if (mkfifo(path, 0666) == -1) {
                 perror("mkfifo");
-                return 1;
+                return -1;
             }
             // Try opening again
-            fd = open(argv[1], O_RDWR | O_NONBLOCK);
+            fd = open(path, O_RDWR | O_NONBLOCK);
         }
         if (fd == -1) {
             perror("open");
-            return 1;
+            return -1;
         }
     }
+    return fd;
+}
 
-    printf("Waiting for data on %s...\n", argv[1]);
+struct fifo {
+    const char *path;
+    int *ret;
+};
 
+/*
+ * Edge-triggered 이므로 EAGAIN 이 나올 때까지 읽어야 한다.
+ * usleep() polling 과 달리 데이터가 들어오는 즉시 호출된다.
+ */
+static void on_readable(struct reactor *r, int fd, uint32_t events, void *arg) {
+    struct fifo *f = arg;
     char buf[1024];
+    (void)events;
+
     while (1) {
-        ssize_t ret = read(fd, buf, sizeof(buf));
-        
+        ssize_t ret = read(fd, buf, sizeof(buf) - 1);
+
         if (ret == -1) {
-            if (errno == EAGAIN) {
-                printf(".");
-                fflush(stdout);
-                usleep(100000); // 100ms
+            if (errno == EINTR)
                 continue;
-            }
+            if (errno == EAGAIN)
+                return;
             perror("read");
-            break;
+            *f->ret = 1;
+            reactor_stop(r);
+            return;
         } else if (ret == 0) {
-            // With O_RDWR, this shouldn't happen unless we close the write end ourselves?
-            // Actually, for FIFO opened O_RDWR, read returns 0 only if we close the fd?
-            // Or if the pipe is broken?
-            // In any case, handle it.
+            // With O_RDWR we hold a write end ourselves, so this should not happen.
             printf("\nWriter closed or EOF\n");
-            break;
-        } else if (ret > 0) {
-            buf[ret] = '\0';
-            printf("\nReceived: \"%s\"\n", buf);
-            break;
+            reactor_stop(r);
+            return;
         }
+
+        buf[ret] = '\0';
+        printf("\nReceived on %s: \"%s\"\n", f->path, buf);
+        *f->ret = 0;
+        reactor_stop(r);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <fifo_path> [fifo_path ...]\n", argv[0]);
+        return 1;
     }
 
-    close(fd);
-    return 0;
-}
\ No newline at end of file
+    struct reactor *r = reactor_create();
+    if (!r) {
+        perror("reactor_create");
+        return 1;
+    }
+
+    int nfifo = argc - 1;
+    int fds[nfifo];
+    struct fifo fifos[nfifo];
+    int ret = 1;
+
+    for (int i = 0; i < nfifo; i++)
+        fds[i] = -1;
+
+    for (int i = 0; i < nfifo; i++) {
+        fds[i] = open_fifo(argv[i + 1]);
+        if (fds[i] == -1)
+            goto out;
+
+        fifos[i].path = argv[i + 1];
+        fifos[i].ret = &ret;
+        if (reactor_add(r, fds[i], EPOLLIN, REACTOR_EDGE, on_readable, &fifos[i]) == -1) {
+            perror("reactor_add");
+            goto out;
+        }
+    }
+
+    if (nfifo == 1)
+        printf("Waiting for data on %s...\n", argv[1]);
+    else
+        printf("Waiting for data on %d FIFOs...\n", nfifo);
+
+    if (reactor_run(r) == -1) {
+        perror("epoll_wait");
+        ret = 1;
+    }
+
+out:
+    reactor_destroy(r);
+    for (int i = 0; i < nfifo; i++) {
+        if (fds[i] != -1)
+            close(fds[i]);
+    }
+    return ret;
+}
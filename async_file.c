@@ -0,0 +1,543 @@
+/*
+ * Thread-Pool Async File I/O
+ *
+ * Build: gcc -O2 -pthread -c async_file.c
+ */
+
+#define _GNU_SOURCE
+#include "async_file.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#define HASH_SIZE 256
+
+enum { OP_PREAD, OP_PWRITE, OP_FSYNC, OP_FDATASYNC };
+enum { ST_QUEUED, ST_RUNNING, ST_DONE };
+
+struct fileq;
+
+struct afio_req {
+    struct afio_req *prev;
+    struct afio_req *next;       /* fileq 또는 완료 목록 */
+    struct afio_pool *pool;
+    struct fileq *q;
+    int op;
+    int fd;
+    void *buf;
+    size_t len;
+    off_t off;
+    afio_cb cb;
+    void *arg;
+    ssize_t res;
+    int state;
+    int refs;                    /* 호출자 1 + pool 1 */
+};
+
+/*
+ * fd 하나의 대기열. busy 인 동안 (요청 하나가 실행 중) 은 ready 목록에
+ * 올리지 않으므로 같은 fd 의 요청이 동시에 실행되지 않는다.
+ */
+struct fileq {
+    struct fileq *hnext;         /* hash chain */
+    struct fileq *rnext;         /* ready 목록 */
+    int fd;
+    int busy;
+    int ready;
+    struct afio_req *head;
+    struct afio_req *tail;
+};
+
+struct afio_pool {
+    pthread_mutex_t lock;
+    pthread_cond_t work_cv;      /* worker: ready 목록이 생김 */
+    pthread_cond_t space_cv;     /* submit: pending 이 줄어듦 */
+    pthread_cond_t done_cv;      /* afio_wait */
+    struct fileq *hash[HASH_SIZE];
+    struct fileq unordered;      /* AFIO_UNORDERED 요청, busy 를 쓰지 않음 */
+    struct fileq *ready_head;
+    struct fileq *ready_tail;
+    struct afio_req *done_head;  /* completion_fd 모드에서 callback 대기 */
+    struct afio_req *done_tail;
+    unsigned int pending;
+    unsigned int max_pending;
+    int nonblock_submit;
+    int efd;
+    int stop;
+    int nworkers;
+    pthread_t *tids;
+    struct afio_stats st;
+};
+
+static void req_put(struct afio_req *r) {
+    if (__atomic_sub_fetch(&r->refs, 1, __ATOMIC_ACQ_REL) == 0)
+        free(r);
+}
+
+static void ready_push(struct afio_pool *p, struct fileq *q) {
+    if (q->ready)
+        return;
+    q->ready = 1;
+    q->rnext = NULL;
+    if (p->ready_tail)
+        p->ready_tail->rnext = q;
+    else
+        p->ready_head = q;
+    p->ready_tail = q;
+}
+
+static struct fileq *ready_pop(struct afio_pool *p) {
+    struct fileq *q = p->ready_head;
+    if (q) {
+        p->ready_head = q->rnext;
+        if (!p->ready_head)
+            p->ready_tail = NULL;
+        q->ready = 0;
+    }
+    return q;
+}
+
+static void ready_remove(struct afio_pool *p, struct fileq *q) {
+    struct fileq **pp = &p->ready_head, *prev = NULL;
+    while (*pp && *pp != q) {
+        prev = *pp;
+        pp = &(*pp)->rnext;
+    }
+    if (!*pp)
+        return;
+    *pp = q->rnext;
+    if (p->ready_tail == q)
+        p->ready_tail = prev;
+    q->ready = 0;
+}
+
+static struct fileq *fileq_get(struct afio_pool *p, int fd, int create) {
+    struct fileq **pp = &p->hash[(unsigned int)fd % HASH_SIZE];
+    for (struct fileq *q = *pp; q; q = q->hnext)
+        if (q->fd == fd)
+            return q;
+    if (!create)
+        return NULL;
+    struct fileq *q = calloc(1, sizeof(*q));
+    if (!q)
+        return NULL;
+    q->fd = fd;
+    q->hnext = *pp;
+    *pp = q;
+    return q;
+}
+
+/* 비었고 실행 중인 것도 없으면 hash 에서 뺀다 (fd 가 계속 늘어나도 커지지 않게) */
+static void fileq_maybe_free(struct afio_pool *p, struct fileq *q) {
+    if (q == &p->unordered || q->busy || q->head)
+        return;
+    struct fileq **pp = &p->hash[(unsigned int)q->fd % HASH_SIZE];
+    while (*pp != q)
+        pp = &(*pp)->hnext;
+    *pp = q->hnext;
+    if (q->ready)
+        ready_remove(p, q);
+    free(q);
+}
+
+static void q_append(struct fileq *q, struct afio_req *r) {
+    r->q = q;
+    r->next = NULL;
+    r->prev = q->tail;
+    if (q->tail)
+        q->tail->next = r;
+    else
+        q->head = r;
+    q->tail = r;
+}
+
+static void q_unlink(struct fileq *q, struct afio_req *r) {
+    if (r->prev)
+        r->prev->next = r->next;
+    else
+        q->head = r->next;
+    if (r->next)
+        r->next->prev = r->prev;
+    else
+        q->tail = r->prev;
+    r->prev = r->next = NULL;
+}
+
+/*
+ * lock 을 잡은 상태에서 결과를 확정한다. completion_fd 모드면 완료 목록에
+ * 넣고 1 (호출자가 eventfd 에 쓴다), 아니면 0 (호출자가 lock 밖에서 callback).
+ */
+static int finish_locked(struct afio_pool *p, struct afio_req *r, ssize_t res) {
+    r->res = res;
+    __atomic_store_n(&r->state, ST_DONE, __ATOMIC_RELEASE);
+    p->pending--;
+    if (res == -ECANCELED)
+        p->st.cancelled++;
+    else
+        p->st.completed++;
+    pthread_cond_signal(&p->space_cv);
+    pthread_cond_broadcast(&p->done_cv);
+
+    if (p->efd < 0)
+        return 0;
+    r->next = NULL;
+    if (p->done_tail)
+        p->done_tail->next = r;
+    else
+        p->done_head = r;
+    p->done_tail = r;
+    return 1;
+}
+
+static void notify(struct afio_pool *p) {
+    uint64_t one = 1;
+    /* 카운터가 넘칠 만큼 쌓이지 않으므로 실패 (EAGAIN) 는 무시 */
+    ssize_t n = write(p->efd, &one, sizeof(one));
+    (void)n;
+}
+
+/* callback 후 pool 의 참조를 놓는다 */
+static void deliver(struct afio_req *r) {
+    if (r->cb)
+        r->cb(r, r->res, r->arg);
+    req_put(r);
+}
+
+static ssize_t execute(struct afio_req *r) {
+    size_t done = 0;
+
+    switch (r->op) {
+    case OP_FSYNC:
+        return fsync(r->fd) == 0 ? 0 : -errno;
+    case OP_FDATASYNC:
+        return fdatasync(r->fd) == 0 ? 0 : -errno;
+    }
+
+    while (done < r->len) {
+        ssize_t n = r->op == OP_PREAD
+                        ? pread(r->fd, (char *)r->buf + done, r->len - done, r->off + done)
+                        : pwrite(r->fd, (char *)r->buf + done, r->len - done, r->off + done);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return done ? (ssize_t)done : -errno;
+        }
+        if (n == 0)
+            break;
+        done += n;
+    }
+    return done;
+}
+
+static void *worker(void *arg) {
+    struct afio_pool *p = arg;
+
+    pthread_mutex_lock(&p->lock);
+    while (1) {
+        while (!p->ready_head && !p->stop)
+            pthread_cond_wait(&p->work_cv, &p->lock);
+        struct fileq *q = ready_pop(p);
+        if (!q)
+            break;
+
+        struct afio_req *r = q->head;
+        q_unlink(q, r);
+        r->state = ST_RUNNING;
+        if (q == &p->unordered) {
+            if (q->head)
+                ready_push(p, q);
+        } else {
+            q->busy = 1;
+        }
+        pthread_mutex_unlock(&p->lock);
+
+        ssize_t res = execute(r);
+
+        pthread_mutex_lock(&p->lock);
+        if (q != &p->unordered) {
+            q->busy = 0;
+            if (q->head)
+                ready_push(p, q);      /* 뒤로 보내서 다른 fd 와 번갈아 실행 */
+            else
+                fileq_maybe_free(p, q);
+        }
+        if (p->ready_head)
+            pthread_cond_signal(&p->work_cv);
+        int queued = finish_locked(p, r, res);
+        pthread_mutex_unlock(&p->lock);
+
+        if (queued)
+            notify(p);
+        else
+            deliver(r);
+        pthread_mutex_lock(&p->lock);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+struct afio_pool *afio_create(const struct afio_params *params) {
+    struct afio_pool *p = calloc(1, sizeof(*p));
+    if (!p)
+        return NULL;
+
+    p->nworkers = params && params->workers > 0 ? params->workers : 4;
+    p->max_pending = params && params->max_pending ? params->max_pending : 1024;
+    p->nonblock_submit = params && params->nonblock_submit;
+    p->unordered.fd = -1;
+    p->efd = -1;
+
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->work_cv, NULL);
+    pthread_cond_init(&p->space_cv, NULL);
+    pthread_cond_init(&p->done_cv, NULL);
+
+    if (params && params->completion_fd) {
+        p->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (p->efd == -1)
+            goto fail;
+    }
+
+    p->tids = calloc(p->nworkers, sizeof(*p->tids));
+    if (!p->tids)
+        goto fail;
+    for (int i = 0; i < p->nworkers; i++) {
+        int err = pthread_create(&p->tids[i], NULL, worker, p);
+        if (err) {
+            p->nworkers = i;
+            afio_destroy(p);
+            errno = err;
+            return NULL;
+        }
+    }
+    return p;
+
+fail:;
+    int saved = errno;
+    if (p->efd >= 0)
+        close(p->efd);
+    free(p->tids);
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->work_cv);
+    pthread_cond_destroy(&p->space_cv);
+    pthread_cond_destroy(&p->done_cv);
+    free(p);
+    errno = saved;
+    return NULL;
+}
+
+static struct afio_req *submit(struct afio_pool *p, int op, int fd, void *buf, size_t len,
+                               off_t off, int flags, afio_cb cb, void *arg) {
+    struct afio_req *r = calloc(1, sizeof(*r));
+    if (!r)
+        return NULL;
+    r->pool = p;
+    r->op = op;
+    r->fd = fd;
+    r->buf = buf;
+    r->len = len;
+    r->off = off;
+    r->cb = cb;
+    r->arg = arg;
+    r->refs = 2;
+
+    pthread_mutex_lock(&p->lock);
+    if (p->pending >= p->max_pending && !p->stop) {
+        if (p->nonblock_submit) {
+            p->st.rejected++;
+            pthread_mutex_unlock(&p->lock);
+            free(r);
+            errno = EAGAIN;
+            return NULL;
+        }
+        p->st.throttled++;
+        while (p->pending >= p->max_pending && !p->stop)
+            pthread_cond_wait(&p->space_cv, &p->lock);
+    }
+
+    struct fileq *q = flags & AFIO_UNORDERED ? &p->unordered : fileq_get(p, fd, 1);
+    if (p->stop || !q) {
+        pthread_mutex_unlock(&p->lock);
+        free(r);
+        errno = p->stop ? ESHUTDOWN : ENOMEM;
+        return NULL;
+    }
+    q_append(q, r);
+    r->state = ST_QUEUED;
+    p->pending++;
+    p->st.submitted++;
+    if (!q->busy && !q->ready) {
+        ready_push(p, q);
+        pthread_cond_signal(&p->work_cv);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return r;
+}
+
+struct afio_req *afio_pread(struct afio_pool *p, int fd, void *buf, size_t len, off_t off,
+                            int flags, afio_cb cb, void *arg) {
+    return submit(p, OP_PREAD, fd, buf, len, off, flags, cb, arg);
+}
+
+struct afio_req *afio_pwrite(struct afio_pool *p, int fd, const void *buf, size_t len,
+                             off_t off, int flags, afio_cb cb, void *arg) {
+    return submit(p, OP_PWRITE, fd, (void *)buf, len, off, flags, cb, arg);
+}
+
+struct afio_req *afio_fsync(struct afio_pool *p, int fd, int datasync, int flags,
+                            afio_cb cb, void *arg) {
+    return submit(p, datasync ? OP_FDATASYNC : OP_FSYNC, fd, NULL, 0, 0, flags, cb, arg);
+}
+
+int afio_done(struct afio_req *r) {
+    return __atomic_load_n(&r->state, __ATOMIC_ACQUIRE) == ST_DONE;
+}
+
+ssize_t afio_wait(struct afio_req *r) {
+    struct afio_pool *p = r->pool;
+
+    pthread_mutex_lock(&p->lock);
+    while (r->state != ST_DONE)
+        pthread_cond_wait(&p->done_cv, &p->lock);
+    ssize_t res = r->res;
+    pthread_mutex_unlock(&p->lock);
+
+    if (res < 0) {
+        errno = -res;
+        return -1;
+    }
+    return res;
+}
+
+int afio_cancel(struct afio_req *r) {
+    struct afio_pool *p = r->pool;
+
+    pthread_mutex_lock(&p->lock);
+    if (r->state != ST_QUEUED) {
+        int err = r->state == ST_RUNNING ? EBUSY : EALREADY;
+        pthread_mutex_unlock(&p->lock);
+        errno = err;
+        return -1;
+    }
+    struct fileq *q = r->q;
+    q_unlink(q, r);
+    if (!q->head && q->ready)
+        ready_remove(p, q);
+    fileq_maybe_free(p, q);
+    int queued = finish_locked(p, r, -ECANCELED);
+    pthread_mutex_unlock(&p->lock);
+
+    if (queued)
+        notify(p);
+    else
+        deliver(r);
+    return 0;
+}
+
+void afio_release(struct afio_req *r) {
+    if (r)
+        req_put(r);
+}
+
+int afio_fd(const struct afio_pool *p) {
+    return p->efd;
+}
+
+int afio_reap(struct afio_pool *p, unsigned int max) {
+    uint64_t count;
+    int n = 0;
+
+    if (p->efd < 0)
+        return 0;
+    while (read(p->efd, &count, sizeof(count)) > 0)
+        ;
+
+    pthread_mutex_lock(&p->lock);
+    struct afio_req *list = p->done_head, *last = NULL;
+    for (struct afio_req *r = list; r && (unsigned int)n < max; r = r->next) {
+        last = r;
+        n++;
+    }
+    if (last) {
+        p->done_head = last->next;
+        if (!p->done_head)
+            p->done_tail = NULL;
+        last->next = NULL;
+    }
+    int more = p->done_head != NULL;
+    pthread_mutex_unlock(&p->lock);
+
+    /* 남은 것은 다음 이벤트에서 (edge-triggered 루프에서도 다시 깨도록) */
+    if (more)
+        notify(p);
+
+    while (list) {
+        struct afio_req *next = list->next;
+        deliver(list);
+        list = next;
+    }
+    return n;
+}
+
+void afio_get_stats(struct afio_pool *p, struct afio_stats *st) {
+    pthread_mutex_lock(&p->lock);
+    *st = p->st;
+    pthread_mutex_unlock(&p->lock);
+}
+
+void afio_destroy(struct afio_pool *p) {
+    if (!p)
+        return;
+
+    /* 시작하지 않은 요청은 취소 */
+    struct afio_req *cancelled = NULL;
+    pthread_mutex_lock(&p->lock);
+    p->stop = 1;
+    p->ready_head = p->ready_tail = NULL;
+    for (int i = 0; i <= HASH_SIZE; i++) {
+        for (struct fileq *q = i < HASH_SIZE ? p->hash[i] : &p->unordered; q;
+             q = i < HASH_SIZE ? q->hnext : NULL) {
+            q->ready = 0;
+            while (q->head) {
+                struct afio_req *r = q->head;
+                q_unlink(q, r);
+                if (!finish_locked(p, r, -ECANCELED)) {
+                    r->next = cancelled;
+                    cancelled = r;
+                }
+            }
+        }
+    }
+    pthread_cond_broadcast(&p->work_cv);
+    pthread_cond_broadcast(&p->space_cv);
+    pthread_mutex_unlock(&p->lock);
+
+    while (cancelled) {
+        struct afio_req *next = cancelled->next;
+        deliver(cancelled);
+        cancelled = next;
+    }
+    for (int i = 0; i < p->nworkers; i++)
+        pthread_join(p->tids[i], NULL);
+    afio_reap(p, (unsigned int)-1);
+
+    for (int i = 0; i < HASH_SIZE; i++) {
+        while (p->hash[i]) {
+            struct fileq *q = p->hash[i];
+            p->hash[i] = q->hnext;
+            free(q);
+        }
+    }
+    if (p->efd >= 0)
+        close(p->efd);
+    free(p->tids);
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->work_cv);
+    pthread_cond_destroy(&p->space_cv);
+    pthread_cond_destroy(&p->done_cv);
+    free(p);
+}
@@ -0,0 +1,100 @@
+/*
+ * Thread-Pool Async File I/O
+ *
+ * 3.c 는 일반 파일을 O_NONBLOCK 으로 열고 EAGAIN 을 기대하지만, 일반 파일에는
+ * 이 flag 가 무시된다. page cache 에 없으면 read() 는 디스크를 기다리며 멈춘다.
+ * reactor 콜백 안에서 그런 read() 를 하면 이벤트 루프 전체가 멈춘다.
+ *
+ * afio 는 정해진 수의 worker 스레드가 blocking pread/pwrite/fsync 를 대신 하고,
+ * 요청마다 future (struct afio_req) 를 돌려준다.
+ *
+ *   - 파일별 순서: 같은 fd 의 요청은 제출 순서대로 하나씩 실행
+ *                  (AFIO_UNORDERED 면 다른 요청과 동시에 실행될 수 있음)
+ *   - 다른 fd 의 요청은 worker 수만큼 동시에 실행
+ *   - 취소: 아직 시작하지 않은 요청은 -ECANCELED 로 끝남
+ *   - back-pressure: 대기+실행 중인 요청이 max_pending 이면 submit 이 기다림
+ *                    (nonblock_submit 이면 NULL + EAGAIN)
+ *   - 완료 통지: callback 을 worker 스레드에서 바로 부르거나,
+ *                completion_fd 를 켜면 eventfd 로 알리고 afio_reap() 을
+ *                부른 스레드 (이벤트 루프) 에서 callback 을 부른다
+ *
+ * reactor 와 같이 쓰기:
+ *   struct afio_params p = { .completion_fd = 1, .nonblock_submit = 1 };
+ *   struct afio_pool *io = afio_create(&p);
+ *   reactor_add(r, afio_fd(io), EPOLLIN, 0, on_io_done, io);   // on_io_done 에서 afio_reap
+ *   afio_release(afio_pread(io, fd, buf, len, off, 0, on_read, ctx));
+ *
+ * Build: gcc -O2 -pthread -c async_file.c
+ */
+
+#ifndef ASYNC_FILE_H
+#define ASYNC_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define AFIO_UNORDERED 0x1       /* 같은 fd 의 다른 요청과 순서를 지키지 않아도 됨 */
+
+struct afio_params {
+    int workers;                 /* 0 이면 4 */
+    unsigned int max_pending;    /* 0 이면 1024 */
+    int nonblock_submit;         /* 1 이면 가득 찼을 때 기다리지 않고 EAGAIN */
+    int completion_fd;           /* 1 이면 eventfd + afio_reap() 으로 callback */
+};
+
+struct afio_stats {
+    uint64_t submitted;
+    uint64_t completed;          /* 실행이 끝난 요청 (취소 제외) */
+    uint64_t cancelled;
+    uint64_t rejected;           /* nonblock_submit 에서 EAGAIN */
+    uint64_t throttled;          /* submit 이 back-pressure 로 기다린 횟수 */
+};
+
+struct afio_pool;
+struct afio_req;
+
+/* res: 성공이면 바이트 수 (fsync 는 0), 실패면 -errno (uio_cqe 와 같은 규칙) */
+typedef void (*afio_cb)(struct afio_req *req, ssize_t res, void *arg);
+
+struct afio_pool *afio_create(const struct afio_params *params);
+
+/* 아직 시작하지 않은 요청은 취소하고, 실행 중인 것은 끝날 때까지 기다린다 */
+void afio_destroy(struct afio_pool *p);
+
+/*
+ * 요청 제출. 반환된 future 는 afio_release() 로 놓아야 한다 (결과가 필요
+ * 없으면 바로 놓아도 된다). cb 는 NULL 이어도 된다.
+ * pread/pwrite 는 len 을 다 옮기거나 EOF 가 될 때까지 반복한다.
+ */
+struct afio_req *afio_pread(struct afio_pool *p, int fd, void *buf, size_t len, off_t off,
+                            int flags, afio_cb cb, void *arg);
+struct afio_req *afio_pwrite(struct afio_pool *p, int fd, const void *buf, size_t len,
+                             off_t off, int flags, afio_cb cb, void *arg);
+struct afio_req *afio_fsync(struct afio_pool *p, int fd, int datasync, int flags,
+                            afio_cb cb, void *arg);
+
+/* 끝났으면 1 */
+int afio_done(struct afio_req *r);
+
+/* 끝날 때까지 기다린다. 바이트 수, 실패 시 -1 + errno (취소면 ECANCELED) */
+ssize_t afio_wait(struct afio_req *r);
+
+/*
+ * 아직 시작하지 않았으면 취소하고 0. callback 은 -ECANCELED 로 불린다
+ * (completion_fd 면 afio_reap 에서, 아니면 이 함수 안에서).
+ * 이미 실행 중이거나 끝났으면 -1 (errno = EBUSY / EALREADY).
+ */
+int afio_cancel(struct afio_req *r);
+
+void afio_release(struct afio_req *r);
+
+/* completion_fd 모드의 eventfd. EPOLLIN 이면 afio_reap() */
+int afio_fd(const struct afio_pool *p);
+
+/* 끝난 요청의 callback 을 최대 max 개 부른다. 부른 수 */
+int afio_reap(struct afio_pool *p, unsigned int max);
+
+void afio_get_stats(struct afio_pool *p, struct afio_stats *st);
+
+#endif
@@ -0,0 +1,312 @@
+/*
+ * Event-Loop Stall Benchmark: blocking pread vs afio thread pool
+ *
+ * reactor 에 1ms 주기 timer 를 걸어두고, page cache 를 비운 파일에서
+ * 임의 위치 block 을 reads 번 읽는다. timer 가 예정보다 늦게 불린 시간
+ * (tick lateness) 이 이벤트 루프가 멈춘 시간이다.
+ *
+ *   sync - 3.c 처럼 루프 스레드에서 직접 pread (O_NONBLOCK 이어도 막힘)
+ *   afio - afio_pread 로 depth 개를 동시에 띄우고, eventfd 로 완료를 받아
+ *          루프 스레드의 callback 에서 다음 요청을 제출
+ *
+ * 끝에 파일별 순서 (같은 offset 에 연속 pwrite 후 마지막 값이 남는지) 와
+ * 취소가 동작하는지 확인한다.
+ *
+ * Output (CSV): mode,workers,depth,reads,seconds,mbps,tick_p99_us,tick_max_us
+ *
+ * Build: gcc -O2 -pthread -o async_file_bench async_file_bench.c async_file.c reactor.c
+ * Usage: ./async_file_bench [-f path] [-s file_size] [-b block] [-n reads] [-w workers] [-d depth]
+ */
+
+#define _GNU_SOURCE
+#include "async_file.h"
+#include "reactor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TICK_MS 1
+#define MAX_TICKS 1000000
+
+struct bench;
+
+/* 동시에 띄운 요청 하나가 쓰는 buffer */
+struct slot {
+    struct bench *b;
+    char *buf;
+};
+
+struct bench {
+    struct reactor *r;
+    struct afio_pool *io;
+    int fd;
+    char *bufs;
+    struct slot *slots;
+    size_t block;
+    uint64_t blocks;
+    long reads;
+    long issued;
+    long completed;
+    int failed;
+    unsigned int seed;
+    double last_tick;
+    double *late;
+    int nlate;
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    }
+    return v;
+}
+
+static void drop_cache(int fd) {
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int make_file(const char *path, uint64_t size) {
+    char buf[1 << 16];
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return -1;
+    for (uint64_t off = 0; off < size; off += sizeof(buf)) {
+        memset(buf, (int)(off >> 16), sizeof(buf));
+        if (pwrite(fd, buf, sizeof(buf), off) != (ssize_t)sizeof(buf)) {
+            close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+static void on_tick(struct reactor *r, int id, void *arg) {
+    struct bench *b = arg;
+    double now = now_sec();
+    (void)r;
+    (void)id;
+    if (b->last_tick > 0 && b->nlate < MAX_TICKS) {
+        double late = now - b->last_tick - TICK_MS / 1e3;
+        b->late[b->nlate++] = late > 0 ? late * 1e6 : 0;
+    }
+    b->last_tick = now;
+}
+
+static off_t random_off(struct bench *b) {
+    return (off_t)(rand_r(&b->seed) % b->blocks) * b->block;
+}
+
+static void on_read(struct afio_req *req, ssize_t res, void *arg);
+
+static int issue(struct bench *b, struct slot *s) {
+    struct afio_req *req = afio_pread(b->io, b->fd, s->buf, b->block, random_off(b),
+                                      AFIO_UNORDERED, on_read, s);
+    if (!req)
+        return -1;
+    afio_release(req);
+    b->issued++;
+    return 0;
+}
+
+static void on_read(struct afio_req *req, ssize_t res, void *arg) {
+    struct slot *s = arg;
+    struct bench *b = s->b;
+    (void)req;
+    if (res != (ssize_t)b->block)
+        b->failed = 1;
+    b->completed++;
+    if (!b->failed && b->issued < b->reads && issue(b, s) == -1)
+        b->failed = 1;
+    if (b->completed == b->issued)
+        reactor_stop(b->r);
+}
+
+static void on_io_done(struct reactor *r, int fd, uint32_t events, void *arg) {
+    (void)r;
+    (void)fd;
+    (void)events;
+    afio_reap(arg, 64);
+}
+
+static int run(const char *mode, struct bench *b, int workers, int depth) {
+    b->r = reactor_create();
+    if (!b->r)
+        return -1;
+    b->issued = b->completed = 0;
+    b->failed = 0;
+    b->nlate = 0;
+    b->last_tick = 0;
+    b->seed = 1;
+    drop_cache(b->fd);
+    reactor_add_timer(b->r, TICK_MS, 1, on_tick, b);
+
+    double t0 = now_sec();
+    if (workers == 0) {
+        for (long i = 0; i < b->reads && !b->failed; i++) {
+            if (pread(b->fd, b->bufs, b->block, random_off(b)) != (ssize_t)b->block)
+                b->failed = 1;
+            reactor_run_once(b->r, 0);
+        }
+    } else {
+        struct afio_params p = { .workers = workers, .max_pending = depth,
+                                 .nonblock_submit = 1, .completion_fd = 1 };
+        b->io = afio_create(&p);
+        if (!b->io || reactor_add(b->r, afio_fd(b->io), EPOLLIN, 0, on_io_done, b->io) == -1) {
+            afio_destroy(b->io);
+            reactor_destroy(b->r);
+            return -1;
+        }
+        for (long i = 0; i < depth && i < b->reads; i++)
+            if (issue(b, &b->slots[i]) == -1)
+                b->failed = 1;
+        reactor_run(b->r);
+        afio_destroy(b->io);
+        b->io = NULL;
+    }
+    double secs = now_sec() - t0;
+    reactor_destroy(b->r);
+
+    if (b->failed) {
+        errno = EIO;
+        return -1;
+    }
+    double p99 = 0, max = 0;
+    if (b->nlate > 0) {
+        qsort(b->late, b->nlate, sizeof(double), cmp_double);
+        p99 = b->late[b->nlate * 99 / 100];
+        max = b->late[b->nlate - 1];
+    }
+    printf("%s,%d,%d,%ld,%.4f,%.1f,%.0f,%.0f\n", mode, workers, workers ? depth : 1,
+           b->reads, secs, b->reads * (double)b->block / secs / 1e6, p99, max);
+    fflush(stdout);
+    return 0;
+}
+
+/* 같은 fd 에 연속으로 쓴 값 중 마지막이 남아야 하고, 취소된 요청은 실행되지 않아야 한다 */
+static int check_order_cancel(int fd) {
+    enum { N = 256 };
+    uint32_t vals[N];
+    struct afio_req *reqs[N];
+    struct afio_params p = { .workers = 4 };
+    struct afio_pool *io = afio_create(&p);
+    int ok = io != NULL;
+
+    for (int i = 0; ok && i < N; i++) {
+        vals[i] = i;
+        reqs[i] = afio_pwrite(io, fd, &vals[i], sizeof(vals[i]), 0, 0, NULL, NULL);
+        ok = reqs[i] != NULL;
+    }
+    struct afio_req *sync = ok ? afio_fsync(io, fd, 1, 0, NULL, NULL) : NULL;
+    int cancelled = 0;
+    for (int i = N / 2; ok && i < N; i++)
+        if (afio_cancel(reqs[i]) == 0)
+            cancelled++;
+    if (sync && afio_wait(sync) == -1)
+        ok = 0;
+    afio_release(sync);
+
+    /* 취소되지 않은 것 중 마지막 값 */
+    uint32_t expect = 0, got = ~0u;
+    for (int i = 0; ok && i < N; i++) {
+        ssize_t res = afio_wait(reqs[i]);
+        if (res == (ssize_t)sizeof(uint32_t))
+            expect = vals[i];
+        else if (!(res == -1 && errno == ECANCELED))
+            ok = 0;
+        afio_release(reqs[i]);
+    }
+    if (ok && pread(fd, &got, sizeof(got), 0) != sizeof(got))
+        ok = 0;
+    afio_destroy(io);
+
+    if (!ok || got != expect) {
+        fprintf(stderr, "order check failed: got %u, expected %u\n", got, expect);
+        return -1;
+    }
+    fprintf(stderr, "order check ok (%d of %d cancelled)\n", cancelled, N);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = "afio_bench.dat";
+    uint64_t size = 256ULL << 20;
+    size_t block = 64 * 1024;
+    long reads = 4096;
+    int workers = 8, depth = 32;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:s:b:n:w:d:")) != -1) {
+        switch (opt) {
+        case 'f': path = optarg; break;
+        case 's': size = parse_size(optarg); break;
+        case 'b': block = parse_size(optarg); break;
+        case 'n': reads = atol(optarg); break;
+        case 'w': workers = atoi(optarg); break;
+        case 'd': depth = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-f path] [-s file_size] [-b block] [-n reads] "
+                    "[-w workers] [-d depth]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (block == 0 || size < block || reads < 1 || workers < 1 || depth < 1) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    struct bench b = { .block = block, .blocks = size / block, .reads = reads };
+    b.fd = make_file(path, size);
+    b.bufs = malloc(block * depth);
+    b.slots = malloc(depth * sizeof(*b.slots));
+    b.late = malloc(MAX_TICKS * sizeof(double));
+    if (b.fd < 0 || !b.bufs || !b.slots || !b.late) {
+        perror("setup");
+        return 1;
+    }
+    for (int i = 0; i < depth; i++) {
+        b.slots[i].b = &b;
+        b.slots[i].buf = b.bufs + (size_t)i * block;
+    }
+
+    printf("mode,workers,depth,reads,seconds,mbps,tick_p99_us,tick_max_us\n");
+    if (run("sync", &b, 0, 1) == -1) {
+        perror("sync");
+        return 1;
+    }
+    for (int w = 1; w <= workers; w *= 2) {
+        if (run("afio", &b, w, depth) == -1) {
+            perror("afio");
+            return 1;
+        }
+    }
+
+    int ret = check_order_cancel(b.fd) == 0 ? 0 : 1;
+    close(b.fd);
+    unlink(path);
+    free(b.bufs);
+    free(b.slots);
+    free(b.late);
+    return ret;
+}
@@ -0,0 +1,425 @@
+/*
+ * Bulk File Creation - 구현
+ *
+ * Build: gcc -O2 -pthread -c bulk_create.c
+ */
+
+#define _GNU_SOURCE
+#include "bulk_create.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define FILL_BUF (64 * 1024)
+
+struct item {
+    const char *path;
+    size_t dirlen;               /* 마지막 '/' 위치, root 바로 아래면 0 */
+    uint64_t size;
+};
+
+struct group {
+    size_t start, end;           /* items[start, end) 가 같은 디렉터리 */
+};
+
+struct job {
+    const char *root;
+    int root_fd;
+    const struct bcr_options *o;
+    const struct item *items;
+    const struct group *groups;
+    size_t ngroups;
+    const char *fill;            /* content 를 되풀이한 버퍼 */
+    size_t fill_len;
+    mode_t mode;
+    atomic_size_t next;
+    atomic_int error;            /* 처음 실패의 errno */
+    atomic_uint_fast64_t files, failed, dirs_created, bytes;
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmp_dir(const void *a, const void *b) {
+    const struct item *x = a, *y = b;
+    size_t n = x->dirlen < y->dirlen ? x->dirlen : y->dirlen;
+    int c = memcmp(x->path, y->path, n);
+    if (c)
+        return c;
+    return (x->dirlen > y->dirlen) - (x->dirlen < y->dirlen);
+}
+
+static void set_error(struct job *j, int err) {
+    int zero = 0;
+    atomic_compare_exchange_strong(&j->error, &zero, err ? err : EIO);
+}
+
+/* root_fd 기준으로 dir 의 모든 단계를 만든다. 다른 worker 가 먼저 만든 것은 괜찮다 */
+static int mkdir_p(int root_fd, const char *dir, uint64_t *created) {
+    char tmp[PATH_MAX];
+    size_t len = strlen(dir);
+    if (len >= sizeof(tmp)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    memcpy(tmp, dir, len + 1);
+    for (size_t i = 1; i <= len; i++) {
+        if (tmp[i] != '/' && tmp[i] != '\0')
+            continue;
+        char c = tmp[i];
+        tmp[i] = '\0';
+        if (mkdirat(root_fd, tmp, 0755) == 0)
+            (*created)++;
+        else if (errno != EEXIST)
+            return -1;
+        tmp[i] = c;
+    }
+    return 0;
+}
+
+/* short write 뒤에도 무늬가 이어지도록 fill 안의 같은 위치부터 다시 쓴다
+ * (fill_len 은 content_len 의 배수) */
+static int fill_file(int fd, const struct job *j, uint64_t size, uint64_t *written) {
+    uint64_t done = 0;
+    while (done < size) {
+        size_t phase = done % j->fill_len;
+        size_t left = j->fill_len - phase;
+        size_t want = size - done < left ? size - done : left;
+        ssize_t n = write(fd, j->fill + phase, want);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        done += n;
+    }
+    *written += done;
+    return 0;
+}
+
+static int create_one(struct job *j, int dfd, const char *name, uint64_t size,
+                      uint64_t *written) {
+    const struct bcr_options *o = j->o;
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | (o->exclusive ? O_EXCL : 0);
+    int fd = openat(dfd, name, flags, j->mode);
+    if (fd == -1)
+        return -1;
+
+    int sized = 0;
+    if (o->preallocate && size) {
+        if (fallocate(fd, 0, 0, size) == 0)
+            sized = 1;
+        else if (errno != EOPNOTSUPP && errno != ENOSYS)
+            goto fail;
+    }
+    if (o->write_data && size) {
+        if (fill_file(fd, j, size, written) == -1)
+            goto fail;
+        sized = 1;
+    }
+    if (!sized && size && ftruncate(fd, size) == -1)
+        goto fail;
+    return close(fd);
+
+fail:;
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return -1;
+}
+
+/* 디렉터리 하나 (group) 를 처리한다 */
+static void run_group(struct job *j, const struct group *g, uint64_t *files, uint64_t *failed,
+                      uint64_t *dirs_created, uint64_t *written) {
+    const struct item *first = &j->items[g->start];
+    size_t count = g->end - g->start;
+    char dir[PATH_MAX];
+    int dfd = j->root_fd;
+
+    if (first->dirlen >= sizeof(dir)) {
+        errno = ENAMETOOLONG;
+        goto fail_all;
+    }
+    memcpy(dir, first->path, first->dirlen);
+    dir[first->dirlen] = '\0';
+
+    if (first->dirlen) {
+        if (j->o->mkdirs && mkdir_p(j->root_fd, dir, dirs_created) == -1)
+            goto fail_all;
+        if (!j->o->full_path) {
+            dfd = openat(j->root_fd, dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (dfd == -1)
+                goto fail_all;
+        }
+    }
+
+    for (size_t i = g->start; i < g->end; i++) {
+        const struct item *it = &j->items[i];
+        int r;
+        if (j->o->full_path) {
+            /* 1.c 처럼 매번 경로 전체를 넘긴다 */
+            char path[PATH_MAX];
+            if ((size_t)snprintf(path, sizeof(path), "%s/%s", j->root, it->path) >= sizeof(path)) {
+                errno = ENAMETOOLONG;
+                r = -1;
+            } else {
+                r = create_one(j, AT_FDCWD, path, it->size, written);
+            }
+        } else {
+            r = create_one(j, dfd, it->path + it->dirlen + (it->dirlen ? 1 : 0), it->size,
+                           written);
+        }
+        if (r == -1) {
+            set_error(j, errno);
+            (*failed)++;
+        } else {
+            (*files)++;
+        }
+    }
+    if (dfd != j->root_fd)
+        close(dfd);
+    return;
+
+fail_all:
+    set_error(j, errno);
+    *failed += count;
+}
+
+static void *worker_main(void *arg) {
+    struct job *j = arg;
+    uint64_t files = 0, failed = 0, dirs_created = 0, written = 0;
+    size_t g;
+
+    while ((g = atomic_fetch_add(&j->next, 1)) < j->ngroups)
+        run_group(j, &j->groups[g], &files, &failed, &dirs_created, &written);
+
+    atomic_fetch_add(&j->files, files);
+    atomic_fetch_add(&j->failed, failed);
+    atomic_fetch_add(&j->dirs_created, dirs_created);
+    atomic_fetch_add(&j->bytes, written);
+    return NULL;
+}
+
+/* root 기준 상대 경로만: 절대 경로와 ".." component 는 root 밖으로 나간다 */
+static int valid_path(const char *path) {
+    if (!*path || *path == '/')
+        return 0;
+    for (const char *p = path; *p; ) {
+        size_t len = strcspn(p, "/");
+        if (len == 2 && p[0] == '.' && p[1] == '.')
+            return 0;
+        p += len;
+        if (*p == '/')
+            p++;
+    }
+    return 1;
+}
+
+static int open_root(const char *root, int mkdirs) {
+    int fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1 && errno == ENOENT && mkdirs) {
+        uint64_t created = 0;
+        if (mkdir_p(AT_FDCWD, root, &created) == -1)
+            return -1;
+        fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    }
+    return fd;
+}
+
+/* content 를 FILL_BUF 근처까지 되풀이해 둔다. 길이는 content_len 의 배수라
+ * 여러 번 써도 무늬가 이어진다 */
+static char *make_fill(const struct bcr_options *o, size_t *len) {
+    size_t clen = o->content && o->content_len ? o->content_len : 0;
+    size_t n = clen == 0 ? FILL_BUF : clen >= FILL_BUF ? clen : FILL_BUF / clen * clen;
+    char *p = clen ? malloc(n) : calloc(1, n);
+    if (!p)
+        return NULL;
+    for (size_t off = 0; clen && off < n; off += clen)
+        memcpy(p + off, o->content, clen);
+    *len = n;
+    return p;
+}
+
+int bcr_create(const char *root, const struct bcr_entry *v, size_t n,
+               const struct bcr_options *opts, struct bcr_stats *stats) {
+    struct bcr_options defaults = { 0 };
+    const struct bcr_options *o = opts ? opts : &defaults;
+    struct bcr_stats local;
+    struct item *items = NULL;
+    struct group *groups = NULL;
+    pthread_t *tids = NULL;
+    char *fill = NULL;
+    int ret = -1;
+
+    if (!stats)
+        stats = &local;
+    memset(stats, 0, sizeof(*stats));
+    if (!root || !*root)
+        root = ".";
+    double t0 = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        if (!valid_path(v[i].path)) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+
+    struct job j = {
+        .root = root,
+        .root_fd = -1,
+        .o = o,
+        .mode = o->mode ? o->mode : 0644,
+    };
+
+    items = malloc((n ? n : 1) * sizeof(*items));
+    groups = malloc((n ? n : 1) * sizeof(*groups));
+    if (!items || !groups)
+        goto out;
+    if (o->write_data && !(fill = make_fill(o, &j.fill_len)))
+        goto out;
+    j.fill = fill;
+
+    for (size_t i = 0; i < n; i++) {
+        const char *slash = strrchr(v[i].path, '/');
+        items[i] = (struct item){ v[i].path, slash ? (size_t)(slash - v[i].path) : 0, v[i].size };
+    }
+    qsort(items, n, sizeof(*items), cmp_dir);
+    for (size_t i = 0; i < n; i++) {
+        if (i == 0 || cmp_dir(&items[i - 1], &items[i]) != 0)
+            groups[j.ngroups++] = (struct group){ i, i };
+        groups[j.ngroups - 1].end = i + 1;
+    }
+    j.items = items;
+    j.groups = groups;
+
+    if ((j.root_fd = open_root(root, o->mkdirs)) == -1)
+        goto out;
+
+    /* 디렉터리 수보다 많은 worker 는 할 일이 없다 */
+    size_t threads = o->threads > 1 ? (size_t)o->threads : 1;
+    if (threads > j.ngroups)
+        threads = j.ngroups ? j.ngroups : 1;
+    size_t started = 0;
+    if (threads > 1) {
+        if (!(tids = malloc((threads - 1) * sizeof(*tids))))
+            goto out;
+        for (; started < threads - 1; started++)
+            if (pthread_create(&tids[started], NULL, worker_main, &j) != 0)
+                break;
+    }
+    worker_main(&j);
+    for (size_t i = 0; i < started; i++)
+        pthread_join(tids[i], NULL);
+
+    stats->files = j.files;
+    stats->failed = j.failed;
+    stats->dirs = j.ngroups;
+    stats->dirs_created = j.dirs_created;
+    stats->bytes = j.bytes;
+    if (j.failed)
+        errno = j.error;
+    else
+        ret = 0;
+
+out:;
+    int saved = errno;
+    if (j.root_fd != -1)
+        close(j.root_fd);
+    free(tids);
+    free(fill);
+    free(groups);
+    free(items);
+    stats->seconds = now_sec() - t0;
+    errno = saved;
+    return ret;
+}
+
+int bcr_manifest_load(const char *path, struct bcr_manifest *m) {
+    struct stat st;
+    size_t len = 0;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    memset(m, 0, sizeof(*m));
+    if (fd == -1)
+        return -1;
+    if (fstat(fd, &st) == -1 || !(m->buf = malloc(st.st_size + 1)))
+        goto fail;
+    while (len < (size_t)st.st_size) {
+        ssize_t r = read(fd, m->buf + len, st.st_size - len);
+        if (r == -1) {
+            if (errno == EINTR)
+                continue;
+            goto fail;
+        }
+        if (r == 0)
+            break;
+        len += r;
+    }
+    close(fd);
+    fd = -1;
+    m->buf[len] = '\0';
+
+    /* 줄을 제자리에서 잘라 path 가 buf 를 가리키게 한다 */
+    char *p = m->buf, *end = m->buf + len;
+    while (p < end) {
+        char *nl = memchr(p, '\n', end - p);
+        char *eol = nl ? nl : end;
+        *eol = '\0';
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (*p && *p != '#' && *p != '\r') {
+            char *q = p + strcspn(p, " \t\r");
+            uint64_t size = 0;
+            if (*q) {
+                *q++ = '\0';
+                q += strspn(q, " \t");
+                if (*q && *q != '\r') {
+                    char *e;
+                    errno = 0;
+                    size = strtoull(q, &e, 10);
+                    if (errno || e == q || (*e && *e != '\r' && *e != ' ' && *e != '\t')) {
+                        errno = EINVAL;
+                        goto fail;
+                    }
+                }
+            }
+            if (m->n == m->cap) {
+                size_t ncap = m->cap ? m->cap * 2 : 1024;
+                struct bcr_entry *nv = realloc(m->v, ncap * sizeof(*nv));
+                if (!nv)
+                    goto fail;
+                m->v = nv;
+                m->cap = ncap;
+            }
+            m->v[m->n++] = (struct bcr_entry){ p, size };
+        }
+        p = eol + 1;
+    }
+    return 0;
+
+fail:;
+    int saved = errno;
+    if (fd != -1)
+        close(fd);
+    bcr_manifest_free(m);
+    errno = saved;
+    return -1;
+}
+
+void bcr_manifest_free(struct bcr_manifest *m) {
+    free(m->v);
+    free(m->buf);
+    memset(m, 0, sizeof(*m));
+}
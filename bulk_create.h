@@ -0,0 +1,83 @@
+/*
+ * Bulk File Creation
+ *
+ * 1.c 는 프로세스 하나가 creat() 로 파일 하나를 만든다. 작은 파일 수십만 개를
+ * 만들면 프로세스 시작과, 파일마다 경로 전체를 처음부터 찾는 비용이 대부분이다.
+ *
+ * bcr 는 manifest (경로 + 크기 목록) 를 받아 한 프로세스에서 만든다.
+ *
+ *   - 디렉터리별로 묶어서 디렉터리 fd 를 한 번 열고, 그 안의 파일은
+ *     openat(dir_fd, 파일 이름) 으로 만든다 (경로 탐색은 이름 한 단계뿐)
+ *   - worker 들은 디렉터리 단위로 일을 가져간다. 한 디렉터리는 한 worker 만
+ *     만지므로 디렉터리 inode lock 을 두고 다투지 않는다
+ *   - 필요하면 같은 pass 에서 fallocate 로 크기만큼 미리 잡고 내용까지 쓴다
+ *
+ * 디렉터리 하나에 파일이 몰려 있으면 그 디렉터리는 worker 하나가 처리한다.
+ *
+ * manifest 파일 형식 (한 줄에 하나, '#' 줄과 빈 줄은 무시):
+ *   <root 기준 상대 경로> [크기]
+ *   예) logs/2024/a.txt 4096
+ *
+ * 사용 예:
+ *   struct bcr_manifest m;
+ *   struct bcr_options o = { .threads = 8, .mkdirs = 1, .write_data = 1 };
+ *   struct bcr_stats st;
+ *   bcr_manifest_load("files.txt", &m);
+ *   bcr_create("out", m.v, m.n, &o, &st);
+ *   bcr_manifest_free(&m);
+ *
+ * Build: gcc -O2 -pthread -c bulk_create.c
+ */
+
+#ifndef BULK_CREATE_H
+#define BULK_CREATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+struct bcr_entry {
+    const char *path;            /* root 기준 상대 경로 */
+    uint64_t size;
+};
+
+struct bcr_manifest {
+    struct bcr_entry *v;
+    size_t n;
+    size_t cap;
+    char *buf;                   /* path 들이 가리키는 manifest 내용 */
+};
+
+struct bcr_options {
+    int threads;                 /* 0/1 이면 단일 스레드 */
+    int mkdirs;                  /* 1 이면 없는 디렉터리를 만든다 */
+    int exclusive;               /* 1 이면 O_EXCL (이미 있으면 실패) */
+    int preallocate;             /* 1 이면 fallocate(size) */
+    int write_data;              /* 1 이면 size 만큼 content 를 되풀이해 쓴다 */
+    const void *content;         /* NULL 이면 0 */
+    size_t content_len;
+    mode_t mode;                 /* 0 이면 0644 */
+    int full_path;               /* 1 이면 디렉터리 fd 없이 open(root/path) (비교용) */
+};
+
+/* 크기는 write_data 면 쓴 만큼, preallocate 면 fallocate 로,
+ * 둘 다 아니면 ftruncate 로 (hole) 맞춘다 */
+struct bcr_stats {
+    uint64_t files;              /* 만든 파일 */
+    uint64_t failed;             /* 실패한 파일 */
+    uint64_t dirs;               /* 서로 다른 디렉터리 수 */
+    uint64_t dirs_created;
+    uint64_t bytes;              /* 쓴 바이트 */
+    double seconds;
+};
+
+/* 실패한 파일이 있어도 나머지는 계속 만든다. 하나라도 실패하면 -1 과
+ * 처음 실패의 errno. 절대 경로나 ".." component 가 있으면 아무것도 만들지 않고
+ * -1 (EINVAL) */
+int bcr_create(const char *root, const struct bcr_entry *v, size_t n,
+               const struct bcr_options *opts, struct bcr_stats *stats);
+
+int bcr_manifest_load(const char *path, struct bcr_manifest *m);
+void bcr_manifest_free(struct bcr_manifest *m);
+
+#endif
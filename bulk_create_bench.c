@@ -0,0 +1,245 @@
+/*
+ * Bulk File Creation Benchmark
+ *
+ * manifest 에 적힌 작은 파일 -n 개 (디렉터리 -D 개에 나눠서) 를 만드는 속도.
+ *
+ *   1c_loop       - 파일마다 1.c 바이너리 (-b) 를 실행 (빈 파일, 디렉터리는 미리 만듦)
+ *                   느리므로 처음 -x 개만
+ *   path          - bcr, full_path: 한 프로세스지만 매번 open(경로 전체)
+ *   openat        - bcr, 디렉터리 fd + openat, 스레드 1 개와 -t 개
+ *   openat_data   - 위 + 크기 -s 만큼 내용 쓰기
+ *   openat_falloc - 위 + fallocate 로 미리 잡기
+ *
+ * 빈 파일 행은 file_size 0. 매 측정 전 트리를 지우고 sync 한다.
+ *
+ * Output (CSV): method,threads,files,dirs,file_size,seconds,files_per_sec,mb_per_sec
+ *
+ * Build: gcc -O2 -pthread -o bulk_create_bench bulk_create_bench.c bulk_create.c
+ *        gcc -O2 -o 1 1.c
+ * Usage: ./bulk_create_bench [-d dir] [-n files] [-D dirs] [-s size] [-t threads]
+ *                            [-b path_to_1] [-x spawn_files]
+ */
+
+#define _GNU_SOURCE
+#include "bulk_create.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <spawn.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    }
+    return v;
+}
+
+static int rm_entry(const char *path, const struct stat *st, int flag, struct FTW *ftw) {
+    (void)st;
+    (void)flag;
+    (void)ftw;
+    return remove(path) == -1 && errno != ENOENT ? -1 : 0;
+}
+
+static int rm_tree(const char *dir) {
+    if (access(dir, F_OK) == -1)
+        return 0;
+    return nftw(dir, rm_entry, 64, FTW_DEPTH | FTW_PHYS);
+}
+
+/* 2 단계 디렉터리 gXX/dXXXX 아래에 파일을 고르게 나눈다 */
+static int write_manifest(const char *path, size_t files, size_t dirs, uint64_t size) {
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return -1;
+    fprintf(f, "# bulk_create_bench manifest\n");
+    for (size_t i = 0; i < files; i++) {
+        size_t d = i % dirs;
+        fprintf(f, "g%02zu/d%04zu/f%07zu %llu\n", d % 16, d, i, (unsigned long long)size);
+    }
+    return fclose(f);
+}
+
+static void report(const char *method, int threads, uint64_t files, uint64_t dirs,
+                   uint64_t size, double secs) {
+    printf("%s,%d,%llu,%llu,%llu,%.4f,%.0f,%.1f\n", method, threads,
+           (unsigned long long)files, (unsigned long long)dirs, (unsigned long long)size,
+           secs, files / secs, files * size / secs / (1024.0 * 1024.0));
+    fflush(stdout);
+}
+
+/* 1.c 를 파일마다 실행. 디렉터리는 시간 밖에서 bcr 로 미리 만든다 */
+static int run_spawn(const char *bin, const char *root, const struct bcr_manifest *m,
+                     size_t count) {
+    struct bcr_options o = { .mkdirs = 1 };
+    struct bcr_stats st;
+    char path[8192];
+
+    if (rm_tree(root) == -1 || bcr_create(root, m->v, m->n, &o, &st) == -1)
+        return -1;
+    /* 파일만 지우고 디렉터리는 남긴다 */
+    for (size_t i = 0; i < m->n; i++) {
+        snprintf(path, sizeof(path), "%s/%s", root, m->v[i].path);
+        if (unlink(path) == -1)
+            return -1;
+    }
+    sync();
+
+    double t0 = now_sec();
+    for (size_t i = 0; i < count; i++) {
+        char *argv[] = { (char *)bin, path, NULL };
+        pid_t pid;
+        int status;
+        snprintf(path, sizeof(path), "%s/%s", root, m->v[i].path);
+        if (posix_spawn(&pid, bin, NULL, NULL, argv, environ) != 0 ||
+            waitpid(pid, &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "%s %s failed\n", bin, path);
+            return -1;
+        }
+    }
+    report("1c_loop", 1, count, 0, 0, now_sec() - t0);
+    return 0;
+}
+
+static int run_bcr(const char *method, const char *root, const struct bcr_manifest *m,
+                   struct bcr_options *o, uint64_t size) {
+    struct bcr_stats st;
+
+    if (rm_tree(root) == -1)
+        return -1;
+    sync();
+    if (bcr_create(root, m->v, m->n, o, &st) == -1) {
+        fprintf(stderr, "%s: %s (%llu failed)\n", method, strerror(errno),
+                (unsigned long long)st.failed);
+        return -1;
+    }
+
+    /* 마지막 파일의 크기와 앞부분 내용 확인 */
+    char path[8192];
+    struct stat sb;
+    snprintf(path, sizeof(path), "%s/%s", root, m->v[m->n - 1].path);
+    int ok = st.files == m->n && stat(path, &sb) == 0 && (uint64_t)sb.st_size == size;
+    if (ok && o->write_data && size >= o->content_len) {
+        char head[256];
+        int fd = open(path, O_RDONLY);
+        ok = fd >= 0 && o->content_len <= sizeof(head) &&
+             read(fd, head, o->content_len) == (ssize_t)o->content_len &&
+             memcmp(head, o->content, o->content_len) == 0;
+        if (fd >= 0)
+            close(fd);
+    }
+    if (!ok) {
+        fprintf(stderr, "%s: check failed\n", method);
+        return -1;
+    }
+    report(method, o->threads ? o->threads : 1, st.files, st.dirs, size, st.seconds);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *dir = "bcr_bench_dir", *bin = "./1";
+    size_t files = 20000, dirs = 64, spawn_files = 1000;
+    uint64_t size = 4096;
+    int threads = 4, opt;
+    char root[4096], manifest[4096], manifest0[4096];
+
+    while ((opt = getopt(argc, argv, "d:n:D:s:t:b:x:")) != -1) {
+        switch (opt) {
+        case 'd': dir = optarg; break;
+        case 'n': files = strtoull(optarg, NULL, 10); break;
+        case 'D': dirs = strtoull(optarg, NULL, 10); break;
+        case 's': size = parse_size(optarg); break;
+        case 't': threads = atoi(optarg); break;
+        case 'b': bin = optarg; break;
+        case 'x': spawn_files = strtoull(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "Usage: %s [-d dir] [-n files] [-D dirs] [-s size] [-t threads] "
+                    "[-b path_to_1] [-x spawn_files]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (files < 1 || dirs < 1 || threads < 1) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+    if (mkdir(dir, 0755) == -1 && errno != EEXIST) {
+        perror(dir);
+        return 1;
+    }
+    snprintf(root, sizeof(root), "%s/tree", dir);
+    snprintf(manifest, sizeof(manifest), "%s/manifest.txt", dir);
+    snprintf(manifest0, sizeof(manifest0), "%s/manifest0.txt", dir);
+
+    struct bcr_manifest m, m0;
+    if (write_manifest(manifest, files, dirs, size) == -1 ||
+        write_manifest(manifest0, files, dirs, 0) == -1 ||
+        bcr_manifest_load(manifest, &m) == -1 || bcr_manifest_load(manifest0, &m0) == -1) {
+        perror("manifest");
+        return 1;
+    }
+
+    static const char pattern[] = "bulk_create_bench\n";
+    struct {
+        const char *name;
+        int threads, full_path, data, falloc;
+    } runs[] = {
+        { "path", 1, 1, 0, 0 },
+        { "openat", 1, 0, 0, 0 },
+        { "openat", threads, 0, 0, 0 },
+        { "openat_data", 1, 0, 1, 0 },
+        { "openat_data", threads, 0, 1, 0 },
+        { "openat_falloc", threads, 0, 1, 1 },
+    };
+
+    printf("method,threads,files,dirs,file_size,seconds,files_per_sec,mb_per_sec\n");
+    int ret = 0;
+    if (access(bin, X_OK) == 0) {
+        if (run_spawn(bin, root, &m0, spawn_files < files ? spawn_files : files) == -1)
+            ret = 1;
+    } else {
+        fprintf(stderr, "%s not found, skipping 1c_loop (gcc -O2 -o 1 1.c)\n", bin);
+    }
+    for (size_t i = 0; ret == 0 && i < sizeof(runs) / sizeof(runs[0]); i++) {
+        struct bcr_options o = {
+            .threads = runs[i].threads,
+            .mkdirs = 1,
+            .full_path = runs[i].full_path,
+            .write_data = runs[i].data,
+            .preallocate = runs[i].falloc,
+            .content = pattern,
+            .content_len = sizeof(pattern) - 1,
+        };
+        if (run_bcr(runs[i].name, root, runs[i].data ? &m : &m0, &o,
+                    runs[i].data ? size : 0) == -1)
+            ret = 1;
+    }
+
+    rm_tree(root);
+    unlink(manifest);
+    unlink(manifest0);
+    rmdir(dir);
+    bcr_manifest_free(&m);
+    bcr_manifest_free(&m0);
+    return ret;
+}
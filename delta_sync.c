@@ -0,0 +1,486 @@
+/*
+ * Rolling-Checksum Delta Sync - 구현
+ *
+ * 두 파일 모두 읽기 전용으로 mmap 한다. 서명 -> 탐색 -> 적용 순서이고,
+ * 적용은 매핑을 모두 내린 뒤 한 스레드에서 offset 순서대로 한다.
+ *
+ * Build: gcc -O2 -pthread -c delta_sync.c
+ */
+
+#define _GNU_SOURCE
+#include "delta_sync.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MAX_XFER 0x7ffff000
+
+struct sig {
+    uint32_t weak;
+    uint64_t strong;
+};
+
+/* dst_off < 0 이면 literal */
+struct op {
+    uint64_t src_off;
+    uint64_t len;
+    int64_t dst_off;
+};
+
+struct oplist {
+    struct op *v;
+    size_t n, cap;
+};
+
+struct ctx {
+    const unsigned char *src, *dst;
+    uint64_t src_size, dst_size;
+    size_t bs;
+
+    uint64_t nblocks;            /* 대상의 꽉 찬 block 수 */
+    struct sig *sigs;
+    uint32_t *heads;             /* weak hash -> block + 1 */
+    uint32_t *chain;             /* block -> 같은 칸의 다음 block + 1 */
+    unsigned int bits;
+
+    uint64_t tail_len;           /* 대상 끝의 모자란 block */
+    uint64_t tail_strong;
+};
+
+struct task {
+    struct ctx *c;
+    uint64_t start, end;         /* sig: block 번호, scan: 원본 offset */
+    struct oplist ops;
+    int failed;
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* MurmurHash64A 와 같은 섞기 */
+static uint64_t strong_hash(const unsigned char *p, size_t len) {
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ (len * m);
+
+    while (len >= 8) {
+        uint64_t k;
+        memcpy(&k, p, 8);
+        k *= m;
+        k ^= k >> 47;
+        k *= m;
+        h ^= k;
+        h *= m;
+        p += 8;
+        len -= 8;
+    }
+    if (len) {
+        uint64_t k = 0;
+        memcpy(&k, p, len);
+        h ^= k;
+        h *= m;
+    }
+    h ^= h >> 47;
+    h *= m;
+    h ^= h >> 47;
+    return h;
+}
+
+/* rsync 의 weak checksum: s1 = sum x, s2 = sum (n - i) x (각각 mod 2^16) */
+static void weak_init(const unsigned char *p, size_t n, uint32_t *s1, uint32_t *s2) {
+    uint32_t a = 0, b = 0;
+    for (size_t i = 0; i < n; i++) {
+        a += p[i];
+        b += (uint32_t)(n - i) * p[i];
+    }
+    *s1 = a;
+    *s2 = b;
+}
+
+static uint32_t weak_value(uint32_t s1, uint32_t s2) {
+    return (s1 & 0xffff) | (s2 << 16);
+}
+
+static uint32_t bucket(const struct ctx *c, uint32_t weak) {
+    return (weak * 0x9e3779b1u) >> (32 - c->bits);
+}
+
+static int push_op(struct oplist *l, uint64_t src_off, uint64_t len, int64_t dst_off) {
+    if (len == 0)
+        return 0;
+    /* 이어지는 literal 은 하나로 */
+    if (dst_off < 0 && l->n && l->v[l->n - 1].dst_off < 0 &&
+        l->v[l->n - 1].src_off + l->v[l->n - 1].len == src_off) {
+        l->v[l->n - 1].len += len;
+        return 0;
+    }
+    if (l->n == l->cap) {
+        size_t ncap = l->cap ? l->cap * 2 : 256;
+        struct op *p = realloc(l->v, ncap * sizeof(*p));
+        if (!p)
+            return -1;
+        l->v = p;
+        l->cap = ncap;
+    }
+    l->v[l->n++] = (struct op){ src_off, len, dst_off };
+    return 0;
+}
+
+static int run_tasks(void *(*fn)(void *), struct task *tasks, int n) {
+    pthread_t *tids = n > 1 ? malloc((n - 1) * sizeof(*tids)) : NULL;
+    int started = 0, ret = 0;
+
+    if (n > 1 && !tids)
+        return -1;
+    for (; started < n - 1; started++)
+        if (pthread_create(&tids[started], NULL, fn, &tasks[started + 1]) != 0)
+            break;
+    /* 못 띄운 것은 이 스레드에서 */
+    for (int i = started + 1; i < n; i++)
+        fn(&tasks[i]);
+    fn(&tasks[0]);
+    for (int i = 0; i < started; i++)
+        pthread_join(tids[i], NULL);
+    for (int i = 0; i < n; i++)
+        if (tasks[i].failed)
+            ret = -1;
+    free(tids);
+    return ret;
+}
+
+/* ---------- 1. 서명 ---------- */
+
+static void *sig_main(void *arg) {
+    struct task *t = arg;
+    struct ctx *c = t->c;
+
+    for (uint64_t b = t->start; b < t->end; b++) {
+        const unsigned char *p = c->dst + b * c->bs;
+        uint32_t s1, s2;
+        weak_init(p, c->bs, &s1, &s2);
+        c->sigs[b].weak = weak_value(s1, s2);
+        c->sigs[b].strong = strong_hash(p, c->bs);
+    }
+    return NULL;
+}
+
+static int build_signatures(struct ctx *c, int threads) {
+    c->nblocks = c->dst_size / c->bs;
+    c->tail_len = c->dst_size % c->bs;
+    if (c->nblocks >= UINT32_MAX) {
+        errno = EFBIG;
+        return -1;
+    }
+    if (c->tail_len)
+        c->tail_strong = strong_hash(c->dst + c->nblocks * c->bs, c->tail_len);
+
+    c->bits = 4;
+    while ((1ULL << c->bits) < c->nblocks * 2)
+        c->bits++;
+    c->sigs = malloc((c->nblocks ? c->nblocks : 1) * sizeof(*c->sigs));
+    c->chain = calloc(c->nblocks ? c->nblocks : 1, sizeof(*c->chain));
+    c->heads = calloc(1ULL << c->bits, sizeof(*c->heads));
+    if (!c->sigs || !c->chain || !c->heads)
+        return -1;
+
+    if ((uint64_t)threads > c->nblocks)
+        threads = c->nblocks ? (int)c->nblocks : 1;
+    struct task *tasks = calloc(threads, sizeof(*tasks));
+    if (!tasks)
+        return -1;
+    uint64_t per = (c->nblocks + threads - 1) / threads;
+    for (int i = 0; i < threads; i++) {
+        tasks[i].c = c;
+        tasks[i].start = per * i < c->nblocks ? per * i : c->nblocks;
+        tasks[i].end = per * (i + 1) < c->nblocks ? per * (i + 1) : c->nblocks;
+    }
+    int ret = run_tasks(sig_main, tasks, threads);
+    free(tasks);
+
+    /* 뒤에서부터 넣어서 chain 이 앞 block 부터 나오게 */
+    for (uint64_t b = c->nblocks; b-- > 0;) {
+        uint32_t h = bucket(c, c->sigs[b].weak);
+        c->chain[b] = c->heads[h];
+        c->heads[h] = (uint32_t)b + 1;
+    }
+    return ret;
+}
+
+/* ---------- 2. 탐색 ---------- */
+
+/* 원본 o 에서 시작하는 창과 같은 대상 block. 없으면 -1 */
+static int64_t lookup(const struct ctx *c, uint32_t weak, uint64_t o) {
+    const unsigned char *win = c->src + o;
+    uint64_t strong = 0;
+    int have = 0;
+
+    /* 같은 위치의 block 부터: 거의 안 바뀐 파일에서는 대부분 여기서 끝난다 */
+    uint64_t same = o / c->bs;
+    if (o % c->bs == 0 && same < c->nblocks && c->sigs[same].weak == weak) {
+        strong = strong_hash(win, c->bs);
+        have = 1;
+        if (c->sigs[same].strong == strong)
+            return (int64_t)same;
+    }
+    for (uint32_t i = c->heads[bucket(c, weak)]; i; i = c->chain[i - 1]) {
+        const struct sig *s = &c->sigs[i - 1];
+        if (s->weak != weak)
+            continue;
+        if (!have) {
+            strong = strong_hash(win, c->bs);
+            have = 1;
+        }
+        if (s->strong == strong)
+            return (int64_t)i - 1;
+    }
+    return -1;
+}
+
+/* [start, end) 에서 시작하는 창을 본다. 마지막 match 는 end 를 넘을 수 있다 */
+static void *scan_main(void *arg) {
+    struct task *t = arg;
+    struct ctx *c = t->c;
+    const unsigned char *src = c->src;
+    uint64_t size = c->src_size, bs = c->bs;
+    uint64_t o = t->start, lit = t->start;
+    uint32_t s1 = 0, s2 = 0;
+    int have = 0;
+
+    while (c->nblocks && o < t->end && o + bs <= size) {
+        if (!have) {
+            weak_init(src + o, bs, &s1, &s2);
+            have = 1;
+        }
+        int64_t blk = lookup(c, weak_value(s1, s2), o);
+        if (blk >= 0) {
+            if (push_op(&t->ops, lit, o - lit, -1) == -1 ||
+                push_op(&t->ops, o, bs, blk * (int64_t)bs) == -1)
+                goto fail;
+            o += bs;
+            lit = o;
+            have = 0;
+            continue;
+        }
+        if (o + bs == size)
+            break;
+        /* 한 바이트 굴리기 */
+        uint32_t out = src[o], in = src[o + bs];
+        s1 = s1 - out + in;
+        s2 = s2 - (uint32_t)bs * out + s1;
+        o++;
+    }
+
+    if (lit >= t->end)
+        return NULL;
+    if (t->end < size) {
+        if (push_op(&t->ops, lit, t->end - lit, -1) == -1)
+            goto fail;
+        return NULL;
+    }
+    /* 대상 끝의 모자란 block 이 원본 끝과 같은 위치에서 같으면 건너뛴다 */
+    uint64_t tail_off = c->nblocks * bs;
+    if (c->tail_len && tail_off + c->tail_len == size && lit <= tail_off &&
+        strong_hash(src + tail_off, c->tail_len) == c->tail_strong) {
+        if (push_op(&t->ops, lit, tail_off - lit, -1) == -1 ||
+            push_op(&t->ops, tail_off, c->tail_len, (int64_t)tail_off) == -1)
+            goto fail;
+        return NULL;
+    }
+    if (push_op(&t->ops, lit, size - lit, -1) == -1)
+        goto fail;
+    return NULL;
+
+fail:
+    t->failed = 1;
+    return NULL;
+}
+
+/* ---------- 3. 적용 ---------- */
+
+static int write_range(int src_fd, int dst_fd, const unsigned char *src, uint64_t off,
+                       uint64_t len, int *use_pwrite) {
+    while (len > 0 && !*use_pwrite) {
+        loff_t in = off, out = off;
+        size_t want = len > MAX_XFER ? MAX_XFER : len;
+        ssize_t n = copy_file_range(src_fd, &in, dst_fd, &out, want, 0);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EXDEV && errno != ENOSYS && errno != EINVAL && errno != EOPNOTSUPP)
+                return -1;
+            *use_pwrite = 1;     /* 이후 구간은 모두 pwrite */
+            break;
+        }
+        if (n == 0) {
+            errno = EIO;
+            return -1;
+        }
+        off += n;
+        len -= n;
+    }
+    while (len > 0) {
+        size_t want = len > MAX_XFER ? MAX_XFER : len;
+        ssize_t n = pwrite(dst_fd, src + off, want, off);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        off += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int map_file(int fd, uint64_t size, const unsigned char **p) {
+    *p = NULL;
+    if (size == 0)
+        return 0;
+    void *m = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (m == MAP_FAILED)
+        return -1;
+    madvise(m, size, MADV_SEQUENTIAL);
+    *p = m;
+    return 0;
+}
+
+int dsync_fd(int src_fd, int dst_fd, const struct dsync_options *opts,
+             struct dsync_stats *stats) {
+    struct dsync_stats local;
+    struct ctx c = { .bs = opts && opts->block_size ? opts->block_size : DSYNC_DEFAULT_BLOCK };
+    int threads = opts && opts->threads > 1 ? opts->threads : 1;
+    int use_pwrite = opts && opts->use_pwrite;
+    struct task *tasks = NULL;
+    struct stat sst, dst;
+    int ret = -1, ntasks = 0, saved;
+
+    if (!stats)
+        stats = &local;
+    memset(stats, 0, sizeof(*stats));
+    if (fstat(src_fd, &sst) == -1 || fstat(dst_fd, &dst) == -1)
+        return -1;
+    c.src_size = stats->src_bytes = sst.st_size;
+    c.dst_size = stats->dst_bytes = dst.st_size;
+    if (map_file(src_fd, c.src_size, &c.src) == -1 || map_file(dst_fd, c.dst_size, &c.dst) == -1)
+        goto out;
+
+    double t0 = now_sec();
+    if (build_signatures(&c, threads) == -1)
+        goto out;
+    double t1 = now_sec();
+    stats->sig_seconds = t1 - t0;
+
+    /* block 경계에 맞춘 chunk 로 나눈다 */
+    uint64_t blocks = (c.src_size + c.bs - 1) / c.bs;
+    ntasks = (uint64_t)threads < blocks ? threads : (blocks ? (int)blocks : 1);
+    uint64_t per = (blocks + ntasks - 1) / ntasks * c.bs;
+    tasks = calloc(ntasks, sizeof(*tasks));
+    if (!tasks)
+        goto out;
+    for (int i = 0; i < ntasks; i++) {
+        tasks[i].c = &c;
+        tasks[i].start = per * i < c.src_size ? per * i : c.src_size;
+        tasks[i].end = per * (i + 1) < c.src_size ? per * (i + 1) : c.src_size;
+    }
+    if (run_tasks(scan_main, tasks, ntasks) == -1)
+        goto out;
+    double t2 = now_sec();
+    stats->scan_seconds = t2 - t1;
+
+    /* 앞 chunk 의 마지막 match 와 겹친 부분은 잘라내고, 쓸 구간을 합친다 */
+    munmap((void *)c.dst, c.dst_size);
+    c.dst = NULL;
+    uint64_t covered = 0, w_start = 0, w_end = 0;
+    for (int i = 0; i < ntasks; i++) {
+        for (size_t k = 0; k < tasks[i].ops.n; k++) {
+            struct op o = tasks[i].ops.v[k];
+            if (o.src_off + o.len <= covered)
+                continue;
+            if (o.src_off < covered) {
+                uint64_t cut = covered - o.src_off;
+                o.src_off += cut;
+                o.len -= cut;
+                if (o.dst_off >= 0)
+                    o.dst_off += cut;
+            }
+            covered = o.src_off + o.len;
+
+            if (o.dst_off == (int64_t)o.src_off) {
+                stats->same_bytes += o.len;
+                continue;
+            }
+            if (o.dst_off >= 0)
+                stats->moved_bytes += o.len;
+            else
+                stats->literal_bytes += o.len;
+            if (w_end == o.src_off && w_end > w_start) {
+                w_end += o.len;
+                continue;
+            }
+            if (w_end > w_start) {
+                stats->write_ranges++;
+                if (!(opts && opts->dry_run) &&
+                    write_range(src_fd, dst_fd, c.src, w_start, w_end - w_start, &use_pwrite) == -1)
+                    goto out;
+            }
+            w_start = o.src_off;
+            w_end = o.src_off + o.len;
+        }
+    }
+    if (w_end > w_start) {
+        stats->write_ranges++;
+        if (!(opts && opts->dry_run) &&
+            write_range(src_fd, dst_fd, c.src, w_start, w_end - w_start, &use_pwrite) == -1)
+            goto out;
+    }
+    stats->written_bytes = stats->moved_bytes + stats->literal_bytes;
+    if (!(opts && opts->dry_run) && c.dst_size != c.src_size &&
+        ftruncate(dst_fd, c.src_size) == -1)
+        goto out;
+    stats->apply_seconds = now_sec() - t2;
+    ret = 0;
+
+out:
+    saved = errno;
+    for (int i = 0; tasks && i < ntasks; i++)
+        free(tasks[i].ops.v);
+    free(tasks);
+    free(c.sigs);
+    free(c.chain);
+    free(c.heads);
+    if (c.src)
+        munmap((void *)c.src, c.src_size);
+    if (c.dst)
+        munmap((void *)c.dst, c.dst_size);
+    errno = saved;
+    return ret;
+}
+
+int dsync_path(const char *src, const char *dst, const struct dsync_options *opts,
+               struct dsync_stats *stats) {
+    int in = open(src, O_RDONLY);
+    if (in < 0)
+        return -1;
+    int out = open(dst, O_RDWR | O_CREAT, 0644);
+    if (out < 0) {
+        int saved = errno;
+        close(in);
+        errno = saved;
+        return -1;
+    }
+    int ret = dsync_fd(in, out, opts, stats);
+    int saved = errno;
+    close(in);
+    close(out);
+    errno = saved;
+    return ret;
+}
@@ -0,0 +1,67 @@
+/*
+ * Rolling-Checksum Delta Sync
+ *
+ * test_sendfile() (zerocopy_example.c) 는 zerocopy_test.txt 를 매번
+ * zerocopy_output.txt 로 통째로 복사한다. 대상이 몇 바이트만 달라도
+ * 파일 전체를 다시 쓴다.
+ *
+ * dsync 는 rsync 처럼 바뀐 구간만 쓴다.
+ *
+ *   1. 서명: 대상 파일을 block_size 단위로 나눠 block 마다
+ *            weak (rsync 의 rolling Adler-32) + strong (64-bit hash) 을 계산
+ *   2. 탐색: 원본 위에서 block_size 창을 1 바이트씩 굴리며 weak 를 갱신하고,
+ *            weak 가 맞는 block 이 있으면 strong 으로 확인한다
+ *   3. 적용: 같은 위치에서 찾은 block 은 건너뛰고, 나머지 (다른 위치에서 찾은
+ *            block 과 literal) 는 원본에서 copy_file_range (안 되면 pwrite) 로
+ *            대상의 같은 위치에 쓴 뒤 원본 크기로 자른다
+ *
+ * 로컬 파일끼리라서 위치가 옮겨진 block 도 원본에서 가져온다. 대상 안에서
+ * 옮기면 아직 읽지 않은 block 을 덮어쓸 수 있기 때문이다 (rsync --inplace 문제).
+ * 서명 계산과 탐색은 모두 chunk 로 나눠 여러 스레드가 한다.
+ *
+ * strong hash 는 암호학적 hash 가 아니다 (우연한 충돌만 고려).
+ *
+ * 사용 예:
+ *   struct dsync_stats st;
+ *   dsync_path("zerocopy_test.txt", "zerocopy_output.txt", NULL, &st);
+ *
+ * Build: gcc -O2 -pthread -c delta_sync.c
+ */
+
+#ifndef DELTA_SYNC_H
+#define DELTA_SYNC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DSYNC_DEFAULT_BLOCK (16 * 1024)
+
+struct dsync_options {
+    size_t block_size;           /* 0 이면 DSYNC_DEFAULT_BLOCK */
+    int threads;                 /* 0/1 이면 단일 스레드 */
+    int dry_run;                 /* 1 이면 통계만 내고 쓰지 않음 */
+    int use_pwrite;              /* 1 이면 copy_file_range 를 쓰지 않음 */
+};
+
+struct dsync_stats {
+    uint64_t src_bytes;
+    uint64_t dst_bytes;          /* sync 전 대상 크기 */
+    uint64_t same_bytes;         /* 같은 위치에서 찾아 건너뛴 바이트 */
+    uint64_t moved_bytes;        /* 다른 위치에서 찾은 block */
+    uint64_t literal_bytes;      /* 대상에 없는 바이트 */
+    uint64_t written_bytes;      /* moved + literal */
+    uint64_t write_ranges;       /* 쓰기 구간 수 (붙은 구간은 합침) */
+    double sig_seconds;
+    double scan_seconds;
+    double apply_seconds;
+};
+
+/* dst_fd 는 읽기/쓰기로 열려 있어야 한다. 끝나면 dst 는 src 와 같다 */
+int dsync_fd(int src_fd, int dst_fd, const struct dsync_options *opts,
+             struct dsync_stats *stats);
+
+/* dst 가 없으면 만든다 */
+int dsync_path(const char *src, const char *dst, const struct dsync_options *opts,
+               struct dsync_stats *stats);
+
+#endif
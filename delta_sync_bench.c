@@ -0,0 +1,249 @@
+/*
+ * Delta Sync Benchmark
+ *
+ * 대상 (어제 파일) 을 원본 (오늘 파일) 과 같게 만드는 데 걸리는 시간과 쓴 양.
+ *
+ *   cases  : same   - 바뀐 것 없음
+ *            edits  - 임의 위치 1 바이트 수정 -e 개
+ *            insert - 가운데에 100 바이트 끼움 (뒤가 모두 밀림)
+ *            append - 끝에 1MB 추가
+ *   methods: full   - fcopy_path (test_sendfile 처럼 전체 복사, copy_file_range)
+ *            dsync  - 스레드 1 개와 -t 개
+ *            dsync_pwrite - copy_file_range 대신 pwrite
+ *
+ * 매번 대상 내용을 원본과 비교한다.
+ *
+ * Output (CSV): case,method,threads,seconds,mb_per_sec,written_bytes,literal_bytes,moved_bytes,same_bytes
+ *
+ * Build: gcc -O2 -pthread -o delta_sync_bench delta_sync_bench.c delta_sync.c file_copy.c
+ * Usage: ./delta_sync_bench [-d dir] [-s size] [-b block_size] [-t threads] [-e edits] [-C]
+ *   -C: 매 측정 전 page cache 비우기
+ */
+
+#define _GNU_SOURCE
+#include "delta_sync.h"
+#include "file_copy.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+enum { CASE_SAME, CASE_EDITS, CASE_INSERT, CASE_APPEND, CASE_COUNT };
+
+static const char *case_names[CASE_COUNT] = { "same", "edits", "insert", "append" };
+
+#define INSERT_LEN 100
+#define APPEND_LEN (1 << 20)
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    }
+    return v;
+}
+
+static void drop_cache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd != -1) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+static int write_file(const char *path, const char *data, size_t len) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return -1;
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n <= 0) {
+            close(fd);
+            return -1;
+        }
+        data += n;
+        len -= n;
+    }
+    return close(fd);
+}
+
+static int same_content(const char *path, const char *data, size_t len) {
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) == -1 || (size_t)st.st_size != len) {
+        if (fd >= 0)
+            close(fd);
+        return 0;
+    }
+    int ok = 1;
+    if (len) {
+        void *p = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+        ok = p != MAP_FAILED && memcmp(p, data, len) == 0;
+        if (p != MAP_FAILED)
+            munmap(p, len);
+    }
+    close(fd);
+    return ok;
+}
+
+/* base 에서 case 에 맞게 원본 내용을 만든다 */
+static char *make_source(int which, const char *base, size_t size, int edits, size_t *out_len) {
+    size_t len = size + (which == CASE_INSERT ? INSERT_LEN : which == CASE_APPEND ? APPEND_LEN : 0);
+    char *p = malloc(len);
+    if (!p)
+        return NULL;
+
+    unsigned int seed = 12345;
+    switch (which) {
+    case CASE_SAME:
+        memcpy(p, base, size);
+        break;
+    case CASE_EDITS:
+        memcpy(p, base, size);
+        for (int i = 0; i < edits; i++)
+            p[((size_t)rand_r(&seed) << 16 ^ rand_r(&seed)) % size] ^= 0x5a;
+        break;
+    case CASE_INSERT:
+        memcpy(p, base, size / 2);
+        memset(p + size / 2, '+', INSERT_LEN);
+        memcpy(p + size / 2 + INSERT_LEN, base + size / 2, size - size / 2);
+        break;
+    case CASE_APPEND:
+        memcpy(p, base, size);
+        for (size_t i = 0; i < APPEND_LEN; i++)
+            p[size + i] = (char)rand_r(&seed);
+        break;
+    }
+    *out_len = len;
+    return p;
+}
+
+int main(int argc, char *argv[]) {
+    const char *dir = "dsync_bench_dir";
+    size_t size = 64 << 20, block = DSYNC_DEFAULT_BLOCK;
+    int threads = 4, edits = 16, cold = 0, opt;
+    char src_path[4096], dst_path[4096];
+
+    while ((opt = getopt(argc, argv, "d:s:b:t:e:C")) != -1) {
+        switch (opt) {
+        case 'd': dir = optarg; break;
+        case 's': size = parse_size(optarg); break;
+        case 'b': block = parse_size(optarg); break;
+        case 't': threads = atoi(optarg); break;
+        case 'e': edits = atoi(optarg); break;
+        case 'C': cold = 1; break;
+        default:
+            fprintf(stderr, "Usage: %s [-d dir] [-s size] [-b block_size] [-t threads] "
+                    "[-e edits] [-C]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (size < 2 || block < 1 || threads < 1 || edits < 0) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+    if (mkdir(dir, 0755) == -1 && errno != EEXIST) {
+        perror(dir);
+        return 1;
+    }
+    snprintf(src_path, sizeof(src_path), "%s/src", dir);
+    snprintf(dst_path, sizeof(dst_path), "%s/dst", dir);
+
+    char *base = malloc(size);
+    if (!base) {
+        perror("malloc");
+        return 1;
+    }
+    uint64_t x = 88172645463325252ULL;
+    for (size_t i = 0; i < size; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        base[i] = (char)x;
+    }
+
+    static const struct {
+        const char *name;
+        int full, pwrite, threaded;
+    } methods[] = {
+        { "full", 1, 0, 0 },
+        { "dsync", 0, 0, 0 },
+        { "dsync", 0, 0, 1 },
+        { "dsync_pwrite", 0, 1, 1 },
+    };
+
+    printf("case,method,threads,seconds,mb_per_sec,written_bytes,literal_bytes,moved_bytes,"
+           "same_bytes\n");
+    int ret = 0;
+    for (int cs = 0; ret == 0 && cs < CASE_COUNT; cs++) {
+        size_t src_len;
+        char *src = make_source(cs, base, size, edits, &src_len);
+        if (!src || write_file(src_path, src, src_len) == -1) {
+            perror("source");
+            return 1;
+        }
+        for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++) {
+            struct dsync_options o = {
+                .block_size = block,
+                .threads = methods[m].threaded ? threads : 1,
+                .use_pwrite = methods[m].pwrite,
+            };
+            struct dsync_stats st = { 0 };
+            if (write_file(dst_path, base, size) == -1) {
+                perror(dst_path);
+                return 1;
+            }
+            if (cold) {
+                drop_cache(src_path);
+                drop_cache(dst_path);
+            }
+
+            double t0 = now_sec();
+            int err;
+            if (methods[m].full) {
+                struct fcopy_stats fs;
+                err = fcopy_path(src_path, dst_path, NULL, &fs);
+                st.written_bytes = st.literal_bytes = fs.bytes;
+            } else {
+                err = dsync_path(src_path, dst_path, &o, &st);
+            }
+            double secs = now_sec() - t0;
+
+            if (err == -1 || !same_content(dst_path, src, src_len)) {
+                fprintf(stderr, "%s/%s: %s\n", case_names[cs], methods[m].name,
+                        err == -1 ? strerror(errno) : "content mismatch");
+                ret = 1;
+                break;
+            }
+            printf("%s,%s,%d,%.4f,%.1f,%llu,%llu,%llu,%llu\n", case_names[cs], methods[m].name,
+                   o.threads, secs, src_len / secs / (1024.0 * 1024.0),
+                   (unsigned long long)st.written_bytes, (unsigned long long)st.literal_bytes,
+                   (unsigned long long)st.moved_bytes, (unsigned long long)st.same_bytes);
+            fflush(stdout);
+        }
+        free(src);
+    }
+
+    unlink(src_path);
+    unlink(dst_path);
+    rmdir(dir);
+    free(base);
+    return ret;
+}
@@ -0,0 +1,260 @@
+/*
+ * O_DIRECT Aligned Buffer Pool - 구현
+ *
+ * pool 은 mmap 한 덩어리 하나를 buf_size 씩 잘라 쓴다.
+ * free stack 은 create 때 만든 포인터 배열이라 get/put 은 mutex 안에서
+ * 포인터 하나를 옮기는 것뿐이다.
+ */
+
+#define _GNU_SOURCE
+#include "direct_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define HUGE_PAGE (2UL * 1024 * 1024)
+
+struct dio_pool {
+    char *base;
+    size_t map_len;
+    size_t buf_size;
+    size_t nbufs;
+    int huge;                        /* MAP_HUGETLB 로 잡혔는가 */
+
+    pthread_mutex_t lock;
+    void **free_stack;
+    size_t nfree;
+};
+
+struct dio_file {
+    int fd;
+    int direct;
+    size_t align;                    /* offset / 길이 정렬 */
+    size_t mem_align;                /* 버퍼 주소 정렬 */
+    off_t size;                      /* 쓰기 꼬리 처리를 위해 추적 */
+};
+
+static size_t round_up(size_t v, size_t a) {
+    return (v + a - 1) / a * a;
+}
+
+struct dio_pool *dio_pool_create(size_t nbufs, size_t buf_size, int flags) {
+    if (nbufs == 0 || buf_size == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    struct dio_pool *p = calloc(1, sizeof(*p));
+    if (!p)
+        return NULL;
+    p->nbufs = nbufs;
+    p->buf_size = round_up(buf_size, DIO_DEFAULT_ALIGN);
+    p->free_stack = malloc(nbufs * sizeof(*p->free_stack));
+    if (!p->free_stack) {
+        free(p);
+        return NULL;
+    }
+
+    size_t len = p->buf_size * nbufs;
+    p->base = MAP_FAILED;
+    if (flags & DIO_HUGEPAGES) {
+        /* 예약된 huge page 가 있어야 성공한다. 없으면 THP 에 맡긴다 */
+        p->map_len = round_up(len, HUGE_PAGE);
+        p->base = mmap(NULL, p->map_len, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        p->huge = p->base != MAP_FAILED;
+    }
+    if (p->base == MAP_FAILED) {
+        p->map_len = len;
+        p->base = mmap(NULL, p->map_len, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p->base == MAP_FAILED) {
+            free(p->free_stack);
+            free(p);
+            return NULL;
+        }
+        if (flags & DIO_HUGEPAGES)
+            madvise(p->base, p->map_len, MADV_HUGEPAGE);
+    }
+
+    /* 첫 사용 때 page fault 가 나지 않도록 미리 건드려 둔다 */
+    memset(p->base, 0, len);
+
+    for (size_t i = 0; i < nbufs; i++)
+        p->free_stack[i] = p->base + (nbufs - 1 - i) * p->buf_size;
+    p->nfree = nbufs;
+    pthread_mutex_init(&p->lock, NULL);
+    return p;
+}
+
+void *dio_buf_get(struct dio_pool *p) {
+    void *buf = NULL;
+
+    pthread_mutex_lock(&p->lock);
+    if (p->nfree > 0)
+        buf = p->free_stack[--p->nfree];
+    pthread_mutex_unlock(&p->lock);
+    if (!buf)
+        errno = EAGAIN;
+    return buf;
+}
+
+void dio_buf_put(struct dio_pool *p, void *buf) {
+    pthread_mutex_lock(&p->lock);
+    p->free_stack[p->nfree++] = buf;
+    pthread_mutex_unlock(&p->lock);
+}
+
+size_t dio_pool_buf_size(const struct dio_pool *p) {
+    return p->buf_size;
+}
+
+int dio_pool_is_huge(const struct dio_pool *p) {
+    return p->huge;
+}
+
+void dio_pool_destroy(struct dio_pool *p) {
+    if (!p)
+        return;
+    munmap(p->base, p->map_len);
+    pthread_mutex_destroy(&p->lock);
+    free(p->free_stack);
+    free(p);
+}
+
+/* ---------------------------------------------------------------- */
+
+static void query_align(struct dio_file *f) {
+    f->align = DIO_DEFAULT_ALIGN;
+    f->mem_align = DIO_DEFAULT_ALIGN;
+#ifdef STATX_DIOALIGN
+    struct statx stx;
+    if (statx(f->fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &stx) == 0 &&
+        (stx.stx_mask & STATX_DIOALIGN) && stx.stx_dio_offset_align) {
+        f->align = stx.stx_dio_offset_align;
+        f->mem_align = stx.stx_dio_mem_align;
+    }
+#endif
+}
+
+struct dio_file *dio_open(const char *path, int flags, mode_t mode) {
+    struct dio_file *f = calloc(1, sizeof(*f));
+    struct stat st;
+
+    if (!f)
+        return NULL;
+
+    f->fd = open(path, flags | O_DIRECT, mode);
+    f->direct = 1;
+    if (f->fd < 0 && errno == EINVAL) {
+        f->fd = open(path, flags, mode);
+        f->direct = 0;
+    }
+    if (f->fd < 0 || fstat(f->fd, &st) == -1) {
+        int saved = errno;
+        if (f->fd >= 0)
+            close(f->fd);
+        free(f);
+        errno = saved;
+        return NULL;
+    }
+    f->size = st.st_size;
+    query_align(f);
+    if (!f->direct)
+        posix_fadvise(f->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    return f;
+}
+
+int dio_is_direct(const struct dio_file *f) {
+    return f->direct;
+}
+
+size_t dio_align(const struct dio_file *f) {
+    return f->align;
+}
+
+static int check_align(const struct dio_file *f, const void *buf, off_t off) {
+    if (f->direct && ((uintptr_t)buf % f->mem_align || (size_t)off % f->align)) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+ssize_t dio_pread(struct dio_file *f, void *buf, size_t len, off_t off) {
+    size_t want = f->direct ? round_up(len, f->align) : len;
+    size_t done = 0;
+
+    if (check_align(f, buf, off) == -1)
+        return -1;
+
+    /* O_DIRECT 는 EOF 에서만 짧게 끝난다. 정렬이 깨지는 중간 재시도는 하지 않는다 */
+    while (done < want) {
+        ssize_t n = pread(f->fd, (char *)buf + done, want - done, off + done);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return done ? (ssize_t)done : -1;
+        }
+        if (n == 0)
+            break;
+        done += n;
+        if (f->direct && done % f->align)
+            break;
+    }
+
+    if (!f->direct && done)
+        posix_fadvise(f->fd, off, done, POSIX_FADV_DONTNEED);
+    return done < len ? (ssize_t)done : (ssize_t)len;
+}
+
+ssize_t dio_pwrite(struct dio_file *f, void *buf, size_t len, off_t off) {
+    size_t want = f->direct ? round_up(len, f->align) : len;
+    size_t done = 0;
+    off_t end = off + (off_t)len;
+
+    if (check_align(f, buf, off) == -1)
+        return -1;
+    /* 정렬되지 않은 길이는 파일의 마지막 조각일 때만 (뒤의 데이터를 0 으로 덮지 않도록) */
+    if (want > len && f->size > end) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (want > len)
+        memset((char *)buf + len, 0, want - len);
+
+    while (done < want) {
+        ssize_t n = pwrite(f->fd, (char *)buf + done, want - done, off + done);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        done += n;
+    }
+
+    /* 채워 넣은 0 만큼 늘어난 파일 끝을 잘라낸다 */
+    if (want > len && ftruncate(f->fd, end) == -1)
+        return -1;
+    if (end > f->size)
+        f->size = end;
+
+    if (!f->direct)
+        posix_fadvise(f->fd, off, len, POSIX_FADV_DONTNEED);
+    return (ssize_t)len;
+}
+
+int dio_close(struct dio_file *f) {
+    if (!f)
+        return 0;
+    int ret = close(f->fd);
+    free(f);
+    return ret;
+}
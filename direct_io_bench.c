@@ -0,0 +1,276 @@
+/*
+ * O_DIRECT vs Buffered Scan Benchmark
+ *
+ * 큰 파일(끝이 정렬되지 않은 크기)을 한 번 훑으면서
+ *   - 처리량
+ *   - 훑은 파일이 page cache 에 얼마나 남았는지
+ *   - 미리 읽어 둔 "hot" 파일이 cache 에 얼마나 남았는지
+ * 를 mincore 로 비교한다.
+ *
+ *   buffered - 2.c 처럼 read() (버퍼만 pool 크기로 키움)
+ *   direct   - dio_pool + dio_pread (O_DIRECT)
+ *   copy     - dio_pread -> dio_pwrite 로 복사 후 크기/checksum 검증 (꼬리 쓰기)
+ *
+ * Output (CSV): mode,direct,bytes,seconds,mbps,scan_cached_pct,hot_cached_pct,checksum
+ *
+ * Build: gcc -O2 -pthread -o direct_io_bench direct_io_bench.c direct_io.c
+ * Usage: ./direct_io_bench [-d dir] [-s size] [-b buf_size] [-H]
+ *   -H: pool 을 huge page 로
+ */
+
+#define _GNU_SOURCE
+#include "direct_io.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define HOT_SIZE (64ULL * 1024 * 1024)
+#define TAIL 1234                    /* 정렬되지 않은 꼬리 */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    }
+    return v;
+}
+
+static void drop_cache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd != -1) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+/* page cache 에 올라와 있는 페이지 비율 (%) */
+static double cached_pct(const char *path) {
+    struct stat st;
+    double pct = -1;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return -1;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        long page = sysconf(_SC_PAGESIZE);
+        size_t pages = (st.st_size + page - 1) / page;
+        void *p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        unsigned char *vec = malloc(pages);
+        if (p != MAP_FAILED && vec && mincore(p, st.st_size, vec) == 0) {
+            size_t resident = 0;
+            for (size_t i = 0; i < pages; i++)
+                resident += vec[i] & 1;
+            pct = 100.0 * resident / pages;
+        }
+        free(vec);
+        if (p != MAP_FAILED)
+            munmap(p, st.st_size);
+    }
+    close(fd);
+    return pct;
+}
+
+static int make_file(const char *path, uint64_t size) {
+    char buf[1 << 16];
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return -1;
+    for (uint64_t off = 0; off < size; off += sizeof(buf)) {
+        size_t len = size - off < sizeof(buf) ? size - off : sizeof(buf);
+        for (size_t i = 0; i < len; i++)
+            buf[i] = (char)((off + i) * 2654435761U >> 24);
+        if (write(fd, buf, len) != (ssize_t)len) {
+            close(fd);
+            return -1;
+        }
+    }
+    return close(fd);
+}
+
+static uint64_t mix(uint64_t h, const unsigned char *p, size_t len) {
+    for (size_t i = 0; i < len; i++)
+        h = (h ^ p[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+static void warm(const char *path) {
+    char buf[1 << 16];
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+    while (read(fd, buf, sizeof(buf)) > 0)
+        ;
+    close(fd);
+}
+
+static int scan_buffered(const char *path, char *buf, size_t bsize, uint64_t *bytes,
+                         uint64_t *sum) {
+    ssize_t n;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    *bytes = 0;
+    while ((n = read(fd, buf, bsize)) > 0) {
+        h = mix(h, (unsigned char *)buf, n);
+        *bytes += n;
+    }
+    close(fd);
+    *sum = h;
+    return n == -1 ? -1 : 0;
+}
+
+/* dst 가 있으면 읽은 것을 그대로 dio_pwrite 로 복사 */
+static int scan_direct(struct dio_pool *pool, const char *path, const char *dst,
+                       uint64_t *bytes, uint64_t *sum, int *direct) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    size_t bsize = dio_pool_buf_size(pool);
+    struct dio_file *out = NULL;
+    ssize_t n;
+    int ret = -1;
+
+    struct dio_file *in = dio_open(path, O_RDONLY, 0);
+    if (!in)
+        return -1;
+    if (dst && !(out = dio_open(dst, O_WRONLY | O_CREAT | O_TRUNC, 0644))) {
+        dio_close(in);
+        return -1;
+    }
+    *direct = dio_is_direct(in);
+
+    void *buf = dio_buf_get(pool);
+    if (!buf)
+        goto out;
+
+    *bytes = 0;
+    while ((n = dio_pread(in, buf, bsize, (off_t)*bytes)) > 0) {
+        h = mix(h, buf, n);
+        if (out && dio_pwrite(out, buf, n, (off_t)*bytes) != n)
+            break;
+        *bytes += n;
+        if ((size_t)n < bsize)
+            break;
+    }
+    if (n >= 0)
+        ret = 0;
+    *sum = h;
+    dio_buf_put(pool, buf);
+
+out:
+    dio_close(in);
+    if (out && dio_close(out) == -1)
+        ret = -1;
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    const char *dir = ".";
+    uint64_t size = 1ULL << 30;
+    size_t bsize = 1024 * 1024;
+    int flags = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:s:b:H")) != -1) {
+        switch (opt) {
+        case 'd': dir = optarg; break;
+        case 's': size = parse_size(optarg); break;
+        case 'b': bsize = parse_size(optarg); break;
+        case 'H': flags |= DIO_HUGEPAGES; break;
+        default:
+            fprintf(stderr, "Usage: %s [-d dir] [-s size] [-b buf_size] [-H]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    char scan[4096], hot[4096], copy[4096];
+    snprintf(scan, sizeof(scan), "%s/dio_scan.bin", dir);
+    snprintf(hot, sizeof(hot), "%s/dio_hot.bin", dir);
+    snprintf(copy, sizeof(copy), "%s/dio_copy.bin", dir);
+
+    size += TAIL;
+    if (make_file(scan, size) == -1 || make_file(hot, HOT_SIZE) == -1) {
+        perror("make_file");
+        return 1;
+    }
+
+    struct dio_pool *pool = dio_pool_create(2, bsize, flags);
+    if (!pool) {
+        perror("dio_pool_create");
+        return 1;
+    }
+    fprintf(stderr, "pool: %zu bytes x 2, huge=%d\n", dio_pool_buf_size(pool),
+            dio_pool_is_huge(pool));
+
+    printf("mode,direct,bytes,seconds,mbps,scan_cached_pct,hot_cached_pct,checksum\n");
+    uint64_t expect = 0;
+    for (int mode = 0; mode < 3; mode++) {
+        static const char *names[] = { "buffered", "direct", "copy" };
+        uint64_t bytes = 0, sum = 0;
+        int direct = 0, ret;
+
+        drop_cache(scan);
+        warm(hot);
+
+        double t0 = now_sec();
+        if (mode == 0) {
+            void *buf = dio_buf_get(pool);
+            ret = scan_buffered(scan, buf, dio_pool_buf_size(pool), &bytes, &sum);
+            dio_buf_put(pool, buf);
+        } else {
+            ret = scan_direct(pool, scan, mode == 2 ? copy : NULL, &bytes, &sum, &direct);
+        }
+        double secs = now_sec() - t0;
+        if (ret == -1) {
+            perror(names[mode]);
+            return 1;
+        }
+
+        if (mode == 0)
+            expect = sum;
+        if (bytes != size || sum != expect) {
+            fprintf(stderr, "%s: read %llu of %llu bytes, checksum %s\n", names[mode],
+                    (unsigned long long)bytes, (unsigned long long)size,
+                    sum == expect ? "ok" : "mismatch");
+            return 1;
+        }
+        if (mode == 2) {
+            /* 꼬리까지 그대로 써졌는지 다시 읽어서 확인 */
+            uint64_t cbytes, csum;
+            void *buf = dio_buf_get(pool);
+            ret = scan_buffered(copy, buf, dio_pool_buf_size(pool), &cbytes, &csum);
+            dio_buf_put(pool, buf);
+            if (ret == -1 || cbytes != size || csum != expect) {
+                fprintf(stderr, "copy: %llu bytes, want %llu\n",
+                        (unsigned long long)cbytes, (unsigned long long)size);
+                return 1;
+            }
+        }
+
+        printf("%s,%d,%llu,%.4f,%.1f,%.1f,%.1f,%016llx\n", names[mode], direct,
+               (unsigned long long)bytes, secs, secs > 0 ? bytes / secs / 1e6 : 0.0,
+               cached_pct(scan), cached_pct(hot), (unsigned long long)sum);
+        fflush(stdout);
+    }
+
+    dio_pool_destroy(pool);
+    unlink(scan);
+    unlink(hot);
+    unlink(copy);
+    return 0;
+}
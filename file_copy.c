@@ -0,0 +1,467 @@
+/*
+ * Large-File Copy Engine - 구현
+ *
+ * 모든 방법은 명시적 offset 으로 동작하도록 맞췄다.
+ * (여러 스레드가 같은 fd 를 공유해도 파일 위치가 섞이지 않도록)
+ * sendfile 만 출력 offset 을 받지 않으므로 스레드마다 출력 fd 를
+ * /proc/self/fd 로 다시 열어서 lseek 후 사용한다.
+ */
+
+#define _GNU_SOURCE
+#include "file_copy.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+
+#define MAX_XFER 0x7ffff000          /* 한 번의 syscall 이 처리할 수 있는 최대치 */
+#define RW_BUF (1024 * 1024)
+#define DEFAULT_CHUNK (64ULL * 1024 * 1024)
+
+static const char *method_names[FCOPY_METHOD_COUNT] = {
+    "auto", "copy_file_range", "sendfile", "splice", "rw"
+};
+
+const char *fcopy_method_name(enum fcopy_method m) {
+    return m < FCOPY_METHOD_COUNT ? method_names[m] : "?";
+}
+
+/* 이 errno 면 다음 방법으로 넘어간다 */
+static int unsupported(int err) {
+    return err == EXDEV || err == ENOSYS || err == EINVAL ||
+           err == EOPNOTSUPP || err == EBADF || err == ESPIPE;
+}
+
+struct copy_ctx {
+    int in_fd;
+    int out_fd;
+    int pipe_fd[2];              /* splice 용, 처음 필요할 때 생성 */
+    int send_fd;                 /* sendfile 용 출력 fd (스레드 전용) */
+    char *buf;                   /* rw 용 */
+};
+
+/* ---------------------------------------------------------------- */
+/* 방법별 구현: [off, off+len) 을 복사하고 복사한 바이트 수를 돌려준다.
+ * 도중에 실패하면 그때까지 복사한 양을, 하나도 못 했으면 -1 을 돌려준다. */
+
+static int64_t copy_cfr(struct copy_ctx *c, off_t off, uint64_t len) {
+    loff_t in_off = off, out_off = off;
+    uint64_t done = 0;
+
+    while (done < len) {
+        size_t want = len - done > MAX_XFER ? MAX_XFER : len - done;
+        ssize_t n = copy_file_range(c->in_fd, &in_off, c->out_fd, &out_off, want, 0);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return done ? (int64_t)done : -1;
+        }
+        if (n == 0) {
+            /* 원본이 줄었거나, 지원하지 않는 파일시스템/특수 파일이라 0 을 돌려준 것.
+             * 아직 원본 크기 안이면 후자로 보고 다음 방법으로 넘긴다 */
+            struct stat st;
+            if (fstat(c->in_fd, &st) == 0 && in_off < st.st_size) {
+                errno = EOPNOTSUPP;
+                return done ? (int64_t)done : -1;
+            }
+            break;
+        }
+        done += n;
+    }
+    return (int64_t)done;
+}
+
+static int64_t copy_sendfile(struct copy_ctx *c, off_t off, uint64_t len) {
+    off_t in_off = off;
+    uint64_t done = 0;
+
+    if (c->send_fd < 0) {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/fd/%d", c->out_fd);
+        c->send_fd = open(path, O_WRONLY);
+        if (c->send_fd < 0)
+            return -1;
+    }
+    if (lseek(c->send_fd, off, SEEK_SET) == (off_t)-1)
+        return -1;
+
+    while (done < len) {
+        size_t want = len - done > MAX_XFER ? MAX_XFER : len - done;
+        ssize_t n = sendfile(c->send_fd, c->in_fd, &in_off, want);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return done ? (int64_t)done : -1;
+        }
+        if (n == 0)
+            break;
+        done += n;
+    }
+    return (int64_t)done;
+}
+
+static int64_t copy_splice(struct copy_ctx *c, off_t off, uint64_t len) {
+    loff_t in_off = off, out_off = off;
+    uint64_t done = 0;
+
+    if (c->pipe_fd[0] < 0) {
+        if (pipe(c->pipe_fd) == -1)
+            return -1;
+        /* pipe 를 키울수록 splice 호출 수가 줄어든다 (한도 초과 시 기본값 유지) */
+        fcntl(c->pipe_fd[1], F_SETPIPE_SZ, 1024 * 1024);
+    }
+
+    while (done < len) {
+        size_t want = len - done > MAX_XFER ? MAX_XFER : len - done;
+        ssize_t in = splice(c->in_fd, &in_off, c->pipe_fd[1], NULL, want, SPLICE_F_MOVE);
+        if (in == -1) {
+            if (errno == EINTR)
+                continue;
+            return done ? (int64_t)done : -1;
+        }
+        if (in == 0)
+            break;
+
+        ssize_t left = in;
+        while (left > 0) {
+            ssize_t out = splice(c->pipe_fd[0], NULL, c->out_fd, &out_off, left, SPLICE_F_MOVE);
+            if (out == -1) {
+                if (errno == EINTR)
+                    continue;
+                /* pipe 에 남은 데이터는 버리고 그 구간부터 다시 하도록 */
+                int saved = errno;
+                close(c->pipe_fd[0]);
+                close(c->pipe_fd[1]);
+                c->pipe_fd[0] = c->pipe_fd[1] = -1;
+                errno = saved;
+                return done ? (int64_t)done : -1;
+            }
+            left -= out;
+            done += out;
+        }
+    }
+    return (int64_t)done;
+}
+
+static int64_t copy_rw(struct copy_ctx *c, off_t off, uint64_t len) {
+    uint64_t done = 0;
+
+    if (!c->buf) {
+        c->buf = malloc(RW_BUF);
+        if (!c->buf)
+            return -1;
+    }
+
+    while (done < len) {
+        size_t want = len - done > RW_BUF ? RW_BUF : len - done;
+        ssize_t n = pread(c->in_fd, c->buf, want, off + done);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return done ? (int64_t)done : -1;
+        }
+        if (n == 0)
+            break;
+
+        ssize_t w = 0;
+        while (w < n) {
+            ssize_t r = pwrite(c->out_fd, c->buf + w, n - w, off + done + w);
+            if (r == -1) {
+                if (errno == EINTR)
+                    continue;
+                return (done + w) ? (int64_t)(done + w) : -1;
+            }
+            w += r;
+        }
+        done += n;
+    }
+    return (int64_t)done;
+}
+
+static int64_t copy_with(struct copy_ctx *c, enum fcopy_method m, off_t off, uint64_t len) {
+    switch (m) {
+    case FCOPY_COPY_FILE_RANGE: return copy_cfr(c, off, len);
+    case FCOPY_SENDFILE:        return copy_sendfile(c, off, len);
+    case FCOPY_SPLICE:          return copy_splice(c, off, len);
+    case FCOPY_RW:              return copy_rw(c, off, len);
+    default:
+        errno = EINVAL;
+        return -1;
+    }
+}
+
+/*
+ * 구간 하나를 복사. *method 부터 시도하고, 지원되지 않으면 다음 방법으로.
+ * AUTO 가 아니면 지정된 방법만 사용한다. 실제로 복사한 양을 *copied 에 더한다.
+ */
+static int copy_range(struct copy_ctx *c, int fixed, enum fcopy_method *method,
+                      off_t off, uint64_t len, uint64_t *copied) {
+    while (len > 0) {
+        int64_t n = copy_with(c, *method, off, len);
+        if (n > 0) {
+            off += n;
+            len -= n;
+            *copied += n;
+            continue;
+        }
+        if (n == 0) {
+            /* 원본이 예상보다 짧다 - 나머지는 hole 로 남는다 */
+            return 0;
+        }
+        if (fixed || !unsupported(errno) || *method == FCOPY_RW)
+            return -1;
+        (*method)++;
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------------- */
+
+struct extent {
+    off_t off;
+    uint64_t len;
+};
+
+struct job {
+    int in_fd;
+    int out_fd;
+    int fixed;
+    enum fcopy_method start;
+    struct extent *ranges;
+    size_t nranges;
+    atomic_size_t next;
+    atomic_uint_fast64_t bytes;
+    atomic_int method_used;
+    atomic_int error;
+};
+
+static void ctx_init(struct copy_ctx *c, int in_fd, int out_fd) {
+    c->in_fd = in_fd;
+    c->out_fd = out_fd;
+    c->pipe_fd[0] = c->pipe_fd[1] = -1;
+    c->send_fd = -1;
+    c->buf = NULL;
+}
+
+static void ctx_free(struct copy_ctx *c) {
+    if (c->pipe_fd[0] >= 0) {
+        close(c->pipe_fd[0]);
+        close(c->pipe_fd[1]);
+    }
+    if (c->send_fd >= 0)
+        close(c->send_fd);
+    free(c->buf);
+}
+
+static void *worker_main(void *arg) {
+    struct job *j = arg;
+    struct copy_ctx c;
+    enum fcopy_method m = j->start;
+    size_t i;
+
+    ctx_init(&c, j->in_fd, j->out_fd);
+    while (!atomic_load(&j->error) && (i = atomic_fetch_add(&j->next, 1)) < j->nranges) {
+        uint64_t copied = 0;
+        int ret = copy_range(&c, j->fixed, &m, j->ranges[i].off, j->ranges[i].len, &copied);
+        int saved = errno;
+        atomic_fetch_add(&j->bytes, copied);
+        if (ret == -1) {
+            atomic_store(&j->error, saved ? saved : EIO);
+            break;
+        }
+    }
+    /* 여러 스레드 중 가장 뒤쪽 방법(= fallback 이 가장 많이 일어난 것)을 기록 */
+    int prev = atomic_load(&j->method_used);
+    while ((int)m > prev && !atomic_compare_exchange_weak(&j->method_used, &prev, (int)m))
+        ;
+    ctx_free(&c);
+    return NULL;
+}
+
+/* 데이터 구간 목록. sparse 가 아니거나 SEEK_DATA 를 지원하지 않으면 [0, size) 하나 */
+static int collect_extents(int fd, off_t size, int sparse, struct extent **out,
+                           size_t *count) {
+    size_t cap = 16, n = 0;
+    struct extent *ext = malloc(cap * sizeof(*ext));
+    if (!ext)
+        return -1;
+
+    off_t pos = 0;
+    while (pos < size) {
+        off_t data = pos, hole = size;
+        if (sparse) {
+            data = lseek(fd, pos, SEEK_DATA);
+            if (data == (off_t)-1) {
+                if (errno == ENXIO)
+                    break;               /* 이후는 전부 hole */
+                data = pos;              /* SEEK_DATA 미지원 */
+                sparse = 0;
+            } else {
+                hole = lseek(fd, data, SEEK_HOLE);
+                if (hole == (off_t)-1 || hole > size)
+                    hole = size;
+            }
+        }
+
+        if (n == cap) {
+            struct extent *ne = realloc(ext, cap * 2 * sizeof(*ext));
+            if (!ne) {
+                free(ext);
+                return -1;
+            }
+            ext = ne;
+            cap *= 2;
+        }
+        ext[n].off = data;
+        ext[n].len = hole - data;
+        n++;
+        pos = hole;
+    }
+
+    *out = ext;
+    *count = n;
+    return 0;
+}
+
+/* 병렬 처리를 위해 extent 를 chunk 크기로 자른다 */
+static struct extent *split_extents(const struct extent *ext, size_t n, uint64_t chunk,
+                                    size_t *out_n) {
+    size_t total = 0;
+    for (size_t i = 0; i < n; i++)
+        total += (ext[i].len + chunk - 1) / chunk;
+
+    struct extent *r = malloc((total ? total : 1) * sizeof(*r));
+    if (!r)
+        return NULL;
+
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        for (uint64_t done = 0; done < ext[i].len; done += chunk) {
+            r[k].off = ext[i].off + (off_t)done;
+            r[k].len = ext[i].len - done < chunk ? ext[i].len - done : chunk;
+            k++;
+        }
+    }
+    *out_n = k;
+    return r;
+}
+
+int fcopy_fd(int in_fd, int out_fd, const struct fcopy_options *opts,
+             struct fcopy_stats *stats) {
+    struct fcopy_options o = { 0 };
+    struct stat st;
+    struct extent *ext = NULL, *ranges = NULL;
+    size_t nextents = 0, nranges = 0;
+    int ret = -1;
+
+    if (opts)
+        o = *opts;
+    if (o.threads < 1)
+        o.threads = 1;
+    if (o.chunk == 0)
+        o.chunk = DEFAULT_CHUNK;
+
+    struct stat out_st;
+    if (fstat(in_fd, &st) == -1 || fstat(out_fd, &out_st) == -1)
+        return -1;
+    /* 같은 파일이면 아래 ftruncate 가 원본을 지운다 */
+    if (st.st_dev == out_st.st_dev && st.st_ino == out_st.st_ino) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    /* 먼저 최종 크기로 맞춰두면 hole 은 그대로 남고 병렬 쓰기도 안전하다 */
+    if (ftruncate(out_fd, 0) == -1 || ftruncate(out_fd, st.st_size) == -1)
+        return -1;
+
+    if (collect_extents(in_fd, st.st_size, o.sparse, &ext, &nextents) == -1)
+        return -1;
+
+    if (o.threads > 1) {
+        ranges = split_extents(ext, nextents, o.chunk, &nranges);
+        if (!ranges)
+            goto out;
+    } else {
+        ranges = ext;
+        nranges = nextents;
+        ext = NULL;
+    }
+
+    struct job j = {
+        .in_fd = in_fd,
+        .out_fd = out_fd,
+        .fixed = o.method != FCOPY_AUTO,
+        .start = o.method == FCOPY_AUTO ? FCOPY_COPY_FILE_RANGE : o.method,
+        .ranges = ranges,
+        .nranges = nranges,
+    };
+    atomic_init(&j.next, 0);
+    atomic_init(&j.bytes, 0);
+    atomic_init(&j.method_used, (int)j.start);
+    atomic_init(&j.error, 0);
+
+    int threads = (size_t)o.threads > nranges ? (int)(nranges ? nranges : 1) : o.threads;
+    pthread_t *tids = threads > 1 ? malloc(threads * sizeof(*tids)) : NULL;
+    int started = 1;
+    for (int i = 1; tids && i < threads; i++) {
+        if (pthread_create(&tids[i], NULL, worker_main, &j) != 0)
+            break;
+        started++;
+    }
+    worker_main(&j);
+    for (int i = 1; i < started; i++)
+        pthread_join(tids[i], NULL);
+    free(tids);
+
+    if (stats) {
+        stats->bytes = atomic_load(&j.bytes);
+        stats->extents = nextents;
+        stats->used = (enum fcopy_method)atomic_load(&j.method_used);
+    }
+    if (atomic_load(&j.error)) {
+        errno = atomic_load(&j.error);
+        goto out;
+    }
+    ret = 0;
+
+out:
+    free(ext);
+    free(ranges);
+    return ret;
+}
+
+int fcopy_path(const char *src, const char *dst, const struct fcopy_options *opts,
+               struct fcopy_stats *stats) {
+    struct stat st;
+    int in_fd = open(src, O_RDONLY);
+    if (in_fd < 0)
+        return -1;
+    if (fstat(in_fd, &st) == -1) {
+        close(in_fd);
+        return -1;
+    }
+
+    /* O_TRUNC 없이: 같은 파일인지는 fcopy_fd 가 자르기 전에 확인한다 */
+    int out_fd = open(dst, O_WRONLY | O_CREAT, st.st_mode & 0777);
+    if (out_fd < 0) {
+        int saved = errno;
+        close(in_fd);
+        errno = saved;
+        return -1;
+    }
+
+    int ret = fcopy_fd(in_fd, out_fd, opts, stats);
+    int saved = errno;
+    close(in_fd);
+    if (close(out_fd) == -1 && ret == 0)
+        return -1;
+    errno = saved;
+    return ret;
+}
@@ -0,0 +1,60 @@
+/*
+ * Large-File Copy Engine
+ *
+ * test_sendfile() (zerocopy_example.c) 는 sendfile 을 한 번만 호출하고
+ * 짧게 끝난 전송을 무시한다. 4KB 파일이라 동작할 뿐이다.
+ *
+ * 이 엔진은 2GB 이상의 파일도 끝까지 복사하며, 아래 순서로 방법을 시도한다:
+ *
+ *   1. copy_file_range - 같은 fs 면 reflink / 서버 측 복사 가능
+ *   2. sendfile        - 커널 안에서 page cache -> 파일
+ *   3. splice          - file -> pipe -> file
+ *   4. read/write      - 어디서나 동작하는 마지막 수단
+ *
+ * 방법이 지원되지 않으면 (EXDEV, ENOSYS, EINVAL, EOPNOTSUPP ...)
+ * 남은 구간을 다음 방법으로 이어서 복사한다.
+ *
+ *   - sparse : SEEK_DATA/SEEK_HOLE 로 데이터 구간만 복사, hole 은 유지
+ *   - threads: 구간을 chunk 로 나눠 여러 스레드가 동시에 복사
+ *
+ * Build: gcc -O2 -pthread -c file_copy.c
+ */
+
+#ifndef FILE_COPY_H
+#define FILE_COPY_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+enum fcopy_method {
+    FCOPY_AUTO = 0,
+    FCOPY_COPY_FILE_RANGE,
+    FCOPY_SENDFILE,
+    FCOPY_SPLICE,
+    FCOPY_RW,
+    FCOPY_METHOD_COUNT
+};
+
+struct fcopy_options {
+    enum fcopy_method method;    /* AUTO 면 위 순서대로 시도 */
+    int sparse;                  /* 1 이면 hole 을 건너뜀 */
+    int threads;                 /* 0/1 이면 단일 스레드 */
+    size_t chunk;                /* 병렬 복사 단위, 0 이면 64MB */
+};
+
+struct fcopy_stats {
+    uint64_t bytes;              /* 실제로 복사한 바이트 (hole 제외) */
+    uint64_t extents;            /* 복사한 데이터 구간 수 */
+    enum fcopy_method used;      /* 마지막으로 사용한 방법 */
+};
+
+/* in_fd 전체를 out_fd 로 복사. out_fd 는 최종 크기로 truncate 된다 */
+int fcopy_fd(int in_fd, int out_fd, const struct fcopy_options *opts,
+             struct fcopy_stats *stats);
+
+int fcopy_path(const char *src, const char *dst, const struct fcopy_options *opts,
+               struct fcopy_stats *stats);
+
+const char *fcopy_method_name(enum fcopy_method m);
+
+#endif
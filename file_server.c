@@ -0,0 +1,540 @@
+/*
+ * epoll Static File Server (sendfile) - 구현
+ *
+ * 연결은 edge-triggered 로 EPOLLIN | EPOLLOUT 을 함께 등록한다.
+ * 콜백은 읽기와 writable 표시만 하고, 실제 전송은 reactor_run_once() 사이의
+ * run_round() 에서 run queue 순서대로 quantum 만큼씩 한다.
+ *
+ * Build: gcc -O2 -c file_server.c reactor.c
+ */
+
+#define _GNU_SOURCE
+#include "file_server.h"
+#include "reactor.h"
+#include "zerocopy.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <linux/openat2.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#define IN_BUF 8192
+#define RW_BUF (64 * 1024)
+#define HDR_MAX 256
+
+struct conn {
+    struct fsrv *s;
+    int fd;
+    int closing;                 /* run queue 에 있어서 거기서 정리 */
+    int in_runq;
+    int writable;                /* 마지막 EAGAIN 이후 EPOLLOUT 을 받음 */
+    int rd_pending;              /* in 이 가득 차서 EAGAIN 까지 읽지 못함 */
+    int rd_closed;               /* 상대가 쓰기를 닫음: 남은 요청만 처리하고 닫는다 */
+    int sending;
+    int keep_alive;
+    int corked;
+
+    char in[IN_BUF];
+    size_t in_len;
+
+    char hdr[HDR_MAX];
+    size_t hdr_len, hdr_off;
+    int file_fd;
+    off_t off, end;
+
+    char *buf;                   /* FSRV_READWRITE 전용 */
+    size_t buf_len, buf_off;
+
+    struct conn *next;           /* run queue */
+    struct conn *all_prev, *all_next;
+};
+
+struct fsrv {
+    struct reactor *r;
+    int listen_fd;
+    int root_fd;
+    int mode;
+    int coalesce;
+    size_t quantum;
+    atomic_int stopped;
+
+    struct conn *head, *tail;    /* run queue */
+    struct conn *all;
+    struct fsrv_stats stats;
+};
+
+static void runq_push(struct fsrv *s, struct conn *c) {
+    if (c->in_runq)
+        return;
+    c->in_runq = 1;
+    c->next = NULL;
+    if (s->tail)
+        s->tail->next = c;
+    else
+        s->head = c;
+    s->tail = c;
+}
+
+static void conn_free(struct fsrv *s, struct conn *c) {
+    reactor_del(s->r, c->fd);
+    close(c->fd);
+    if (c->file_fd >= 0)
+        close(c->file_fd);
+    if (c->all_prev)
+        c->all_prev->all_next = c->all_next;
+    else
+        s->all = c->all_next;
+    if (c->all_next)
+        c->all_next->all_prev = c->all_prev;
+    free(c->buf);
+    free(c);
+}
+
+static void conn_close(struct fsrv *s, struct conn *c) {
+    if (c->in_runq)
+        c->closing = 1;
+    else
+        conn_free(s, c);
+}
+
+static int has_request(const struct conn *c) {
+    return c->in_len == IN_BUF || memmem(c->in, c->in_len, "\r\n\r\n", 4) != NULL;
+}
+
+/* 이 연결로 더 할 일이 없다: 상대가 닫았고 보낼 것도 남은 요청도 없다 */
+static int conn_done(const struct conn *c) {
+    return c->rd_closed && !c->sending && !has_request(c);
+}
+
+/* EAGAIN 까지 (또는 버퍼가 찰 때까지) 읽는다. 읽기 오류면 -1.
+ * EOF (half-close) 면 rd_closed 만 표시하고, 이미 받은 요청은 마저 응답한다 */
+static int do_read(struct conn *c) {
+    while (!c->rd_closed && c->in_len < IN_BUF) {
+        ssize_t n = recv(c->fd, c->in + c->in_len, IN_BUF - c->in_len, 0);
+        if (n > 0) {
+            c->in_len += n;
+            continue;
+        }
+        if (n == 0) {
+            c->rd_closed = 1;
+            break;
+        }
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN)
+            break;
+        return -1;
+    }
+    if (c->rd_closed || c->in_len < IN_BUF) {
+        c->rd_pending = 0;
+        return 0;
+    }
+    c->rd_pending = 1;
+    return 0;
+}
+
+/* 요청 경로의 각 component 가 ".." 인지 ("a..b" 같은 이름은 허용) */
+static int has_dotdot(const char *path) {
+    for (const char *p = path; *p; ) {
+        size_t len = strcspn(p, "/");
+        if (len == 2 && p[0] == '.' && p[1] == '.')
+            return 1;
+        p += len;
+        if (*p == '/')
+            p++;
+    }
+    return 0;
+}
+
+/* root 아래로만 해석한다. openat 은 symlink 를 따라가므로 root/pw -> /etc/passwd
+ * 같은 링크로 빠져나갈 수 있다. RESOLVE_BENEATH 는 절대 경로, "..", root 밖을
+ * 가리키는 symlink 를 모두 거부한다 (root 안을 가리키는 symlink 는 된다).
+ * openat2 가 없는 커널 (5.6 미만) 에서는 ENOSYS 로 실패하고 404 가 된다 */
+static int open_beneath(int root_fd, const char *rel) {
+    struct open_how how = {
+        .flags = O_RDONLY | O_CLOEXEC | O_NONBLOCK,
+        .resolve = RESOLVE_BENEATH | RESOLVE_NO_MAGICLINKS,
+    };
+    return (int)syscall(SYS_openat2, root_fd, rel, &how, sizeof(how));
+}
+
+static void start_response(struct fsrv *s, struct conn *c, int status, const char *reason,
+                           int file_fd, off_t size) {
+    c->hdr_len = snprintf(c->hdr, sizeof(c->hdr),
+                          "HTTP/1.1 %d %s\r\nContent-Length: %lld\r\nConnection: %s\r\n\r\n",
+                          status, reason, (long long)size, c->keep_alive ? "keep-alive" : "close");
+    c->hdr_off = 0;
+    c->file_fd = file_fd;
+    c->off = 0;
+    c->end = size;
+    c->buf_len = c->buf_off = 0;
+    c->sending = 1;
+    s->stats.requests++;
+    if (status >= 400)
+        s->stats.errors++;
+
+    /* header 와 body 첫 부분이 한 segment 로 나가도록 응답 끝까지 막아 둔다 */
+    if (s->mode == FSRV_SENDFILE && s->coalesce == FSRV_COALESCE_CORK && size > 0) {
+        int one = 1;
+        if (setsockopt(c->fd, IPPROTO_TCP, TCP_CORK, &one, sizeof(one)) == 0)
+            c->corked = 1;
+    }
+}
+
+/* 버퍼의 첫 요청을 꺼내 응답을 시작한다. 완성된 요청이 없으면 0 */
+static int parse_request(struct fsrv *s, struct conn *c) {
+    char line[2048], method[16], path[1024], version[16];
+
+    char *end = memmem(c->in, c->in_len, "\r\n\r\n", 4);
+    if (!end) {
+        if (c->in_len < IN_BUF)
+            return 0;
+        /* header 가 버퍼보다 크다 */
+        c->keep_alive = 0;
+        c->in_len = 0;
+        start_response(s, c, 431, "Request Header Fields Too Large", -1, 0);
+        return 1;
+    }
+    size_t req_len = end - c->in + 4;
+
+    char *eol = memmem(c->in, req_len, "\r\n", 2);
+    size_t line_len = eol - c->in < (ptrdiff_t)sizeof(line) - 1 ? (size_t)(eol - c->in)
+                                                                 : sizeof(line) - 1;
+    memcpy(line, c->in, line_len);
+    line[line_len] = '\0';
+    int fields = sscanf(line, "%15s %1023s %15s", method, path, version);
+
+    /* HTTP/1.1 은 기본 keep-alive, 1.0 은 "Connection: keep-alive" 일 때만 */
+    c->keep_alive = fields == 3 && strcmp(version, "HTTP/1.1") == 0;
+    for (char *p = eol + 2; p < end; ) {
+        char *next = memmem(p, end + 2 - p, "\r\n", 2);
+        if (next - p >= 11 && strncasecmp(p, "Connection:", 11) == 0) {
+            char *v = p + 11;
+            while (*v == ' ')
+                v++;
+            if (next - v >= 5 && strncasecmp(v, "close", 5) == 0)
+                c->keep_alive = 0;
+            else if (next - v >= 10 && strncasecmp(v, "keep-alive", 10) == 0)
+                c->keep_alive = 1;
+        }
+        p = next + 2;
+    }
+    memmove(c->in, c->in + req_len, c->in_len - req_len);
+    c->in_len -= req_len;
+
+    /* "//etc/x" 는 path + 1 이 절대 경로가 된다 (open_beneath 도 거부하지만 400 으로) */
+    if (fields != 3 || path[0] != '/' || path[1] == '/' || has_dotdot(path)) {
+        c->keep_alive = 0;
+        start_response(s, c, 400, "Bad Request", -1, 0);
+        return 1;
+    }
+    if (strcmp(method, "GET") != 0) {
+        start_response(s, c, 405, "Method Not Allowed", -1, 0);
+        return 1;
+    }
+
+    /* O_NONBLOCK: root 아래 FIFO 를 열다가 서버 전체가 멈추지 않게 (일반 파일엔 영향 없음) */
+    struct stat st;
+    int fd = path[1] ? open_beneath(s->root_fd, path + 1) : -1;
+    if (fd >= 0 && (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode))) {
+        close(fd);
+        fd = -1;
+    }
+    if (fd < 0)
+        start_response(s, c, 404, "Not Found", -1, 0);
+    else
+        start_response(s, c, 200, "OK", fd, st.st_size);
+    return 1;
+}
+
+/* header 와 읽어 둔 buf 를 한 번에 (FSRV_READWRITE) */
+static ssize_t send_rw(struct conn *c, size_t budget) {
+    if (c->buf_off == c->buf_len && c->off < c->end) {
+        size_t want = c->end - c->off < RW_BUF ? (size_t)(c->end - c->off) : RW_BUF;
+        if (!c->buf && !(c->buf = malloc(RW_BUF)))
+            return -1;
+        ssize_t n = pread(c->file_fd, c->buf, want, c->off);
+        if (n <= 0) {
+            if (n == 0)
+                errno = EIO;     /* 보내는 도중 파일이 줄었다 */
+            return -1;
+        }
+        c->off += n;
+        c->buf_len = n;
+        c->buf_off = 0;
+    }
+
+    struct iovec iov[2];
+    int cnt = 0;
+    if (c->hdr_off < c->hdr_len)
+        iov[cnt++] = (struct iovec){ c->hdr + c->hdr_off, c->hdr_len - c->hdr_off };
+    if (c->buf_off < c->buf_len) {
+        size_t len = c->buf_len - c->buf_off;
+        iov[cnt++] = (struct iovec){ c->buf + c->buf_off, len < budget ? len : budget };
+    }
+    struct msghdr msg = { .msg_iov = iov, .msg_iovlen = cnt };
+    ssize_t n = sendmsg(c->fd, &msg, MSG_NOSIGNAL);
+    if (n > 0) {
+        size_t h = c->hdr_len - c->hdr_off < (size_t)n ? c->hdr_len - c->hdr_off : (size_t)n;
+        c->hdr_off += h;
+        c->buf_off += n - h;
+    }
+    return n;
+}
+
+static ssize_t send_sendfile(struct fsrv *s, struct conn *c, size_t budget) {
+    if (c->hdr_off < c->hdr_len) {
+        int flags = MSG_NOSIGNAL;
+        if (s->coalesce == FSRV_COALESCE_MSG_MORE && c->off < c->end)
+            flags |= MSG_MORE;
+        ssize_t n = send(c->fd, c->hdr + c->hdr_off, c->hdr_len - c->hdr_off, flags);
+        if (n > 0)
+            c->hdr_off += n;
+        return n;
+    }
+    size_t left = c->end - c->off;
+    ssize_t n = sendfile_zero_copy(c->fd, c->file_fd, &c->off, left < budget ? left : budget);
+    if (n == 0) {
+        errno = EIO;
+        return -1;
+    }
+    return n;
+}
+
+enum { SEND_DONE, SEND_PREEMPTED, SEND_BLOCKED, SEND_ERROR };
+
+/* quantum 바이트까지 보낸다 */
+static int send_response(struct fsrv *s, struct conn *c) {
+    size_t budget = s->quantum;
+
+    while (c->hdr_off < c->hdr_len || c->off < c->end || c->buf_off < c->buf_len) {
+        if (budget == 0)
+            return SEND_PREEMPTED;
+        ssize_t n = s->mode == FSRV_READWRITE ? send_rw(c, budget) : send_sendfile(s, c, budget);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN ? SEND_BLOCKED : SEND_ERROR;
+        }
+        s->stats.bytes_sent += n;
+        budget -= (size_t)n < budget ? (size_t)n : budget;
+    }
+    return SEND_DONE;
+}
+
+static void finish_response(struct conn *c) {
+    if (c->file_fd >= 0)
+        close(c->file_fd);
+    c->file_fd = -1;
+    if (c->corked) {
+        int zero = 0;
+        setsockopt(c->fd, IPPROTO_TCP, TCP_CORK, &zero, sizeof(zero));
+        c->corked = 0;
+    }
+    c->sending = 0;
+}
+
+/* run queue 에서 꺼낸 연결 하나의 차례 */
+static void serve(struct fsrv *s, struct conn *c) {
+    if (!c->sending && !parse_request(s, c))
+        return;
+
+    switch (send_response(s, c)) {
+    case SEND_PREEMPTED:
+        s->stats.preempted++;
+        runq_push(s, c);
+        return;
+    case SEND_BLOCKED:
+        /* 다음 EPOLLOUT 에서 다시 run queue 로 */
+        c->writable = 0;
+        s->stats.blocked++;
+        return;
+    case SEND_ERROR:
+        conn_close(s, c);
+        return;
+    }
+
+    finish_response(c);
+    if (!c->keep_alive) {
+        conn_close(s, c);
+        return;
+    }
+    if (c->rd_pending && do_read(c) == -1) {
+        conn_close(s, c);
+        return;
+    }
+    /* pipelining 된 다음 요청은 다른 연결들 뒤에서 */
+    if (has_request(c))
+        runq_push(s, c);
+    else if (c->rd_closed)
+        conn_close(s, c);
+}
+
+static void run_round(struct fsrv *s) {
+    struct conn *c = s->head;
+    s->head = s->tail = NULL;
+    while (c) {
+        struct conn *next = c->next;
+        c->in_runq = 0;
+        if (c->closing)
+            conn_free(s, c);
+        else
+            serve(s, c);
+        c = next;
+    }
+}
+
+
+static void on_conn(struct reactor *r, int fd, uint32_t events, void *arg) {
+    struct conn *c = arg;
+    struct fsrv *s = c->s;
+    (void)r;
+    (void)fd;
+
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        conn_close(s, c);
+        return;
+    }
+    if (events & EPOLLOUT)
+        c->writable = 1;
+    if ((events & EPOLLIN) && do_read(c) == -1) {
+        conn_close(s, c);
+        return;
+    }
+    if (!c->closing && conn_done(c)) {
+        conn_close(s, c);
+        return;
+    }
+    if (!c->closing && c->writable && (c->sending || has_request(c)))
+        runq_push(s, c);
+}
+
+static void on_accept(struct reactor *r, int fd, uint32_t events, void *arg) {
+    struct fsrv *s = arg;
+    (void)events;
+
+    for (;;) {
+        int cfd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (cfd == -1) {
+            if (errno == EINTR)
+                continue;
+            return;              /* EAGAIN, 또는 EMFILE 등: 다음 연결 때 다시 */
+        }
+        int one = 1;
+        setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        struct conn *c = calloc(1, sizeof(*c));
+        if (!c) {
+            close(cfd);
+            continue;
+        }
+        c->s = s;
+        c->fd = cfd;
+        c->file_fd = -1;
+        c->writable = 1;
+        if (reactor_add(r, cfd, EPOLLIN | EPOLLOUT, REACTOR_EDGE, on_conn, c) == -1) {
+            close(cfd);
+            free(c);
+            continue;
+        }
+        c->all_next = s->all;
+        if (s->all)
+            s->all->all_prev = c;
+        s->all = c;
+        s->stats.connections++;
+    }
+}
+
+struct fsrv *fsrv_create(const struct fsrv_options *opts) {
+    struct sockaddr_in sa = { .sin_family = AF_INET, .sin_port = htons(opts->port) };
+    int saved, one = 1;
+
+    if (inet_pton(AF_INET, opts->addr ? opts->addr : "127.0.0.1", &sa.sin_addr) != 1) {
+        errno = EINVAL;
+        return NULL;
+    }
+    struct fsrv *s = calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+    s->listen_fd = -1;
+    s->mode = opts->mode;
+    s->coalesce = opts->coalesce;
+    s->quantum = opts->quantum ? opts->quantum : FSRV_DEFAULT_QUANTUM;
+
+    s->root_fd = open(opts->root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (s->root_fd < 0)
+        goto fail;
+    s->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (s->listen_fd < 0)
+        goto fail;
+    setsockopt(s->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(s->listen_fd, (struct sockaddr *)&sa, sizeof(sa)) == -1 ||
+        listen(s->listen_fd, SOMAXCONN) == -1)
+        goto fail;
+    s->r = reactor_create();
+    if (!s->r || reactor_add(s->r, s->listen_fd, EPOLLIN, REACTOR_EDGE, on_accept, s) == -1)
+        goto fail;
+    return s;
+
+fail:
+    saved = errno;
+    if (s->r)
+        reactor_destroy(s->r);
+    if (s->listen_fd >= 0)
+        close(s->listen_fd);
+    if (s->root_fd >= 0)
+        close(s->root_fd);
+    free(s);
+    errno = saved;
+    return NULL;
+}
+
+int fsrv_port(const struct fsrv *s) {
+    struct sockaddr_in sa;
+    socklen_t len = sizeof(sa);
+    if (getsockname(s->listen_fd, (struct sockaddr *)&sa, &len) == -1)
+        return -1;
+    return ntohs(sa.sin_port);
+}
+
+int fsrv_run(struct fsrv *s) {
+    while (!atomic_load(&s->stopped)) {
+        /* 보낼 것이 남아 있으면 기다리지 않고 이벤트만 확인 */
+        if (reactor_run_once(s->r, s->head ? 0 : -1) == -1)
+            return -1;
+        run_round(s);
+    }
+    return 0;
+}
+
+void fsrv_stop(struct fsrv *s) {
+    atomic_store(&s->stopped, 1);
+    reactor_wakeup(s->r);
+}
+
+void fsrv_get_stats(const struct fsrv *s, struct fsrv_stats *st) {
+    *st = s->stats;
+}
+
+void fsrv_destroy(struct fsrv *s) {
+    if (!s)
+        return;
+    while (s->all)
+        conn_free(s, s->all);
+    reactor_destroy(s->r);
+    close(s->listen_fd);
+    close(s->root_fd);
+    free(s);
+}
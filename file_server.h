@@ -0,0 +1,84 @@
+/*
+ * epoll Static File Server (sendfile)
+ *
+ * sendfile_zero_copy() (zerocopy_example.c) 는 파일 -> 파일로만 쓰이지만,
+ * sendfile 이 가장 이득인 곳은 출력이 socket 일 때다: page cache 에서 바로
+ * socket buffer 로 가고, 사용자 버퍼와 read()/write() 두 번의 복사가 없다.
+ *
+ * fsrv 는 reactor.c 위에서 도는 단일 스레드 HTTP/1.1 GET 서버다.
+ *
+ *   - keep-alive: 한 연결에서 요청을 계속 받는다 (pipelining 포함).
+ *                 HTTP/1.0 이나 "Connection: close" 면 응답 후 닫는다
+ *   - header 합치기: accept 한 socket 은 TCP_NODELAY 이므로 header 를 따로
+ *                 보내면 작은 segment 가 하나 더 나간다.
+ *                   FSRV_COALESCE_MSG_MORE : header 를 send(MSG_MORE) 로
+ *                   FSRV_COALESCE_CORK     : 응답 동안 TCP_CORK
+ *   - 부분 전송: socket 이 가득 차면 (EAGAIN) 보낸 위치를 기억하고
+ *                EPOLLOUT (edge) 이 오면 이어서 보낸다
+ *   - 공정 분배: 보낼 것이 있는 연결은 run queue 에 있고, 한 차례에 quantum
+ *                바이트까지만 보낸 뒤 뒤로 돌아간다. 큰 파일 하나가 작은
+ *                요청들을 오래 막지 않는다
+ *   - FSRV_READWRITE: 비교용. pread() 로 사용자 버퍼에 읽고 send()
+ *
+ * 사용 예:
+ *   struct fsrv_options o = { .root = "www", .addr = "127.0.0.1", .port = 8080 };
+ *   struct fsrv *s = fsrv_create(&o);
+ *   fsrv_run(s);                 // 다른 스레드에서 fsrv_stop(s)
+ *   fsrv_destroy(s);
+ *
+ * Build: gcc -O2 -c file_server.c reactor.c
+ */
+
+#ifndef FILE_SERVER_H
+#define FILE_SERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FSRV_SENDFILE  0
+#define FSRV_READWRITE 1
+
+#define FSRV_COALESCE_NONE     0
+#define FSRV_COALESCE_MSG_MORE 1
+#define FSRV_COALESCE_CORK     2
+
+#define FSRV_DEFAULT_QUANTUM (64 * 1024)
+
+struct fsrv_options {
+    const char *root;            /* 서비스할 디렉터리 ("/a/b" -> root/a/b) */
+    const char *addr;            /* NULL 이면 "127.0.0.1" */
+    uint16_t port;               /* 0 이면 임의 포트 (fsrv_port 로 확인) */
+    int mode;                    /* FSRV_SENDFILE / FSRV_READWRITE */
+    int coalesce;                /* FSRV_COALESCE_* (sendfile 에서만 의미 있음) */
+    size_t quantum;              /* 0 이면 FSRV_DEFAULT_QUANTUM, SIZE_MAX 면 제한 없음 */
+};
+
+struct fsrv_stats {
+    uint64_t connections;
+    uint64_t requests;
+    uint64_t errors;             /* 4xx 응답 */
+    uint64_t bytes_sent;         /* header 포함 */
+    uint64_t blocked;            /* EAGAIN 으로 EPOLLOUT 을 기다린 횟수 */
+    uint64_t preempted;          /* quantum 을 다 써서 뒤로 돌아간 횟수 */
+};
+
+struct fsrv;
+
+/* listen 까지 한다. 실패 시 NULL + errno */
+struct fsrv *fsrv_create(const struct fsrv_options *opts);
+
+int fsrv_port(const struct fsrv *s);
+
+/* fsrv_stop 까지 이벤트 루프를 돈다 */
+int fsrv_run(struct fsrv *s);
+
+/* 다른 스레드에서 호출 가능 */
+void fsrv_stop(struct fsrv *s);
+
+/* fsrv_run 이 끝난 뒤 (또는 같은 스레드에서) 호출 */
+void fsrv_get_stats(const struct fsrv *s, struct fsrv_stats *st);
+
+/* 남은 연결을 모두 닫는다 */
+void fsrv_destroy(struct fsrv *s);
+
+#endif
@@ -0,0 +1,404 @@
+/*
+ * Static File Server Benchmark (loopback load generator)
+ *
+ * fsrv 를 스레드 하나에서 돌리고, client 스레드들이 각자 keep-alive 연결
+ * 하나로 GET 을 반복한다. 받은 body 는 원본과 비교한다.
+ *
+ *   readwrite      - FSRV_READWRITE: pread() + send() (사용자 버퍼 복사 2번)
+ *   sendfile       - sendfile_zero_copy, header 는 따로 send
+ *   sendfile_more  - header 를 MSG_MORE 로 보내 body 와 합침
+ *   sendfile_cork  - 응답 동안 TCP_CORK
+ *
+ * 공정 분배: bulk client 하나가 큰 파일을 계속 받는 동안 작은 요청의 latency.
+ *   fair_q<N>      - quantum N 바이트씩 돌아가며 전송
+ *   fair_unlimited - quantum 제한 없음 (응답 하나를 EAGAIN 까지 보냄)
+ *
+ * Output (CSV): mode,quantum,clients,requests,file_size,seconds,req_per_sec,mb_per_sec,p50_us,p99_us
+ *
+ * Build: gcc -O2 -pthread -o file_server_bench file_server_bench.c file_server.c reactor.c
+ * Usage: ./file_server_bench [-d root] [-s file_size] [-B bulk_size] [-n requests_per_client]
+ *                            [-c max_clients] [-q quantum]
+ */
+
+#define _GNU_SOURCE
+#include "file_server.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#define RBUF (64 * 1024)
+
+struct bench {
+    const char *root;
+    size_t file_size;
+    size_t bulk_size;
+    long requests;
+    char *data;                  /* "small" 파일 내용 */
+    int port;
+    atomic_int bulk_stop;
+};
+
+struct client {
+    struct bench *b;
+    const char *path;
+    const char *expect;          /* NULL 이면 내용 확인 없이 버림 */
+    size_t expect_len;
+    long requests;               /* 0 이면 bulk_stop 까지 */
+    uint64_t *lat_ns;
+    long done;
+    int failed;
+    pthread_t tid;
+
+    int fd;
+    char rbuf[RBUF];
+    size_t r_len, r_off;
+    char *body;
+};
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    }
+    return v;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int write_file(const char *path, const char *data, size_t len) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return -1;
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n <= 0) {
+            close(fd);
+            return -1;
+        }
+        data += n;
+        len -= n;
+    }
+    return close(fd);
+}
+
+static int connect_port(int port) {
+    struct sockaddr_in sa = { .sin_family = AF_INET, .sin_port = htons(port) };
+    int one = 1;
+
+    inet_pton(AF_INET, "127.0.0.1", &sa.sin_addr);
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(fd, (struct sockaddr *)&sa, sizeof(sa)) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* header 를 받아 status 와 Content-Length 를 얻는다. 남은 바이트는 rbuf 에 */
+static int read_header(struct client *c, int *status, size_t *len) {
+    char *end;
+    while (!(end = memmem(c->rbuf + c->r_off, c->r_len - c->r_off, "\r\n\r\n", 4))) {
+        if (c->r_off > 0) {
+            memmove(c->rbuf, c->rbuf + c->r_off, c->r_len - c->r_off);
+            c->r_len -= c->r_off;
+            c->r_off = 0;
+        }
+        if (c->r_len == RBUF)
+            return -1;
+        ssize_t n = recv(c->fd, c->rbuf + c->r_len, RBUF - c->r_len, 0);
+        if (n <= 0)
+            return -1;
+        c->r_len += n;
+    }
+    *end = '\0';
+    const char *cl = strstr(c->rbuf + c->r_off, "Content-Length: ");
+    if (sscanf(c->rbuf + c->r_off, "HTTP/1.1 %d", status) != 1 || !cl)
+        return -1;
+    *len = strtoull(cl + 16, NULL, 10);
+    c->r_off = end + 4 - c->rbuf;
+    return 0;
+}
+
+/* body 를 dst (NULL 이면 버림) 로 */
+static int read_body(struct client *c, char *dst, size_t len) {
+    size_t got = c->r_len - c->r_off < len ? c->r_len - c->r_off : len;
+    if (dst)
+        memcpy(dst, c->rbuf + c->r_off, got);
+    c->r_off += got;
+    if (c->r_off == c->r_len)
+        c->r_off = c->r_len = 0;
+
+    while (got < len) {
+        char *p = dst ? dst + got : c->rbuf;
+        size_t want = dst ? len - got : (len - got < RBUF ? len - got : RBUF);
+        ssize_t n = recv(c->fd, p, want, 0);
+        if (n <= 0)
+            return -1;
+        got += n;
+    }
+    return 0;
+}
+
+static int one_request(struct client *c) {
+    char req[256];
+    int status;
+    size_t len;
+
+    int n = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n", c->path);
+    if (send(c->fd, req, n, MSG_NOSIGNAL) != n || read_header(c, &status, &len) == -1 ||
+        status != 200 || len != c->expect_len)
+        return -1;
+    if (read_body(c, c->body, len) == -1)
+        return -1;
+    if (c->expect && memcmp(c->body, c->expect, len) != 0)
+        return -1;
+    return 0;
+}
+
+static void *client_main(void *arg) {
+    struct client *c = arg;
+
+    c->fd = connect_port(c->b->port);
+    c->body = c->expect ? malloc(c->expect_len) : NULL;
+    if (c->fd < 0 || (c->expect && !c->body)) {
+        c->failed = 1;
+        goto out;
+    }
+    for (long i = 0; c->requests ? i < c->requests : !atomic_load(&c->b->bulk_stop); i++) {
+        uint64_t t0 = now_ns();
+        if (one_request(c) == -1) {
+            c->failed = 1;
+            break;
+        }
+        if (c->lat_ns)
+            c->lat_ns[i] = now_ns() - t0;
+        c->done++;
+    }
+out:
+    if (c->fd >= 0)
+        close(c->fd);
+    free(c->body);
+    return NULL;
+}
+
+static void *server_main(void *arg) {
+    fsrv_run(arg);
+    return NULL;
+}
+
+static int run(struct bench *b, const char *name, int mode, int coalesce, size_t quantum,
+               int clients, int bulk) {
+    struct fsrv_options o = {
+        .root = b->root, .mode = mode, .coalesce = coalesce, .quantum = quantum,
+    };
+    struct client *cs = calloc(clients + 1, sizeof(*cs));
+    uint64_t *lat = malloc(clients * b->requests * sizeof(*lat));
+    pthread_t server;
+    int ret = 0;
+
+    struct fsrv *s = fsrv_create(&o);
+    if (!s || !cs || !lat) {
+        fsrv_destroy(s);
+        free(cs);
+        free(lat);
+        return -1;
+    }
+    b->port = fsrv_port(s);
+    atomic_store(&b->bulk_stop, 0);
+    pthread_create(&server, NULL, server_main, s);
+
+    if (bulk) {
+        cs[clients] = (struct client){ .b = b, .path = "/bulk", .expect_len = b->bulk_size };
+        pthread_create(&cs[clients].tid, NULL, client_main, &cs[clients]);
+        usleep(20000);           /* bulk 전송이 먼저 시작되도록 */
+    }
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < clients; i++) {
+        cs[i].b = b;
+        cs[i].path = "/small";
+        cs[i].expect = b->data;
+        cs[i].expect_len = b->file_size;
+        cs[i].requests = b->requests;
+        cs[i].lat_ns = lat + (size_t)i * b->requests;
+        pthread_create(&cs[i].tid, NULL, client_main, &cs[i]);
+    }
+    for (int i = 0; i < clients; i++) {
+        pthread_join(cs[i].tid, NULL);
+        if (cs[i].failed)
+            ret = -1;
+    }
+    double secs = (now_ns() - t0) / 1e9;
+    if (bulk) {
+        atomic_store(&b->bulk_stop, 1);
+        pthread_join(cs[clients].tid, NULL);
+        if (cs[clients].failed)
+            ret = -1;
+    }
+    fsrv_stop(s);
+    pthread_join(server, NULL);
+    fsrv_destroy(s);
+
+    if (ret == 0) {
+        size_t n = (size_t)clients * b->requests;
+        qsort(lat, n, sizeof(*lat), cmp_u64);
+        printf("%s,%zu,%d,%zu,%zu,%.4f,%.0f,%.1f,%.1f,%.1f\n", name,
+               quantum == SIZE_MAX ? 0 : quantum, clients, n, b->file_size, secs, n / secs,
+               (double)n * b->file_size / secs / (1024.0 * 1024.0),
+               lat[n / 2] / 1000.0, lat[n * 99 / 100] / 1000.0);
+        fflush(stdout);
+    }
+    free(cs);
+    free(lat);
+    return ret;
+}
+
+/* 한 연결에서 pipelining 된 요청 세 개: 200, 404, 그리고 "Connection: close" */
+static int check_protocol(struct bench *b) {
+    struct fsrv_options o = { .root = b->root };
+    struct client c = { .b = b };
+    char body[16];
+    pthread_t server;
+    int status[3] = { 0 }, closed = 0, ok = 0;
+    size_t len[3] = { 0 };
+
+    struct fsrv *s = fsrv_create(&o);
+    if (!s)
+        return -1;
+    b->port = fsrv_port(s);
+    pthread_create(&server, NULL, server_main, s);
+
+    c.fd = connect_port(b->port);
+    const char *reqs = "GET /small HTTP/1.1\r\n\r\n"
+                       "GET /missing HTTP/1.1\r\n\r\n"
+                       "GET /small HTTP/1.1\r\nConnection: close\r\n\r\n";
+    if (c.fd >= 0 && send(c.fd, reqs, strlen(reqs), MSG_NOSIGNAL) == (ssize_t)strlen(reqs)) {
+        ok = 1;
+        for (int i = 0; ok && i < 3; i++)
+            ok = read_header(&c, &status[i], &len[i]) == 0 && read_body(&c, NULL, len[i]) == 0;
+        closed = ok && recv(c.fd, body, sizeof(body), 0) == 0;
+    }
+    if (c.fd >= 0)
+        close(c.fd);
+    fsrv_stop(s);
+    pthread_join(server, NULL);
+    fsrv_destroy(s);
+
+    ok = ok && closed && status[0] == 200 && len[0] == b->file_size && status[1] == 404 &&
+         len[1] == 0 && status[2] == 200;
+    fprintf(stderr, "protocol check %s\n", ok ? "ok" : "failed");
+    return ok ? 0 : -1;
+}
+
+int main(int argc, char *argv[]) {
+    struct bench b = { .root = "fsrv_bench_root", .file_size = 16 << 10, .bulk_size = 64 << 20,
+                       .requests = 2000 };
+    size_t quantum = FSRV_DEFAULT_QUANTUM;
+    int max_clients = 8, opt;
+    char path[4096];
+
+    while ((opt = getopt(argc, argv, "d:s:B:n:c:q:")) != -1) {
+        switch (opt) {
+        case 'd': b.root = optarg; break;
+        case 's': b.file_size = parse_size(optarg); break;
+        case 'B': b.bulk_size = parse_size(optarg); break;
+        case 'n': b.requests = atol(optarg); break;
+        case 'c': max_clients = atoi(optarg); break;
+        case 'q': quantum = parse_size(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-d root] [-s file_size] [-B bulk_size] "
+                    "[-n requests_per_client] [-c max_clients] [-q quantum]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (b.file_size < 1 || b.bulk_size < 1 || b.requests < 1 || max_clients < 1 || quantum < 1) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    b.data = malloc(b.file_size > b.bulk_size ? b.file_size : b.bulk_size);
+    if (!b.data || (mkdir(b.root, 0755) == -1 && errno != EEXIST)) {
+        perror("setup");
+        return 1;
+    }
+    for (size_t i = 0; i < b.bulk_size; i++)
+        b.data[i] = 'a' + i % 26;
+    snprintf(path, sizeof(path), "%s/bulk", b.root);
+    if (write_file(path, b.data, b.bulk_size) == -1) {
+        perror(path);
+        return 1;
+    }
+    for (size_t i = 0; i < b.file_size; i++)
+        b.data[i] = (char)(i * 7 + i / 4096);
+    snprintf(path, sizeof(path), "%s/small", b.root);
+    if (write_file(path, b.data, b.file_size) == -1) {
+        perror(path);
+        return 1;
+    }
+
+    static const struct {
+        const char *name;
+        int mode, coalesce;
+    } modes[] = {
+        { "readwrite", FSRV_READWRITE, FSRV_COALESCE_NONE },
+        { "sendfile", FSRV_SENDFILE, FSRV_COALESCE_NONE },
+        { "sendfile_more", FSRV_SENDFILE, FSRV_COALESCE_MSG_MORE },
+        { "sendfile_cork", FSRV_SENDFILE, FSRV_COALESCE_CORK },
+    };
+
+    int ret = check_protocol(&b) == 0 ? 0 : 1;
+    printf("mode,quantum,clients,requests,file_size,seconds,req_per_sec,mb_per_sec,p50_us,p99_us\n");
+    for (size_t m = 0; ret == 0 && m < sizeof(modes) / sizeof(modes[0]); m++) {
+        for (int c = 1; c <= max_clients; c *= 2) {
+            if (run(&b, modes[m].name, modes[m].mode, modes[m].coalesce, quantum, c, 0) == -1) {
+                fprintf(stderr, "%s: failed\n", modes[m].name);
+                ret = 1;
+                break;
+            }
+        }
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "fair_q%zu", quantum);
+    if (ret == 0 &&
+        (run(&b, name, FSRV_SENDFILE, FSRV_COALESCE_MSG_MORE, quantum, max_clients, 1) == -1 ||
+         run(&b, "fair_unlimited", FSRV_SENDFILE, FSRV_COALESCE_MSG_MORE, SIZE_MAX,
+             max_clients, 1) == -1)) {
+        fprintf(stderr, "fairness run failed\n");
+        ret = 1;
+    }
+
+    unlink(path);
+    snprintf(path, sizeof(path), "%s/bulk", b.root);
+    unlink(path);
+    rmdir(b.root);
+    free(b.data);
+    return ret;
+}
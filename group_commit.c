@@ -0,0 +1,255 @@
+/*
+ * Group-Commit Durable Log Writer - 구현
+ *
+ * 구조:
+ *   append 스레드들 --(pending 리스트)--> flusher 스레드
+ *   flusher: batch 수집 -> writev() -> fdatasync() -> 완료 통보
+ *
+ * flusher 가 디스크 I/O 를 하는 동안 들어온 레코드는 다음 batch 로 모인다.
+ * 부하가 높을수록 batch 가 커져서 fdatasync 1회당 레코드 수가 늘어난다.
+ */
+
+#define _GNU_SOURCE
+#include "group_commit.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+struct gc_log {
+    int fd;
+    struct gc_options opts;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;    /* flusher 깨우기 */
+    pthread_cond_t done_cond;    /* append 호출자 깨우기 */
+
+    struct gc_completion *head;  /* pending 리스트 (FIFO) */
+    struct gc_completion *tail;
+    unsigned int pending_records;
+    size_t pending_bytes;
+
+    struct iovec *iov;           /* flusher 전용 batch 버퍼 (max_records 개) */
+    int closing;
+    pthread_t flusher;
+};
+
+static void timespec_add_us(struct timespec *ts, unsigned int us) {
+    ts->tv_nsec += (long)us * 1000;
+    while (ts->tv_nsec >= 1000000000L) {
+        ts->tv_nsec -= 1000000000L;
+        ts->tv_sec++;
+    }
+}
+
+/* writev 를 partial write 까지 고려해서 끝까지 수행 */
+static int writev_all(int fd, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t n = writev(fd, iov, iovcnt);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        /* 다 써진 iovec 은 건너뛰고, 일부만 써진 것은 앞부분을 잘라낸다 */
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+static int batch_full(const struct gc_log *log) {
+    return log->pending_records >= log->opts.max_records ||
+           log->pending_bytes >= log->opts.max_bytes;
+}
+
+static void *flusher_main(void *arg) {
+    struct gc_log *log = arg;
+    struct iovec *iov = log->iov;
+
+    pthread_mutex_lock(&log->lock);
+    for (;;) {
+        while (!log->head && !log->closing)
+            pthread_cond_wait(&log->work_cond, &log->lock);
+        if (!log->head && log->closing)
+            break;
+
+        /* 첫 레코드가 들어온 뒤 max_delay_us 동안 batch 를 더 모은다 */
+        if (log->opts.max_delay_us > 0 && !log->closing) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            timespec_add_us(&deadline, log->opts.max_delay_us);
+            while (!batch_full(log) && !log->closing) {
+                if (pthread_cond_timedwait(&log->work_cond, &log->lock, &deadline) == ETIMEDOUT)
+                    break;
+            }
+        }
+
+        /* pending 리스트 앞에서부터 한 batch 분량을 떼어낸다 */
+        struct gc_completion *batch = log->head, *last = NULL, *c = log->head;
+        unsigned int n = 0;
+        size_t bytes = 0;
+        while (c && n < log->opts.max_records &&
+               (n == 0 || bytes + c->len <= log->opts.max_bytes)) {
+            iov[n].iov_base = (void *)c->buf;
+            iov[n].iov_len = c->len;
+            bytes += c->len;
+            n++;
+            last = c;
+            c = c->next;
+        }
+        log->head = c;
+        if (!c)
+            log->tail = NULL;
+        last->next = NULL;
+        log->pending_records -= n;
+        log->pending_bytes -= bytes;
+
+        pthread_mutex_unlock(&log->lock);
+
+        int status = 0, err = 0;
+        if (writev_all(log->fd, iov, (int)n) == -1 || fdatasync(log->fd) == -1) {
+            status = -1;
+            err = errno;
+        }
+
+        pthread_mutex_lock(&log->lock);
+        for (c = batch; c; c = c->next) {
+            c->status = status;
+            c->err = err;
+            c->done = 1;
+        }
+        pthread_cond_broadcast(&log->done_cond);
+    }
+    pthread_mutex_unlock(&log->lock);
+    return NULL;
+}
+
+struct gc_log *gc_log_open(const char *path, const struct gc_options *opts) {
+    struct gc_log *log = calloc(1, sizeof(*log));
+    if (!log)
+        return NULL;
+
+    if (opts) {
+        log->opts = *opts;
+    } else {
+        log->opts.max_delay_us = GC_DEFAULT_DELAY_US;
+        log->opts.max_records = GC_DEFAULT_RECORDS;
+        log->opts.max_bytes = GC_DEFAULT_BYTES;
+    }
+    if (log->opts.max_records == 0 || log->opts.max_records > IOV_MAX)
+        log->opts.max_records = IOV_MAX;
+    if (log->opts.max_bytes == 0)
+        log->opts.max_bytes = GC_DEFAULT_BYTES;
+
+    log->iov = malloc(sizeof(*log->iov) * log->opts.max_records);
+    if (!log->iov) {
+        free(log);
+        return NULL;
+    }
+
+    log->fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (log->fd < 0) {
+        free(log->iov);
+        free(log);
+        return NULL;
+    }
+
+    pthread_mutex_init(&log->lock, NULL);
+    pthread_cond_init(&log->work_cond, NULL);
+    pthread_cond_init(&log->done_cond, NULL);
+
+    int ret = pthread_create(&log->flusher, NULL, flusher_main, log);
+    if (ret != 0) {
+        close(log->fd);
+        free(log->iov);
+        free(log);
+        errno = ret;
+        return NULL;
+    }
+    return log;
+}
+
+int gc_log_append_async(struct gc_log *log, struct gc_completion *c,
+                        const void *buf, size_t len) {
+    c->buf = buf;
+    c->len = len;
+    c->done = 0;
+    c->status = 0;
+    c->err = 0;
+    c->next = NULL;
+
+    pthread_mutex_lock(&log->lock);
+    if (log->closing) {
+        pthread_mutex_unlock(&log->lock);
+        errno = EPIPE;
+        return -1;
+    }
+    if (log->tail)
+        log->tail->next = c;
+    else
+        log->head = c;
+    log->tail = c;
+    log->pending_records++;
+    log->pending_bytes += len;
+
+    /* 대기 중인 flusher 는 첫 레코드 또는 batch 가 찼을 때만 깨운다 */
+    if (log->pending_records == 1 || batch_full(log))
+        pthread_cond_signal(&log->work_cond);
+    pthread_mutex_unlock(&log->lock);
+    return 0;
+}
+
+int gc_completion_wait(struct gc_log *log, struct gc_completion *c) {
+    pthread_mutex_lock(&log->lock);
+    while (!c->done)
+        pthread_cond_wait(&log->done_cond, &log->lock);
+    pthread_mutex_unlock(&log->lock);
+
+    if (c->status == -1) {
+        errno = c->err;
+        return -1;
+    }
+    return 0;
+}
+
+int gc_log_append(struct gc_log *log, const void *buf, size_t len) {
+    struct gc_completion c;
+    if (gc_log_append_async(log, &c, buf, len) == -1)
+        return -1;
+    return gc_completion_wait(log, &c);
+}
+
+int gc_log_close(struct gc_log *log) {
+    pthread_mutex_lock(&log->lock);
+    log->closing = 1;
+    pthread_cond_signal(&log->work_cond);
+    pthread_mutex_unlock(&log->lock);
+
+    pthread_join(log->flusher, NULL);
+
+    int ret = close(log->fd);
+    pthread_cond_destroy(&log->done_cond);
+    pthread_cond_destroy(&log->work_cond);
+    pthread_mutex_destroy(&log->lock);
+    free(log->iov);
+    free(log);
+    return ret;
+}
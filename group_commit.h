@@ -0,0 +1,62 @@
+/*
+ * Group-Commit Durable Log Writer
+ *
+ * 5.c ~ 8.c 는 append 한 번마다 fsync/fdatasync/O_SYNC 를 한 번씩 호출한다.
+ * 여기서는 여러 스레드의 append 를 모아서
+ *   writev() 1회 + fdatasync() 1회
+ * 로 한꺼번에 내구화하고, 각 호출자에게는 자기 레코드가 포함된 batch 가
+ * 디스크에 기록된 뒤에 완료를 알려준다.
+ *
+ * 사용 예:
+ *   struct gc_log *log = gc_log_open("log.txt", NULL);
+ *   gc_log_append(log, msg, strlen(msg));   // 내구화될 때까지 대기
+ *   gc_log_close(log);
+ *
+ * Build: gcc -O2 -pthread -c group_commit.c
+ */
+
+#ifndef GROUP_COMMIT_H
+#define GROUP_COMMIT_H
+
+#include <stddef.h>
+
+struct gc_options {
+    unsigned int max_delay_us;   /* 첫 레코드 이후 batch 를 모으는 최대 시간 */
+    unsigned int max_records;    /* batch 당 최대 레코드 수 (IOV_MAX 이하로 제한) */
+    size_t max_bytes;            /* batch 당 최대 바이트 수 */
+};
+
+#define GC_DEFAULT_DELAY_US 200
+#define GC_DEFAULT_RECORDS 1024
+#define GC_DEFAULT_BYTES (1024 * 1024)
+
+/*
+ * 비동기 append 용 완료 객체.
+ * buf 는 완료될 때까지 호출자가 유지해야 한다 (복사하지 않음).
+ */
+struct gc_completion {
+    const void *buf;
+    size_t len;
+    int done;
+    int status;                  /* 0: 성공, -1: 실패 (err 에 errno) */
+    int err;
+    struct gc_completion *next;
+};
+
+struct gc_log;
+
+/* opts 가 NULL 이면 기본값 사용. 실패 시 NULL, errno 설정 */
+struct gc_log *gc_log_open(const char *path, const struct gc_options *opts);
+
+/* batch 가 내구화될 때까지 블록. 성공 0, 실패 -1 (errno 설정) */
+int gc_log_append(struct gc_log *log, const void *buf, size_t len);
+
+/* 큐에 넣고 바로 반환. gc_completion_wait() 로 완료를 기다린다 */
+int gc_log_append_async(struct gc_log *log, struct gc_completion *c,
+                        const void *buf, size_t len);
+int gc_completion_wait(struct gc_log *log, struct gc_completion *c);
+
+/* 남은 레코드를 모두 내구화한 뒤 닫는다 */
+int gc_log_close(struct gc_log *log);
+
+#endif
@@ -0,0 +1,206 @@
+/*
+ * Group-Commit Benchmark
+ *
+ * N 개의 스레드가 각각 M 번 append 할 때의 처리량과 latency 를 비교한다.
+ *
+ *   append    - 5.c: O_APPEND write() 만 (내구성 없음, 기준선)
+ *   fsync     - 6.c: write() + fsync()
+ *   fdatasync - 7.c: write() + fdatasync()
+ *   osync     - 8.c: O_SYNC write()
+ *   group     - group_commit.c: writev() + fdatasync() 를 batch 단위로
+ *
+ * Output (CSV): strategy,threads,appends,seconds,appends_per_sec,p50_us,p99_us
+ *
+ * Build: gcc -O2 -pthread -o group_commit_bench group_commit_bench.c group_commit.c
+ * Usage: ./group_commit_bench [-f path] [-t max_threads] [-n appends_per_thread]
+ *                             [-d max_delay_us] [-r max_records]
+ */
+
+#include "group_commit.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+enum strategy { S_APPEND, S_FSYNC, S_FDATASYNC, S_OSYNC, S_GROUP, S_COUNT };
+
+static const char *strategy_names[S_COUNT] = {
+    "append", "fsync", "fdatasync", "osync", "group"
+};
+
+struct worker {
+    pthread_t tid;
+    int id;
+    int fd;                  /* S_GROUP 이외의 전략에서 공유 */
+    struct gc_log *log;      /* S_GROUP 에서 공유 */
+    enum strategy strategy;
+    int appends;
+    uint64_t *lat_ns;        /* append 별 latency */
+    int error;
+};
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void *worker_main(void *arg) {
+    struct worker *w = arg;
+    char msg[128];
+
+    for (int i = 0; i < w->appends; i++) {
+        int len = snprintf(msg, sizeof(msg), "thread %d: message %d\n", w->id, i);
+        uint64_t t0 = now_ns();
+
+        if (w->strategy == S_GROUP) {
+            if (gc_log_append(w->log, msg, len) == -1) {
+                perror("gc_log_append");
+                w->error = 1;
+                return NULL;
+            }
+        } else {
+            if (write(w->fd, msg, len) != len) {
+                perror("write");
+                w->error = 1;
+                return NULL;
+            }
+            if (w->strategy == S_FSYNC && fsync(w->fd) == -1) {
+                perror("fsync");
+                w->error = 1;
+                return NULL;
+            }
+            if (w->strategy == S_FDATASYNC && fdatasync(w->fd) == -1) {
+                perror("fdatasync");
+                w->error = 1;
+                return NULL;
+            }
+        }
+
+        w->lat_ns[i] = now_ns() - t0;
+    }
+    return NULL;
+}
+
+static int run(enum strategy s, const char *path, int nthreads, int appends,
+               const struct gc_options *opts) {
+    struct worker *workers = calloc(nthreads, sizeof(*workers));
+    uint64_t *lat = malloc(sizeof(uint64_t) * nthreads * appends);
+    int fd = -1;
+    struct gc_log *log = NULL;
+    int rc = 0;
+
+    if (!workers || !lat) {
+        perror("malloc");
+        free(workers);
+        free(lat);
+        return -1;
+    }
+
+    unlink(path);
+    if (s == S_GROUP) {
+        log = gc_log_open(path, opts);
+        if (!log) {
+            perror("gc_log_open");
+            rc = -1;
+            goto out;
+        }
+    } else {
+        int flags = O_WRONLY | O_CREAT | O_APPEND;
+        if (s == S_OSYNC)
+            flags |= O_SYNC;
+        fd = open(path, flags, 0644);
+        if (fd < 0) {
+            perror("open");
+            rc = -1;
+            goto out;
+        }
+    }
+
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < nthreads; i++) {
+        workers[i].id = i;
+        workers[i].fd = fd;
+        workers[i].log = log;
+        workers[i].strategy = s;
+        workers[i].appends = appends;
+        workers[i].lat_ns = lat + (size_t)i * appends;
+        pthread_create(&workers[i].tid, NULL, worker_main, &workers[i]);
+    }
+    for (int i = 0; i < nthreads; i++) {
+        pthread_join(workers[i].tid, NULL);
+        if (workers[i].error)
+            rc = -1;
+    }
+    double secs = (now_ns() - t0) / 1e9;
+
+    if (rc == 0) {
+        size_t total = (size_t)nthreads * appends;
+        qsort(lat, total, sizeof(uint64_t), cmp_u64);
+        printf("%s,%d,%zu,%.4f,%.0f,%.1f,%.1f\n",
+               strategy_names[s], nthreads, total, secs, total / secs,
+               lat[total / 2] / 1000.0, lat[total * 99 / 100] / 1000.0);
+        fflush(stdout);
+    }
+
+out:
+    if (log)
+        gc_log_close(log);
+    if (fd >= 0)
+        close(fd);
+    free(workers);
+    free(lat);
+    return rc;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = "group_commit_bench.log";
+    int max_threads = 16;
+    int appends = 200;
+    struct gc_options opts = {
+        .max_delay_us = GC_DEFAULT_DELAY_US,
+        .max_records = GC_DEFAULT_RECORDS,
+        .max_bytes = GC_DEFAULT_BYTES,
+    };
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:t:n:d:r:")) != -1) {
+        switch (opt) {
+        case 'f': path = optarg; break;
+        case 't': max_threads = atoi(optarg); break;
+        case 'n': appends = atoi(optarg); break;
+        case 'd': opts.max_delay_us = (unsigned int)atoi(optarg); break;
+        case 'r': opts.max_records = (unsigned int)atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-f path] [-t max_threads] [-n appends] "
+                            "[-d max_delay_us] [-r max_records]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (max_threads < 1 || appends < 1) {
+        fprintf(stderr, "threads and appends must be > 0\n");
+        return 1;
+    }
+
+    printf("strategy,threads,appends,seconds,appends_per_sec,p50_us,p99_us\n");
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        for (int s = 0; s < S_COUNT; s++) {
+            if (run(s, path, threads, appends, &opts))
+                return 1;
+        }
+    }
+
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,674 @@
+/*
+ * I/O Throughput Benchmark
+ *
+ * compare_io_methods() (zerocopy_example.c) 는 바이트 수만 출력하고
+ * 시간을 재지 않는다. 이 프로그램은 repo 에 있는 모든 읽기 경로를
+ * 같은 조건에서 측정한다:
+ *
+ *   read     - 2.c 의 read() 루프
+ *   pread    - 오프셋 지정 pread()
+ *   mmap     - mmap_zero_copy_reader 처럼 매핑 후 직접 접근
+ *   sendfile - sendfile_zero_copy (file -> /dev/null)
+ *   splice   - file -> pipe -> /dev/null
+ *   readv    - iovec_demo.c 처럼 여러 버퍼로 scatter read
+ *
+ * Sweep: file size x buffer size x cold/warm page cache x 1..N threads
+ * Output (CSV, stdout):
+ *   method,file_size,buf_size,threads,cache,bytes,seconds,gbps,
+ *   syscalls,syscalls_per_byte,p50_us,p99_us
+ *
+ * Build: gcc -O2 -pthread -o io_bench io_bench.c
+ * Usage: ./io_bench [-d dir] [-s min_size] [-S max_size]
+ *                   [-b min_buf] [-B max_buf] [-t max_threads]
+ *                   [-m read,pread,mmap,sendfile,splice,readv]
+ *   크기 인자는 K/M/G 접미사를 받는다. (예: -S 8G)
+ *   root 로 실행하면 cold 측정 시 /proc/sys/vm/drop_caches 도 사용한다.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
+
+#define KB (1024ULL)
+#define MB (1024ULL * KB)
+#define GB (1024ULL * MB)
+
+#define SIZE_STEP 16     /* file size sweep 배수 */
+#define BUF_STEP 8       /* buffer size sweep 배수 */
+#define IOV_SEGS 4       /* readv 에 사용할 iovec 개수 */
+#define FILL_CHUNK (1 * MB)
+
+/*
+ * Latency histogram (log-linear)
+ *
+ * 2의 거듭제곱 구간을 16개로 다시 나눠서 ns 단위 latency 를 기록.
+ * 모든 샘플을 저장하지 않아도 p50/p99 를 ~6% 오차로 구할 수 있다.
+ */
+#define HIST_SUB 16
+#define HIST_BUCKETS (64 * HIST_SUB)
+
+struct hist {
+    uint64_t count[HIST_BUCKETS];
+    uint64_t total;
+};
+
+static int hist_index(uint64_t ns) {
+    if (ns < HIST_SUB)
+        return (int)ns;
+    int msb = 63 - __builtin_clzll(ns);
+    int sub = (int)((ns >> (msb - 4)) & (HIST_SUB - 1));
+    return (msb - 3) * HIST_SUB + sub;
+}
+
+static uint64_t hist_value(int idx) {
+    if (idx < HIST_SUB)
+        return idx;
+    int msb = idx / HIST_SUB + 3;
+    int sub = idx % HIST_SUB;
+    return ((uint64_t)(HIST_SUB + sub)) << (msb - 4);
+}
+
+static void hist_record(struct hist *h, uint64_t ns) {
+    h->count[hist_index(ns)]++;
+    h->total++;
+}
+
+static void hist_merge(struct hist *dst, const struct hist *src) {
+    for (int i = 0; i < HIST_BUCKETS; i++)
+        dst->count[i] += src->count[i];
+    dst->total += src->total;
+}
+
+static double hist_percentile_us(const struct hist *h, double pct) {
+    if (h->total == 0)
+        return 0.0;
+    uint64_t want = (uint64_t)(h->total * pct / 100.0);
+    if (want == 0)
+        want = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->count[i];
+        if (seen >= want)
+            return hist_value(i) / 1000.0;
+    }
+    return 0.0;
+}
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* ---------------------------------------------------------------- */
+
+enum method { M_READ, M_PREAD, M_MMAP, M_SENDFILE, M_SPLICE, M_READV, M_COUNT };
+
+static const char *method_names[M_COUNT] = {
+    "read", "pread", "mmap", "sendfile", "splice", "readv"
+};
+
+/* 스레드 하나가 담당하는 구간 [start, start + len) */
+struct worker {
+    pthread_t tid;
+    enum method method;
+    const char *path;
+    off_t start;
+    size_t len;
+    size_t buf_size;
+
+    /* 결과 */
+    uint64_t bytes;
+    uint64_t syscalls;
+    struct hist hist;
+    int error;
+};
+
+static int devnull_fd = -1;
+
+/* 2.c 의 read() 루프 - 버퍼가 찰 때마다 다시 읽는다 */
+static int run_read(struct worker *w, int fd, char *buf) {
+    if (lseek(fd, w->start, SEEK_SET) == (off_t)-1) {
+        perror("lseek");
+        return -1;
+    }
+    w->syscalls++;
+
+    size_t left = w->len;
+    while (left > 0) {
+        size_t want = left < w->buf_size ? left : w->buf_size;
+        uint64_t t0 = now_ns();
+        ssize_t ret = read(fd, buf, want);
+        hist_record(&w->hist, now_ns() - t0);
+        w->syscalls++;
+        if (ret == -1) {
+            if (errno == EINTR)
+                continue;
+            perror("read");
+            return -1;
+        }
+        if (ret == 0)
+            break;
+        left -= ret;
+        w->bytes += ret;
+    }
+    return 0;
+}
+
+static int run_pread(struct worker *w, int fd, char *buf) {
+    off_t off = w->start;
+    size_t left = w->len;
+    while (left > 0) {
+        size_t want = left < w->buf_size ? left : w->buf_size;
+        uint64_t t0 = now_ns();
+        ssize_t ret = pread(fd, buf, want, off);
+        hist_record(&w->hist, now_ns() - t0);
+        w->syscalls++;
+        if (ret == -1) {
+            if (errno == EINTR)
+                continue;
+            perror("pread");
+            return -1;
+        }
+        if (ret == 0)
+            break;
+        off += ret;
+        left -= ret;
+        w->bytes += ret;
+    }
+    return 0;
+}
+
+/* iovec_demo.c 처럼 버퍼를 IOV_SEGS 조각으로 나눠서 readv */
+static int run_readv(struct worker *w, int fd, char *buf) {
+    if (lseek(fd, w->start, SEEK_SET) == (off_t)-1) {
+        perror("lseek");
+        return -1;
+    }
+    w->syscalls++;
+
+    size_t left = w->len;
+    while (left > 0) {
+        size_t want = left < w->buf_size ? left : w->buf_size;
+        struct iovec iov[IOV_SEGS];
+        size_t seg = want / IOV_SEGS;
+        int iovcnt = 0;
+        for (int i = 0; i < IOV_SEGS; i++) {
+            size_t l = (i == IOV_SEGS - 1) ? want - seg * i : seg;
+            if (l == 0)
+                continue;
+            iov[iovcnt].iov_base = buf + seg * i;
+            iov[iovcnt].iov_len = l;
+            iovcnt++;
+        }
+
+        uint64_t t0 = now_ns();
+        ssize_t ret = readv(fd, iov, iovcnt);
+        hist_record(&w->hist, now_ns() - t0);
+        w->syscalls++;
+        if (ret == -1) {
+            if (errno == EINTR)
+                continue;
+            perror("readv");
+            return -1;
+        }
+        if (ret == 0)
+            break;
+        left -= ret;
+        w->bytes += ret;
+    }
+    return 0;
+}
+
+/*
+ * mmap_zero_copy_reader 와 같은 방식으로 매핑.
+ * 페이지마다 1바이트씩 접근해서 실제 page fault 비용을 포함시킨다.
+ * latency 는 buf_size 만큼 접근하는 시간을 한 번의 op 로 기록.
+ */
+static int run_mmap(struct worker *w, int fd) {
+    long page = sysconf(_SC_PAGESIZE);
+    off_t map_start = w->start & ~((off_t)page - 1);
+    size_t lead = w->start - map_start;
+    size_t map_len = w->len + lead;
+
+    if (w->len == 0)
+        return 0;
+
+    char *mapped = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, fd, map_start);
+    w->syscalls++;
+    if (mapped == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+
+    volatile unsigned char sink = 0;
+    const char *p = mapped + lead;
+    size_t left = w->len;
+    while (left > 0) {
+        size_t chunk = left < w->buf_size ? left : w->buf_size;
+        uint64_t t0 = now_ns();
+        for (size_t i = 0; i < chunk; i += page)
+            sink ^= p[i];
+        sink ^= p[chunk - 1];
+        hist_record(&w->hist, now_ns() - t0);
+        p += chunk;
+        left -= chunk;
+        w->bytes += chunk;
+    }
+    (void)sink;
+
+    munmap(mapped, map_len);
+    w->syscalls++;
+    return 0;
+}
+
+/* sendfile_zero_copy 와 동일: 사용자 버퍼 없이 커널 안에서 전송 */
+static int run_sendfile(struct worker *w, int fd) {
+    off_t off = w->start;
+    size_t left = w->len;
+    while (left > 0) {
+        size_t want = left < w->buf_size ? left : w->buf_size;
+        uint64_t t0 = now_ns();
+        ssize_t ret = sendfile(devnull_fd, fd, &off, want);
+        hist_record(&w->hist, now_ns() - t0);
+        w->syscalls++;
+        if (ret == -1) {
+            if (errno == EINTR)
+                continue;
+            perror("sendfile");
+            return -1;
+        }
+        if (ret == 0)
+            break;
+        left -= ret;
+        w->bytes += ret;
+    }
+    return 0;
+}
+
+/*
+ * splice: file -> pipe -> /dev/null
+ * pipe 용량을 buf_size 로 맞추되, 커널 한도(pipe-max-size)를 넘으면
+ * 기본 크기로 진행한다. 한 번의 op = splice 2회.
+ */
+static int run_splice(struct worker *w, int fd) {
+    int pfd[2];
+    if (pipe(pfd) == -1) {
+        perror("pipe");
+        return -1;
+    }
+    w->syscalls++;
+
+    int cap = fcntl(pfd[1], F_SETPIPE_SZ, (int)w->buf_size);
+    if (cap == -1)
+        cap = fcntl(pfd[1], F_GETPIPE_SZ);
+    w->syscalls++;
+
+    loff_t off = w->start;
+    size_t left = w->len;
+    int rc = 0;
+    while (left > 0) {
+        size_t want = left < w->buf_size ? left : w->buf_size;
+        if (want > (size_t)cap)
+            want = cap;
+
+        uint64_t t0 = now_ns();
+        ssize_t in = splice(fd, &off, pfd[1], NULL, want, SPLICE_F_MOVE);
+        w->syscalls++;
+        if (in == -1) {
+            if (errno == EINTR)
+                continue;
+            perror("splice in");
+            rc = -1;
+            break;
+        }
+        if (in == 0)
+            break;
+
+        ssize_t out_left = in;
+        while (out_left > 0) {
+            ssize_t out = splice(pfd[0], NULL, devnull_fd, NULL, out_left, SPLICE_F_MOVE);
+            w->syscalls++;
+            if (out == -1) {
+                if (errno == EINTR)
+                    continue;
+                perror("splice out");
+                rc = -1;
+                goto done;
+            }
+            out_left -= out;
+        }
+        hist_record(&w->hist, now_ns() - t0);
+        left -= in;
+        w->bytes += in;
+    }
+
+done:
+    close(pfd[0]);
+    close(pfd[1]);
+    return rc;
+}
+
+static void *worker_main(void *arg) {
+    struct worker *w = arg;
+    char *buf = NULL;
+
+    int fd = open(w->path, O_RDONLY);
+    if (fd == -1) {
+        perror("open");
+        w->error = 1;
+        return NULL;
+    }
+    w->syscalls++;
+
+    if (w->method == M_READ || w->method == M_PREAD || w->method == M_READV) {
+        if (posix_memalign((void **)&buf, 4096, w->buf_size) != 0) {
+            fprintf(stderr, "posix_memalign failed\n");
+            close(fd);
+            w->error = 1;
+            return NULL;
+        }
+        /* 첫 접근 page fault 가 측정에 섞이지 않도록 미리 터치 */
+        memset(buf, 0, w->buf_size);
+    }
+
+    int rc;
+    switch (w->method) {
+    case M_READ:     rc = run_read(w, fd, buf); break;
+    case M_PREAD:    rc = run_pread(w, fd, buf); break;
+    case M_READV:    rc = run_readv(w, fd, buf); break;
+    case M_MMAP:     rc = run_mmap(w, fd); break;
+    case M_SENDFILE: rc = run_sendfile(w, fd); break;
+    case M_SPLICE:   rc = run_splice(w, fd); break;
+    default:         rc = -1; break;
+    }
+    if (rc)
+        w->error = 1;
+
+    free(buf);
+    close(fd);
+    w->syscalls++;
+    return NULL;
+}
+
+/* ---------------------------------------------------------------- */
+
+/* 테스트 파일 준비 - 이미 같은 크기로 있으면 재사용 */
+static int prepare_file(const char *path, uint64_t size) {
+    struct stat st;
+    if (stat(path, &st) == 0 && (uint64_t)st.st_size == size)
+        return 0;
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        perror("open");
+        return -1;
+    }
+
+    char *chunk = malloc(FILL_CHUNK);
+    if (!chunk) {
+        close(fd);
+        return -1;
+    }
+    for (size_t i = 0; i < FILL_CHUNK; i++)
+        chunk[i] = 'a' + (i % 26);
+
+    uint64_t left = size;
+    while (left > 0) {
+        size_t want = left < FILL_CHUNK ? left : FILL_CHUNK;
+        ssize_t ret = write(fd, chunk, want);
+        if (ret == -1) {
+            if (errno == EINTR)
+                continue;
+            perror("write");
+            free(chunk);
+            close(fd);
+            return -1;
+        }
+        left -= ret;
+    }
+
+    free(chunk);
+    if (fsync(fd) == -1)
+        perror("fsync");
+    close(fd);
+    return 0;
+}
+
+/*
+ * Cold cache: 해당 파일의 page cache 를 비운다.
+ * 일반 사용자는 POSIX_FADV_DONTNEED 만 가능하고,
+ * root 라면 drop_caches 로 전체 캐시를 비운다.
+ */
+static void drop_cache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd != -1) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+
+    if (geteuid() == 0) {
+        sync();
+        int dc = open("/proc/sys/vm/drop_caches", O_WRONLY);
+        if (dc != -1) {
+            if (write(dc, "1", 1) == -1)
+                perror("drop_caches");
+            close(dc);
+        }
+    }
+}
+
+/* warm: 한 번 읽어서 page cache 에 올려둔다 */
+static void warm_cache(const char *path, uint64_t size) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+        return;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    char *buf = malloc(FILL_CHUNK);
+    if (buf) {
+        uint64_t left = size;
+        ssize_t ret;
+        while (left > 0 && (ret = read(fd, buf, FILL_CHUNK)) > 0)
+            left -= ret;
+        free(buf);
+    }
+    close(fd);
+}
+
+static void run_case(enum method m, const char *path, uint64_t file_size,
+                     size_t buf_size, int nthreads, int cold) {
+    /* 각 스레드는 파일을 균등하게 나눈 구간을 읽는다 (페이지 정렬).
+     * 파일이 작아 한 구간이 0 이면 한 스레드가 다 읽으므로 1 로 보고한다 */
+    uint64_t per = (file_size / nthreads) & ~(4096ULL - 1);
+    if (per == 0)
+        nthreads = 1;
+
+    struct worker *workers = calloc(nthreads, sizeof(*workers));
+    if (!workers) {
+        perror("calloc");
+        return;
+    }
+
+    if (cold)
+        drop_cache(path);
+    else
+        warm_cache(path, file_size);
+
+    for (int i = 0; i < nthreads; i++) {
+        struct worker *w = &workers[i];
+        w->method = m;
+        w->path = path;
+        w->buf_size = buf_size;
+        w->start = (off_t)(per * i);
+        w->len = (i == nthreads - 1) ? file_size - per * i : per;
+    }
+
+    uint64_t t0 = now_ns();
+    int started = 0, error = 0;
+    for (; started < nthreads; started++) {
+        int rc = pthread_create(&workers[started].tid, NULL, worker_main, &workers[started]);
+        if (rc) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(rc));
+            error = 1;
+            break;
+        }
+    }
+    for (int i = 0; i < started; i++)
+        pthread_join(workers[i].tid, NULL);
+    uint64_t elapsed = now_ns() - t0;
+
+    struct hist *total = calloc(1, sizeof(*total));
+    if (!total) {
+        perror("calloc");
+        free(workers);
+        return;
+    }
+    uint64_t bytes = 0, syscalls = 0;
+    for (int i = 0; i < started; i++) {
+        hist_merge(total, &workers[i].hist);
+        bytes += workers[i].bytes;
+        syscalls += workers[i].syscalls;
+        error |= workers[i].error;
+    }
+
+    if (error) {
+        fprintf(stderr, "%s: run failed (file=%llu buf=%zu threads=%d)\n",
+                method_names[m], (unsigned long long)file_size, buf_size, nthreads);
+    } else {
+        double secs = elapsed / 1e9;
+        printf("%s,%llu,%zu,%d,%s,%llu,%.6f,%.3f,%llu,%.3e,%.2f,%.2f\n",
+               method_names[m], (unsigned long long)file_size, buf_size, nthreads,
+               cold ? "cold" : "warm", (unsigned long long)bytes, secs,
+               secs > 0 ? bytes / secs / 1e9 : 0.0,
+               (unsigned long long)syscalls,
+               bytes ? (double)syscalls / bytes : 0.0,
+               hist_percentile_us(total, 50.0), hist_percentile_us(total, 99.0));
+        fflush(stdout);
+    }
+
+    free(total);
+    free(workers);
+}
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v *= KB; break;
+    case 'm': case 'M': v *= MB; break;
+    case 'g': case 'G': v *= GB; break;
+    default: break;
+    }
+    return v;
+}
+
+static int parse_methods(const char *list, int *enabled) {
+    char *copy = strdup(list);
+    char *save = NULL;
+    memset(enabled, 0, sizeof(int) * M_COUNT);
+    for (char *tok = strtok_r(copy, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        int found = 0;
+        for (int m = 0; m < M_COUNT; m++) {
+            if (strcmp(tok, method_names[m]) == 0) {
+                enabled[m] = 1;
+                found = 1;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "unknown method: %s\n", tok);
+            free(copy);
+            return -1;
+        }
+    }
+    free(copy);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *dir = ".";
+    uint64_t min_size = 4 * KB, max_size = 4 * GB;
+    uint64_t min_buf = 512, max_buf = 16 * MB;
+    int max_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int enabled[M_COUNT];
+    int opt;
+
+    for (int m = 0; m < M_COUNT; m++)
+        enabled[m] = 1;
+
+    while ((opt = getopt(argc, argv, "d:s:S:b:B:t:m:")) != -1) {
+        switch (opt) {
+        case 'd': dir = optarg; break;
+        case 's': min_size = parse_size(optarg); break;
+        case 'S': max_size = parse_size(optarg); break;
+        case 'b': min_buf = parse_size(optarg); break;
+        case 'B': max_buf = parse_size(optarg); break;
+        case 't': max_threads = atoi(optarg); break;
+        case 'm':
+            if (parse_methods(optarg, enabled))
+                return 1;
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-d dir] [-s min_size] [-S max_size] [-b min_buf] "
+                    "[-B max_buf] [-t max_threads] [-m methods]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (max_threads < 1)
+        max_threads = 1;
+    if (min_size == 0 || min_buf == 0) {
+        fprintf(stderr, "sizes must be > 0\n");
+        return 1;
+    }
+
+    devnull_fd = open("/dev/null", O_WRONLY);
+    if (devnull_fd == -1) {
+        perror("open /dev/null");
+        return 1;
+    }
+
+    printf("method,file_size,buf_size,threads,cache,bytes,seconds,gbps,"
+           "syscalls,syscalls_per_byte,p50_us,p99_us\n");
+
+    for (uint64_t size = min_size; size <= max_size; size *= SIZE_STEP) {
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/io_bench_%llu.dat", dir, (unsigned long long)size);
+        if (prepare_file(path, size))
+            return 1;
+
+        for (uint64_t buf = min_buf; buf <= max_buf; buf *= BUF_STEP) {
+            /* 파일보다 큰 버퍼는 의미가 없으므로 첫 번째 크기만 측정 */
+            if (buf > size && buf != min_buf)
+                break;
+
+            /* 1, 2, 4 ... 마지막은 정확히 max_threads */
+            for (int threads = 1; threads <= max_threads;
+                 threads = (threads < max_threads && threads * 2 > max_threads)
+                               ? max_threads : threads * 2) {
+                for (int cold = 1; cold >= 0; cold--) {
+                    for (int m = 0; m < M_COUNT; m++) {
+                        if (enabled[m])
+                            run_case(m, path, size, buf, threads, cold);
+                    }
+                }
+            }
+        }
+
+        unlink(path);
+    }
+
+    close(devnull_fd);
+    return 0;
+}
@@ -0,0 +1,299 @@
+/*
+ * Vectored Write Coalescer / Scatter-Read Ring - 구현
+ *
+ * short write 가 나면 다 써진 iovec 은 건너뛰고 일부만 써진 iovec 은
+ * 앞을 잘라낸 뒤 같은 배열로 다시 호출한다 (group_commit.c 의 writev_all 과 같음).
+ * pwritev2 가 RWF_* 를 지원하지 않는 커널이면 writev/pwritev 로 쓰고
+ * DSYNC 는 fdatasync, APPEND 는 lseek(SEEK_END) 로 흉내낸다.
+ */
+
+#define _GNU_SOURCE
+#include "iovec_batch.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_MAX_BYTES (256 * 1024)
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+struct iovb {
+    int fd;
+    struct iovb_options opts;
+    int no_rwf;                      /* pwritev2 플래그 미지원 */
+    int sync_pending;                /* 흉내낸 DSYNC: 다 썼지만 fdatasync 전 (또는 실패) */
+
+    struct iovec *iov;
+    int iov_max;                     /* syscall 한 번에 넘길 수 있는 수 */
+    int cap;                         /* 할당된 수, flush 가 밀리면 늘어남 */
+    int count;
+    size_t bytes;
+    uint64_t first_ns;               /* 첫 조각을 넣은 시각 */
+
+    struct iovb_stats stats;
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+struct iovb *iovb_create(int fd, const struct iovb_options *opts) {
+    struct iovb *b = calloc(1, sizeof(*b));
+    if (!b)
+        return NULL;
+
+    b->fd = fd;
+    b->opts.offset = -1;
+    if (opts)
+        b->opts = *opts;
+    if (b->opts.max_bytes == 0)
+        b->opts.max_bytes = DEFAULT_MAX_BYTES;
+
+    long max = sysconf(_SC_IOV_MAX);
+    b->iov_max = max > 0 ? (int)max : IOV_MAX;
+    b->cap = b->iov_max;
+    b->iov = malloc(b->cap * sizeof(*b->iov));
+    if (!b->iov) {
+        free(b);
+        return NULL;
+    }
+    return b;
+}
+
+/* 한 번의 vectored write. 쓴 바이트 또는 -1 */
+static ssize_t write_once(struct iovb *b, struct iovec *iov, int cnt) {
+    int rwf = 0;
+
+    if (b->opts.flags & IOVB_DSYNC)
+        rwf |= RWF_DSYNC;
+    if (b->opts.flags & IOVB_APPEND)
+        rwf |= RWF_APPEND;
+
+    if (rwf && !b->no_rwf) {
+        /* APPEND 면 offset 은 무시되므로 -1 로 */
+        off_t off = (b->opts.flags & IOVB_APPEND) ? -1 : b->opts.offset;
+        ssize_t n = pwritev2(b->fd, iov, cnt, off, rwf);
+        /* 모르는 RWF_* 는 EOPNOTSUPP, pwritev2 자체가 없으면 ENOSYS.
+         * EINVAL 은 인자 (O_DIRECT 정렬 등) 때문일 수 있으므로 그대로 돌려준다 */
+        if (n != -1 || (errno != EOPNOTSUPP && errno != ENOSYS))
+            return n;
+        b->no_rwf = 1;
+    }
+
+    if ((b->opts.flags & IOVB_APPEND) && b->no_rwf) {
+        /* 원자적이지 않다: 다른 writer 가 있으면 O_APPEND 로 열어야 한다 */
+        b->stats.syscalls++;
+        if (lseek(b->fd, 0, SEEK_END) == (off_t)-1)
+            return -1;
+        return writev(b->fd, iov, cnt);
+    }
+    if (b->opts.offset >= 0)
+        return pwritev(b->fd, iov, cnt, b->opts.offset);
+    return writev(b->fd, iov, cnt);
+}
+
+int iovb_flush(struct iovb *b) {
+    struct iovec *iov = b->iov;
+    int cnt = b->count;
+
+    if (cnt == 0 && !b->sync_pending)
+        return 0;
+
+    while (cnt > 0) {
+        ssize_t n = write_once(b, iov, cnt < b->iov_max ? cnt : b->iov_max);
+        b->stats.syscalls++;
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            /* 남은 조각을 맨 앞으로 당겨두면 호출자가 다시 flush 할 수 있다 */
+            memmove(b->iov, iov, cnt * sizeof(*iov));
+            b->count = cnt;
+            return -1;
+        }
+        b->bytes -= n;
+        b->stats.bytes += n;
+        if (b->opts.offset >= 0 && !(b->opts.flags & IOVB_APPEND))
+            b->opts.offset += n;
+
+        while (cnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            cnt--;
+        }
+        if (cnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+
+    /* 이미 다 썼으므로 sync 가 실패해도 조각은 비운다 (다시 쓰면 append 가 중복된다).
+     * 다음 flush 는 sync 만 다시 한다 */
+    if (b->count > 0) {
+        b->count = 0;
+        b->bytes = 0;
+        b->stats.flushes++;
+        if ((b->opts.flags & IOVB_DSYNC) && b->no_rwf)
+            b->sync_pending = 1;
+    }
+    if (b->sync_pending) {
+        b->stats.syscalls++;
+        if (fdatasync(b->fd) == -1)
+            return -1;
+        b->sync_pending = 0;
+    }
+    return 0;
+}
+
+static int deadline_passed(const struct iovb *b) {
+    return b->opts.max_delay_us && b->count > 0 &&
+           now_ns() - b->first_ns >= (uint64_t)b->opts.max_delay_us * 1000;
+}
+
+int iovb_add(struct iovb *b, const void *buf, size_t len) {
+    if (len == 0)
+        return 0;
+    if (b->count == b->cap) {
+        /* 앞선 flush 가 실패해서 밀려 있는 경우에만 여기로 온다 */
+        struct iovec *p = realloc(b->iov, b->cap * 2 * sizeof(*p));
+        if (!p)
+            return -1;
+        b->iov = p;
+        b->cap *= 2;
+    }
+
+    if (b->count == 0 && b->opts.max_delay_us)
+        b->first_ns = now_ns();
+    b->iov[b->count].iov_base = (void *)buf;
+    b->iov[b->count].iov_len = len;
+    b->count++;
+    b->bytes += len;
+
+    if (b->count >= b->iov_max || b->bytes >= b->opts.max_bytes || deadline_passed(b))
+        return iovb_flush(b);
+    return 0;
+}
+
+int iovb_poll(struct iovb *b) {
+    return deadline_passed(b) ? iovb_flush(b) : 0;
+}
+
+size_t iovb_pending(const struct iovb *b) {
+    return b->bytes;
+}
+
+void iovb_get_stats(const struct iovb *b, struct iovb_stats *st) {
+    *st = b->stats;
+}
+
+int iovb_destroy(struct iovb *b) {
+    int ret = 0;
+
+    if (!b)
+        return 0;
+    if (iovb_flush(b) == -1)
+        ret = -1;
+    int saved = errno;
+    free(b->iov);
+    free(b);
+    errno = saved;
+    return ret;
+}
+
+/* ---------------------------------------------------------------- */
+
+struct iovr {
+    size_t nbufs;
+    size_t buf_size;
+    char *mem;
+    size_t *len;                     /* 칸마다 채워진 길이 */
+    struct iovec *iov;               /* readv 용 임시 배열 */
+    size_t head;                     /* 가장 오래된 채워진 칸 */
+    size_t filled;                   /* 채워진 칸 수 */
+};
+
+struct iovr *iovr_create(size_t nbufs, size_t buf_size) {
+    if (nbufs == 0 || buf_size == 0 || nbufs > IOV_MAX) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    struct iovr *r = calloc(1, sizeof(*r));
+    if (!r)
+        return NULL;
+    r->nbufs = nbufs;
+    r->buf_size = buf_size;
+    r->mem = malloc(nbufs * buf_size);
+    r->len = calloc(nbufs, sizeof(*r->len));
+    r->iov = malloc(nbufs * sizeof(*r->iov));
+    if (!r->mem || !r->len || !r->iov) {
+        iovr_destroy(r);
+        errno = ENOMEM;
+        return NULL;
+    }
+    return r;
+}
+
+ssize_t iovr_fill(struct iovr *r, int fd) {
+    size_t nfree = r->nbufs - r->filled;
+    size_t first = (r->head + r->filled) % r->nbufs;
+    ssize_t n;
+
+    if (nfree == 0)
+        return 0;
+
+    /* ring 순서대로 빈 칸을 나열 (끝에서 앞으로 감기는 것 포함) */
+    for (size_t i = 0; i < nfree; i++) {
+        size_t slot = (first + i) % r->nbufs;
+        r->iov[i].iov_base = r->mem + slot * r->buf_size;
+        r->iov[i].iov_len = r->buf_size;
+    }
+
+    do {
+        n = readv(fd, r->iov, (int)nfree);
+    } while (n == -1 && errno == EINTR);
+    if (n <= 0)
+        return n;
+
+    /* 앞 칸부터 꽉 채워지고 마지막 칸만 일부일 수 있다 */
+    size_t left = (size_t)n;
+    for (size_t i = 0; i < nfree && left > 0; i++) {
+        size_t slot = (first + i) % r->nbufs;
+        r->len[slot] = left < r->buf_size ? left : r->buf_size;
+        left -= r->len[slot];
+        r->filled++;
+    }
+    return n;
+}
+
+int iovr_peek(const struct iovr *r, struct iovec *out) {
+    if (r->filled == 0)
+        return 0;
+    out->iov_base = r->mem + r->head * r->buf_size;
+    out->iov_len = r->len[r->head];
+    return 1;
+}
+
+void iovr_consume(struct iovr *r) {
+    if (r->filled == 0)
+        return;
+    r->len[r->head] = 0;
+    r->head = (r->head + 1) % r->nbufs;
+    r->filled--;
+}
+
+void iovr_destroy(struct iovr *r) {
+    if (!r)
+        return;
+    free(r->mem);
+    free(r->len);
+    free(r->iov);
+    free(r);
+}
@@ -0,0 +1,94 @@
+/*
+ * Vectored Write Coalescer / Scatter-Read Ring
+ *
+ * iovec_demo.c 는 iovec 3개를 직접 채워서 writev 한 번을 부르고,
+ * 일부만 써지는 경우(short write)는 처리하지 않는다.
+ *
+ * iovb (gather write):
+ *   작은 조각들을 복사 없이 iovec 으로 모아두었다가
+ *     - IOV_MAX 개가 찼을 때
+ *     - 모인 바이트가 max_bytes 이상일 때
+ *     - 첫 조각을 넣은 지 max_delay_us 가 지났을 때
+ *   writev / pwritev2 한 번(+ short write 재시도)으로 내보낸다.
+ *   IOVB_DSYNC, IOVB_APPEND 는 pwritev2 의 RWF_DSYNC, RWF_APPEND.
+ *
+ *   넣은 버퍼는 복사하지 않으므로 다음 flush 가 끝날 때까지 살아 있어야 한다.
+ *   flush 는 동기식이라, iovb_add()/iovb_flush() 가 flush 를 했다면
+ *   그 전에 넣은 버퍼는 모두 재사용해도 된다 (iovb_pending() == 0).
+ *
+ * iovr (scatter read):
+ *   고정 크기 버퍼 ring 의 빈 칸들을 readv 한 번으로 채우고,
+ *   채워진 버퍼를 순서대로 꺼내 쓴다.
+ *
+ * Build: gcc -O2 -c iovec_batch.c
+ */
+
+#ifndef IOVEC_BATCH_H
+#define IOVEC_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#define IOVB_DSYNC  0x1              /* RWF_DSYNC: 이번 쓰기만 O_DSYNC 처럼 */
+#define IOVB_APPEND 0x2              /* RWF_APPEND: 이번 쓰기만 O_APPEND 처럼 */
+
+struct iovb_options {
+    size_t max_bytes;                /* 0 이면 256KB */
+    uint32_t max_delay_us;           /* 0 이면 deadline 없음 */
+    int flags;                       /* IOVB_DSYNC | IOVB_APPEND */
+    off_t offset;                    /* -1 이면 fd 의 현재 위치에 씀 */
+};
+
+struct iovb_stats {
+    uint64_t flushes;
+    uint64_t syscalls;               /* short write 재시도 포함 */
+    uint64_t bytes;
+};
+
+struct iovb;
+
+/* opts 가 NULL 이면 기본값 + 현재 위치에 씀 */
+struct iovb *iovb_create(int fd, const struct iovb_options *opts);
+
+/*
+ * 조각 추가 (복사 없음). 조건이 맞으면 이 안에서 flush.
+ * -1 은 flush 실패이며 조각은 이미 들어가 있다 (ENOMEM 인 경우만 제외).
+ * non-blocking fd 에서 EAGAIN 이면 쓰기 가능해진 뒤 iovb_flush 를 다시 부른다.
+ */
+int iovb_add(struct iovb *b, const void *buf, size_t len);
+
+/* deadline 이 지났으면 flush. 이벤트 루프에서 주기적으로 호출 */
+int iovb_poll(struct iovb *b);
+
+/* 모인 조각을 모두 쓴다. 쓰기가 실패하면 남은 부분은 그대로 pending 에 남는다.
+ * -1 인데 iovb_pending() == 0 이면 다 썼지만 (흉내낸 DSYNC 의) fdatasync 가
+ * 실패한 것이다. 다시 부르면 sync 만 다시 한다 */
+int iovb_flush(struct iovb *b);
+
+size_t iovb_pending(const struct iovb *b);
+
+void iovb_get_stats(const struct iovb *b, struct iovb_stats *st);
+
+/* 남은 조각을 flush 하고 해제. fd 는 닫지 않는다 */
+int iovb_destroy(struct iovb *b);
+
+/* ---------------------------------------------------------------- */
+
+struct iovr;
+
+struct iovr *iovr_create(size_t nbufs, size_t buf_size);
+
+/* 빈 칸을 readv 한 번으로 채운다. 읽은 바이트, 0(EOF 또는 빈 칸 없음), -1 */
+ssize_t iovr_fill(struct iovr *r, int fd);
+
+/* 가장 오래된 채워진 버퍼. 1: 있음, 0: 없음 */
+int iovr_peek(const struct iovr *r, struct iovec *out);
+
+/* peek 한 버퍼를 돌려준다 */
+void iovr_consume(struct iovr *r);
+
+void iovr_destroy(struct iovr *r);
+
+#endif
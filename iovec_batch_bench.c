@@ -0,0 +1,364 @@
+/*
+ * Vectored Write Coalescer Benchmark
+ *
+ * 응답 serializer 처럼 작은 조각(상태줄, 헤더 key/": "/value/"\r\n", body)을
+ * 잔뜩 만들어 놓고 파일로 내보내는 방법을 비교한다.
+ *
+ *   write_each  - 조각마다 write()
+ *   copy_write  - 256KB 버퍼에 memcpy 했다가 write()
+ *   iovb        - iovb_add 로 복사 없이 모아서 writev
+ *   iovb_socket - 작은 SO_SNDBUF 의 non-blocking socketpair 로 iovb
+ *                 (short write / EAGAIN 후 이어쓰기 확인)
+ *   iovr_read   - 결과 파일을 iovr ring 으로 다시 읽어 검증
+ *
+ * Output (CSV): method,fragments,bytes,seconds,mbps,syscalls
+ *
+ * Build: gcc -O2 -pthread -o iovec_batch_bench iovec_batch_bench.c iovec_batch.c
+ * Usage: ./iovec_batch_bench [-n responses] [-f path] [-d]
+ *   -d: iovb 를 IOVB_DSYNC 로 한 번 더 측정
+ */
+
+#define _GNU_SOURCE
+#include "iovec_batch.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#define COPY_BUF (256 * 1024)
+#define NUM_HEADERS 6
+
+struct frag {
+    const char *ptr;
+    size_t len;
+};
+
+static struct frag *frags;
+static size_t nfrags;
+static uint64_t total_bytes;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *method, double secs, uint64_t syscalls) {
+    printf("%s,%zu,%llu,%.4f,%.1f,%llu\n", method, nfrags,
+           (unsigned long long)total_bytes, secs,
+           secs > 0 ? total_bytes / secs / 1e6 : 0.0, (unsigned long long)syscalls);
+    fflush(stdout);
+}
+
+static void push(const char *p, size_t len) {
+    frags[nfrags].ptr = p;
+    frags[nfrags].len = len;
+    nfrags++;
+    total_bytes += len;
+}
+
+/* 응답 n 개를 조각으로 만든다. 숫자 문자열은 arena 에 둔다 */
+static char *build_responses(size_t n) {
+    static const char *keys[NUM_HEADERS] = {
+        "Content-Type", "Content-Length", "Cache-Control",
+        "X-Request-Id", "Server", "Connection"
+    };
+    static const char *values[NUM_HEADERS] = {
+        "text/plain", NULL, "no-cache", NULL, "demo", "keep-alive"
+    };
+    static const char body[] = "Ahoy! Here be the treasure you asked for.\n";
+
+    char *arena = malloc(n * 64);
+    frags = malloc(n * (2 + NUM_HEADERS * 4 + 1) * sizeof(*frags));
+    if (!arena || !frags)
+        return NULL;
+
+    for (size_t i = 0; i < n; i++) {
+        char *num = arena + i * 64;
+        int len = snprintf(num, 32, "%zu", sizeof(body) - 1);
+        int id = snprintf(num + 32, 32, "%zu", i);
+
+        push("HTTP/1.1 200 OK\r\n", 17);
+        for (int h = 0; h < NUM_HEADERS; h++) {
+            push(keys[h], strlen(keys[h]));
+            push(": ", 2);
+            if (h == 1)
+                push(num, len);
+            else if (h == 3)
+                push(num + 32, id);
+            else
+                push(values[h], strlen(values[h]));
+            push("\r\n", 2);
+        }
+        push("\r\n", 2);
+        push(body, sizeof(body) - 1);
+    }
+    return arena;
+}
+
+static int open_out(const char *path) {
+    return open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+}
+
+static int run_write_each(const char *path) {
+    int fd = open_out(path);
+    if (fd < 0)
+        return -1;
+    double t0 = now_sec();
+    for (size_t i = 0; i < nfrags; i++) {
+        if (write(fd, frags[i].ptr, frags[i].len) != (ssize_t)frags[i].len) {
+            close(fd);
+            return -1;
+        }
+    }
+    report("write_each", now_sec() - t0, nfrags);
+    return close(fd);
+}
+
+static int run_copy_write(const char *path) {
+    char *buf = malloc(COPY_BUF);
+    size_t used = 0;
+    uint64_t calls = 0;
+    int fd = open_out(path);
+    if (fd < 0 || !buf) {
+        free(buf);
+        return -1;
+    }
+
+    double t0 = now_sec();
+    for (size_t i = 0; i <= nfrags; i++) {
+        if (i == nfrags || used + frags[i].len > COPY_BUF) {
+            if (write(fd, buf, used) != (ssize_t)used) {
+                free(buf);
+                close(fd);
+                return -1;
+            }
+            calls++;
+            used = 0;
+            if (i == nfrags)
+                break;
+        }
+        memcpy(buf + used, frags[i].ptr, frags[i].len);
+        used += frags[i].len;
+    }
+    report("copy_write", now_sec() - t0, calls);
+    free(buf);
+    return close(fd);
+}
+
+/* non-blocking fd 에서 EAGAIN 이면 쓸 수 있을 때까지 기다렸다가 남은 것을 flush */
+static int retry_flush(struct iovb *b, int fd) {
+    struct pollfd p = { .fd = fd, .events = POLLOUT };
+
+    while (errno == EAGAIN || errno == EWOULDBLOCK) {
+        if (poll(&p, 1, -1) == -1 && errno != EINTR)
+            return -1;
+        if (iovb_flush(b) == 0)
+            return 0;
+    }
+    return -1;
+}
+
+static int gather(const char *method, int fd, int flags) {
+    struct iovb_options o = { .flags = flags, .offset = -1 };
+    struct iovb_stats st;
+
+    struct iovb *b = iovb_create(fd, &o);
+    if (!b)
+        return -1;
+
+    double t0 = now_sec();
+    for (size_t i = 0; i <= nfrags; i++) {
+        int ret = i < nfrags ? iovb_add(b, frags[i].ptr, frags[i].len) : iovb_flush(b);
+        if (ret == -1 && retry_flush(b, fd) == -1) {
+            iovb_destroy(b);
+            return -1;
+        }
+    }
+    iovb_get_stats(b, &st);
+    report(method, now_sec() - t0, st.syscalls);
+    return iovb_destroy(b);
+}
+
+static int run_iovb(const char *method, const char *path, int flags) {
+    int fd = open_out(path);
+    if (fd < 0)
+        return -1;
+    if (gather(method, fd, flags) == -1) {
+        close(fd);
+        return -1;
+    }
+    return close(fd);
+}
+
+struct drain_arg {
+    int fd;
+    char *out;
+    uint64_t got;
+};
+
+static void *drain_main(void *arg) {
+    struct drain_arg *d = arg;
+    ssize_t n;
+    /* 조금씩 읽어서 writer 쪽 버퍼가 자주 차도록 한다 */
+    while ((n = read(d->fd, d->out + d->got, 4096)) > 0)
+        d->got += n;
+    return NULL;
+}
+
+static int run_socket(const char *expect) {
+    int sv[2];
+    int sndbuf = 4096;
+    pthread_t tid;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+        return -1;
+    setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    fcntl(sv[0], F_SETFL, fcntl(sv[0], F_GETFL) | O_NONBLOCK);
+
+    struct drain_arg d = { .fd = sv[1], .out = malloc(total_bytes + 1) };
+    if (!d.out || pthread_create(&tid, NULL, drain_main, &d) != 0) {
+        free(d.out);
+        close(sv[0]);
+        close(sv[1]);
+        return -1;
+    }
+
+    int ret = gather("iovb_socket", sv[0], 0);
+    close(sv[0]);
+    pthread_join(tid, NULL);
+    close(sv[1]);
+
+    if (ret == 0 && (d.got != total_bytes || memcmp(d.out, expect, total_bytes) != 0)) {
+        fprintf(stderr, "iovb_socket: received data differs\n");
+        ret = -1;
+    }
+    free(d.out);
+    return ret;
+}
+
+/* 파일을 iovr 로 읽어 expect 와 비교 */
+static int run_iovr(const char *path, const char *expect) {
+    uint64_t off = 0, calls = 0;
+    struct iovec v;
+    ssize_t n;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    struct iovr *r = iovr_create(16, 4096);
+    if (!r) {
+        close(fd);
+        return -1;
+    }
+
+    double t0 = now_sec();
+    while ((n = iovr_fill(r, fd)) > 0) {
+        calls++;
+        while (iovr_peek(r, &v)) {
+            if (off + v.iov_len > total_bytes ||
+                memcmp(expect + off, v.iov_base, v.iov_len) != 0) {
+                fprintf(stderr, "iovr_read: mismatch at %llu\n", (unsigned long long)off);
+                n = -1;
+                break;
+            }
+            off += v.iov_len;
+            iovr_consume(r);
+        }
+        if (n == -1)
+            break;
+    }
+    report("iovr_read", now_sec() - t0, calls + 1);
+    iovr_destroy(r);
+    close(fd);
+    return n == -1 || off != total_bytes ? -1 : 0;
+}
+
+static char *load(const char *path) {
+    char *buf = malloc(total_bytes + 1);
+    uint64_t got = 0;
+    ssize_t n;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0 || !buf) {
+        free(buf);
+        if (fd >= 0)
+            close(fd);
+        return NULL;
+    }
+    while (got <= total_bytes && (n = read(fd, buf + got, total_bytes + 1 - got)) > 0)
+        got += n;
+    close(fd);
+    if (got != total_bytes) {
+        free(buf);
+        return NULL;
+    }
+    return buf;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = "iovb_out.txt";
+    size_t n = 100000;
+    int dsync = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:f:d")) != -1) {
+        switch (opt) {
+        case 'n': n = strtoull(optarg, NULL, 10); break;
+        case 'f': path = optarg; break;
+        case 'd': dsync = 1; break;
+        default:
+            fprintf(stderr, "Usage: %s [-n responses] [-f path] [-d]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    char *arena = build_responses(n);
+    if (!arena) {
+        perror("build_responses");
+        return 1;
+    }
+
+    printf("method,fragments,bytes,seconds,mbps,syscalls\n");
+    if (run_copy_write(path) == -1) {
+        perror("copy_write");
+        return 1;
+    }
+    char *expect = load(path);
+    if (!expect) {
+        fprintf(stderr, "copy_write: short output\n");
+        return 1;
+    }
+
+    if (run_write_each(path) == -1) {
+        perror("write_each");
+        return 1;
+    }
+    if (run_iovb("iovb", path, 0) == -1) {
+        perror("iovb");
+        return 1;
+    }
+    if (run_iovr(path, expect) == -1)
+        return 1;
+    if (dsync && run_iovb("iovb_dsync", path, IOVB_DSYNC) == -1) {
+        perror("iovb_dsync");
+        return 1;
+    }
+    if (run_socket(expect) == -1) {
+        perror("iovb_socket");
+        return 1;
+    }
+
+    unlink(path);
+    free(expect);
+    free(arena);
+    free(frags);
+    return 0;
+}
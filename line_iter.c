@@ -0,0 +1,277 @@
+/*
+ * SIMD Line Iterator - 구현
+ *
+ * find_delim(p, end, c): [p, end) 에서 c 의 첫 위치, 없으면 end.
+ *   scalar: 한 바이트씩
+ *   sse2  : _mm_cmpeq_epi8 + movemask 로 16바이트씩
+ *   avx2  : _mm256_cmpeq_epi8 + movemask 로 32바이트씩
+ * AVX2 함수는 target attribute 로만 컴파일하므로 -mavx2 없이도 빌드된다.
+ */
+
+#define _GNU_SOURCE
+#include "line_iter.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
+typedef const char *(*find_fn)(const char *p, const char *end, int c);
+
+static const char *find_scalar(const char *p, const char *end, int c) {
+    while (p < end && *p != (char)c)
+        p++;
+    return p;
+}
+
+#ifdef HAVE_X86_SIMD
+__attribute__((target("sse2")))
+static const char *find_sse2(const char *p, const char *end, int c) {
+    const __m128i needle = _mm_set1_epi8((char)c);
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return find_scalar(p, end, c);
+}
+
+__attribute__((target("avx2")))
+static const char *find_avx2(const char *p, const char *end, int c) {
+    const __m256i needle = _mm256_set1_epi8((char)c);
+    while (end - p >= 64) {
+        /* 64바이트씩 두 번 비교해서 분기를 줄인다 */
+        __m256i a = _mm256_loadu_si256((const __m256i *)p);
+        __m256i b = _mm256_loadu_si256((const __m256i *)(p + 32));
+        unsigned int ma = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, needle));
+        unsigned int mb = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, needle));
+        if (ma | mb) {
+            if (ma)
+                return p + __builtin_ctz(ma);
+            return p + 32 + __builtin_ctz(mb);
+        }
+        p += 64;
+    }
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle));
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return find_sse2(p, end, c);
+}
+#endif
+
+static find_fn find_delim;
+static const char *kernel_name;
+
+int line_iter_set_kernel(const char *name) {
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (!name || strcmp(name, "avx2") == 0) {
+        if (__builtin_cpu_supports("avx2")) {
+            find_delim = find_avx2;
+            kernel_name = "avx2";
+            return 0;
+        }
+        if (name)
+            return -1;
+    }
+    if (!name || strcmp(name, "sse2") == 0) {
+        if (__builtin_cpu_supports("sse2")) {
+            find_delim = find_sse2;
+            kernel_name = "sse2";
+            return 0;
+        }
+        if (name)
+            return -1;
+    }
+#endif
+    if (!name || strcmp(name, "scalar") == 0) {
+        find_delim = find_scalar;
+        kernel_name = "scalar";
+        return 0;
+    }
+    return -1;
+}
+
+const char *line_iter_kernel_name(void) {
+    if (!find_delim)
+        line_iter_set_kernel(NULL);
+    return kernel_name;
+}
+
+/* ---------------------------------------------------------------- */
+
+struct line_iter {
+    int fd;
+    int own_fd;
+    int delim;
+    int eof;
+
+    char *buf;                   /* read 모드: 내부 버퍼, mmap 모드: 매핑 */
+    size_t cap;
+    size_t start;                /* 아직 돌려주지 않은 데이터 시작 */
+    size_t end;                  /* 유효 데이터 끝 */
+    size_t scanned;              /* start 이후 구분자가 없다고 확인된 위치 */
+
+    int mapped;
+    size_t map_len;
+};
+
+static struct line_iter *iter_alloc(int delim) {
+    if (!find_delim)
+        line_iter_set_kernel(NULL);
+
+    struct line_iter *it = calloc(1, sizeof(*it));
+    if (!it)
+        return NULL;
+    it->fd = -1;
+    it->delim = delim;
+    return it;
+}
+
+struct line_iter *line_iter_from_fd(int fd, int delim) {
+    struct line_iter *it = iter_alloc(delim);
+    if (!it)
+        return NULL;
+
+    it->fd = fd;
+    it->cap = LINE_ITER_BLOCK;
+    it->buf = malloc(it->cap);
+    if (!it->buf) {
+        free(it);
+        return NULL;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    return it;
+}
+
+struct line_iter *line_iter_open(const char *path, int delim, int flags) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    if (!(flags & LINE_ITER_MMAP)) {
+        struct line_iter *it = line_iter_from_fd(fd, delim);
+        if (!it) {
+            close(fd);
+            return NULL;
+        }
+        it->own_fd = 1;
+        return it;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return NULL;
+    }
+
+    struct line_iter *it = iter_alloc(delim);
+    if (!it) {
+        close(fd);
+        return NULL;
+    }
+
+    if (st.st_size > 0) {
+        void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            int saved = errno;
+            close(fd);
+            free(it);
+            errno = saved;
+            return NULL;
+        }
+        madvise(p, st.st_size, MADV_SEQUENTIAL);
+        it->buf = p;
+        it->map_len = st.st_size;
+        it->mapped = 1;
+    }
+    close(fd);
+
+    it->end = st.st_size;
+    it->eof = 1;
+    return it;
+}
+
+/* 남은 데이터를 앞으로 옮기고 (필요하면 버퍼를 키워서) 더 읽는다 */
+static int fill(struct line_iter *it) {
+    if (it->start > 0) {
+        memmove(it->buf, it->buf + it->start, it->end - it->start);
+        it->end -= it->start;
+        it->scanned -= it->start;
+        it->start = 0;
+    }
+    if (it->end == it->cap) {
+        /* 한 줄이 버퍼보다 길다 */
+        char *nb = realloc(it->buf, it->cap * 2);
+        if (!nb)
+            return -1;
+        it->buf = nb;
+        it->cap *= 2;
+    }
+
+    for (;;) {
+        ssize_t n = read(it->fd, it->buf + it->end, it->cap - it->end);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (n == 0)
+            it->eof = 1;
+        it->end += n;
+        return 0;
+    }
+}
+
+int line_iter_next(struct line_iter *it, struct line_view *out) {
+    for (;;) {
+        const char *base = it->buf;
+        const char *hit = find_delim(base + it->scanned, base + it->end, it->delim);
+
+        if (hit < base + it->end) {
+            out->ptr = base + it->start;
+            out->len = hit - out->ptr;
+            it->start = it->scanned = (hit - base) + 1;
+            return 1;
+        }
+        it->scanned = it->end;
+
+        if (it->eof) {
+            /* 구분자 없이 끝나는 마지막 줄 */
+            if (it->start < it->end) {
+                out->ptr = base + it->start;
+                out->len = it->end - it->start;
+                it->start = it->scanned = it->end;
+                return 1;
+            }
+            return 0;
+        }
+
+        if (fill(it) == -1)
+            return -1;
+    }
+}
+
+void line_iter_close(struct line_iter *it) {
+    if (it->mapped)
+        munmap(it->buf, it->map_len);
+    else
+        free(it->buf);
+    if (it->own_fd)
+        close(it->fd);
+    free(it);
+}
@@ -0,0 +1,59 @@
+/*
+ * SIMD Line Iterator
+ *
+ * eof_example.c 는 fgetc()/putchar() 로 한 바이트씩 처리한다.
+ * 바이트마다 함수 호출 1번 + stdio lock 1번이 든다.
+ *
+ * 이 iterator 는 큰 블록을 read() 하거나 파일 전체를 mmap() 한 뒤,
+ * 구분자를 SSE2/AVX2 로 16/32 바이트씩 찾아서 줄 단위 view 를 돌려준다.
+ * view 는 내부 버퍼를 가리키므로 복사가 없다.
+ *
+ *   - CPU dispatch: 처음 사용할 때 AVX2 > SSE2 > scalar 중 선택
+ *   - read 모드: view 는 다음 line_iter_next() 호출 전까지 유효
+ *   - mmap 모드: view 는 line_iter_close() 전까지 유효
+ *
+ * 사용 예:
+ *   struct line_iter *it = line_iter_open("data", '\n', 0);
+ *   struct line_view v;
+ *   while (line_iter_next(it, &v) > 0)
+ *       fwrite(v.ptr, 1, v.len, stdout);
+ *   line_iter_close(it);
+ *
+ * Build: gcc -O2 -c line_iter.c
+ */
+
+#ifndef LINE_ITER_H
+#define LINE_ITER_H
+
+#include <stddef.h>
+
+#define LINE_ITER_MMAP 0x1           /* read() 대신 파일 전체를 mmap */
+
+#define LINE_ITER_BLOCK (1024 * 1024)  /* read 모드 기본 블록 크기 */
+
+struct line_view {
+    const char *ptr;
+    size_t len;                      /* 구분자 미포함 */
+};
+
+struct line_iter;
+
+/* 실패 시 NULL, errno 설정 */
+struct line_iter *line_iter_open(const char *path, int delim, int flags);
+
+/* fd 로부터 (read 모드만). fd 는 호출자가 닫는다 */
+struct line_iter *line_iter_from_fd(int fd, int delim);
+
+/* 1: 줄 하나, 0: EOF, -1: 에러 */
+int line_iter_next(struct line_iter *it, struct line_view *out);
+
+void line_iter_close(struct line_iter *it);
+
+/*
+ * 구분자 검색 kernel 선택.
+ * name: "avx2", "sse2", "scalar", NULL(자동). 지원하지 않으면 -1.
+ */
+int line_iter_set_kernel(const char *name);
+const char *line_iter_kernel_name(void);
+
+#endif
@@ -0,0 +1,370 @@
+/*
+ * Mapped-File Cache
+ *
+ * Build: gcc -O2 -pthread -c map_cache.c
+ */
+
+#define _GNU_SOURCE
+#include "map_cache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define NBUCKETS 256
+#define EVICT_IDLE_SCANS 2       /* 내릴 것이 없는 shard 를 이만큼 보면 그만 */
+
+struct entry {
+    struct mcache_map map;       /* 첫 멤버: mcache_put 에서 entry 로 되돌림 */
+    struct entry *next;
+    char *key;
+    uint64_t hash;
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    int refs;                    /* 표에 있으면 1 + 사용 중인 수 */
+    int in_table;                /* shard lock 으로 보호 */
+    uint64_t last_used;          /* ms, atomic */
+    uint64_t checked;            /* 마지막 재검증 시각 ms, atomic */
+};
+
+struct shard {
+    pthread_rwlock_t lock;
+    struct entry *buckets[NBUCKETS];
+};
+
+struct mcache {
+    struct shard *shards;
+    unsigned int nshards;
+    uint64_t max_bytes;
+    int revalidate_ms;
+    unsigned int evict_cursor;
+    struct mcache_stats st;      /* 모두 atomic 으로 갱신 */
+};
+
+#define INC(p, v) __atomic_add_fetch((p), (v), __ATOMIC_RELAXED)
+#define DEC(p, v) __atomic_sub_fetch((p), (v), __ATOMIC_RELAXED)
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static uint64_t hash_key(const char *s) {
+    uint64_t h = 1469598103934665603ull;      /* FNV-1a */
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static struct shard *shard_of(struct mcache *c, uint64_t h) {
+    return &c->shards[(h >> 32) & (c->nshards - 1)];
+}
+
+static struct entry **bucket_of(struct shard *s, uint64_t h) {
+    return &s->buckets[h % NBUCKETS];
+}
+
+static int same_file(const struct entry *e, const struct stat *st) {
+    return e->dev == st->st_dev && e->ino == st->st_ino && e->size == st->st_size &&
+           e->mtime.tv_sec == st->st_mtim.tv_sec && e->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+static void entry_put(struct mcache *c, struct entry *e) {
+    if (__atomic_sub_fetch(&e->refs, 1, __ATOMIC_ACQ_REL) != 0)
+        return;
+    if (e->map.data)
+        munmap((void *)e->map.data, e->map.size);
+    DEC(&c->st.mapped_bytes, e->map.size);
+    free(e->key);
+    free(e);
+}
+
+/* lock 을 잡은 상태에서 */
+static struct entry *find(struct shard *s, const char *key, uint64_t h) {
+    for (struct entry *e = *bucket_of(s, h); e; e = e->next)
+        if (e->hash == h && strcmp(e->key, key) == 0)
+            return e;
+    return NULL;
+}
+
+/* lock 을 잡은 상태에서 표에서 뺀다. 표의 참조는 호출자가 lock 밖에서 놓는다 */
+static void unlink_locked(struct mcache *c, struct shard *s, struct entry *e) {
+    struct entry **pp = bucket_of(s, e->hash);
+    while (*pp != e)
+        pp = &(*pp)->next;
+    *pp = e->next;
+    e->in_table = 0;
+    DEC(&c->st.entries, 1);
+}
+
+static void remove_entry(struct mcache *c, struct shard *s, struct entry *e) {
+    int removed = 0;
+    pthread_rwlock_wrlock(&s->lock);
+    if (e->in_table) {
+        unlink_locked(c, s, e);
+        removed = 1;
+    }
+    pthread_rwlock_unlock(&s->lock);
+    if (removed)
+        entry_put(c, e);
+}
+
+static struct entry *new_entry(struct mcache *c, const char *key, uint64_t h, int fd,
+                               const struct stat *st) {
+    struct entry *e = calloc(1, sizeof(*e));
+    if (!e)
+        return NULL;
+    e->key = strdup(key);
+    if (!e->key) {
+        free(e);
+        return NULL;
+    }
+    if (st->st_size > 0) {
+        void *p = mmap(NULL, st->st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            int saved = errno;
+            free(e->key);
+            free(e);
+            errno = saved;
+            return NULL;
+        }
+        e->map.data = p;
+        e->map.size = st->st_size;
+    }
+    e->hash = h;
+    e->dev = st->st_dev;
+    e->ino = st->st_ino;
+    e->size = st->st_size;
+    e->mtime = st->st_mtim;
+    e->refs = 2;                 /* 표 + 호출자 */
+    e->last_used = e->checked = now_ms();
+    INC(&c->st.mapped_bytes, e->map.size);
+    return e;
+}
+
+/*
+ * 한도를 넘으면 아무도 쓰지 않는 (refs == 1) 매핑 중 last_used 가 가장 오래된
+ * 것을 shard 하나씩 돌아가며 내린다. 내릴 것이 없는 shard 를 EVICT_IDLE_SCANS 개
+ * 연달아 보면 그만 (모두 사용 중일 때 miss 마다 모든 shard 를 wrlock 으로 훑지 않게).
+ * cursor 가 계속 돌므로 다음 miss 는 다른 shard 부터 본다.
+ */
+static void evict(struct mcache *c) {
+    unsigned int idle = 0;
+    unsigned int max_idle = c->nshards < EVICT_IDLE_SCANS ? c->nshards : EVICT_IDLE_SCANS;
+
+    while (__atomic_load_n(&c->st.mapped_bytes, __ATOMIC_RELAXED) > c->max_bytes &&
+           idle < max_idle) {
+        unsigned int i = __atomic_fetch_add(&c->evict_cursor, 1, __ATOMIC_RELAXED);
+        struct shard *s = &c->shards[i & (c->nshards - 1)];
+        struct entry *victim = NULL;
+
+        pthread_rwlock_wrlock(&s->lock);
+        for (int b = 0; b < NBUCKETS; b++) {
+            for (struct entry *e = s->buckets[b]; e; e = e->next) {
+                if (__atomic_load_n(&e->refs, __ATOMIC_ACQUIRE) != 1)
+                    continue;
+                if (!victim || e->last_used < victim->last_used)
+                    victim = e;
+            }
+        }
+        if (victim)
+            unlink_locked(c, s, victim);
+        pthread_rwlock_unlock(&s->lock);
+
+        if (victim) {
+            INC(&c->st.evictions, 1);
+            entry_put(c, victim);
+            idle = 0;
+        } else {
+            idle++;
+        }
+    }
+}
+
+/*
+ * path 가 있으면 경로로, 없으면 fd + st (이미 fstat 한 결과) 로 찾는다.
+ */
+static const struct mcache_map *lookup(struct mcache *c, const char *key, const char *path,
+                                       int fd, const struct stat *known) {
+    uint64_t h = hash_key(key);
+    struct shard *s = shard_of(c, h);
+    uint64_t now = now_ms();
+    struct stat st;
+
+    pthread_rwlock_rdlock(&s->lock);
+    struct entry *e = find(s, key, h);
+    if (e) {
+        INC(&e->refs, 1);
+        __atomic_store_n(&e->last_used, now, __ATOMIC_RELAXED);
+    }
+    pthread_rwlock_unlock(&s->lock);
+
+    if (e) {
+        int fresh = 1;
+        if (known) {
+            fresh = same_file(e, known);
+        } else if (c->revalidate_ms >= 0 &&
+                   now - __atomic_load_n(&e->checked, __ATOMIC_RELAXED) >=
+                       (uint64_t)c->revalidate_ms) {
+            fresh = stat(path, &st) == 0 && same_file(e, &st);
+            if (fresh)
+                __atomic_store_n(&e->checked, now, __ATOMIC_RELAXED);
+        }
+        if (fresh) {
+            INC(&c->st.hits, 1);
+            return &e->map;
+        }
+        /* 바뀐 파일: 표에서 빼고 새로 매핑 (쓰던 쪽은 옛 매핑을 계속 쓴다) */
+        INC(&c->st.stale, 1);
+        remove_entry(c, s, e);
+        entry_put(c, e);
+    }
+
+    INC(&c->st.misses, 1);
+    int own_fd = -1;
+    if (path) {
+        own_fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (own_fd < 0)
+            return NULL;
+        if (fstat(own_fd, &st) == -1) {
+            int saved = errno;
+            close(own_fd);
+            errno = saved;
+            return NULL;
+        }
+        fd = own_fd;
+        known = &st;
+    }
+    struct entry *n = new_entry(c, key, h, fd, known);
+    if (own_fd >= 0) {
+        int saved = errno;
+        close(own_fd);            /* 매핑은 fd 를 닫아도 유지된다 */
+        errno = saved;
+    }
+    if (!n)
+        return NULL;
+
+    /* 매핑하는 동안 다른 스레드가 같은 파일을 넣었으면 그것을 쓴다 */
+    struct entry *old, *drop = NULL;
+    pthread_rwlock_wrlock(&s->lock);
+    old = find(s, key, h);
+    if (old && same_file(old, known)) {
+        INC(&old->refs, 1);
+        __atomic_store_n(&old->last_used, now, __ATOMIC_RELAXED);
+        pthread_rwlock_unlock(&s->lock);
+        n->refs = 1;
+        entry_put(c, n);
+        return &old->map;
+    }
+    if (old) {
+        unlink_locked(c, s, old);
+        drop = old;
+    }
+    struct entry **b = bucket_of(s, h);
+    n->next = *b;
+    *b = n;
+    n->in_table = 1;
+    INC(&c->st.entries, 1);
+    pthread_rwlock_unlock(&s->lock);
+
+    if (drop)
+        entry_put(c, drop);
+    evict(c);
+    return &n->map;
+}
+
+struct mcache *mcache_create(const struct mcache_params *params) {
+    struct mcache *c = calloc(1, sizeof(*c));
+    if (!c)
+        return NULL;
+
+    unsigned int want = params && params->shards ? params->shards : 16;
+    c->nshards = 1;
+    while (c->nshards < want)
+        c->nshards <<= 1;
+    c->max_bytes = params && params->max_bytes ? params->max_bytes : MCACHE_DEFAULT_MAX_BYTES;
+    c->revalidate_ms = params ? params->revalidate_ms : MCACHE_DEFAULT_REVALIDATE_MS;
+
+    c->shards = calloc(c->nshards, sizeof(*c->shards));
+    if (!c->shards) {
+        free(c);
+        return NULL;
+    }
+    for (unsigned int i = 0; i < c->nshards; i++)
+        pthread_rwlock_init(&c->shards[i].lock, NULL);
+    return c;
+}
+
+void mcache_destroy(struct mcache *c) {
+    if (!c)
+        return;
+    for (unsigned int i = 0; i < c->nshards; i++) {
+        struct shard *s = &c->shards[i];
+        for (int b = 0; b < NBUCKETS; b++) {
+            while (s->buckets[b]) {
+                struct entry *e = s->buckets[b];
+                s->buckets[b] = e->next;
+                e->in_table = 0;
+                entry_put(c, e);
+            }
+        }
+        pthread_rwlock_destroy(&s->lock);
+    }
+    free(c->shards);
+    free(c);
+}
+
+const struct mcache_map *mcache_get(struct mcache *c, const char *path) {
+    return lookup(c, path, path, -1, NULL);
+}
+
+const struct mcache_map *mcache_get_fd(struct mcache *c, int fd) {
+    struct stat st;
+    char key[64];
+
+    if (fstat(fd, &st) == -1)
+        return NULL;
+    /* 경로 키와 겹치지 않도록 '/' 나 '.' 로 시작하지 않는 형태 */
+    snprintf(key, sizeof(key), "#%llx:%llx", (unsigned long long)st.st_dev,
+             (unsigned long long)st.st_ino);
+    return lookup(c, key, NULL, fd, &st);
+}
+
+void mcache_put(struct mcache *c, const struct mcache_map *m) {
+    if (m)
+        entry_put(c, (struct entry *)m);
+}
+
+void mcache_invalidate(struct mcache *c, const char *path) {
+    uint64_t h = hash_key(path);
+    struct shard *s = shard_of(c, h);
+
+    pthread_rwlock_wrlock(&s->lock);
+    struct entry *e = find(s, path, h);
+    if (e)
+        unlink_locked(c, s, e);
+    pthread_rwlock_unlock(&s->lock);
+    if (e)
+        entry_put(c, e);
+}
+
+void mcache_get_stats(struct mcache *c, struct mcache_stats *st) {
+    st->hits = __atomic_load_n(&c->st.hits, __ATOMIC_RELAXED);
+    st->misses = __atomic_load_n(&c->st.misses, __ATOMIC_RELAXED);
+    st->stale = __atomic_load_n(&c->st.stale, __ATOMIC_RELAXED);
+    st->evictions = __atomic_load_n(&c->st.evictions, __ATOMIC_RELAXED);
+    st->mapped_bytes = __atomic_load_n(&c->st.mapped_bytes, __ATOMIC_RELAXED);
+    st->entries = __atomic_load_n(&c->st.entries, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,85 @@
+/*
+ * Mapped-File Cache
+ *
+ * mmap_zero_copy_reader 는 스레드마다 같은 파일을 open + fstat + mmap 하고
+ * 작은 read 한 번 뒤에 munmap 한다. munmap 은 그 매핑을 쓴 CPU 들에게
+ * TLB shootdown IPI 를 보내므로, 작은 요청이 많으면 이 비용이 대부분이 된다.
+ *
+ * mcache 는 프로세스 전체에서 파일 매핑을 공유한다.
+ *
+ *   - 키: 경로 (mcache_get) 또는 (dev, inode) (mcache_get_fd)
+ *   - 참조 카운트: mcache_get 이 준 매핑은 mcache_put 전까지 unmap 되지 않는다.
+ *                  캐시에서 밀려나거나 파일이 rename 으로 교체돼도 쓰던 쪽은
+ *                  옛 내용을 그대로 읽는다. 하지만 MAP_SHARED 라서 같은 파일을
+ *                  제자리에서 고치면 바뀐 내용이 보이고, 잘리면 새 EOF 를 넘는
+ *                  page 를 읽을 때 SIGBUS 가 난다. 파일은 새로 써서 rename 으로
+ *                  바꿔야 한다
+ *   - 크기 한도: 매핑된 바이트 합이 max_bytes 를 넘으면 아무도 쓰지 않는
+ *                매핑 중 가장 오래전에 쓴 것부터 내린다 (근사 LRU).
+ *                모두 사용 중이면 한도를 넘은 채로 두고, miss 마다 shard 몇 개만 본다
+ *   - 재검증: revalidate_ms 마다 stat 해서 inode/크기/mtime 이 바뀌었으면
+ *             새로 매핑한다 (0 이면 매번)
+ *   - 동시성: 전역 lock 없음. 키 hash 로 나눈 shard 마다 rwlock 이고,
+ *             hit 경로는 read lock + atomic 증가뿐이다
+ *
+ * 사용 예:
+ *   struct mcache *c = mcache_create(NULL);
+ *   const struct mcache_map *m = mcache_get(c, "zerocopy_test.txt");
+ *   memcpy(dst, (const char *)m->data + off, len);
+ *   mcache_put(c, m);
+ *
+ * Build: gcc -O2 -pthread -c map_cache.c
+ */
+
+#ifndef MAP_CACHE_H
+#define MAP_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MCACHE_DEFAULT_MAX_BYTES (1024ULL * 1024 * 1024)
+#define MCACHE_DEFAULT_REVALIDATE_MS 1000
+
+struct mcache_params {
+    uint64_t max_bytes;          /* 0 이면 MCACHE_DEFAULT_MAX_BYTES */
+    unsigned int shards;         /* 0 이면 16 (2의 거듭제곱으로 올림) */
+    int revalidate_ms;           /* 음수면 재검증 안 함, 0 이면 매번 */
+};
+
+struct mcache_stats {
+    uint64_t hits;
+    uint64_t misses;             /* 새로 매핑함 */
+    uint64_t stale;              /* 재검증에서 바뀐 것을 발견 */
+    uint64_t evictions;
+    uint64_t mapped_bytes;       /* 지금 매핑돼 있는 바이트 (밀려났지만 사용 중인 것 포함) */
+    uint64_t entries;
+};
+
+/* 읽기 전용 매핑. 빈 파일이면 data == NULL, size == 0 */
+struct mcache_map {
+    const void *data;
+    size_t size;
+};
+
+struct mcache;
+
+/* params 가 NULL 이면 기본값 */
+struct mcache *mcache_create(const struct mcache_params *params);
+
+/* 모든 매핑이 mcache_put 된 뒤에 부른다 */
+void mcache_destroy(struct mcache *c);
+
+/* 실패 시 NULL + errno (open/mmap 의 errno) */
+const struct mcache_map *mcache_get(struct mcache *c, const char *path);
+
+/* 이미 연 fd 로 찾는다 (키는 dev/inode, 재검증은 fstat(fd)) */
+const struct mcache_map *mcache_get_fd(struct mcache *c, int fd);
+
+void mcache_put(struct mcache *c, const struct mcache_map *m);
+
+/* 다음 get 이 새로 매핑하도록 캐시에서 뺀다 */
+void mcache_invalidate(struct mcache *c, const char *path);
+
+void mcache_get_stats(struct mcache *c, struct mcache_stats *st);
+
+#endif
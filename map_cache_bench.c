@@ -0,0 +1,274 @@
+/*
+ * Mapped-File Cache Benchmark
+ *
+ * 여러 스레드가 files 개 파일 중 임의의 파일, 임의의 위치에서 작은 read 를 한다.
+ *
+ *   mmap_each    - mmap_zero_copy_reader 처럼 요청마다 open+fstat+mmap+munmap+close
+ *   pread_each   - 요청마다 open+pread+close
+ *   mcache       - mcache_get/put (한도가 전체보다 큼: 처음 한 번만 매핑)
+ *   mcache_capped- 한도를 전체의 1/4 로 (eviction 이 계속 일어남)
+ *
+ * 마지막으로 파일을 바꾼 뒤 재검증으로 새 크기가 보이는지 확인한다.
+ *
+ * Output (CSV): mode,threads,files,ops,seconds,ops_per_sec,hit_rate,evictions
+ *
+ * Build: gcc -O2 -pthread -o map_cache_bench map_cache_bench.c map_cache.c
+ * Usage: ./map_cache_bench [-d dir] [-F files] [-s file_size] [-n ops_per_thread] [-t max_threads]
+ */
+
+#define _GNU_SOURCE
+#include "map_cache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define READ_SIZE 256
+
+enum { MODE_MMAP_EACH, MODE_PREAD_EACH, MODE_MCACHE, MODE_MCACHE_CAPPED, MODE_COUNT };
+
+static const char *mode_names[MODE_COUNT] = {
+    "mmap_each", "pread_each", "mcache", "mcache_capped"
+};
+
+struct bench {
+    int mode;
+    char (*paths)[256];
+    int files;
+    uint64_t size;
+    long ops;
+    struct mcache *cache;
+};
+
+struct worker_arg {
+    struct bench *b;
+    unsigned int seed;
+    uint64_t sum;
+    int failed;
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    }
+    return v;
+}
+
+static int one_read(struct bench *b, const char *path, off_t off, char *dst) {
+    switch (b->mode) {
+    case MODE_MMAP_EACH: {
+        struct stat st;
+        int fd = open(path, O_RDONLY);
+        if (fd < 0 || fstat(fd, &st) == -1)
+            return -1;
+        void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        memcpy(dst, (char *)p + off, READ_SIZE);
+        munmap(p, st.st_size);
+        return close(fd);
+    }
+    case MODE_PREAD_EACH: {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+            return -1;
+        ssize_t n = pread(fd, dst, READ_SIZE, off);
+        close(fd);
+        return n == READ_SIZE ? 0 : -1;
+    }
+    default: {
+        const struct mcache_map *m = mcache_get(b->cache, path);
+        if (!m || m->size < (size_t)off + READ_SIZE) {
+            mcache_put(b->cache, m);
+            return -1;
+        }
+        memcpy(dst, (const char *)m->data + off, READ_SIZE);
+        mcache_put(b->cache, m);
+        return 0;
+    }
+    }
+}
+
+static void *worker(void *arg) {
+    struct worker_arg *w = arg;
+    struct bench *b = w->b;
+    char buf[READ_SIZE];
+
+    for (long i = 0; i < b->ops; i++) {
+        int f = rand_r(&w->seed) % b->files;
+        off_t off = (off_t)(rand_r(&w->seed) % (b->size / READ_SIZE)) * READ_SIZE;
+        if (one_read(b, b->paths[f], off, buf) == -1) {
+            w->failed = 1;
+            break;
+        }
+        w->sum += (unsigned char)buf[0];
+    }
+    return NULL;
+}
+
+static int run(struct bench *b, int threads) {
+    pthread_t *tids = malloc(threads * sizeof(*tids));
+    struct worker_arg *args = calloc(threads, sizeof(*args));
+    int ret = 0;
+
+    if (!tids || !args) {
+        free(tids);
+        free(args);
+        return -1;
+    }
+    b->cache = NULL;
+    if (b->mode == MODE_MCACHE || b->mode == MODE_MCACHE_CAPPED) {
+        uint64_t total = b->size * b->files;
+        struct mcache_params p = {
+            .max_bytes = b->mode == MODE_MCACHE ? total * 2 : total / 4,
+            .revalidate_ms = MCACHE_DEFAULT_REVALIDATE_MS,
+        };
+        b->cache = mcache_create(&p);
+        if (!b->cache) {
+            free(tids);
+            free(args);
+            return -1;
+        }
+    }
+
+    double t0 = now_sec();
+    for (int i = 0; i < threads; i++) {
+        args[i].b = b;
+        args[i].seed = i + 1;
+        pthread_create(&tids[i], NULL, worker, &args[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+        if (args[i].failed)
+            ret = -1;
+    }
+    double secs = now_sec() - t0;
+
+    struct mcache_stats st = { 0 };
+    if (b->cache) {
+        mcache_get_stats(b->cache, &st);
+        mcache_destroy(b->cache);
+    }
+    if (ret == 0) {
+        long ops = b->ops * threads;
+        double hit = st.hits + st.misses ? (double)st.hits / (st.hits + st.misses) : 0;
+        printf("%s,%d,%d,%ld,%.4f,%.0f,%.3f,%llu\n", mode_names[b->mode], threads, b->files,
+               ops, secs, ops / secs, hit, (unsigned long long)st.evictions);
+        fflush(stdout);
+    }
+    free(tids);
+    free(args);
+    return ret;
+}
+
+/* 파일을 늘린 뒤 재검증이 새 매핑을 주는지, 쓰던 옛 매핑은 그대로인지 */
+static int check_revalidate(const char *path, uint64_t size) {
+    struct mcache_params p = { .revalidate_ms = 0 };
+    struct mcache *c = mcache_create(&p);
+    if (!c)
+        return -1;
+
+    const struct mcache_map *old = mcache_get(c, path);
+    int fd = open(path, O_WRONLY | O_APPEND);
+    int ok = old && old->size == size && fd >= 0 && write(fd, "x", 1) == 1;
+    if (fd >= 0)
+        close(fd);
+
+    const struct mcache_map *cur = ok ? mcache_get(c, path) : NULL;
+    ok = ok && cur && cur->size == size + 1 && old->size == size;
+    mcache_put(c, cur);
+    mcache_put(c, old);
+    mcache_destroy(c);
+
+    if (truncate(path, size) == -1)
+        ok = 0;
+    fprintf(stderr, "revalidate check %s\n", ok ? "ok" : "failed");
+    return ok ? 0 : -1;
+}
+
+int main(int argc, char *argv[]) {
+    const char *dir = "mcache_bench_dir";
+    int files = 64, max_threads = 8;
+    uint64_t size = 1 << 20;
+    long ops = 200000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:F:s:n:t:")) != -1) {
+        switch (opt) {
+        case 'd': dir = optarg; break;
+        case 'F': files = atoi(optarg); break;
+        case 's': size = parse_size(optarg); break;
+        case 'n': ops = atol(optarg); break;
+        case 't': max_threads = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-d dir] [-F files] [-s file_size] "
+                    "[-n ops_per_thread] [-t max_threads]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (files < 1 || size < READ_SIZE || ops < 1 || max_threads < 1) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    struct bench b = { .files = files, .size = size, .ops = ops };
+    b.paths = malloc(files * sizeof(*b.paths));
+    if (!b.paths || (mkdir(dir, 0755) == -1 && errno != EEXIST)) {
+        perror("setup");
+        return 1;
+    }
+    char *block = malloc(size);
+    if (!block) {
+        perror("malloc");
+        return 1;
+    }
+    for (int i = 0; i < files; i++) {
+        snprintf(b.paths[i], sizeof(b.paths[i]), "%s/f%04d", dir, i);
+        memset(block, 'a' + i % 26, size);
+        int fd = open(b.paths[i], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || write(fd, block, size) != (ssize_t)size) {
+            perror(b.paths[i]);
+            return 1;
+        }
+        close(fd);
+    }
+    free(block);
+
+    printf("mode,threads,files,ops,seconds,ops_per_sec,hit_rate,evictions\n");
+    for (int mode = 0; mode < MODE_COUNT; mode++) {
+        b.mode = mode;
+        for (int t = 1; t <= max_threads; t *= 2) {
+            if (run(&b, t) == -1) {
+                perror(mode_names[mode]);
+                return 1;
+            }
+        }
+    }
+
+    int ret = check_revalidate(b.paths[0], size) == 0 ? 0 : 1;
+    for (int i = 0; i < files; i++)
+        unlink(b.paths[i]);
+    rmdir(dir);
+    free(b.paths);
+    return ret;
+}
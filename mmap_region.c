@@ -0,0 +1,286 @@
+/*
+ * Writable mmap Region - 구현
+ *
+ * dirty 구간은 페이지 경계로 넓힌 [start, end) 를 start 순으로 정렬한 배열에
+ * 넣는다. 넣을 때 겹치거나 맞닿은 구간을 합치므로 배열은 항상 서로 떨어진
+ * 구간만 갖는다.
+ *
+ * ASYNC commit 으로 writeback 을 시작한 구간은 started 에 옮겨 두고,
+ * 다음 SYNC commit 때 dirty 와 함께 기다린다.
+ * (writeback 을 시작했다고 durable 한 것은 아니므로)
+ */
+
+#define _GNU_SOURCE
+#include "mmap_region.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct range {
+    uint64_t start;
+    uint64_t end;
+};
+
+struct range_set {
+    struct range *r;
+    size_t n;
+    size_t cap;
+};
+
+struct mreg {
+    int fd;
+    char *map;
+    size_t cap;                      /* 매핑 길이 = 디스크상 파일 크기 */
+    uint64_t size;                   /* 실제로 쓴 끝 */
+    size_t grow_step;
+    size_t page;
+    int no_sfr;                      /* sync_file_range 미지원 */
+
+    struct range_set dirty;
+    struct range_set started;
+    struct mreg_stats stats;
+};
+
+/* ---------------------------------------------------------------- */
+
+/* [s, e) 를 넣고 겹치거나 맞닿은 구간과 합친다 */
+static int set_add(struct range_set *set, uint64_t s, uint64_t e) {
+    size_t lo = 0, hi = set->n;
+
+    /* end >= s 인 첫 구간 */
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (set->r[mid].end < s)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    size_t j = lo;
+    while (j < set->n && set->r[j].start <= e) {
+        if (set->r[j].start < s)
+            s = set->r[j].start;
+        if (set->r[j].end > e)
+            e = set->r[j].end;
+        j++;
+    }
+
+    if (j == lo) {
+        /* 합칠 구간 없음: lo 자리에 끼워 넣는다 */
+        if (set->n == set->cap) {
+            size_t ncap = set->cap ? set->cap * 2 : 16;
+            struct range *p = realloc(set->r, ncap * sizeof(*p));
+            if (!p)
+                return -1;
+            set->r = p;
+            set->cap = ncap;
+        }
+        memmove(&set->r[lo + 1], &set->r[lo], (set->n - lo) * sizeof(*set->r));
+        set->n++;
+    } else if (j > lo + 1) {
+        /* [lo, j) 를 하나로 */
+        memmove(&set->r[lo + 1], &set->r[j], (set->n - j) * sizeof(*set->r));
+        set->n -= j - lo - 1;
+    }
+    set->r[lo].start = s;
+    set->r[lo].end = e;
+    return 0;
+}
+
+/* ---------------------------------------------------------------- */
+
+static int grow(struct mreg *r, uint64_t end) {
+    size_t new_cap = (end + r->grow_step - 1) / r->grow_step * r->grow_step;
+    void *p;
+
+    /* 블록을 미리 잡아 두면 page fault 때마다 블록 할당을 하지 않는다 */
+    int err = fallocate(r->fd, 0, r->cap, new_cap - r->cap);
+    if (err == -1 && (errno == EOPNOTSUPP || errno == ENOSYS))
+        err = ftruncate(r->fd, new_cap);
+    if (err == -1)
+        return -1;
+
+    if (r->map)
+        p = mremap(r->map, r->cap, new_cap, MREMAP_MAYMOVE);
+    else
+        p = mmap(NULL, new_cap, PROT_READ | PROT_WRITE, MAP_SHARED, r->fd, 0);
+    if (p == MAP_FAILED)
+        return -1;
+
+    r->map = p;
+    r->cap = new_cap;
+    r->stats.grows++;
+    return 0;
+}
+
+struct mreg *mreg_open(const char *path, const struct mreg_options *opts) {
+    struct mreg *r = calloc(1, sizeof(*r));
+    struct stat st;
+    int saved;
+
+    if (!r)
+        return NULL;
+    r->grow_step = opts && opts->grow_step ? opts->grow_step : MREG_DEFAULT_GROW;
+    r->page = (size_t)sysconf(_SC_PAGESIZE);
+    /* grow_step 은 페이지 배수여야 mremap 길이가 맞는다 */
+    r->grow_step = (r->grow_step + r->page - 1) / r->page * r->page;
+
+    r->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (r->fd < 0 || fstat(r->fd, &st) == -1)
+        goto fail;
+
+    r->size = st.st_size;
+    if (st.st_size > 0) {
+        r->map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, r->fd, 0);
+        if (r->map == MAP_FAILED) {
+            r->map = NULL;
+            goto fail;
+        }
+        r->cap = st.st_size;
+    }
+    return r;
+
+fail:
+    saved = errno;
+    if (r->fd >= 0)
+        close(r->fd);
+    free(r);
+    errno = saved;
+    return NULL;
+}
+
+void *mreg_ptr(struct mreg *r, uint64_t off, size_t len) {
+    if (off + len > r->cap && grow(r, off + len) == -1)
+        return NULL;
+    return r->map + off;
+}
+
+void mreg_mark_dirty(struct mreg *r, uint64_t off, size_t len) {
+    if (len == 0)
+        return;
+    uint64_t s = off / r->page * r->page;
+    uint64_t e = (off + len + r->page - 1) / r->page * r->page;
+    if (e > r->cap)
+        e = r->cap;
+    if (off + len > r->size)
+        r->size = off + len;
+    /* 기록할 메모리가 없으면 그 자리에서 내보낸다 (느리지만 잃어버리지 않음) */
+    if (set_add(&r->dirty, s, e) == -1)
+        msync(r->map + s, e - s, MS_SYNC);
+}
+
+int mreg_write(struct mreg *r, uint64_t off, const void *buf, size_t len) {
+    void *p = mreg_ptr(r, off, len);
+    if (!p)
+        return -1;
+    memcpy(p, buf, len);
+    mreg_mark_dirty(r, off, len);
+    return 0;
+}
+
+static int commit_async(struct mreg *r) {
+    for (size_t i = 0; i < r->dirty.n; i++) {
+        struct range *g = &r->dirty.r[i];
+        int ret = -1;
+
+        if (!r->no_sfr) {
+            ret = sync_file_range(r->fd, g->start, g->end - g->start,
+                                  SYNC_FILE_RANGE_WRITE);
+            if (ret == -1 && errno == ENOSYS)
+                r->no_sfr = 1;
+        }
+        if (r->no_sfr)
+            ret = msync(r->map + g->start, g->end - g->start, MS_ASYNC);
+        if (ret == -1)
+            return -1;
+
+        r->stats.ranges_flushed++;
+        r->stats.bytes_flushed += g->end - g->start;
+        if (set_add(&r->started, g->start, g->end) == -1)
+            return -1;
+    }
+    r->dirty.n = 0;
+    return 0;
+}
+
+static int commit_sync(struct mreg *r) {
+    /* writeback 만 시작했던 구간도 여기서 끝까지 기다린다 */
+    for (size_t i = 0; i < r->dirty.n; i++) {
+        if (set_add(&r->started, r->dirty.r[i].start, r->dirty.r[i].end) == -1)
+            return -1;
+        r->stats.ranges_flushed++;
+        r->stats.bytes_flushed += r->dirty.r[i].end - r->dirty.r[i].start;
+    }
+    r->dirty.n = 0;
+
+    if (r->started.n == 1) {
+        struct range *g = &r->started.r[0];
+        if (msync(r->map + g->start, g->end - g->start, MS_SYNC) == -1)
+            return -1;
+        r->started.n = 0;
+        return 0;
+    }
+
+    /*
+     * 구간이 여러 개면 msync(MS_SYNC) 를 구간마다 부르지 않는다.
+     * Linux 의 msync 는 구간마다 fsync 를 하므로 (ext4 면 journal commit 포함)
+     * 모든 구간의 writeback 을 먼저 시작하고 fdatasync 한 번으로 기다린다.
+     * dirty 페이지는 이 구간들뿐이라 fdatasync 가 더 쓰는 것은 없다.
+     */
+    for (size_t i = 0; i < r->started.n && !r->no_sfr; i++) {
+        struct range *g = &r->started.r[i];
+        if (sync_file_range(r->fd, g->start, g->end - g->start,
+                            SYNC_FILE_RANGE_WRITE) == -1) {
+            if (errno != ENOSYS)
+                return -1;
+            r->no_sfr = 1;
+        }
+    }
+    if (fdatasync(r->fd) == -1)
+        return -1;
+    r->started.n = 0;
+    return 0;
+}
+
+int mreg_commit(struct mreg *r, int mode) {
+    r->stats.commits++;
+    return mode == MREG_SYNC ? commit_sync(r) : commit_async(r);
+}
+
+uint64_t mreg_size(const struct mreg *r) {
+    return r->size;
+}
+
+size_t mreg_dirty_ranges(const struct mreg *r) {
+    return r->dirty.n;
+}
+
+void mreg_get_stats(const struct mreg *r, struct mreg_stats *st) {
+    *st = r->stats;
+}
+
+int mreg_close(struct mreg *r) {
+    int ret = 0;
+
+    if (!r)
+        return 0;
+    if (r->map) {
+        if (commit_sync(r) == -1)
+            ret = -1;
+        munmap(r->map, r->cap);
+    }
+    /* 미리 잡아둔 꼬리를 잘라낸다 */
+    if (r->cap > r->size && ftruncate(r->fd, r->size) == -1)
+        ret = -1;
+    if (close(r->fd) == -1)
+        ret = -1;
+    free(r->dirty.r);
+    free(r->started.r);
+    free(r);
+    return ret;
+}
@@ -0,0 +1,72 @@
+/*
+ * Writable mmap Region with Dirty-Range Tracking
+ *
+ * mmap_zero_copy_writer 는 snprintf 한 번 뒤에 매핑 전체를 msync(MS_SYNC) 한다.
+ * 매핑이 크면 commit 한 번의 비용이 파일 전체 크기에 비례한다.
+ *
+ * mreg 는 쓰기가 일어난 페이지 구간만 기록해 두고 (겹치거나 붙은 구간은
+ * 합침) commit 때 그 구간만 내보낸다.
+ *
+ *   MREG_ASYNC : sync_file_range(SYNC_FILE_RANGE_WRITE) - writeback 만 시작
+ *   MREG_SYNC  : 이전 ASYNC 구간까지 포함해서 디스크까지. 구간이 하나면
+ *                msync(MS_SYNC), 여럿이면 writeback 시작 후 fdatasync 한 번
+ *
+ * 파일은 grow_step 단위로 fallocate 해서 키운다 (확장할 때마다 ftruncate 하지
+ * 않음). 키울 때 mremap 으로 매핑이 옮겨질 수 있으므로, mreg_ptr() 로 받은
+ * 포인터는 다음 확장 전까지만 유효하다.
+ * mreg_close() 는 sync commit 후 파일을 실제 쓴 크기로 잘라낸다.
+ *
+ * 사용 예:
+ *   struct mreg *r = mreg_open("data.bin", NULL);
+ *   mreg_write(r, off, buf, len);
+ *   mreg_commit(r, MREG_ASYNC);     // 자주
+ *   mreg_commit(r, MREG_SYNC);      // durability point
+ *   mreg_close(r);
+ *
+ * Build: gcc -O2 -c mmap_region.c
+ */
+
+#ifndef MMAP_REGION_H
+#define MMAP_REGION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MREG_ASYNC 0
+#define MREG_SYNC  1
+
+#define MREG_DEFAULT_GROW (64 * 1024 * 1024)
+
+struct mreg_options {
+    size_t grow_step;                /* 0 이면 MREG_DEFAULT_GROW */
+};
+
+struct mreg_stats {
+    uint64_t commits;
+    uint64_t ranges_flushed;         /* commit 으로 내보낸 구간 수 */
+    uint64_t bytes_flushed;          /* 그 구간들의 크기 합 */
+    uint64_t grows;
+};
+
+struct mreg;
+
+/* 없으면 만든다. 실패 시 NULL, errno 설정 */
+struct mreg *mreg_open(const char *path, const struct mreg_options *opts);
+
+/* [off, off+len) 을 쓸 수 있는 포인터 (필요하면 키움). 쓴 뒤 mreg_mark_dirty */
+void *mreg_ptr(struct mreg *r, uint64_t off, size_t len);
+
+void mreg_mark_dirty(struct mreg *r, uint64_t off, size_t len);
+
+/* memcpy + mark_dirty */
+int mreg_write(struct mreg *r, uint64_t off, const void *buf, size_t len);
+
+int mreg_commit(struct mreg *r, int mode);
+
+uint64_t mreg_size(const struct mreg *r);       /* 쓴 데이터의 끝 */
+size_t mreg_dirty_ranges(const struct mreg *r);
+void mreg_get_stats(const struct mreg *r, struct mreg_stats *st);
+
+int mreg_close(struct mreg *r);
+
+#endif
@@ -0,0 +1,245 @@
+/*
+ * Dirty-Range msync Benchmark
+ *
+ * 큰 매핑 안의 임의 위치에 작은 레코드를 쓰고 commit 마다 durability 를 얻는다.
+ *
+ *   full_msync   - mmap_zero_copy_writer 처럼 매 commit 마다 매핑 전체 msync
+ *   mreg_sync    - 매 commit 마다 mreg_commit(MREG_SYNC) (dirty 구간만)
+ *   mreg_async   - 매 commit 은 MREG_ASYNC, 10 번에 한 번 MREG_SYNC
+ *
+ * 파일 확장 비교 (4KB 레코드를 append):
+ *   grow_ftruncate - 레코드마다 ftruncate + mremap
+ *   grow_mreg      - mreg (grow_step 단위 fallocate)
+ *
+ * Output (CSV): mode,writes,commits,seconds,us_per_commit,flush_span_bytes
+ *
+ * Build: gcc -O2 -o mmap_region_bench mmap_region_bench.c mmap_region.c
+ * Usage: ./mmap_region_bench [-f path] [-s map_size] [-c commits] [-w writes_per_commit]
+ */
+
+#define _GNU_SOURCE
+#include "mmap_region.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define RECORD 64
+#define APPEND_RECORD 4096
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    }
+    return v;
+}
+
+/* flushed: flush 요청이 덮은 범위의 합 (깨끗한 페이지 포함) */
+static void report(const char *mode, uint64_t writes, uint64_t commits, double secs,
+                   uint64_t flushed) {
+    printf("%s,%llu,%llu,%.4f,%.1f,%llu\n", mode, (unsigned long long)writes,
+           (unsigned long long)commits, secs, commits ? secs * 1e6 / commits : 0.0,
+           (unsigned long long)flushed);
+    fflush(stdout);
+}
+
+static void fill_record(char *rec, uint64_t i) {
+    memset(rec, 'a' + (int)(i % 26), RECORD);
+    memcpy(rec, &i, sizeof(i));
+}
+
+static int run_full(const char *path, uint64_t size, int commits, int per_commit) {
+    char rec[RECORD];
+    unsigned int seed = 1;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, size) == -1)
+        return -1;
+    char *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    double t0 = now_sec();
+    for (int c = 0; c < commits; c++) {
+        for (int w = 0; w < per_commit; w++) {
+            uint64_t slot = (uint64_t)rand_r(&seed) % (size / RECORD);
+            fill_record(rec, slot);
+            memcpy(map + slot * RECORD, rec, RECORD);
+        }
+        if (msync(map, size, MS_SYNC) == -1) {
+            munmap(map, size);
+            close(fd);
+            return -1;
+        }
+    }
+    report("full_msync", (uint64_t)commits * per_commit, commits, now_sec() - t0,
+           (uint64_t)commits * size);
+    munmap(map, size);
+    return close(fd);
+}
+
+static int run_mreg(const char *mode, const char *path, uint64_t size, int commits,
+                    int per_commit, int async) {
+    char rec[RECORD];
+    unsigned int seed = 1;
+    struct mreg_stats st;
+
+    unlink(path);
+    struct mreg_options o = { .grow_step = size };
+    struct mreg *r = mreg_open(path, &o);
+    if (!r || !mreg_ptr(r, 0, size))
+        return -1;
+
+    double t0 = now_sec();
+    for (int c = 0; c < commits; c++) {
+        for (int w = 0; w < per_commit; w++) {
+            uint64_t slot = (uint64_t)rand_r(&seed) % (size / RECORD);
+            fill_record(rec, slot);
+            if (mreg_write(r, slot * RECORD, rec, RECORD) == -1) {
+                mreg_close(r);
+                return -1;
+            }
+        }
+        int sync = !async || c % 10 == 9 || c == commits - 1;
+        if (mreg_commit(r, sync ? MREG_SYNC : MREG_ASYNC) == -1) {
+            mreg_close(r);
+            return -1;
+        }
+    }
+    mreg_get_stats(r, &st);
+    report(mode, (uint64_t)commits * per_commit, commits, now_sec() - t0,
+           st.bytes_flushed);
+    return mreg_close(r);
+}
+
+static int run_grow_ftruncate(const char *path, int records) {
+    char rec[APPEND_RECORD];
+    char *map = NULL;
+    size_t len = 0;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return -1;
+
+    memset(rec, 'x', sizeof(rec));
+    double t0 = now_sec();
+    for (int i = 0; i < records; i++) {
+        size_t nlen = len + APPEND_RECORD;
+        if (ftruncate(fd, nlen) == -1)
+            break;
+        void *p = map ? mremap(map, len, nlen, MREMAP_MAYMOVE)
+                      : mmap(NULL, nlen, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED)
+            break;
+        map = p;
+        memcpy(map + len, rec, APPEND_RECORD);
+        len = nlen;
+    }
+    if (map)
+        msync(map, len, MS_SYNC);
+    report("grow_ftruncate", len / APPEND_RECORD, 1, now_sec() - t0, len);
+    if (map)
+        munmap(map, len);
+    close(fd);
+    return len == (size_t)records * APPEND_RECORD ? 0 : -1;
+}
+
+static int run_grow_mreg(const char *path, int records) {
+    char rec[APPEND_RECORD];
+    struct mreg_stats st;
+
+    unlink(path);
+    struct mreg *r = mreg_open(path, NULL);
+    if (!r)
+        return -1;
+
+    memset(rec, 'x', sizeof(rec));
+    double t0 = now_sec();
+    for (int i = 0; i < records; i++) {
+        if (mreg_write(r, (uint64_t)i * APPEND_RECORD, rec, APPEND_RECORD) == -1) {
+            mreg_close(r);
+            return -1;
+        }
+    }
+    if (mreg_commit(r, MREG_SYNC) == -1) {
+        mreg_close(r);
+        return -1;
+    }
+    mreg_get_stats(r, &st);
+    report("grow_mreg", records, 1, now_sec() - t0, st.bytes_flushed);
+    return mreg_close(r);
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = "mreg_bench.bin";
+    uint64_t size = 256ULL << 20;
+    int commits = 200, per_commit = 16;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:s:c:w:")) != -1) {
+        switch (opt) {
+        case 'f': path = optarg; break;
+        case 's': size = parse_size(optarg); break;
+        case 'c': commits = atoi(optarg); break;
+        case 'w': per_commit = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-f path] [-s map_size] [-c commits] "
+                    "[-w writes_per_commit]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (size < RECORD || commits < 1 || per_commit < 1) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    printf("mode,writes,commits,seconds,us_per_commit,flush_span_bytes\n");
+    if (run_full(path, size, commits, per_commit) == -1) {
+        perror("full_msync");
+        return 1;
+    }
+    if (run_mreg("mreg_sync", path, size, commits, per_commit, 0) == -1) {
+        perror("mreg_sync");
+        return 1;
+    }
+    if (run_mreg("mreg_async", path, size, commits, per_commit, 1) == -1) {
+        perror("mreg_async");
+        return 1;
+    }
+
+    int records = (int)(size / APPEND_RECORD);
+    if (run_grow_ftruncate(path, records) == -1) {
+        perror("grow_ftruncate");
+        return 1;
+    }
+    if (run_grow_mreg(path, records) == -1) {
+        perror("grow_mreg");
+        return 1;
+    }
+
+    /* close 가 꼬리를 잘라냈는지 확인 */
+    struct mreg *r = mreg_open(path, NULL);
+    if (!r || mreg_size(r) != (uint64_t)records * APPEND_RECORD) {
+        fprintf(stderr, "grow_mreg: size after reopen is wrong\n");
+        return 1;
+    }
+    mreg_close(r);
+    unlink(path);
+    return 0;
+}
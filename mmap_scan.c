@@ -0,0 +1,221 @@
+/*
+ * Parallel Chunked mmap Scanner - 구현
+ *
+ * chunk 경계 처리:
+ *   - checksum 은 chunk 가 8의 배수(페이지 정렬)이므로 word 합을 그냥 더함
+ *   - pattern 은 chunk 안에서 "시작"하는 것만 세고, 끝 부분은
+ *     다음 chunk 영역까지 (pattern_len - 1) 바이트를 더 읽는다
+ */
+
+#define _GNU_SOURCE
+#include "mmap_scan.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct scan_job {
+    const char *base;
+    size_t len;
+    size_t chunk;
+    size_t nchunks;
+    int kernels;
+    const char *pattern;
+    size_t pattern_len;
+    atomic_size_t next;
+};
+
+struct scan_worker {
+    pthread_t tid;
+    struct scan_job *job;
+    struct scan_result res;
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t count_lines(const char *p, size_t len) {
+    uint64_t n = 0;
+    const char *end = p + len;
+    while (p < end && (p = memchr(p, '\n', end - p)) != NULL) {
+        n++;
+        p++;
+    }
+    return n;
+}
+
+static uint64_t word_sum(const char *p, size_t len) {
+    uint64_t sum = 0, w;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        memcpy(&w, p + i, 8);
+        sum += w;
+    }
+    /* 파일 끝의 8바이트 미만 꼬리는 0 으로 채운 word 로 취급 */
+    if (i < len) {
+        w = 0;
+        memcpy(&w, p + i, len - i);
+        sum += w;
+    }
+    return sum;
+}
+
+/* [start, start+len) 에서 시작하는 pattern 개수. limit 은 읽을 수 있는 끝.
+ * 다음 chunk 로는 plen - 1 바이트만 넘겨 본다 (끝까지 찾으면 hit 없는 chunk 마다
+ * 파일 끝까지 훑어 전체가 O(n^2) 이 된다) */
+static uint64_t count_matches(const char *start, size_t len, const char *limit,
+                              const char *pat, size_t plen) {
+    uint64_t n = 0;
+    const char *p = start;
+    const char *last_start = start + len;
+    const char *end = (size_t)(limit - last_start) > plen - 1 ? last_start + plen - 1 : limit;
+
+    while (p < last_start) {
+        const char *hit = memmem(p, end - p, pat, plen);
+        if (!hit || hit >= last_start)
+            break;
+        n++;
+        p = hit + 1;
+    }
+    return n;
+}
+
+static void scan_chunk(struct scan_job *job, size_t idx, struct scan_result *r) {
+    size_t off = idx * job->chunk;
+    size_t len = job->len - off < job->chunk ? job->len - off : job->chunk;
+    const char *p = job->base + off;
+
+    /* 이번 chunk 를 미리 읽어달라고 커널에 알림 */
+    madvise((void *)p, len, MADV_WILLNEED);
+
+    r->bytes += len;
+    if (job->kernels & SCAN_LINES)
+        r->lines += count_lines(p, len);
+    if (job->kernels & SCAN_CHECKSUM)
+        r->checksum += word_sum(p, len);
+    if ((job->kernels & SCAN_PATTERN) && job->pattern_len > 0)
+        r->matches += count_matches(p, len, job->base + job->len,
+                                    job->pattern, job->pattern_len);
+}
+
+static void *worker_main(void *arg) {
+    struct scan_worker *w = arg;
+    struct scan_job *job = w->job;
+    size_t idx;
+
+    while ((idx = atomic_fetch_add(&job->next, 1)) < job->nchunks)
+        scan_chunk(job, idx, &w->res);
+    return NULL;
+}
+
+int mmap_scan_region(const char *base, size_t len, int kernels,
+                     const struct scan_options *opts, struct scan_result *res) {
+    long page = sysconf(_SC_PAGESIZE);
+    int threads = opts && opts->threads > 0 ? opts->threads
+                                            : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    size_t chunk = opts && opts->chunk_size ? opts->chunk_size : SCAN_DEFAULT_CHUNK;
+    chunk = (chunk + page - 1) & ~((size_t)page - 1);
+
+    struct scan_job job = {
+        .base = base,
+        .len = len,
+        .chunk = chunk,
+        .nchunks = (len + chunk - 1) / chunk,
+        .kernels = kernels,
+        .pattern = opts ? opts->pattern : NULL,
+        .pattern_len = opts && opts->pattern ? opts->pattern_len : 0,
+    };
+    atomic_init(&job.next, 0);
+
+    if ((size_t)threads > job.nchunks)
+        threads = job.nchunks ? (int)job.nchunks : 1;
+
+    struct scan_worker *workers = calloc(threads, sizeof(*workers));
+    if (!workers)
+        return -1;
+
+    /* 호출 스레드도 worker 0 으로 참여 */
+    for (int i = 0; i < threads; i++)
+        workers[i].job = &job;
+    for (int i = 1; i < threads; i++) {
+        int ret = pthread_create(&workers[i].tid, NULL, worker_main, &workers[i]);
+        if (ret != 0) {
+            /* 스레드를 더 못 만들면 만든 만큼만으로 진행 */
+            threads = i;
+            break;
+        }
+    }
+    worker_main(&workers[0]);
+    for (int i = 1; i < threads; i++)
+        pthread_join(workers[i].tid, NULL);
+
+    memset(res, 0, sizeof(*res));
+    for (int i = 0; i < threads; i++) {
+        res->bytes += workers[i].res.bytes;
+        res->lines += workers[i].res.lines;
+        res->checksum += workers[i].res.checksum;
+        res->matches += workers[i].res.matches;
+    }
+
+    free(workers);
+    return 0;
+}
+
+int mmap_scan_file(const char *path, int kernels, const struct scan_options *opts,
+                   struct scan_result *res) {
+    double t0 = now_sec();
+    struct stat st;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    if (fstat(fd, &st) < 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+
+    if (st.st_size == 0) {
+        close(fd);
+        memset(res, 0, sizeof(*res));
+        res->seconds = now_sec() - t0;
+        return 0;
+    }
+
+    int flags = MAP_PRIVATE;
+    if (opts && opts->populate)
+        flags |= MAP_POPULATE;
+
+    /* 파일 전체를 한 번만 매핑 - 모든 worker 가 공유 */
+    char *mapped = mmap(NULL, st.st_size, PROT_READ, flags, fd, 0);
+    if (mapped == MAP_FAILED) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    close(fd);
+
+    madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    if (opts && opts->hugepages)
+        madvise(mapped, st.st_size, MADV_HUGEPAGE);
+#endif
+
+    int ret = mmap_scan_region(mapped, st.st_size, kernels, opts, res);
+    munmap(mapped, st.st_size);
+    res->seconds = now_sec() - t0;
+    return ret;
+}
@@ -0,0 +1,252 @@
+/*
+ * Lock-free MPSC Log Ring - 구현
+ *
+ * slot 상태는 seq 하나로 표현한다 (pos = 예약 번호, N = slot 개수):
+ *   seq == pos      : 비어 있음, pos 번 producer 가 쓸 수 있음
+ *   seq == pos + 1  : publish 됨, flusher 가 쓸 수 있음
+ *   seq == pos + N  : flusher 가 비움, 다음 바퀴(pos + N) producer 용
+ *
+ * flusher 는 할 일이 없으면 futex 로 잠들고, publish 하는 producer 가
+ * sleeping 플래그를 보고 깨운다.
+ */
+
+#define _GNU_SOURCE
+#include "mpsc_log.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+#define SPIN_BEFORE_SLEEP 128
+
+struct mpsc_log {
+    /* producer 들이 경합하는 tail 은 별도 cache line 에 */
+    _Alignas(64) atomic_uint_fast64_t tail;
+    _Alignas(64) uint64_t head;              /* flusher 전용 */
+    atomic_int sleeping;
+    atomic_int closing;
+    int fd;
+    int error;
+    size_t mask;
+    struct mpsc_slot *slots;
+    pthread_t flusher;
+};
+
+static long futex(atomic_int *addr, int op, int val, const struct timespec *ts) {
+    return syscall(SYS_futex, addr, op, val, ts, NULL, 0);
+}
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static inline uint64_t slot_seq(struct mpsc_slot *s, memory_order mo) {
+    return __atomic_load_n(&s->seq, mo);
+}
+
+/* 전부 쓰일 때까지 writev (partial write 처리) */
+static int writev_all(int fd, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t n = writev(fd, iov, iovcnt);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+/* head 부터 연속으로 publish 된 slot 들을 한 번에 쓰고 비운다 */
+static int flush_ready(struct mpsc_log *log, struct iovec *iov) {
+    size_t nslots = log->mask + 1;
+    int n = 0;
+
+    while (n < IOV_MAX) {
+        uint64_t pos = log->head + n;
+        struct mpsc_slot *s = &log->slots[pos & log->mask];
+        if (slot_seq(s, __ATOMIC_ACQUIRE) != pos + 1)
+            break;
+        iov[n].iov_base = s->data;
+        iov[n].iov_len = s->len;
+        n++;
+    }
+    if (n == 0)
+        return 0;
+
+    if (writev_all(log->fd, iov, n) == -1) {
+        perror("writev");
+        log->error = 1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        uint64_t pos = log->head + i;
+        __atomic_store_n(&log->slots[pos & log->mask].seq, pos + nslots, __ATOMIC_RELEASE);
+    }
+    log->head += n;
+    return n;
+}
+
+static int has_ready(struct mpsc_log *log) {
+    struct mpsc_slot *s = &log->slots[log->head & log->mask];
+    return slot_seq(s, __ATOMIC_ACQUIRE) == log->head + 1;
+}
+
+static void *flusher_main(void *arg) {
+    struct mpsc_log *log = arg;
+    struct iovec *iov = malloc(sizeof(*iov) * IOV_MAX);
+    int idle = 0;
+
+    if (!iov) {
+        perror("malloc");
+        log->error = 1;
+        return NULL;
+    }
+
+    for (;;) {
+        if (flush_ready(log, iov) > 0) {
+            idle = 0;
+            continue;
+        }
+
+        /* closing 이후에는 예약된 레코드가 모두 publish 되면 끝 */
+        if (atomic_load(&log->closing) && atomic_load(&log->tail) == log->head)
+            break;
+
+        if (++idle < SPIN_BEFORE_SLEEP) {
+            cpu_relax();
+            continue;
+        }
+
+        atomic_store(&log->sleeping, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!has_ready(log) && !atomic_load(&log->closing)) {
+            struct timespec ts = { 0, 10 * 1000 * 1000 };
+            futex(&log->sleeping, FUTEX_WAIT_PRIVATE, 1, &ts);
+        }
+        atomic_store(&log->sleeping, 0);
+        idle = 0;
+    }
+
+    free(iov);
+    return NULL;
+}
+
+struct mpsc_log *mpsc_log_open(int fd, size_t nslots) {
+    size_t n = 64;
+    while (n < nslots)
+        n <<= 1;
+
+    struct mpsc_log *log = aligned_alloc(64, sizeof(*log));
+    if (!log)
+        return NULL;
+    memset(log, 0, sizeof(*log));
+
+    log->slots = aligned_alloc(64, n * sizeof(struct mpsc_slot));
+    if (!log->slots) {
+        free(log);
+        return NULL;
+    }
+    for (size_t i = 0; i < n; i++)
+        log->slots[i].seq = i;
+
+    log->fd = fd;
+    log->mask = n - 1;
+    atomic_init(&log->tail, 0);
+
+    int ret = pthread_create(&log->flusher, NULL, flusher_main, log);
+    if (ret != 0) {
+        free(log->slots);
+        free(log);
+        errno = ret;
+        return NULL;
+    }
+    return log;
+}
+
+struct mpsc_slot *mpsc_log_reserve(struct mpsc_log *log) {
+    uint64_t pos = atomic_fetch_add_explicit(&log->tail, 1, memory_order_relaxed);
+    struct mpsc_slot *s = &log->slots[pos & log->mask];
+
+    /* ring 이 가득 참 - flusher 가 이 slot 을 비울 때까지 대기 */
+    for (int spins = 0; slot_seq(s, __ATOMIC_ACQUIRE) != pos; spins++) {
+        if (spins < 64)
+            cpu_relax();
+        else
+            sched_yield();
+    }
+    return s;
+}
+
+void mpsc_log_publish(struct mpsc_log *log, struct mpsc_slot *slot, size_t len) {
+    uint64_t pos = slot_seq(slot, __ATOMIC_RELAXED);
+
+    slot->len = (uint32_t)(len > MPSC_RECORD_MAX ? MPSC_RECORD_MAX : len);
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    /* flusher 가 sleeping 을 세운 뒤 has_ready() 를 보는 것과 짝을 이룬다 */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&log->sleeping, memory_order_relaxed)) {
+        atomic_store(&log->sleeping, 0);
+        futex(&log->sleeping, FUTEX_WAKE_PRIVATE, 1, NULL);
+    }
+}
+
+int mpsc_log_printf(struct mpsc_log *log, const char *fmt, ...) {
+    struct mpsc_slot *s = mpsc_log_reserve(log);
+    va_list ap;
+
+    va_start(ap, fmt);
+    int len = vsnprintf(s->data, MPSC_RECORD_MAX, fmt, ap);
+    va_end(ap);
+
+    if (len < 0)
+        len = 0;
+    else if (len >= MPSC_RECORD_MAX) {
+        /* vsnprintf 가 마지막 바이트에 '\0' 을 씀. 잘린 레코드도 줄로 끝나야
+         * 다음 레코드가 같은 줄에 붙지 않는다 */
+        len = MPSC_RECORD_MAX - 1;
+        s->data[len - 1] = '\n';
+    }
+
+    mpsc_log_publish(log, s, (size_t)len);
+    return len;
+}
+
+int mpsc_log_close(struct mpsc_log *log) {
+    atomic_store(&log->closing, 1);
+    atomic_store(&log->sleeping, 0);
+    futex(&log->sleeping, FUTEX_WAKE_PRIVATE, 1, NULL);
+    pthread_join(log->flusher, NULL);
+
+    int ret = log->error ? -1 : 0;
+    free(log->slots);
+    free(log);
+    return ret;
+}
@@ -0,0 +1,452 @@
+/*
+ * Pirate Record Store - 구현
+ *
+ * 읽기는 MAP_SHARED 읽기 전용 매핑으로, 쓰기는 pwrite 로 한다.
+ * (page cache 가 하나이므로 pwrite 한 내용이 매핑에서 바로 보인다)
+ *
+ * append 순서: 레코드 pwrite -> header 의 count 갱신.
+ * 중간에 죽으면 count 뒤의 꼬리 데이터는 무시된다.
+ */
+
+#define _GNU_SOURCE
+#include "pirate_store.h"
+
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define PSTORE_MAGIC "PIRT"
+#define PINDEX_MAGIC "PIDX"
+#define PINDEX_HEADER_SIZE 32
+#define BULK_BUF_RECORDS 32768       /* 약 3.5MB 단위로 write */
+#define MIN_BUCKETS 1024
+
+struct pstore {
+    int fd;
+    char *path;
+    char *map;
+    size_t map_len;
+    uint64_t count;
+
+    uint64_t *buckets;               /* 레코드 번호 + 1, 0 은 빈 칸 */
+    uint64_t nbuckets;
+    int index_dirty;
+};
+
+/* ---------------------------------------------------------------- */
+/* 인코딩 - 필드별로 명시적 offset / little-endian */
+
+static void encode_record(const struct pirate *p, char *out) {
+    uint64_t booty = htole64((uint64_t)p->booty);
+    uint32_t beard = htole32((uint32_t)p->beard_len);
+
+    memset(out, 0, PSTORE_NAME_LEN);
+    strncpy(out, p->name, PSTORE_NAME_LEN);
+    memcpy(out + 100, &booty, 8);
+    memcpy(out + 108, &beard, 4);
+}
+
+static void decode_record(const char *in, struct pirate *p) {
+    uint64_t booty;
+    uint32_t beard;
+
+    memcpy(p->name, in, PSTORE_NAME_LEN);
+    p->name[PSTORE_NAME_LEN - 1] = '\0';
+    memcpy(&booty, in + 100, 8);
+    memcpy(&beard, in + 108, 4);
+    p->booty = (unsigned long)le64toh(booty);
+    p->beard_len = le32toh(beard);
+}
+
+static void encode_header(char *out, uint64_t count) {
+    uint16_t version = htole16(PSTORE_VERSION);
+    uint16_t rsize = htole16(PSTORE_RECORD_SIZE);
+    uint64_t c = htole64(count);
+
+    memset(out, 0, PSTORE_HEADER_SIZE);
+    memcpy(out, PSTORE_MAGIC, 4);
+    memcpy(out + 4, &version, 2);
+    memcpy(out + 6, &rsize, 2);
+    memcpy(out + 8, &c, 8);
+}
+
+static int pwrite_all(int fd, const char *buf, size_t len, off_t off) {
+    while (len > 0) {
+        ssize_t n = pwrite(fd, buf, len, off);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        buf += n;
+        len -= n;
+        off += n;
+    }
+    return 0;
+}
+
+static const char *record_ptr(const struct pstore *s, uint64_t idx) {
+    return s->map + PSTORE_HEADER_SIZE + idx * PSTORE_RECORD_SIZE;
+}
+
+/* ---------------------------------------------------------------- */
+/* name index */
+
+static uint64_t hash_name(const char *name, size_t max) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < max && name[i]; i++) {
+        h ^= (unsigned char)name[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static void index_insert(uint64_t *buckets, uint64_t nbuckets, const char *name,
+                         uint64_t idx) {
+    uint64_t mask = nbuckets - 1;
+    uint64_t b = hash_name(name, PSTORE_NAME_LEN) & mask;
+    while (buckets[b])
+        b = (b + 1) & mask;
+    buckets[b] = idx + 1;
+}
+
+/* load factor 0.5 이하가 되도록 테이블을 다시 만든다 */
+static int index_rebuild(struct pstore *s, uint64_t want) {
+    uint64_t n = MIN_BUCKETS;
+    while (n < want * 2)
+        n <<= 1;
+
+    uint64_t *b = calloc(n, sizeof(uint64_t));
+    if (!b)
+        return -1;
+    for (uint64_t i = 0; i < s->count; i++)
+        index_insert(b, n, record_ptr(s, i), i);
+
+    free(s->buckets);
+    s->buckets = b;
+    s->nbuckets = n;
+    s->index_dirty = 1;
+    return 0;
+}
+
+static char *index_path(const char *path) {
+    size_t len = strlen(path);
+    char *p = malloc(len + 5);
+    if (!p)
+        return NULL;
+    memcpy(p, path, len);
+    memcpy(p + len, ".idx", 5);
+    return p;
+}
+
+/* <path>.idx 가 현재 count 와 맞으면 읽어오고, 아니면 0 */
+static int index_load(struct pstore *s) {
+    char *ipath = index_path(s->path);
+    if (!ipath)
+        return 0;
+
+    int fd = open(ipath, O_RDONLY);
+    free(ipath);
+    if (fd < 0)
+        return 0;
+
+    char hdr[PINDEX_HEADER_SIZE];
+    struct stat st;
+    uint64_t count, nbuckets;
+    int ok = 0;
+
+    if (fstat(fd, &st) == 0 && pread(fd, hdr, sizeof(hdr), 0) == sizeof(hdr) &&
+        memcmp(hdr, PINDEX_MAGIC, 4) == 0) {
+        memcpy(&count, hdr + 8, 8);
+        memcpy(&nbuckets, hdr + 16, 8);
+        count = le64toh(count);
+        nbuckets = le64toh(nbuckets);
+
+        /* nbuckets 도 파일에서 읽은 값: 파일 크기로 먼저 묶어야 곱셈이 안전하다 */
+        if (count == s->count && nbuckets >= MIN_BUCKETS &&
+            (nbuckets & (nbuckets - 1)) == 0 && nbuckets / 2 >= count &&
+            nbuckets <= ((uint64_t)st.st_size - PINDEX_HEADER_SIZE) / sizeof(uint64_t)) {
+            uint64_t *b = malloc(nbuckets * sizeof(uint64_t));
+            size_t bytes = nbuckets * sizeof(uint64_t);
+            if (b && pread(fd, b, bytes, PINDEX_HEADER_SIZE) == (ssize_t)bytes) {
+                /* 오래되었거나 깨진 .idx: bucket 값은 0 (빈 칸) 또는 1..count 여야 하고
+                 * 채워진 칸이 count 개여야 한다. 아니면 index_rebuild 로 */
+                uint64_t used = 0;
+                ok = 1;
+                for (uint64_t i = 0; i < nbuckets; i++) {
+                    b[i] = le64toh(b[i]);
+                    if (b[i] > count)
+                        ok = 0;
+                    else if (b[i])
+                        used++;
+                }
+                if (ok && used == count) {
+                    s->buckets = b;
+                    s->nbuckets = nbuckets;
+                } else {
+                    ok = 0;
+                    free(b);
+                }
+            } else {
+                free(b);
+            }
+        }
+    }
+    close(fd);
+    return ok;
+}
+
+static int index_save(struct pstore *s) {
+    char *ipath = index_path(s->path);
+    if (!ipath)
+        return -1;
+
+    int fd = open(ipath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    free(ipath);
+    if (fd < 0)
+        return -1;
+
+    char hdr[PINDEX_HEADER_SIZE];
+    uint64_t count = htole64(s->count), nb = htole64(s->nbuckets);
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, PINDEX_MAGIC, 4);
+    memcpy(hdr + 8, &count, 8);
+    memcpy(hdr + 16, &nb, 8);
+
+    int ret = pwrite_all(fd, hdr, sizeof(hdr), 0);
+    if (ret == 0) {
+#if __BYTE_ORDER == __BIG_ENDIAN
+        for (uint64_t i = 0; i < s->nbuckets; i++)
+            s->buckets[i] = htole64(s->buckets[i]);
+#endif
+        ret = pwrite_all(fd, (const char *)s->buckets, s->nbuckets * sizeof(uint64_t),
+                         PINDEX_HEADER_SIZE);
+#if __BYTE_ORDER == __BIG_ENDIAN
+        for (uint64_t i = 0; i < s->nbuckets; i++)
+            s->buckets[i] = le64toh(s->buckets[i]);
+#endif
+    }
+    if (close(fd) == -1)
+        ret = -1;
+    if (ret == 0)
+        s->index_dirty = 0;
+    return ret;
+}
+
+/* ---------------------------------------------------------------- */
+
+static int remap(struct pstore *s) {
+    size_t want = PSTORE_HEADER_SIZE + s->count * PSTORE_RECORD_SIZE;
+    void *p;
+
+    if (s->map)
+        p = mremap(s->map, s->map_len, want, MREMAP_MAYMOVE);
+    else
+        p = mmap(NULL, want, PROT_READ, MAP_SHARED, s->fd, 0);
+    if (p == MAP_FAILED)
+        return -1;
+
+    s->map = p;
+    s->map_len = want;
+    return 0;
+}
+
+struct pstore *pstore_open(const char *path) {
+    struct pstore *s = calloc(1, sizeof(*s));
+    char hdr[PSTORE_HEADER_SIZE];
+    struct stat st;
+    int saved;
+
+    if (!s)
+        return NULL;
+    s->path = strdup(path);
+    s->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (!s->path || s->fd < 0)
+        goto fail;
+
+    if (fstat(s->fd, &st) < 0)
+        goto fail;
+
+    if (st.st_size == 0) {
+        encode_header(hdr, 0);
+        if (pwrite_all(s->fd, hdr, sizeof(hdr), 0) == -1)
+            goto fail;
+    } else {
+        uint16_t version, rsize;
+        uint64_t count;
+
+        if (pread(s->fd, hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+            memcmp(hdr, PSTORE_MAGIC, 4) != 0) {
+            errno = EINVAL;
+            goto fail;
+        }
+        memcpy(&version, hdr + 4, 2);
+        memcpy(&rsize, hdr + 6, 2);
+        memcpy(&count, hdr + 8, 8);
+        if (le16toh(version) != PSTORE_VERSION || le16toh(rsize) != PSTORE_RECORD_SIZE) {
+            errno = EINVAL;
+            goto fail;
+        }
+        s->count = le64toh(count);
+        /* count 는 파일에서 읽은 값: 곱하면 넘칠 수 있으므로 나눠서 비교 */
+        if (s->count > ((uint64_t)st.st_size - PSTORE_HEADER_SIZE) / PSTORE_RECORD_SIZE) {
+            errno = EINVAL;
+            goto fail;
+        }
+    }
+
+    if (remap(s) == -1)
+        goto fail;
+
+    if (!index_load(s) && index_rebuild(s, s->count) == -1)
+        goto fail;
+    return s;
+
+fail:
+    saved = errno;
+    if (s->map)
+        munmap(s->map, s->map_len);
+    if (s->fd >= 0)
+        close(s->fd);
+    free(s->path);
+    free(s);
+    errno = saved;
+    return NULL;
+}
+
+int pstore_close(struct pstore *s) {
+    int ret = 0;
+
+    if (s->index_dirty && index_save(s) == -1)
+        ret = -1;
+    munmap(s->map, s->map_len);
+    if (close(s->fd) == -1)
+        ret = -1;
+    free(s->buckets);
+    free(s->path);
+    free(s);
+    return ret;
+}
+
+uint64_t pstore_count(const struct pstore *s) {
+    return s->count;
+}
+
+int pstore_get(const struct pstore *s, uint64_t idx, struct pirate *out) {
+    if (idx >= s->count) {
+        errno = ERANGE;
+        return -1;
+    }
+    decode_record(record_ptr(s, idx), out);
+    return 0;
+}
+
+int pstore_append(struct pstore *s, const struct pirate *recs, size_t n) {
+    if (n == 0)
+        return 0;
+
+    char *buf = malloc(n * PSTORE_RECORD_SIZE);
+    if (!buf)
+        return -1;
+    for (size_t i = 0; i < n; i++)
+        encode_record(&recs[i], buf + i * PSTORE_RECORD_SIZE);
+
+    off_t off = PSTORE_HEADER_SIZE + (off_t)s->count * PSTORE_RECORD_SIZE;
+    int ret = pwrite_all(s->fd, buf, n * PSTORE_RECORD_SIZE, off);
+    free(buf);
+    if (ret == -1)
+        return -1;
+
+    /* 레코드가 다 써진 뒤에 count 를 올린다 */
+    uint64_t c = htole64(s->count + n);
+    if (pwrite_all(s->fd, (const char *)&c, 8, 8) == -1)
+        return -1;
+
+    uint64_t old = s->count;
+    s->count += n;
+    if (remap(s) == -1)
+        return -1;
+
+    if (s->count * 2 > s->nbuckets)
+        return index_rebuild(s, s->count);
+    for (uint64_t i = old; i < s->count; i++)
+        index_insert(s->buckets, s->nbuckets, record_ptr(s, i), i);
+    s->index_dirty = 1;
+    return 0;
+}
+
+int64_t pstore_find(const struct pstore *s, const char *name, struct pirate *out) {
+    uint64_t mask = s->nbuckets - 1;
+    uint64_t b = hash_name(name, PSTORE_NAME_LEN) & mask;
+
+    for (; s->buckets[b]; b = (b + 1) & mask) {
+        uint64_t idx = s->buckets[b] - 1;
+        const char *rec = record_ptr(s, idx);
+        if (strncmp(rec, name, PSTORE_NAME_LEN) == 0) {
+            if (out)
+                decode_record(rec, out);
+            return (int64_t)idx;
+        }
+    }
+    return -1;
+}
+
+int pstore_sync(struct pstore *s) {
+    return fdatasync(s->fd);
+}
+
+int pstore_bulk_load(const char *path, uint64_t n, pstore_gen_fn gen, void *arg) {
+    char hdr[PSTORE_HEADER_SIZE];
+    struct pirate rec;
+    int ret = -1;
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return -1;
+
+    /* 최종 크기를 미리 잡아두면 write 마다 블록 할당을 하지 않는다 */
+    off_t total = PSTORE_HEADER_SIZE + (off_t)n * PSTORE_RECORD_SIZE;
+    posix_fallocate(fd, 0, total);
+
+    char *buf = malloc((size_t)BULK_BUF_RECORDS * PSTORE_RECORD_SIZE);
+    if (!buf)
+        goto out;
+
+    /* header 는 마지막에 count 와 함께 쓴다 */
+    off_t off = PSTORE_HEADER_SIZE;
+    for (uint64_t i = 0; i < n;) {
+        size_t k = 0;
+        for (; k < BULK_BUF_RECORDS && i < n; k++, i++) {
+            memset(&rec, 0, sizeof(rec));
+            gen(i, &rec, arg);
+            encode_record(&rec, buf + k * PSTORE_RECORD_SIZE);
+        }
+        if (pwrite_all(fd, buf, k * PSTORE_RECORD_SIZE, off) == -1)
+            goto out;
+        off += k * PSTORE_RECORD_SIZE;
+    }
+
+    encode_header(hdr, n);
+    if (pwrite_all(fd, hdr, sizeof(hdr), 0) == -1)
+        goto out;
+
+    /* 이전 index 는 더 이상 맞지 않음 - 다음 open 때 다시 만든다 */
+    char *ipath = index_path(path);
+    if (ipath) {
+        unlink(ipath);
+        free(ipath);
+    }
+    ret = 0;
+
+out:
+    free(buf);
+    if (close(fd) == -1)
+        ret = -1;
+    return ret;
+}
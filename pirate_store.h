@@ -0,0 +1,75 @@
+/*
+ * Pirate Record Store
+ *
+ * 11.c 는 struct pirate 를 fwrite/fread 로 그대로 저장한다.
+ * 컴파일러 padding 과 host endian 에 의존하고, N 번째 레코드를 찾으려면
+ * 앞의 레코드를 전부 읽어야 한다.
+ *
+ * 파일 형식 (모든 정수는 little-endian):
+ *
+ *   header (64 bytes)
+ *     0  magic        "PIRT"
+ *     4  version      u16 (PSTORE_VERSION)
+ *     6  record_size  u16 (PSTORE_RECORD_SIZE)
+ *     8  count        u64
+ *     16 reserved
+ *   records (record_size bytes each, padding 없음)
+ *     0   name        char[100] ('\0' 채움)
+ *     100 booty       u64
+ *     108 beard_len   u32
+ *
+ *   <path>.idx : name 의 FNV-1a hash 로 만든 open addressing 테이블
+ *
+ * 레코드 i 의 위치는 64 + i * 112 이므로 mmap 으로 O(1) 접근.
+ *
+ * Build: gcc -O2 -c pirate_store.c
+ */
+
+#ifndef PIRATE_STORE_H
+#define PIRATE_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PSTORE_VERSION 1
+#define PSTORE_HEADER_SIZE 64
+#define PSTORE_NAME_LEN 100
+#define PSTORE_RECORD_SIZE 112
+
+/* 11.c 와 같은 in-memory 형태 */
+struct pirate {
+    char name[PSTORE_NAME_LEN];
+    unsigned long booty;
+    unsigned int beard_len;
+};
+
+struct pstore;
+
+/* 없으면 새로 만든다. 실패 시 NULL, errno 설정 */
+struct pstore *pstore_open(const char *path);
+
+/* index 를 <path>.idx 에 저장하고 닫는다 */
+int pstore_close(struct pstore *s);
+
+uint64_t pstore_count(const struct pstore *s);
+
+/* O(1) 랜덤 접근. 범위 밖이면 -1 (errno = ERANGE) */
+int pstore_get(const struct pstore *s, uint64_t idx, struct pirate *out);
+
+/* n 개를 한 번의 write 로 추가 (index 도 갱신) */
+int pstore_append(struct pstore *s, const struct pirate *recs, size_t n);
+
+/* name 으로 찾기. 찾으면 레코드 번호, 없으면 -1 */
+int64_t pstore_find(const struct pstore *s, const char *name, struct pirate *out);
+
+/*
+ * 대량 적재: gen(i, &rec, arg) 로 n 개를 만들어 큰 버퍼 단위로 write.
+ * 기존 내용은 지운다.
+ */
+typedef void (*pstore_gen_fn)(uint64_t i, struct pirate *rec, void *arg);
+int pstore_bulk_load(const char *path, uint64_t n, pstore_gen_fn gen, void *arg);
+
+/* 변경 내용을 디스크에 기록 (fdatasync) */
+int pstore_sync(struct pstore *s);
+
+#endif
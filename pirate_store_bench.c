@@ -0,0 +1,164 @@
+/*
+ * Pirate Record Store Benchmark
+ *
+ *   bulk_load   - pstore_bulk_load 로 N 개 적재
+ *   open        - 헤더 검사 + 매핑 + index 로드/재생성
+ *   get_random  - 임의 번호 M 개 O(1) 접근
+ *   find_index  - name 으로 M 번 조회 (hash index)
+ *   find_scan   - 11.c 방식: fread 로 처음부터 읽으며 name 비교 (조회 몇 번만)
+ *   append      - 1000 개씩 batch append
+ *
+ * Output (CSV): op,count,seconds,ops_per_sec
+ *
+ * Build: gcc -O2 -o pirate_store_bench pirate_store_bench.c pirate_store.c
+ * Usage: ./pirate_store_bench [-f path] [-n records] [-m lookups]
+ */
+
+#include "pirate_store.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SCAN_LOOKUPS 5
+#define APPEND_BATCH 1000
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *op, uint64_t count, double secs) {
+    printf("%s,%llu,%.4f,%.0f\n", op, (unsigned long long)count, secs,
+           secs > 0 ? count / secs : 0.0);
+    fflush(stdout);
+}
+
+static void make_pirate(uint64_t i, struct pirate *p, void *arg) {
+    (void)arg;
+    snprintf(p->name, sizeof(p->name), "Pirate #%llu", (unsigned long long)i);
+    p->booty = 950 + i;
+    p->beard_len = (unsigned int)(i % 100);
+}
+
+/* 11.c 처럼 레코드를 하나씩 fread 하면서 찾는다 */
+static int64_t find_scan(const char *path, const char *name) {
+    FILE *in = fopen(path, "r");
+    char rec[PSTORE_RECORD_SIZE];
+    int64_t idx = 0;
+
+    if (!in)
+        return -1;
+    fseek(in, PSTORE_HEADER_SIZE, SEEK_SET);
+    while (fread(rec, sizeof(rec), 1, in) == 1) {
+        if (strncmp(rec, name, PSTORE_NAME_LEN) == 0) {
+            fclose(in);
+            return idx;
+        }
+        idx++;
+    }
+    fclose(in);
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = "pirates.db";
+    uint64_t n = 2000000;
+    uint64_t m = 1000000;
+    unsigned int seed = 42;
+    struct pirate p;
+    char name[PSTORE_NAME_LEN];
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:n:m:")) != -1) {
+        switch (opt) {
+        case 'f': path = optarg; break;
+        case 'n': n = strtoull(optarg, NULL, 10); break;
+        case 'm': m = strtoull(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "Usage: %s [-f path] [-n records] [-m lookups]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (n == 0) {
+        fprintf(stderr, "records must be > 0\n");
+        return 1;
+    }
+
+    printf("op,count,seconds,ops_per_sec\n");
+
+    double t0 = now_sec();
+    if (pstore_bulk_load(path, n, make_pirate, NULL) == -1) {
+        perror("pstore_bulk_load");
+        return 1;
+    }
+    report("bulk_load", n, now_sec() - t0);
+
+    t0 = now_sec();
+    struct pstore *s = pstore_open(path);
+    if (!s) {
+        perror("pstore_open");
+        return 1;
+    }
+    report("open", 1, now_sec() - t0);
+
+    uint64_t checksum = 0;
+    t0 = now_sec();
+    for (uint64_t i = 0; i < m; i++) {
+        pstore_get(s, (uint64_t)rand_r(&seed) % n, &p);
+        checksum += p.booty;
+    }
+    report("get_random", m, now_sec() - t0);
+
+    uint64_t found = 0;
+    t0 = now_sec();
+    for (uint64_t i = 0; i < m; i++) {
+        uint64_t want = (uint64_t)rand_r(&seed) % n;
+        snprintf(name, sizeof(name), "Pirate #%llu", (unsigned long long)want);
+        if (pstore_find(s, name, &p) == (int64_t)want)
+            found++;
+    }
+    report("find_index", m, now_sec() - t0);
+    if (found != m) {
+        fprintf(stderr, "find_index: %llu of %llu found\n",
+                (unsigned long long)found, (unsigned long long)m);
+        return 1;
+    }
+
+    t0 = now_sec();
+    for (int i = 0; i < SCAN_LOOKUPS; i++) {
+        snprintf(name, sizeof(name), "Pirate #%llu",
+                 (unsigned long long)((uint64_t)rand_r(&seed) % n));
+        find_scan(path, name);
+    }
+    report("find_scan", SCAN_LOOKUPS, now_sec() - t0);
+
+    struct pirate batch[APPEND_BATCH];
+    t0 = now_sec();
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < APPEND_BATCH; i++)
+            make_pirate(n + (uint64_t)round * APPEND_BATCH + i, &batch[i], NULL);
+        if (pstore_append(s, batch, APPEND_BATCH) == -1) {
+            perror("pstore_append");
+            return 1;
+        }
+    }
+    report("append", 10 * APPEND_BATCH, now_sec() - t0);
+
+    if (pstore_find(s, "Pirate #0", &p) != 0 || p.booty != 950) {
+        fprintf(stderr, "lookup after append failed\n");
+        return 1;
+    }
+
+    if (pstore_close(s) == -1) {
+        perror("pstore_close");
+        return 1;
+    }
+
+    fprintf(stderr, "checksum %llu\n", (unsigned long long)checksum);
+    return 0;
+}
@@ -0,0 +1,283 @@
+/*
+ * epoll Reactor - 구현
+ *
+ * 등록된 fd 마다 handler 를 하나 할당해서 epoll_data.ptr 에 넣는다.
+ * 콜백 안에서 reactor_del() 이 호출될 수 있으므로, 삭제된 handler 는
+ * 바로 free 하지 않고 이번 epoll_wait 결과를 다 처리한 뒤에 해제한다.
+ */
+
+#include "reactor.h"
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#define MAX_EVENTS 256
+
+enum handler_kind { H_FD, H_TIMER, H_WAKEUP };
+
+struct handler {
+    enum handler_kind kind;
+    int fd;
+    int dead;
+    reactor_cb cb;
+    reactor_timer_cb timer_cb;
+    void *arg;
+    struct handler *next;        /* table bucket 또는 garbage 리스트 */
+};
+
+#define TABLE_SIZE 1024          /* fd -> handler 조회용 hash table */
+
+struct reactor {
+    int epfd;
+    int wakefd;
+    atomic_int stopped;
+    struct handler wake_handler;
+    struct handler *table[TABLE_SIZE];
+    struct handler *garbage;
+};
+
+static struct handler **table_slot(struct reactor *r, int fd) {
+    struct handler **pp = &r->table[(unsigned int)fd % TABLE_SIZE];
+    while (*pp && (*pp)->fd != fd)
+        pp = &(*pp)->next;
+    return pp;
+}
+
+static uint32_t to_epoll_events(uint32_t events, int flags) {
+    if (flags & REACTOR_EDGE)
+        events |= EPOLLET;
+    return events;
+}
+
+struct reactor *reactor_create(void) {
+    struct reactor *r = calloc(1, sizeof(*r));
+    if (!r)
+        return NULL;
+
+    r->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (r->epfd == -1) {
+        free(r);
+        return NULL;
+    }
+
+    r->wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (r->wakefd == -1) {
+        close(r->epfd);
+        free(r);
+        return NULL;
+    }
+
+    r->wake_handler.kind = H_WAKEUP;
+    r->wake_handler.fd = r->wakefd;
+
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &r->wake_handler };
+    if (epoll_ctl(r->epfd, EPOLL_CTL_ADD, r->wakefd, &ev) == -1) {
+        close(r->wakefd);
+        close(r->epfd);
+        free(r);
+        return NULL;
+    }
+    return r;
+}
+
+static void collect_garbage(struct reactor *r) {
+    while (r->garbage) {
+        struct handler *h = r->garbage;
+        r->garbage = h->next;
+        free(h);
+    }
+}
+
+void reactor_destroy(struct reactor *r) {
+    for (int i = 0; i < TABLE_SIZE; i++) {
+        struct handler *h = r->table[i];
+        while (h) {
+            struct handler *next = h->next;
+            /* timerfd 는 reactor 가 만든 것이므로 닫는다 */
+            if (h->kind == H_TIMER)
+                close(h->fd);
+            free(h);
+            h = next;
+        }
+    }
+    collect_garbage(r);
+    close(r->wakefd);
+    close(r->epfd);
+    free(r);
+}
+
+static struct handler *add_handler(struct reactor *r, int fd, uint32_t events) {
+    struct handler **pp = table_slot(r, fd);
+    if (*pp) {
+        errno = EEXIST;
+        return NULL;
+    }
+
+    struct handler *h = calloc(1, sizeof(*h));
+    if (!h)
+        return NULL;
+    h->fd = fd;
+
+    struct epoll_event ev = { .events = events, .data.ptr = h };
+    if (epoll_ctl(r->epfd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        free(h);
+        return NULL;
+    }
+    *pp = h;
+    return h;
+}
+
+int reactor_add(struct reactor *r, int fd, uint32_t events, int flags,
+                reactor_cb cb, void *arg) {
+    struct handler *h = add_handler(r, fd, to_epoll_events(events, flags));
+    if (!h)
+        return -1;
+    h->kind = H_FD;
+    h->cb = cb;
+    h->arg = arg;
+    return 0;
+}
+
+int reactor_mod(struct reactor *r, int fd, uint32_t events, int flags) {
+    struct handler *h = *table_slot(r, fd);
+    if (!h) {
+        errno = ENOENT;
+        return -1;
+    }
+    struct epoll_event ev = { .events = to_epoll_events(events, flags), .data.ptr = h };
+    return epoll_ctl(r->epfd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+int reactor_del(struct reactor *r, int fd) {
+    struct handler **pp = table_slot(r, fd);
+    struct handler *h = *pp;
+    if (!h) {
+        errno = ENOENT;
+        return -1;
+    }
+    *pp = h->next;
+
+    int ret = epoll_ctl(r->epfd, EPOLL_CTL_DEL, fd, NULL);
+
+    /* 같은 epoll_wait 결과에 이 handler 가 남아있을 수 있으므로 지연 해제 */
+    h->dead = 1;
+    h->next = r->garbage;
+    r->garbage = h;
+    return ret;
+}
+
+int reactor_add_timer(struct reactor *r, unsigned int timeout_ms, int periodic,
+                      reactor_timer_cb cb, void *arg) {
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd == -1)
+        return -1;
+
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = timeout_ms / 1000;
+    its.it_value.tv_nsec = (long)(timeout_ms % 1000) * 1000000;
+    /* it_value 가 0 이면 timer 가 꺼지므로 최소 1ns */
+    if (timeout_ms == 0)
+        its.it_value.tv_nsec = 1;
+    if (periodic)
+        its.it_interval = its.it_value;
+
+    if (timerfd_settime(tfd, 0, &its, NULL) == -1) {
+        close(tfd);
+        return -1;
+    }
+
+    struct handler *h = add_handler(r, tfd, EPOLLIN);
+    if (!h) {
+        close(tfd);
+        return -1;
+    }
+    h->kind = H_TIMER;
+    h->timer_cb = cb;
+    h->arg = arg;
+    return tfd;
+}
+
+int reactor_cancel_timer(struct reactor *r, int timer_id) {
+    /* 이미 끝난 timer 의 id 는 다른 fd 로 재사용됐을 수 있으므로 timer 일 때만 닫는다 */
+    struct handler *h = *table_slot(r, timer_id);
+    if (!h || h->kind != H_TIMER) {
+        errno = ENOENT;
+        return -1;
+    }
+    int ret = reactor_del(r, timer_id);
+    close(timer_id);
+    return ret;
+}
+
+int reactor_wakeup(struct reactor *r) {
+    uint64_t one = 1;
+    if (write(r->wakefd, &one, sizeof(one)) == -1 && errno != EAGAIN)
+        return -1;
+    return 0;
+}
+
+void reactor_stop(struct reactor *r) {
+    atomic_store(&r->stopped, 1);
+    reactor_wakeup(r);
+}
+
+int reactor_run_once(struct reactor *r, int timeout_ms) {
+    struct epoll_event events[MAX_EVENTS];
+
+    int n = epoll_wait(r->epfd, events, MAX_EVENTS, timeout_ms);
+    if (n == -1) {
+        if (errno == EINTR)
+            return 0;
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        struct handler *h = events[i].data.ptr;
+        if (h->dead)
+            continue;
+
+        switch (h->kind) {
+        case H_WAKEUP: {
+            uint64_t count;
+            while (read(r->wakefd, &count, sizeof(count)) > 0)
+                ;
+            break;
+        }
+        case H_TIMER: {
+            uint64_t expirations;
+            if (read(h->fd, &expirations, sizeof(expirations)) == -1)
+                break;
+            int tfd = h->fd;
+            struct itimerspec cur;
+            int oneshot = timerfd_gettime(tfd, &cur) == 0 &&
+                          cur.it_interval.tv_sec == 0 && cur.it_interval.tv_nsec == 0;
+            h->timer_cb(r, tfd, h->arg);
+            /* one-shot timer 는 콜백이 끝난 뒤 정리. 콜백 안에서는 tfd 가 아직 열려 있어
+             * 스스로 cancel 해도 되고, 그랬으면 h 는 dead (해제는 collect_garbage) */
+            if (oneshot && !h->dead)
+                reactor_cancel_timer(r, tfd);
+            break;
+        }
+        case H_FD:
+            h->cb(r, h->fd, events[i].events, h->arg);
+            break;
+        }
+    }
+
+    collect_garbage(r);
+    return n;
+}
+
+int reactor_run(struct reactor *r) {
+    while (!atomic_load(&r->stopped)) {
+        if (reactor_run_once(r, -1) == -1)
+            return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * epoll Reactor
+ *
+ * 10.c 의 select() 와 4.c 의 usleep() polling 을 대체하는 이벤트 루프.
+ *
+ *   - fd 감시: epoll (level / edge-triggered 선택)
+ *   - timeout: timerfd (select 의 timeval 대신 fd 로 취급)
+ *   - wakeup : eventfd (다른 스레드에서 루프를 깨우거나 멈출 때)
+ *
+ * 콜백은 모두 reactor_run() 을 호출한 스레드에서 실행된다.
+ * reactor_wakeup() / reactor_stop() 만 다른 스레드에서 호출해도 안전하다.
+ *
+ * 사용 예:
+ *   struct reactor *r = reactor_create();
+ *   reactor_add(r, fd, EPOLLIN, REACTOR_EDGE, on_readable, ctx);
+ *   reactor_add_timer(r, 30000, 0, on_timeout, ctx);
+ *   reactor_run(r);
+ *   reactor_destroy(r);
+ *
+ * Build: gcc -O2 -c reactor.c
+ */
+
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <stdint.h>
+#include <sys/epoll.h>
+
+#define REACTOR_EDGE 0x1     /* EPOLLET: 상태 변화 시에만 통지, EAGAIN 까지 읽어야 함 */
+
+struct reactor;
+
+/* events: EPOLLIN/EPOLLOUT/EPOLLERR/EPOLLHUP 조합 */
+typedef void (*reactor_cb)(struct reactor *r, int fd, uint32_t events, void *arg);
+
+/* timer_id 는 reactor_add_timer() 가 반환한 값 */
+typedef void (*reactor_timer_cb)(struct reactor *r, int timer_id, void *arg);
+
+struct reactor *reactor_create(void);
+void reactor_destroy(struct reactor *r);
+
+int reactor_add(struct reactor *r, int fd, uint32_t events, int flags,
+                reactor_cb cb, void *arg);
+int reactor_mod(struct reactor *r, int fd, uint32_t events, int flags);
+int reactor_del(struct reactor *r, int fd);
+
+/* timeout_ms 후 호출. periodic 이면 같은 주기로 반복. 실패 시 -1
+ * timer fd 는 reactor 가 소유한다 (호출자는 닫지 않는다). one-shot 은 콜백이
+ * 돌아온 뒤, periodic 은 reactor_cancel_timer() 나 reactor_destroy() 에서 닫힌다.
+ * 이미 닫힌 timer 를 cancel 하면 -1 (ENOENT) 이고 아무것도 닫지 않는다 */
+int reactor_add_timer(struct reactor *r, unsigned int timeout_ms, int periodic,
+                      reactor_timer_cb cb, void *arg);
+int reactor_cancel_timer(struct reactor *r, int timer_id);
+
+/* 다른 스레드에서 epoll_wait 를 깨운다 */
+int reactor_wakeup(struct reactor *r);
+
+/* reactor_run() 을 끝낸다 (다른 스레드에서 호출 가능) */
+void reactor_stop(struct reactor *r);
+
+/* 이벤트를 한 번 처리. 처리한 이벤트 수, 실패 시 -1 */
+int reactor_run_once(struct reactor *r, int timeout_ms);
+
+/* reactor_stop() 이 호출될 때까지 반복 */
+int reactor_run(struct reactor *r);
+
+#endif
@@ -0,0 +1,259 @@
+/*
+ * Wakeup Latency Benchmark: usleep polling vs select() vs epoll reactor
+ *
+ * N 개의 pipe 를 만들고 sender 스레드가 그중 하나에 timestamp 를 쓴다.
+ * receiver 가 그 메시지를 읽을 때까지 걸린 시간을 wakeup latency 로 잰다.
+ *
+ *   usleep - 4.c 방식: 모든 fd 를 non-blocking read, 없으면 usleep()
+ *   select - 10.c 방식: 매번 fd_set 을 다시 채우고 select() (fd < FD_SETSIZE)
+ *   epoll  - reactor.c (edge-triggered)
+ *
+ * receiver 스레드의 CPU 시간도 같이 출력한다 (polling 의 CPU 낭비 확인용).
+ *
+ * Output (CSV): mode,fds,iters,p50_us,p99_us,max_us,cpu_ms
+ *
+ * Build: gcc -O2 -pthread -o reactor_bench reactor_bench.c reactor.c
+ * Usage: ./reactor_bench [-n iters] [-F max_fds] [-u usleep_us]
+ */
+
+#define _GNU_SOURCE
+#include "reactor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+
+enum mode { MODE_USLEEP, MODE_SELECT, MODE_EPOLL, MODE_COUNT };
+
+static const char *mode_names[MODE_COUNT] = { "usleep", "select", "epoll" };
+
+struct bench {
+    enum mode mode;
+    int nfds;
+    int iters;
+    int usleep_us;
+    int (*pipes)[2];
+
+    atomic_int received;
+    uint64_t *lat_ns;
+    double cpu_ms;
+};
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* 메시지 하나 읽고 latency 기록. 읽은 메시지 수 반환 */
+static int drain(struct bench *b, int fd) {
+    uint64_t sent;
+    int got = 0;
+    while (read(fd, &sent, sizeof(sent)) == sizeof(sent)) {
+        int idx = atomic_load(&b->received);
+        b->lat_ns[idx] = now_ns() - sent;
+        atomic_store(&b->received, idx + 1);
+        got++;
+    }
+    return got;
+}
+
+static void recv_usleep(struct bench *b) {
+    while (atomic_load(&b->received) < b->iters) {
+        int got = 0;
+        for (int i = 0; i < b->nfds; i++)
+            got += drain(b, b->pipes[i][0]);
+        if (!got)
+            usleep(b->usleep_us);
+    }
+}
+
+static void recv_select(struct bench *b) {
+    int maxfd = 0;
+    for (int i = 0; i < b->nfds; i++)
+        if (b->pipes[i][0] > maxfd)
+            maxfd = b->pipes[i][0];
+
+    while (atomic_load(&b->received) < b->iters) {
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        for (int i = 0; i < b->nfds; i++)
+            FD_SET(b->pipes[i][0], &readfds);
+
+        int ret = select(maxfd + 1, &readfds, NULL, NULL, NULL);
+        if (ret == -1) {
+            if (errno == EINTR)
+                continue;
+            perror("select");
+            return;
+        }
+        for (int i = 0; i < b->nfds && ret > 0; i++) {
+            if (FD_ISSET(b->pipes[i][0], &readfds)) {
+                drain(b, b->pipes[i][0]);
+                ret--;
+            }
+        }
+    }
+}
+
+static void on_pipe(struct reactor *r, int fd, uint32_t events, void *arg) {
+    struct bench *b = arg;
+    (void)events;
+    drain(b, fd);
+    if (atomic_load(&b->received) >= b->iters)
+        reactor_stop(r);
+}
+
+static void recv_epoll(struct bench *b) {
+    struct reactor *r = reactor_create();
+    if (!r) {
+        perror("reactor_create");
+        return;
+    }
+    for (int i = 0; i < b->nfds; i++) {
+        if (reactor_add(r, b->pipes[i][0], EPOLLIN, REACTOR_EDGE, on_pipe, b) == -1) {
+            perror("reactor_add");
+            reactor_destroy(r);
+            return;
+        }
+    }
+    reactor_run(r);
+    reactor_destroy(r);
+}
+
+static void *receiver_main(void *arg) {
+    struct bench *b = arg;
+    struct rusage ru;
+
+    switch (b->mode) {
+    case MODE_USLEEP: recv_usleep(b); break;
+    case MODE_SELECT: recv_select(b); break;
+    case MODE_EPOLL:  recv_epoll(b); break;
+    default: break;
+    }
+
+    getrusage(RUSAGE_THREAD, &ru);
+    b->cpu_ms = ru.ru_utime.tv_sec * 1e3 + ru.ru_utime.tv_usec / 1e3 +
+                ru.ru_stime.tv_sec * 1e3 + ru.ru_stime.tv_usec / 1e3;
+    return NULL;
+}
+
+static int run(enum mode mode, int nfds, int iters, int usleep_us) {
+    struct bench b;
+    memset(&b, 0, sizeof(b));
+    b.mode = mode;
+    b.nfds = nfds;
+    b.iters = iters;
+    b.usleep_us = usleep_us;
+    b.pipes = calloc(nfds, sizeof(*b.pipes));
+    b.lat_ns = calloc(iters, sizeof(uint64_t));
+    if (!b.pipes || !b.lat_ns) {
+        perror("calloc");
+        return -1;
+    }
+
+    int opened = 0, rc = 0;
+    for (; opened < nfds; opened++) {
+        if (pipe2(b.pipes[opened], O_NONBLOCK) == -1) {
+            perror("pipe2");
+            rc = -1;
+            goto out;
+        }
+    }
+
+    pthread_t tid;
+    pthread_create(&tid, NULL, receiver_main, &b);
+    usleep(10000);   /* receiver 가 대기 상태에 들어가도록 */
+
+    /* 메시지마다 임의의 pipe 하나에 보내고, 받을 때까지 기다린 뒤 다음 전송 */
+    unsigned int seed = 12345;
+    for (int i = 0; i < iters; i++) {
+        int k = rand_r(&seed) % nfds;
+        uint64_t ts = now_ns();
+        if (write(b.pipes[k][1], &ts, sizeof(ts)) != sizeof(ts)) {
+            perror("write");
+            rc = -1;
+            break;
+        }
+        while (atomic_load(&b.received) <= i)
+            usleep(50);
+        usleep(1000 + rand_r(&seed) % 1000);
+    }
+    pthread_join(tid, NULL);
+
+    if (rc == 0) {
+        qsort(b.lat_ns, iters, sizeof(uint64_t), cmp_u64);
+        printf("%s,%d,%d,%.1f,%.1f,%.1f,%.1f\n", mode_names[mode], nfds, iters,
+               b.lat_ns[iters / 2] / 1000.0, b.lat_ns[iters * 99 / 100] / 1000.0,
+               b.lat_ns[iters - 1] / 1000.0, b.cpu_ms);
+        fflush(stdout);
+    }
+
+out:
+    for (int i = 0; i < opened; i++) {
+        close(b.pipes[i][0]);
+        close(b.pipes[i][1]);
+    }
+    free(b.pipes);
+    free(b.lat_ns);
+    return rc;
+}
+
+int main(int argc, char *argv[]) {
+    int iters = 200;
+    int max_fds = 4096;
+    int usleep_us = 100000;  /* 4.c 와 같은 100ms */
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:F:u:")) != -1) {
+        switch (opt) {
+        case 'n': iters = atoi(optarg); break;
+        case 'F': max_fds = atoi(optarg); break;
+        case 'u': usleep_us = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-n iters] [-F max_fds] [-u usleep_us]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (iters < 1 || max_fds < 1) {
+        fprintf(stderr, "iters and max_fds must be > 0\n");
+        return 1;
+    }
+
+    /* pipe 하나에 fd 2개 - 가능한 만큼 fd 한도를 올린다 */
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+        if ((rlim_t)max_fds * 2 + 16 > rl.rlim_cur) {
+            max_fds = (int)((rl.rlim_cur - 16) / 2);
+            fprintf(stderr, "fd limit: max_fds reduced to %d\n", max_fds);
+        }
+    }
+
+    printf("mode,fds,iters,p50_us,p99_us,max_us,cpu_ms\n");
+    for (int nfds = 1; nfds <= max_fds; nfds *= 4) {
+        for (int m = 0; m < MODE_COUNT; m++) {
+            /* select() 는 FD_SETSIZE 이상의 fd 번호를 다룰 수 없다 */
+            if (m == MODE_SELECT && nfds * 2 + 16 > FD_SETSIZE)
+                continue;
+            if (run(m, nfds, iters, usleep_us))
+                return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Crash-Safe Framed Record Log
+ *
+ * 5.c ~ 8.c 는 log.txt 에 문자열을 O_APPEND 로 그냥 붙인다. 쓰는 도중 전원이
+ * 나가면 꼬리에 반쯤 쓴 쓰레기가 남고, record 경계는 처음부터 모든 바이트를
+ * 읽어야 알 수 있다.
+ *
+ * rlog 는 record 마다 frame 을 씌운다 (little-endian, 8 바이트 정렬):
+ *
+ *   +0  magic   u32  "RLG1"
+ *   +4  len     u32  payload 길이
+ *   +8  seq     u64
+ *   +16 crc     u32  CRC32C(len, seq, payload)
+ *   +20 (0)     u32
+ *   +24 payload, 8 바이트 단위까지 0 으로 채움
+ *
+ *   - append: frame 전체를 O_APPEND writev 한 번으로 쓰므로 여러 스레드/프로세스가
+ *             동시에 써도 frame 이 섞이지 않는다
+ *   - seq: <path>.seq 를 공유 매핑한 카운터에서 atomic 으로 받는다. 프로세스
+ *          사이에서도 유일하고 증가하지만, 동시에 쓰는 writer 끼리는 파일
+ *          순서와 seq 순서가 조금 바뀔 수 있다
+ *   - CRC32C: x86 SSE4.2 / ARMv8 CRC 명령이 있으면 사용, 없으면 slicing-by-8 표
+ *   - 복구: rlog_open 이 (다른 프로세스가 열고 있지 않으면) 파일을 mmap 해서
+ *           frame 을 따라가며 CRC 를 확인하고, 마지막 정상 record 뒤의 찢어진
+ *           꼬리를 ftruncate 한다 (9.c 의 truncate). 중간에 망가진 구간 뒤에 정상
+ *           frame 이 더 있으면 (짧은 write 등) 그 구간은 건너뛰고 자르지 않는다
+ *
+ * 사용 예:
+ *   struct rlog_recovery rec;
+ *   struct rlog *l = rlog_open("log.rlg", &rec);
+ *   int64_t seq = rlog_append(l, msg, strlen(msg));
+ *   rlog_sync(l);
+ *   rlog_close(l);
+ *
+ *   struct rlog_iter *it = rlog_iter_open("log.rlg");
+ *   struct rlog_record r;
+ *   while (rlog_iter_next(it, &r) > 0) ...
+ *
+ * Build: gcc -O2 -pthread -c rec_log.c
+ */
+
+#ifndef REC_LOG_H
+#define REC_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#define RLOG_MAX_RECORD (64 * 1024 * 1024)
+
+struct rlog_recovery {
+    int scanned;                 /* 0 이면 다른 프로세스가 사용 중이라 검사하지 않음 */
+    uint64_t records;            /* 정상 record 수 */
+    uint64_t valid_bytes;        /* 정상 frame 이 끝나는 위치 (= 잘라낸 뒤 크기) */
+    uint64_t skipped_bytes;      /* 중간의 망가진 구간 */
+    uint64_t truncated_bytes;    /* 잘라낸 꼬리 */
+    uint64_t last_seq;
+    double seconds;
+};
+
+struct rlog_record {
+    uint64_t seq;
+    uint64_t offset;             /* frame 시작 위치 */
+    const void *data;            /* 매핑 안을 가리킴, iter 를 닫기 전까지 유효 */
+    size_t len;
+};
+
+struct rlog;
+struct rlog_iter;
+
+/* 없으면 만든다. rec 는 NULL 가능. 실패 시 NULL + errno */
+struct rlog *rlog_open(const char *path, struct rlog_recovery *rec);
+
+/* 쓴 record 의 seq, 실패 시 -1 + errno (len > RLOG_MAX_RECORD 면 EMSGSIZE) */
+int64_t rlog_append(struct rlog *l, const void *buf, size_t len);
+int64_t rlog_appendv(struct rlog *l, const struct iovec *iov, int iovcnt);
+
+int rlog_sync(struct rlog *l);
+int rlog_close(struct rlog *l);
+
+/* 열 때의 파일 크기까지 읽는다. 망가진 구간은 건너뛴다 */
+struct rlog_iter *rlog_iter_open(const char *path);
+int rlog_iter_next(struct rlog_iter *it, struct rlog_record *r);   /* 1, 0 = 끝 */
+uint64_t rlog_iter_skipped(const struct rlog_iter *it);
+void rlog_iter_close(struct rlog_iter *it);
+
+uint32_t rlog_crc32c(uint32_t crc, const void *buf, size_t len);
+uint32_t rlog_crc32c_sw(uint32_t crc, const void *buf, size_t len);
+int rlog_crc32c_hw(void);        /* 하드웨어 명령을 쓰면 1 */
+
+#endif
@@ -0,0 +1,385 @@
+/*
+ * Framed Record Log Benchmark
+ *
+ *   crc       - CRC32C slicing-by-8 표 vs 하드웨어 명령 (GB/s)
+ *   append    - 스레드 여러 개가 5.c 처럼 O_APPEND write 로 그냥 붙이기 vs rlog_append
+ *   fork      - 프로세스 여러 개가 같은 log 에 rlog_append. iter 로 읽어 record 수와
+ *               seq 가 모두 다른지 확인
+ *   recover   - 큰 log 뒤에 찢어진 frame 을 붙이고 rlog_open 의 복구 검사 속도.
+ *               잘린 크기와 record 수를 확인
+ *
+ * Output (CSV): test,variant,workers,records,bytes,seconds,mb_per_sec
+ *
+ * Build: gcc -O2 -pthread -o rec_log_bench rec_log_bench.c rec_log.c
+ * Usage: ./rec_log_bench [-f path] [-s record_size] [-n records_per_worker] [-t max_workers] [-r recover_size]
+ */
+
+#define _GNU_SOURCE
+#include "rec_log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+struct bench {
+    const char *path;
+    size_t rec_size;
+    long records;
+    int framed;
+    int raw_fd;
+    struct rlog *log;
+};
+
+struct worker_arg {
+    struct bench *b;
+    int id;
+    int failed;
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    }
+    return v;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void report(const char *test, const char *variant, int workers, uint64_t records,
+                   uint64_t bytes, double secs) {
+    printf("%s,%s,%d,%llu,%llu,%.4f,%.1f\n", test, variant, workers,
+           (unsigned long long)records, (unsigned long long)bytes, secs,
+           bytes / secs / (1024.0 * 1024.0));
+    fflush(stdout);
+}
+
+static void remove_log(const char *path) {
+    char seq_path[4096];
+    snprintf(seq_path, sizeof(seq_path), "%s.seq", path);
+    unlink(path);
+    unlink(seq_path);
+}
+
+/* payload: worker id 와 번호로 채워서 읽을 때 확인할 수 있게 */
+static void fill_record(char *buf, size_t len, int id, long i) {
+    memset(buf, 'a' + (i + id) % 26, len);
+    if (len >= 12) {
+        memcpy(buf, &id, 4);
+        memcpy(buf + 4, &i, 8);
+    }
+}
+
+static int bench_crc(void) {
+    size_t len = 64 << 20;
+    char *buf = malloc(len);
+    if (!buf)
+        return -1;
+    for (size_t i = 0; i < len; i++)
+        buf[i] = (char)(i * 131 + 7);
+
+    double t0 = now_sec();
+    uint32_t sw = rlog_crc32c_sw(0, buf, len);
+    report("crc", "slice8", 1, 1, len, now_sec() - t0);
+
+    int ret = 0;
+    if (rlog_crc32c_hw()) {
+        t0 = now_sec();
+        uint32_t hw = rlog_crc32c(0, buf, len);
+        report("crc", "hw", 1, 1, len, now_sec() - t0);
+        if (hw != sw) {
+            fprintf(stderr, "crc mismatch: hw %08x sw %08x\n", hw, sw);
+            ret = -1;
+        }
+    }
+    /* "123456789" 의 CRC32C 는 0xe3069283 */
+    if (rlog_crc32c(0, "123456789", 9) != 0xe3069283u ||
+        rlog_crc32c_sw(0, "123456789", 9) != 0xe3069283u) {
+        fprintf(stderr, "crc check value mismatch\n");
+        ret = -1;
+    }
+    free(buf);
+    return ret;
+}
+
+static void *append_worker(void *arg) {
+    struct worker_arg *w = arg;
+    struct bench *b = w->b;
+    char *buf = malloc(b->rec_size);
+
+    if (!buf) {
+        w->failed = 1;
+        return NULL;
+    }
+    for (long i = 0; i < b->records; i++) {
+        fill_record(buf, b->rec_size, w->id, i);
+        if (b->framed) {
+            if (rlog_append(b->log, buf, b->rec_size) == -1) {
+                w->failed = 1;
+                break;
+            }
+        } else if (write(b->raw_fd, buf, b->rec_size) != (ssize_t)b->rec_size) {
+            w->failed = 1;
+            break;
+        }
+    }
+    free(buf);
+    return NULL;
+}
+
+/* 모든 record 가 한 번씩, 내용 그대로 있는지 */
+static int verify_log(const char *path, size_t rec_size, int workers, long records) {
+    struct rlog_iter *it = rlog_iter_open(path);
+    if (!it)
+        return -1;
+
+    uint64_t total = (uint64_t)workers * records, n = 0;
+    uint64_t *seqs = malloc(total * sizeof(*seqs));
+    char *expect = malloc(rec_size);
+    struct rlog_record r;
+    int ok = seqs && expect;
+
+    while (ok && rlog_iter_next(it, &r) > 0) {
+        int id = 0;
+        long i = 0;
+        if (n == total || r.len != rec_size) {
+            ok = 0;
+            break;
+        }
+        if (rec_size >= 12) {
+            memcpy(&id, r.data, 4);
+            memcpy(&i, (const char *)r.data + 4, 8);
+        }
+        fill_record(expect, rec_size, id, i);
+        if (memcmp(expect, r.data, rec_size) != 0)
+            ok = 0;
+        seqs[n++] = r.seq;
+    }
+    ok = ok && n == total && rlog_iter_skipped(it) == 0;
+    if (ok) {
+        qsort(seqs, n, sizeof(*seqs), cmp_u64);
+        for (uint64_t k = 1; k < n; k++)
+            if (seqs[k] == seqs[k - 1])
+                ok = 0;
+    }
+    free(seqs);
+    free(expect);
+    rlog_iter_close(it);
+    return ok ? 0 : -1;
+}
+
+static int bench_append(struct bench *b, int threads) {
+    pthread_t *tids = malloc(threads * sizeof(*tids));
+    struct worker_arg *args = calloc(threads, sizeof(*args));
+    int ret = 0;
+
+    if (!tids || !args) {
+        free(tids);
+        free(args);
+        return -1;
+    }
+    remove_log(b->path);
+    if (b->framed) {
+        b->log = rlog_open(b->path, NULL);
+        if (!b->log)
+            ret = -1;
+    } else {
+        b->raw_fd = open(b->path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (b->raw_fd < 0)
+            ret = -1;
+    }
+
+    double t0 = now_sec();
+    for (int i = 0; ret == 0 && i < threads; i++) {
+        args[i].b = b;
+        args[i].id = i;
+        pthread_create(&tids[i], NULL, append_worker, &args[i]);
+    }
+    for (int i = 0; ret == 0 && i < threads; i++) {
+        pthread_join(tids[i], NULL);
+        if (args[i].failed)
+            ret = -1;
+    }
+    double secs = now_sec() - t0;
+
+    if (b->framed && b->log)
+        rlog_close(b->log);
+    else if (!b->framed && b->raw_fd >= 0)
+        close(b->raw_fd);
+
+    if (ret == 0 && b->framed && verify_log(b->path, b->rec_size, threads, b->records) == -1) {
+        fprintf(stderr, "append verify failed (%d threads)\n", threads);
+        ret = -1;
+    }
+    if (ret == 0) {
+        uint64_t n = (uint64_t)threads * b->records;
+        report("append", b->framed ? "rlog" : "raw", threads, n, n * b->rec_size, secs);
+    }
+    free(tids);
+    free(args);
+    return ret;
+}
+
+/* 자식 프로세스마다 따로 rlog_open: seq 는 .seq 공유 매핑으로 유일해야 한다 */
+static int bench_fork(struct bench *b, int procs) {
+    remove_log(b->path);
+
+    double t0 = now_sec();
+    for (int p = 0; p < procs; p++) {
+        pid_t pid = fork();
+        if (pid == -1)
+            return -1;
+        if (pid == 0) {
+            struct bench cb = *b;
+            struct worker_arg w = { .b = &cb, .id = p };
+            cb.framed = 1;
+            cb.log = rlog_open(b->path, NULL);
+            if (!cb.log)
+                _exit(1);
+            append_worker(&w);
+            rlog_close(cb.log);
+            _exit(w.failed);
+        }
+    }
+    int ret = 0, status;
+    while (wait(&status) > 0)
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            ret = -1;
+    double secs = now_sec() - t0;
+
+    if (ret == 0 && verify_log(b->path, b->rec_size, procs, b->records) == -1) {
+        fprintf(stderr, "fork verify failed (%d procs)\n", procs);
+        ret = -1;
+    }
+    if (ret == 0) {
+        uint64_t n = (uint64_t)procs * b->records;
+        report("fork", "rlog", procs, n, n * b->rec_size, secs);
+    }
+    return ret;
+}
+
+/* 찢어진 꼬리: 다음 frame 의 앞부분만 쓰인 상태를 흉내낸다 */
+static int bench_recover(struct bench *b, uint64_t log_size) {
+    char *buf = malloc(b->rec_size);
+    struct rlog_recovery rec;
+    int ret = -1;
+
+    if (!buf)
+        return -1;
+    remove_log(b->path);
+    struct rlog *l = rlog_open(b->path, NULL);
+    if (!l)
+        goto out;
+    long n = 0;
+    for (uint64_t done = 0; done < log_size; done += b->rec_size + 24, n++) {
+        fill_record(buf, b->rec_size, 0, n);
+        if (rlog_append(l, buf, b->rec_size) == -1) {
+            rlog_close(l);
+            goto out;
+        }
+    }
+    rlog_close(l);
+
+    struct stat st;
+    if (stat(b->path, &st) == -1)
+        goto out;
+    off_t good = st.st_size;
+
+    /* 정상 frame 을 하나 더 붙인 뒤 중간에서 자른다 */
+    l = rlog_open(b->path, NULL);
+    if (!l || rlog_append(l, buf, b->rec_size) == -1)
+        goto out;
+    rlog_close(l);
+    if (stat(b->path, &st) == -1 || truncate(b->path, good + (st.st_size - good) / 2) == -1)
+        goto out;
+    uint64_t torn = (st.st_size - good) / 2;
+
+    l = rlog_open(b->path, &rec);
+    if (!l)
+        goto out;
+    /* 복구 뒤에 이어 쓴 record 도 읽혀야 한다 */
+    int64_t seq = rlog_append(l, buf, b->rec_size);
+    rlog_close(l);
+
+    if (!rec.scanned || rec.records != (uint64_t)n || rec.truncated_bytes != torn ||
+        rec.valid_bytes != (uint64_t)good || rec.skipped_bytes != 0 ||
+        seq <= (int64_t)rec.last_seq) {
+        fprintf(stderr, "recover check failed: records %llu/%ld truncated %llu/%llu seq %lld\n",
+                (unsigned long long)rec.records, n, (unsigned long long)rec.truncated_bytes,
+                (unsigned long long)torn, (long long)seq);
+        goto out;
+    }
+    report("recover", rlog_crc32c_hw() ? "hw" : "slice8", 1, rec.records, rec.valid_bytes,
+           rec.seconds);
+    ret = 0;
+out:
+    free(buf);
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    struct bench b = { .path = "rec_log_bench.rlg", .rec_size = 100, .records = 100000 };
+    int max_workers = 8;
+    uint64_t recover_size = 256 << 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:s:n:t:r:")) != -1) {
+        switch (opt) {
+        case 'f': b.path = optarg; break;
+        case 's': b.rec_size = parse_size(optarg); break;
+        case 'n': b.records = atol(optarg); break;
+        case 't': max_workers = atoi(optarg); break;
+        case 'r': recover_size = parse_size(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-f path] [-s record_size] [-n records_per_worker] "
+                    "[-t max_workers] [-r recover_size]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (b.rec_size < 1 || b.rec_size > RLOG_MAX_RECORD || b.records < 1 || max_workers < 1) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    printf("test,variant,workers,records,bytes,seconds,mb_per_sec\n");
+    if (bench_crc() == -1)
+        return 1;
+    for (int framed = 0; framed <= 1; framed++) {
+        b.framed = framed;
+        for (int t = 1; t <= max_workers; t *= 2) {
+            if (bench_append(&b, t) == -1) {
+                perror("append");
+                return 1;
+            }
+        }
+    }
+    for (int p = 1; p <= max_workers; p *= 2) {
+        if (bench_fork(&b, p) == -1) {
+            perror("fork");
+            return 1;
+        }
+    }
+    int ret = bench_recover(&b, recover_size) == 0 ? 0 : 1;
+    remove_log(b.path);
+    return ret;
+}
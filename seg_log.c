@@ -0,0 +1,588 @@
+/*
+ * Preallocated, Recycled Log Segments
+ *
+ * Build: gcc -O2 -pthread -c seg_log.c rec_log.c
+ */
+
+#define _GNU_SOURCE
+#include "seg_log.h"
+#include "rec_log.h"
+
+#include <dirent.h>
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#define MAGIC 0x31474c53u        /* "SLG1" little-endian */
+#define HDR_SIZE 24
+#define FILL_CHUNK (1 << 20)
+
+struct seglist {
+    uint64_t *v;
+    size_t n, cap;
+};
+
+struct seglog {
+    pthread_mutex_t lock;
+    int dir_fd;
+    uint64_t seg_size;
+    unsigned int keep_free;
+    int fill;
+
+    int fd;                      /* 쓰는 중인 segment */
+    uint64_t seg;
+    uint64_t off;
+
+    struct seglist live;         /* 오름차순, 마지막이 쓰는 중 */
+    struct seglist free;         /* recycle-* */
+    struct seglog_stats stats;
+};
+
+struct seglog_iter {
+    int dir_fd;
+    struct seglist segs;
+    size_t idx;
+    const unsigned char *base;
+    uint64_t size;
+    uint64_t off;
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t pad8(size_t len) {
+    return (len + 7) & ~(size_t)7;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int seglist_push(struct seglist *s, uint64_t v) {
+    if (s->n == s->cap) {
+        size_t ncap = s->cap ? s->cap * 2 : 16;
+        uint64_t *p = realloc(s->v, ncap * sizeof(*p));
+        if (!p)
+            return -1;
+        s->v = p;
+        s->cap = ncap;
+    }
+    s->v[s->n++] = v;
+    return 0;
+}
+
+static void seg_name(char *buf, size_t n, const char *prefix, uint64_t seg) {
+    snprintf(buf, n, "%s-%016llx", prefix, (unsigned long long)seg);
+}
+
+/* create_segment 가 만드는 "seg-%016llx.tmp" 와 정확히 같은 이름인지 */
+static int is_tmp_name(const char *name) {
+    return strlen(name) == 24 && strncmp(name, "seg-", 4) == 0 &&
+           strspn(name + 4, "0123456789abcdef") == 16 && strcmp(name + 20, ".tmp") == 0;
+}
+
+/* seg-* 와 recycle-* 를 모은다. free_list 가 있으면 (seglog_open, 디렉터리 flock 을
+ * 쥔 writer) 만들다 만 seg-N.tmp 도 지운다. reader (iter) 는 writer 가 지금 만드는
+ * tmp 를 지우면 안 되므로 건드리지 않는다 */
+static int scan_dir(int dir_fd, struct seglist *live, struct seglist *free_list) {
+    int fd = dup(dir_fd);
+    if (fd < 0)
+        return -1;
+    DIR *d = fdopendir(fd);
+    if (!d) {
+        close(fd);
+        return -1;
+    }
+    rewinddir(d);
+
+    struct dirent *e;
+    int ret = 0;
+    while (ret == 0 && (e = readdir(d))) {
+        unsigned long long no;
+        char tail;
+        if (is_tmp_name(e->d_name)) {
+            if (free_list)
+                unlinkat(dir_fd, e->d_name, 0);
+        } else if (sscanf(e->d_name, "seg-%16llx%c", &no, &tail) == 1) {
+            ret = seglist_push(live, no);
+        } else if (free_list && sscanf(e->d_name, "recycle-%16llx%c", &no, &tail) == 1) {
+            ret = seglist_push(free_list, no);
+        }
+    }
+    closedir(d);
+    if (ret == 0)
+        qsort(live->v, live->n, sizeof(*live->v), cmp_u64);
+    return ret;
+}
+
+/* ---------- frame ---------- */
+
+static uint32_t frame_crc(uint32_t payload_crc, uint32_t len, uint64_t seg) {
+    unsigned char b[12];
+    uint32_t l = htole32(len);
+    uint64_t s = htole64(seg);
+    memcpy(b, &l, 4);
+    memcpy(b + 4, &s, 8);
+    return rlog_crc32c(payload_crc, b, sizeof(b));
+}
+
+/* off 의 frame 이 이 segment 의 정상 record 면 frame 길이, 아니면 0 */
+static uint64_t check_frame(const unsigned char *base, uint64_t size, uint64_t off,
+                            uint64_t seg, struct seglog_record *r) {
+    uint32_t magic, len, crc;
+    uint64_t fseg;
+
+    if (size - off < HDR_SIZE)
+        return 0;
+    memcpy(&magic, base + off, 4);
+    memcpy(&fseg, base + off + 8, 8);
+    if (le32toh(magic) != MAGIC || le64toh(fseg) != seg)
+        return 0;
+    memcpy(&len, base + off + 4, 4);
+    len = le32toh(len);
+    if (HDR_SIZE + pad8(len) > size - off)
+        return 0;
+    memcpy(&crc, base + off + 16, 4);
+    uint32_t c = rlog_crc32c(0, base + off + HDR_SIZE, len);
+    if (frame_crc(c, len, seg) != le32toh(crc))
+        return 0;
+
+    if (r) {
+        r->seg = seg;
+        r->offset = off;
+        r->data = base + off + HDR_SIZE;
+        r->len = len;
+    }
+    return HDR_SIZE + pad8(len);
+}
+
+/* ---------- segment 파일 ---------- */
+
+static int pwrite_all(int fd, const void *buf, size_t len, off_t off) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, off);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        p += n;
+        off += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int zero_range(int fd, uint64_t off, uint64_t len) {
+    static const char zeros[FILL_CHUNK];
+    while (len > 0) {
+        size_t n = len < FILL_CHUNK ? len : FILL_CHUNK;
+        if (pwrite_all(fd, zeros, n, off) == -1)
+            return -1;
+        off += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int fill_range(int fd, int fill, uint64_t off, uint64_t len) {
+    if (fill == SEGLOG_FILL_ZERO)
+        return zero_range(fd, off, len);
+    int err = fallocate(fd, 0, off, len);
+    if (err == -1 && (errno == EOPNOTSUPP || errno == ENOSYS))
+        err = ftruncate(fd, off + len);
+    return err;
+}
+
+/* seg-N.tmp 를 다 채우고 내구화한 뒤 rename: 반쯤 만든 segment 는 보이지 않는다 */
+static int create_segment(struct seglog *l, uint64_t seg) {
+    char name[64], tmp[80];
+    seg_name(name, sizeof(name), "seg", seg);
+    snprintf(tmp, sizeof(tmp), "%s.tmp", name);
+
+    int fd = openat(l->dir_fd, tmp, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return -1;
+    if (fill_range(fd, l->fill, 0, l->seg_size) == -1 || fsync(fd) == -1 ||
+        renameat(l->dir_fd, tmp, l->dir_fd, name) == -1 || fsync(l->dir_fd) == -1) {
+        int saved = errno;
+        close(fd);
+        unlinkat(l->dir_fd, tmp, 0);
+        errno = saved;
+        return -1;
+    }
+    l->stats.created++;
+    return fd;
+}
+
+/* 반납된 segment 가 있으면 이름만 바꿔서 쓴다: 블록도 크기도 그대로 */
+static int take_segment(struct seglog *l, uint64_t seg) {
+    if (l->free.n == 0)
+        return create_segment(l, seg);
+
+    char from[64], to[64];
+    uint64_t old = l->free.v[--l->free.n];
+    seg_name(from, sizeof(from), "recycle", old);
+    seg_name(to, sizeof(to), "seg", seg);
+    if (renameat(l->dir_fd, from, l->dir_fd, to) == -1 || fsync(l->dir_fd) == -1)
+        return -1;
+    int fd = openat(l->dir_fd, to, O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+
+    /* segment_size 를 바꿔서 연 경우: 크기가 다른 것은 버리고 새로 */
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (uint64_t)st.st_size != l->seg_size) {
+        close(fd);
+        if (unlinkat(l->dir_fd, to, 0) == -1)
+            return -1;
+        return create_segment(l, seg);
+    }
+    l->stats.recycled++;
+    return fd;
+}
+
+/* 지금 segment 를 내구화하고 다음 segment 로. lock 을 잡은 상태 */
+static int roll(struct seglog *l) {
+    if (fdatasync(l->fd) == -1)
+        return -1;
+    int fd = take_segment(l, l->seg + 1);
+    if (fd < 0)
+        return -1;
+    if (seglist_push(&l->live, l->seg + 1) == -1) {
+        close(fd);
+        return -1;
+    }
+    close(l->fd);
+    l->fd = fd;
+    l->seg++;
+    l->off = 0;
+    l->stats.rollovers++;
+    return 0;
+}
+
+/* 마지막 segment 의 끝을 찾는다. 크기가 다르면 맞추고, 찢어진 frame 은 지운다 */
+static int recover_active(struct seglog *l, struct seglog_recovery *rec) {
+    struct stat st;
+    struct seglog_record r;
+
+    if (fstat(l->fd, &st) == -1)
+        return -1;
+    if ((uint64_t)st.st_size != l->seg_size) {
+        if (ftruncate(l->fd, l->seg_size) == -1)
+            return -1;
+        if ((uint64_t)st.st_size < l->seg_size &&
+            fill_range(l->fd, l->fill, st.st_size, l->seg_size - st.st_size) == -1)
+            return -1;
+        rec->resized++;
+    }
+
+    const unsigned char *base = mmap(NULL, l->seg_size, PROT_READ, MAP_SHARED, l->fd, 0);
+    if (base == MAP_FAILED)
+        return -1;
+    madvise((void *)base, l->seg_size, MADV_SEQUENTIAL);
+
+    uint64_t off = 0, n;
+    while ((n = check_frame(base, l->seg_size, off, l->seg, &r)) > 0) {
+        rec->records++;
+        off += n;
+    }
+
+    /*
+     * off 뒤에 이 segment 번호가 붙은 header 가 남아 있으면 찢어진 frame 이거나,
+     * header page 를 잃은 frame 뒤에 먼저 디스크에 닿은 frame 들이다. 나중 append 의
+     * 끝이 그 경계에 맞으면 다시 record 로 보이므로, 마지막 것의 끝까지 0 으로 덮는다.
+     * frame 은 8 바이트 단위로 놓이므로 그 간격으로 찾는다.
+     */
+    uint64_t torn = 0;
+    for (uint64_t p = off; l->seg_size - p >= HDR_SIZE; p += 8) {
+        uint32_t magic, len;
+        uint64_t fseg;
+        memcpy(&magic, base + p, 4);
+        memcpy(&fseg, base + p + 8, 8);
+        if (le32toh(magic) != MAGIC || le64toh(fseg) != l->seg)
+            continue;
+        memcpy(&len, base + p + 4, 4);
+        uint64_t end = l->seg_size - p - HDR_SIZE < pad8(le32toh(len))
+                           ? l->seg_size : p + HDR_SIZE + pad8(le32toh(len));
+        if (end - off > torn)
+            torn = end - off;
+    }
+    munmap((void *)base, l->seg_size);
+
+    if (torn && (zero_range(l->fd, off, torn) == -1 || fdatasync(l->fd) == -1))
+        return -1;
+    rec->valid_bytes = off;
+    rec->zeroed_bytes = torn;
+    l->off = off;
+    return 0;
+}
+
+struct seglog *seglog_open(const char *dir, const struct seglog_options *opts,
+                           struct seglog_recovery *rec) {
+    struct seglog_recovery local;
+    int saved;
+
+    if (!rec)
+        rec = &local;
+    memset(rec, 0, sizeof(*rec));
+    double t0 = now_sec();
+
+    struct seglog *l = calloc(1, sizeof(*l));
+    if (!l)
+        return NULL;
+    pthread_mutex_init(&l->lock, NULL);
+    l->fd = -1;
+    l->seg_size = opts && opts->segment_size ? opts->segment_size : SEGLOG_DEFAULT_SEGMENT_SIZE;
+    l->seg_size = (l->seg_size + 4095) & ~(uint64_t)4095;
+    l->keep_free = opts && opts->keep_free ? opts->keep_free : SEGLOG_DEFAULT_KEEP_FREE;
+    l->fill = opts ? opts->fill : SEGLOG_FILL_ZERO;
+
+    if (mkdir(dir, 0755) == -1 && errno != EEXIST)
+        goto fail_free;
+    l->dir_fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (l->dir_fd < 0)
+        goto fail_free;
+    /* writer 는 하나: 두 번째 open 은 EWOULDBLOCK */
+    if (flock(l->dir_fd, LOCK_EX | LOCK_NB) == -1)
+        goto fail;
+    if (scan_dir(l->dir_fd, &l->live, &l->free) == -1)
+        goto fail;
+
+    if (l->live.n == 0) {
+        l->seg = 1;
+        l->fd = take_segment(l, l->seg);
+        if (l->fd < 0 || seglist_push(&l->live, l->seg) == -1)
+            goto fail;
+    } else {
+        char name[64];
+        l->seg = l->live.v[l->live.n - 1];
+        seg_name(name, sizeof(name), "seg", l->seg);
+        l->fd = openat(l->dir_fd, name, O_RDWR | O_CLOEXEC);
+        if (l->fd < 0 || recover_active(l, rec) == -1)
+            goto fail;
+    }
+
+    rec->segments = l->live.n;
+    rec->active_seg = l->seg;
+    rec->seconds = now_sec() - t0;
+    return l;
+
+fail:
+    saved = errno;
+    if (l->fd >= 0)
+        close(l->fd);
+    close(l->dir_fd);
+    errno = saved;
+fail_free:
+    saved = errno;
+    free(l->live.v);
+    free(l->free.v);
+    pthread_mutex_destroy(&l->lock);
+    free(l);
+    errno = saved;
+    return NULL;
+}
+
+int seglog_append(struct seglog *l, const void *buf, size_t len, struct seglog_pos *pos) {
+    static const unsigned char zeros[8];
+    unsigned char hdr[HDR_SIZE];
+    uint64_t flen = HDR_SIZE + pad8(len);
+    int ret = -1;
+
+    if (flen > l->seg_size) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    /* payload 의 CRC 는 lock 밖에서. seg 가 정해진 뒤에 header 부분만 이어 계산 */
+    uint32_t payload_crc = rlog_crc32c(0, buf, len);
+
+    pthread_mutex_lock(&l->lock);
+    if (l->off + flen > l->seg_size && roll(l) == -1)
+        goto out;
+
+    uint32_t magic = htole32(MAGIC), l32 = htole32(len), zero = 0;
+    uint32_t c32 = htole32(frame_crc(payload_crc, len, l->seg));
+    uint64_t s64 = htole64(l->seg);
+    memcpy(hdr, &magic, 4);
+    memcpy(hdr + 4, &l32, 4);
+    memcpy(hdr + 8, &s64, 8);
+    memcpy(hdr + 16, &c32, 4);
+    memcpy(hdr + 20, &zero, 4);
+
+    struct iovec iov[3] = {
+        { .iov_base = hdr, .iov_len = HDR_SIZE },
+        { .iov_base = (void *)buf, .iov_len = len },
+        { .iov_base = (void *)zeros, .iov_len = pad8(len) - len },
+    };
+    ssize_t n;
+    do {
+        n = pwritev(l->fd, iov, 3, l->off);
+    } while (n == -1 && errno == EINTR);
+    if (n == -1)
+        goto out;
+    if ((uint64_t)n != flen) {
+        errno = EIO;
+        goto out;
+    }
+
+    if (pos) {
+        pos->seg = l->seg;
+        pos->offset = l->off;
+    }
+    l->off += flen;
+    l->stats.appends++;
+    ret = 0;
+out:
+    pthread_mutex_unlock(&l->lock);
+    return ret;
+}
+
+int seglog_sync(struct seglog *l) {
+    pthread_mutex_lock(&l->lock);
+    int ret = fdatasync(l->fd);
+    pthread_mutex_unlock(&l->lock);
+    return ret;
+}
+
+int seglog_release(struct seglog *l, uint64_t seg) {
+    char from[64], to[64];
+    size_t keep = 0;
+    int ret = 0;
+
+    pthread_mutex_lock(&l->lock);
+    for (size_t i = 0; i < l->live.n; i++) {
+        uint64_t s = l->live.v[i];
+        if (s >= seg || s == l->seg) {
+            l->live.v[keep++] = s;
+            continue;
+        }
+        seg_name(from, sizeof(from), "seg", s);
+        if (l->free.n < l->keep_free) {
+            seg_name(to, sizeof(to), "recycle", s);
+            if (renameat(l->dir_fd, from, l->dir_fd, to) == -1 ||
+                seglist_push(&l->free, s) == -1) {
+                l->live.v[keep++] = s;
+                ret = -1;
+            }
+        } else if (unlinkat(l->dir_fd, from, 0) == -1) {
+            l->live.v[keep++] = s;
+            ret = -1;
+        } else {
+            l->stats.removed++;
+        }
+    }
+    if (keep != l->live.n) {
+        l->live.n = keep;
+        if (fsync(l->dir_fd) == -1)
+            ret = -1;
+    }
+    pthread_mutex_unlock(&l->lock);
+    return ret;
+}
+
+void seglog_get_stats(struct seglog *l, struct seglog_stats *st) {
+    pthread_mutex_lock(&l->lock);
+    *st = l->stats;
+    pthread_mutex_unlock(&l->lock);
+}
+
+int seglog_close(struct seglog *l) {
+    if (!l)
+        return 0;
+    int ret = fdatasync(l->fd);
+    close(l->fd);
+    close(l->dir_fd);
+    free(l->live.v);
+    free(l->free.v);
+    pthread_mutex_destroy(&l->lock);
+    free(l);
+    return ret;
+}
+
+/* ---------- iterator ---------- */
+
+struct seglog_iter *seglog_iter_open(const char *dir) {
+    struct seglog_iter *it = calloc(1, sizeof(*it));
+    if (!it)
+        return NULL;
+    it->dir_fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (it->dir_fd < 0 || scan_dir(it->dir_fd, &it->segs, NULL) == -1) {
+        int saved = errno;
+        if (it->dir_fd >= 0)
+            close(it->dir_fd);
+        free(it->segs.v);
+        free(it);
+        errno = saved;
+        return NULL;
+    }
+    return it;
+}
+
+static void iter_unmap(struct seglog_iter *it) {
+    if (it->base)
+        munmap((void *)it->base, it->size);
+    it->base = NULL;
+}
+
+int seglog_iter_next(struct seglog_iter *it, struct seglog_record *r) {
+    while (it->idx < it->segs.n) {
+        uint64_t seg = it->segs.v[it->idx];
+        if (!it->base) {
+            char name[64];
+            struct stat st;
+            seg_name(name, sizeof(name), "seg", seg);
+            int fd = openat(it->dir_fd, name, O_RDONLY | O_CLOEXEC);
+            if (fd < 0 || fstat(fd, &st) == -1) {
+                if (fd >= 0)
+                    close(fd);
+                return -1;
+            }
+            void *p = st.st_size ? mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0) : NULL;
+            close(fd);
+            if (p == MAP_FAILED)
+                return -1;
+            if (p)
+                madvise(p, st.st_size, MADV_SEQUENTIAL);
+            it->base = p;
+            it->size = st.st_size;
+            it->off = 0;
+            if (!p) {
+                it->idx++;
+                continue;
+            }
+        }
+        uint64_t n = check_frame(it->base, it->size, it->off, seg, r);
+        if (n) {
+            it->off += n;
+            return 1;
+        }
+        iter_unmap(it);
+        it->idx++;
+    }
+    return 0;
+}
+
+void seglog_iter_close(struct seglog_iter *it) {
+    if (!it)
+        return;
+    iter_unmap(it);
+    close(it->dir_fd);
+    free(it->segs.v);
+    free(it);
+}
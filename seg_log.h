@@ -0,0 +1,113 @@
+/*
+ * Preallocated, Recycled Log Segments
+ *
+ * 7.c 는 O_APPEND write 뒤에 fdatasync 한다. append 마다 파일이 커지므로
+ * fdatasync 는 데이터와 함께 inode 의 크기 변경과 새 블록 할당까지 journal 에
+ * 내보내야 한다.
+ *
+ * seglog 는 디렉터리 안에 크기가 고정된 segment 파일을 미리 만들어 두고, 이미
+ * 있는 공간을 pwrite 로 덮어쓴다. 파일 크기도 블록 배치도 바뀌지 않으므로
+ * fdatasync 는 데이터만 내보내면 된다.
+ *
+ *   seg-<16 hex>       사용 중인 segment. 번호가 가장 큰 것이 쓰는 중
+ *   recycle-<16 hex>   seglog_release 로 반납된 segment. 다음 segment 로 재사용
+ *
+ *   - 만들기: seg-N.tmp 를 채워서 fsync 한 뒤 rename.
+ *             SEGLOG_FILL_ZERO 는 0 을 실제로 써서 블록을 초기화된 상태로 만든다.
+ *             SEGLOG_FILL_FALLOCATE 는 fallocate 만 하므로 빨리 만들어지지만,
+ *             처음 덮어쓸 때 unwritten extent 변환이 metadata 로 남는다
+ *   - frame: rec_log 와 같은 모양이고 seq 자리에 segment 번호가 들어간다
+ *             (magic "SLG1", len, seg, CRC32C(payload, len, seg), 8 바이트 정렬).
+ *             재활용한 segment 에 남은 옛 record 는 번호가 달라서 끝 표시
+ *             (sentinel) 역할을 하므로 segment 를 다시 지울 필요가 없다
+ *   - rollover: record 가 남은 공간에 안 들어가면 지금 segment 를 fdatasync 하고
+ *               재활용 segment 를 rename 하거나 새로 만든다
+ *   - 복구: 마지막 segment 만 검사한다 (앞의 것은 rollover 때 내구화됨).
+ *           마지막 정상 record 뒤에 남은 같은 번호의 frame (찢어진 것과 그 뒤에
+ *           먼저 디스크에 닿은 것) 은 0 으로 덮고, 크기가 segment_size 와 다른 segment 는
+ *           ftruncate 로 맞춘다 (9.c 의 truncate 는 여기서만 쓴다)
+ *
+ * 사용 예:
+ *   struct seglog *l = seglog_open("wal", NULL, NULL);
+ *   struct seglog_pos pos;
+ *   seglog_append(l, msg, strlen(msg), &pos);
+ *   seglog_sync(l);
+ *   seglog_release(l, checkpoint_seg);   // 그 앞의 segment 는 재활용
+ *   seglog_close(l);
+ *
+ * Build: gcc -O2 -pthread -c seg_log.c rec_log.c
+ */
+
+#ifndef SEG_LOG_H
+#define SEG_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SEGLOG_FILL_ZERO      0
+#define SEGLOG_FILL_FALLOCATE 1
+
+#define SEGLOG_DEFAULT_SEGMENT_SIZE (64 * 1024 * 1024)
+#define SEGLOG_DEFAULT_KEEP_FREE 2
+
+struct seglog_options {
+    uint64_t segment_size;       /* 0 이면 SEGLOG_DEFAULT_SEGMENT_SIZE (4K 배수로 올림) */
+    unsigned int keep_free;      /* 남겨 둘 재활용 segment 수. 0 이면 기본값 */
+    int fill;                    /* SEGLOG_FILL_* */
+};
+
+struct seglog_recovery {
+    uint64_t segments;           /* 사용 중인 segment 수 */
+    uint64_t active_seg;
+    uint64_t records;            /* 마지막 segment 의 정상 record 수 */
+    uint64_t valid_bytes;        /* 마지막 segment 에서 이어 쓸 위치 */
+    uint64_t zeroed_bytes;       /* 정상 record 뒤의 같은 번호 frame 들을 지운 크기 */
+    uint64_t resized;            /* 크기를 맞춘 segment 수 */
+    double seconds;
+};
+
+struct seglog_stats {
+    uint64_t appends;
+    uint64_t rollovers;
+    uint64_t created;
+    uint64_t recycled;
+    uint64_t removed;            /* keep_free 를 넘어서 지운 것 */
+};
+
+struct seglog_pos {
+    uint64_t seg;
+    uint64_t offset;             /* segment 안 frame 시작 위치 */
+};
+
+struct seglog_record {
+    uint64_t seg;
+    uint64_t offset;
+    const void *data;            /* 다음 seglog_iter_next 전까지 유효 */
+    size_t len;
+};
+
+struct seglog;
+struct seglog_iter;
+
+/* 디렉터리가 없으면 만든다. opts, rec 는 NULL 가능. 실패 시 NULL + errno */
+struct seglog *seglog_open(const char *dir, const struct seglog_options *opts,
+                           struct seglog_recovery *rec);
+
+/* 스레드 안전. len 이 segment 에 안 들어가면 EMSGSIZE. pos 는 NULL 가능 */
+int seglog_append(struct seglog *l, const void *buf, size_t len, struct seglog_pos *pos);
+
+/* 지금까지 append 한 것을 내구화 (fdatasync 한 번) */
+int seglog_sync(struct seglog *l);
+
+/* seg 보다 번호가 작은 segment 는 더 읽지 않는다: 재활용 목록으로 */
+int seglog_release(struct seglog *l, uint64_t seg);
+
+void seglog_get_stats(struct seglog *l, struct seglog_stats *st);
+int seglog_close(struct seglog *l);
+
+/* segment 순서대로 읽는다. 각 segment 는 첫 비정상 frame 에서 끝난다 */
+struct seglog_iter *seglog_iter_open(const char *dir);
+int seglog_iter_next(struct seglog_iter *it, struct seglog_record *r);   /* 1, 0 = 끝, -1 */
+void seglog_iter_close(struct seglog_iter *it);
+
+#endif
@@ -0,0 +1,294 @@
+/*
+ * Segmented Log Benchmark
+ *
+ * append 한 번마다 fdatasync 할 때의 latency 를 비교한다.
+ *
+ *   append_grow    - 7.c: O_APPEND write() + fdatasync(), 파일이 계속 커짐
+ *   seglog_falloc  - seglog, segment 를 fallocate 로만 만듦 (unwritten extent)
+ *   seglog_zero    - seglog, segment 를 0 으로 채워서 만듦
+ *   seglog_recycle - seglog_zero 에 미리 반납된 segment 가 있어 rollover 가 rename 뿐
+ *
+ * seglog 는 rollover 마다 앞 segment 를 seglog_release 한다 (checkpoint 흉내).
+ * 마지막으로 찢어진 frame 을 만들어 복구가 그것만 지우는지 확인한다.
+ *
+ * Output (CSV): mode,appends,record_size,seconds,appends_per_sec,p50_us,p99_us,p999_us,created,recycled
+ *
+ * Build: gcc -O2 -pthread -o seg_log_bench seg_log_bench.c seg_log.c rec_log.c
+ * Usage: ./seg_log_bench [-d dir] [-n appends] [-s record_size] [-S segment_size]
+ */
+
+#define _GNU_SOURCE
+#include "seg_log.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+enum { MODE_GROW, MODE_FALLOC, MODE_ZERO, MODE_RECYCLE, MODE_COUNT };
+
+static const char *mode_names[MODE_COUNT] = {
+    "append_grow", "seglog_falloc", "seglog_zero", "seglog_recycle"
+};
+
+struct bench {
+    const char *dir;
+    long appends;
+    size_t rec_size;
+    uint64_t seg_size;
+    uint64_t *lat_ns;
+    char *buf;
+};
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    }
+    return v;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void clear_dir(const char *dir) {
+    DIR *d = opendir(dir);
+    struct dirent *e;
+    char path[4096];
+
+    if (!d)
+        return;
+    while ((e = readdir(d))) {
+        if (e->d_name[0] == '.')
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, e->d_name);
+        unlink(path);
+    }
+    closedir(d);
+    rmdir(dir);
+}
+
+static void report(struct bench *b, int mode, double secs, const struct seglog_stats *st) {
+    uint64_t n = b->appends;
+    qsort(b->lat_ns, n, sizeof(*b->lat_ns), cmp_u64);
+    printf("%s,%ld,%zu,%.4f,%.0f,%.1f,%.1f,%.1f,%llu,%llu\n", mode_names[mode], b->appends,
+           b->rec_size, secs, n / secs, b->lat_ns[n / 2] / 1000.0,
+           b->lat_ns[n * 99 / 100] / 1000.0, b->lat_ns[n * 999 / 1000] / 1000.0,
+           (unsigned long long)st->created, (unsigned long long)st->recycled);
+    fflush(stdout);
+}
+
+static int run_grow(struct bench *b) {
+    char path[4096];
+    struct seglog_stats st = { 0 };
+
+    if (mkdir(b->dir, 0755) == -1 && errno != EEXIST)
+        return -1;
+    snprintf(path, sizeof(path), "%s/log.txt", b->dir);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd < 0)
+        return -1;
+
+    uint64_t t0 = now_ns();
+    for (long i = 0; i < b->appends; i++) {
+        uint64_t s = now_ns();
+        if (write(fd, b->buf, b->rec_size) != (ssize_t)b->rec_size || fdatasync(fd) == -1) {
+            close(fd);
+            return -1;
+        }
+        b->lat_ns[i] = now_ns() - s;
+    }
+    double secs = (now_ns() - t0) / 1e9;
+    close(fd);
+    report(b, MODE_GROW, secs, &st);
+    return 0;
+}
+
+/* rollover 가 일어나면 앞 segment 를 반납 */
+static int append_sync(struct seglog *l, struct bench *b, uint64_t *cur_seg) {
+    struct seglog_pos pos;
+    if (seglog_append(l, b->buf, b->rec_size, &pos) == -1 || seglog_sync(l) == -1)
+        return -1;
+    if (pos.seg != *cur_seg) {
+        *cur_seg = pos.seg;
+        return seglog_release(l, pos.seg);
+    }
+    return 0;
+}
+
+static int run_seglog(struct bench *b, int mode) {
+    struct seglog_options opts = {
+        .segment_size = b->seg_size,
+        .fill = mode == MODE_FALLOC ? SEGLOG_FILL_FALLOCATE : SEGLOG_FILL_ZERO,
+    };
+    struct seglog_stats before, after;
+    uint64_t cur_seg = 1;
+
+    struct seglog *l = seglog_open(b->dir, &opts, NULL);
+    if (!l)
+        return -1;
+
+    /* 반납된 segment 를 keep_free 개 만들어 둔다 */
+    if (mode == MODE_RECYCLE) {
+        uint64_t per_seg = b->seg_size / (24 + ((b->rec_size + 7) & ~(size_t)7));
+        for (uint64_t i = 0; i < per_seg * (SEGLOG_DEFAULT_KEEP_FREE + 1) + 1; i++) {
+            struct seglog_pos pos;
+            if (seglog_append(l, b->buf, b->rec_size, &pos) == -1) {
+                seglog_close(l);
+                return -1;
+            }
+            cur_seg = pos.seg;
+        }
+        if (seglog_release(l, cur_seg) == -1) {
+            seglog_close(l);
+            return -1;
+        }
+    }
+    seglog_get_stats(l, &before);
+
+    uint64_t t0 = now_ns();
+    for (long i = 0; i < b->appends; i++) {
+        uint64_t s = now_ns();
+        if (append_sync(l, b, &cur_seg) == -1) {
+            seglog_close(l);
+            return -1;
+        }
+        b->lat_ns[i] = now_ns() - s;
+    }
+    double secs = (now_ns() - t0) / 1e9;
+
+    seglog_get_stats(l, &after);
+    after.created -= before.created;
+    after.recycled -= before.recycled;
+    report(b, mode, secs, &after);
+    return seglog_close(l);
+}
+
+static long count_records(const char *dir) {
+    struct seglog_iter *it = seglog_iter_open(dir);
+    struct seglog_record r;
+    long n = 0;
+    int ret;
+
+    if (!it)
+        return -1;
+    while ((ret = seglog_iter_next(it, &r)) > 0)
+        n++;
+    seglog_iter_close(it);
+    return ret < 0 ? -1 : n;
+}
+
+/* 마지막 record 의 payload 끝을 망가뜨리면 복구가 그 frame 만 지워야 한다 */
+static int check_recovery(struct bench *b) {
+    struct seglog_options opts = { .segment_size = b->seg_size };
+    struct seglog_recovery rec = { 0 };
+    struct seglog_pos pos;
+    long n = 1000;
+    char path[4096];
+    int ok = 0;
+
+    clear_dir(b->dir);
+    struct seglog *l = seglog_open(b->dir, &opts, NULL);
+    if (!l)
+        return -1;
+    for (long i = 0; i < n; i++) {
+        if (seglog_append(l, b->buf, b->rec_size, &pos) == -1) {
+            seglog_close(l);
+            goto out;
+        }
+    }
+    seglog_close(l);
+
+    snprintf(path, sizeof(path), "%s/seg-%016llx", b->dir, (unsigned long long)pos.seg);
+    int fd = open(path, O_WRONLY);
+    if (fd < 0 || pwrite(fd, "!", 1, pos.offset + 24 + b->rec_size - 1) != 1) {
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    close(fd);
+
+    l = seglog_open(b->dir, &opts, &rec);
+    if (!l)
+        return -1;
+    if (seglog_append(l, b->buf, b->rec_size, NULL) == -1) {
+        seglog_close(l);
+        goto out;
+    }
+    seglog_close(l);
+
+    ok = rec.active_seg == pos.seg && rec.valid_bytes == pos.offset &&
+         rec.zeroed_bytes == 24 + ((b->rec_size + 7) & ~(size_t)7) &&
+         count_records(b->dir) == n;
+out:
+    fprintf(stderr, "recovery check %s (active seg %llu, %llu records, zeroed %llu, %.2f ms)\n",
+            ok ? "ok" : "failed", (unsigned long long)rec.active_seg,
+            (unsigned long long)rec.records, (unsigned long long)rec.zeroed_bytes,
+            rec.seconds * 1000);
+    return ok ? 0 : -1;
+}
+
+int main(int argc, char *argv[]) {
+    struct bench b = { .dir = "seg_log_bench_dir", .appends = 2000, .rec_size = 100,
+                       .seg_size = 64 << 10 };
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:n:s:S:")) != -1) {
+        switch (opt) {
+        case 'd': b.dir = optarg; break;
+        case 'n': b.appends = atol(optarg); break;
+        case 's': b.rec_size = parse_size(optarg); break;
+        case 'S': b.seg_size = parse_size(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-d dir] [-n appends] [-s record_size] "
+                    "[-S segment_size]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (b.appends < 1 || b.rec_size < 1 || b.rec_size + 32 > b.seg_size) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+    b.lat_ns = malloc(b.appends * sizeof(*b.lat_ns));
+    b.buf = malloc(b.rec_size);
+    if (!b.lat_ns || !b.buf) {
+        perror("malloc");
+        return 1;
+    }
+    memset(b.buf, 'x', b.rec_size);
+    b.buf[b.rec_size - 1] = '\n';
+
+    printf("mode,appends,record_size,seconds,appends_per_sec,p50_us,p99_us,p999_us,"
+           "created,recycled\n");
+    for (int mode = 0; mode < MODE_COUNT; mode++) {
+        clear_dir(b.dir);
+        int ret = mode == MODE_GROW ? run_grow(&b) : run_seglog(&b, mode);
+        if (ret == -1) {
+            perror(mode_names[mode]);
+            return 1;
+        }
+    }
+
+    int ret = check_recovery(&b) == 0 ? 0 : 1;
+    clear_dir(b.dir);
+    free(b.lat_ns);
+    free(b.buf);
+    return ret;
+}
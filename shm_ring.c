@@ -0,0 +1,466 @@
+/*
+ * Shared-Memory Ring Channel - 구현
+ *
+ * 공유 매핑 배치:
+ *   [header 4KB][data]
+ *   SPSC data: capacity 바이트 ring. head/tail 은 계속 증가하는 바이트 위치.
+ *   MPMC data: slot[capacity], slot = { seq, len, payload[msg_max] }
+ *              (mpsc_log.c 와 같은 seq 규칙, 여기서는 consumer 도 CAS 로 경쟁)
+ *
+ * 잠들기/깨우기: 방향마다 futex word(seq) 와 대기자 수를 둔다.
+ *   대기자: seen = seq 를 먼저 읽고 -> 조건 확인 -> 여전히 안 되면
+ *           waiters++ 후 FUTEX_WAIT(seq, seen)
+ *   상대편: 상태를 바꾼 뒤 seq++ -> waiters 가 있을 때만 FUTEX_WAKE
+ * seen 을 조건 확인 전에 읽으므로 그 사이에 seq 가 바뀌면 FUTEX_WAIT 가
+ * 바로 돌아온다 (깨우기를 놓치지 않음).
+ * 프로세스 사이에서 쓰므로 *_PRIVATE futex 가 아니다.
+ */
+
+#define _GNU_SOURCE
+#include "shm_ring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#define RING_MAGIC 0x53524e47u       /* "SRNG" */
+#define RING_VERSION 1
+#define HEADER_SIZE 4096
+#define OPEN_WAIT_MS 1000            /* 만든 쪽의 ftruncate + 초기화를 기다리는 최대 시간 */
+
+struct ring_hdr {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t mpmc;
+    uint32_t pad;
+    uint64_t capacity;
+    uint64_t msg_max;
+    uint64_t slot_size;
+    atomic_uint closed;
+
+    _Alignas(64) atomic_uint_fast64_t head;     /* 읽는 쪽 위치 */
+    _Alignas(64) atomic_uint_fast64_t tail;     /* 쓰는 쪽 위치 */
+    _Alignas(64) atomic_uint data_seq;          /* 데이터가 생김 */
+    atomic_uint data_waiters;
+    _Alignas(64) atomic_uint space_seq;         /* 자리가 생김 */
+    atomic_uint space_waiters;
+};
+
+struct ring_slot {
+    atomic_uint_fast64_t seq;
+    uint32_t len;
+    char data[];
+};
+
+struct shm_ring {
+    int fd;
+    int nonblock;
+    struct ring_hdr *hdr;
+    char *data;
+    size_t map_len;
+    uint64_t mask;
+};
+
+_Static_assert(sizeof(struct ring_hdr) <= HEADER_SIZE, "header too large");
+
+static long futex(atomic_uint *addr, int op, unsigned int val) {
+    return syscall(SYS_futex, addr, op, val, NULL, NULL, 0);
+}
+
+static void wait_on(atomic_uint *seq, atomic_uint *waiters, unsigned int seen) {
+    atomic_fetch_add(waiters, 1);
+    futex(seq, FUTEX_WAIT, seen);
+    atomic_fetch_sub(waiters, 1);
+}
+
+static void notify(atomic_uint *seq, atomic_uint *waiters) {
+    atomic_fetch_add(seq, 1);
+    if (atomic_load(waiters))
+        futex(seq, FUTEX_WAKE, INT_MAX);
+}
+
+static uint64_t pow2(uint64_t v) {
+    uint64_t p = 1;
+    while (p < v)
+        p <<= 1;
+    return p;
+}
+
+static size_t layout(const struct shm_ring_params *p, uint64_t *cap, uint64_t *slot) {
+    if (p->mpmc) {
+        *slot = (sizeof(struct ring_slot) + p->msg_max + 63) / 64 * 64;
+        return HEADER_SIZE + *cap * *slot;
+    }
+    *slot = 0;
+    return HEADER_SIZE + *cap;
+}
+
+static void init_header(struct shm_ring *r, const struct shm_ring_params *p,
+                        uint64_t cap, uint64_t slot) {
+    struct ring_hdr *h = r->hdr;
+
+    h->version = RING_VERSION;
+    h->mpmc = p->mpmc;
+    h->capacity = cap;
+    h->msg_max = p->msg_max;
+    h->slot_size = slot;
+    if (p->mpmc) {
+        for (uint64_t i = 0; i < cap; i++) {
+            struct ring_slot *s = (struct ring_slot *)(r->data + i * slot);
+            atomic_init(&s->seq, i);
+        }
+    }
+    /* magic 은 마지막에: 다른 프로세스는 magic 을 보고 초기화 완료를 안다 */
+    atomic_thread_fence(memory_order_release);
+    h->magic = RING_MAGIC;
+}
+
+static struct shm_ring *map_ring(int fd, int flags, size_t len) {
+    struct shm_ring *r = calloc(1, sizeof(*r));
+    if (!r)
+        return NULL;
+
+    r->hdr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (r->hdr == MAP_FAILED) {
+        free(r);
+        return NULL;
+    }
+    r->fd = fd;
+    r->nonblock = (flags & O_NONBLOCK) != 0;
+    r->data = (char *)r->hdr + HEADER_SIZE;
+    r->map_len = len;
+    return r;
+}
+
+static void fill_params(struct shm_ring_params *o, const struct shm_ring_params *p) {
+    memset(o, 0, sizeof(*o));
+    if (p)
+        *o = *p;
+    if (o->capacity == 0)
+        o->capacity = o->mpmc ? 1024 : SHM_RING_DEFAULT_CAPACITY;
+    if (o->msg_max == 0)
+        o->msg_max = SHM_RING_DEFAULT_MSG_MAX;
+}
+
+/* fd 가 가리키는 ring 을 새로 만든다 (크기 0 인 fd) */
+static struct shm_ring *create_on(int fd, int flags, const struct shm_ring_params *params) {
+    struct shm_ring_params p;
+    uint64_t cap, slot;
+
+    fill_params(&p, params);
+    cap = pow2(p.capacity);
+    size_t len = layout(&p, &cap, &slot);
+    if (ftruncate(fd, len) == -1)
+        return NULL;
+
+    struct shm_ring *r = map_ring(fd, flags, len);
+    if (!r)
+        return NULL;
+    r->mask = cap - 1;
+    init_header(r, &p, cap, slot);
+    return r;
+}
+
+/* 공유 header 는 다른 프로세스가 쓴 것이므로 mask 와 slot 계산에 쓰기 전에
+ * create_on 이 만드는 모양인지 확인한다. 곱셈은 넘칠 수 있으므로 나눗셈으로 비교 */
+static int valid_geometry(const struct ring_hdr *h, size_t map_len) {
+    uint64_t room = map_len - HEADER_SIZE;
+
+    if (h->capacity == 0 || (h->capacity & (h->capacity - 1)))
+        return 0;
+    if (!h->mpmc)
+        return h->capacity <= room;
+    /* slot 의 len 은 u32 이고 seq 는 8 바이트 정렬이어야 한다 */
+    if (h->msg_max > UINT32_MAX ||
+        h->slot_size < sizeof(struct ring_slot) + h->msg_max ||
+        h->slot_size % _Alignof(struct ring_slot))
+        return 0;
+    return h->capacity <= room / h->slot_size;
+}
+
+struct shm_ring *shm_ring_from_fd(int fd, int flags) {
+    struct stat st;
+    struct ring_hdr h;
+
+    /* 만든 쪽이 아직 ftruncate 전이거나 초기화 중일 수 있다. 두 단계가 같은
+     * 시간 한도를 나눠 쓴다 */
+    int waited = 0;
+    for (;;) {
+        if (fstat(fd, &st) == -1)
+            return NULL;
+        if ((size_t)st.st_size >= HEADER_SIZE)
+            break;
+        if (waited++ >= OPEN_WAIT_MS) {
+            errno = EINVAL;
+            return NULL;
+        }
+        usleep(1000);
+    }
+
+    struct shm_ring *r = map_ring(fd, flags, st.st_size);
+    if (!r)
+        return NULL;
+
+    for (; waited < OPEN_WAIT_MS && r->hdr->magic != RING_MAGIC; waited++)
+        usleep(1000);
+    atomic_thread_fence(memory_order_acquire);
+    memcpy(&h, r->hdr, offsetof(struct ring_hdr, closed));
+    if (h.magic != RING_MAGIC || h.version != RING_VERSION ||
+        !valid_geometry(&h, r->map_len)) {
+        munmap(r->hdr, r->map_len);
+        free(r);
+        errno = EPROTO;
+        return NULL;
+    }
+    r->mask = h.capacity - 1;
+    return r;
+}
+
+struct shm_ring *shm_ring_open(const char *name, int flags,
+                               const struct shm_ring_params *params) {
+    struct shm_ring *r;
+    int fd = -1;
+
+    /* O_EXCL 로 먼저 만들어 보고, 이미 있으면 여는 쪽이 된다 */
+    if (flags & O_CREAT)
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) {
+        r = create_on(fd, flags, params);
+    } else {
+        if ((flags & O_CREAT) && errno != EEXIST)
+            return NULL;
+        fd = shm_open(name, O_RDWR, 0);
+        if (fd < 0)
+            return NULL;
+        r = shm_ring_from_fd(fd, flags);
+    }
+    if (!r) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+    }
+    return r;
+}
+
+struct shm_ring *shm_ring_create_anon(const struct shm_ring_params *params, int flags) {
+    int fd = memfd_create("shm_ring", MFD_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+    struct shm_ring *r = create_on(fd, flags, params);
+    if (!r) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+    }
+    return r;
+}
+
+int shm_ring_fd(const struct shm_ring *r) {
+    return r->fd;
+}
+
+/* ---------------------------------------------------------------- */
+/* SPSC: 바이트 스트림 */
+
+static ssize_t spsc_write(struct shm_ring *r, const char *buf, size_t len) {
+    struct ring_hdr *h = r->hdr;
+    uint64_t cap = h->capacity;
+    size_t done = 0;
+
+    while (done < len) {
+        unsigned int seen = atomic_load(&h->space_seq);
+        if (atomic_load_explicit(&h->closed, memory_order_relaxed)) {
+            errno = EPIPE;
+            return done ? (ssize_t)done : -1;
+        }
+
+        uint64_t tail = atomic_load_explicit(&h->tail, memory_order_relaxed);
+        uint64_t head = atomic_load_explicit(&h->head, memory_order_acquire);
+        uint64_t space = cap - (tail - head);
+        if (space == 0) {
+            if (r->nonblock) {
+                if (done)
+                    break;
+                errno = EAGAIN;
+                return -1;
+            }
+            wait_on(&h->space_seq, &h->space_waiters, seen);
+            continue;
+        }
+
+        size_t n = len - done < space ? len - done : space;
+        size_t off = tail & r->mask;
+        size_t first = n < cap - off ? n : cap - off;
+        memcpy(r->data + off, buf + done, first);
+        memcpy(r->data, buf + done + first, n - first);
+        atomic_store_explicit(&h->tail, tail + n, memory_order_release);
+        notify(&h->data_seq, &h->data_waiters);
+        done += n;
+    }
+    return (ssize_t)done;
+}
+
+static ssize_t spsc_read(struct shm_ring *r, char *buf, size_t len) {
+    struct ring_hdr *h = r->hdr;
+    uint64_t cap = h->capacity;
+
+    if (len == 0)
+        return 0;
+    for (;;) {
+        unsigned int seen = atomic_load(&h->data_seq);
+        uint64_t head = atomic_load_explicit(&h->head, memory_order_relaxed);
+        uint64_t tail = atomic_load_explicit(&h->tail, memory_order_acquire);
+        uint64_t avail = tail - head;
+
+        if (avail == 0) {
+            if (atomic_load(&h->closed)) {
+                /* shutdown 직전에 쓴 데이터가 있는지 한 번 더 */
+                if (atomic_load_explicit(&h->tail, memory_order_acquire) == head)
+                    return 0;
+                continue;
+            }
+            if (r->nonblock) {
+                errno = EAGAIN;
+                return -1;
+            }
+            wait_on(&h->data_seq, &h->data_waiters, seen);
+            continue;
+        }
+
+        size_t n = len < avail ? len : avail;
+        size_t off = head & r->mask;
+        size_t first = n < cap - off ? n : cap - off;
+        memcpy(buf, r->data + off, first);
+        memcpy(buf + first, r->data, n - first);
+        atomic_store_explicit(&h->head, head + n, memory_order_release);
+        notify(&h->space_seq, &h->space_waiters);
+        return (ssize_t)n;
+    }
+}
+
+/* ---------------------------------------------------------------- */
+/* MPMC: 메시지 */
+
+static struct ring_slot *slot_at(struct shm_ring *r, uint64_t pos) {
+    return (struct ring_slot *)(r->data + (pos & r->mask) * r->hdr->slot_size);
+}
+
+static ssize_t mpmc_write(struct shm_ring *r, const char *buf, size_t len) {
+    struct ring_hdr *h = r->hdr;
+    struct ring_slot *s;
+    uint64_t pos;
+
+    if (len > h->msg_max) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    for (;;) {
+        unsigned int seen = atomic_load(&h->space_seq);
+        if (atomic_load_explicit(&h->closed, memory_order_relaxed)) {
+            errno = EPIPE;
+            return -1;
+        }
+
+        pos = atomic_load_explicit(&h->tail, memory_order_relaxed);
+        s = slot_at(r, pos);
+        uint64_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+        int64_t diff = (int64_t)(seq - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak(&h->tail, &pos, pos + 1))
+                break;
+        } else if (diff < 0) {
+            /* 한 바퀴 전 메시지가 아직 안 읽힘: 가득 참 */
+            if (r->nonblock) {
+                errno = EAGAIN;
+                return -1;
+            }
+            wait_on(&h->space_seq, &h->space_waiters, seen);
+        }
+    }
+
+    memcpy(s->data, buf, len);
+    s->len = (uint32_t)len;
+    atomic_store_explicit(&s->seq, pos + 1, memory_order_release);
+    notify(&h->data_seq, &h->data_waiters);
+    return (ssize_t)len;
+}
+
+static ssize_t mpmc_read(struct shm_ring *r, char *buf, size_t len) {
+    struct ring_hdr *h = r->hdr;
+    struct ring_slot *s;
+    uint64_t pos;
+
+    for (;;) {
+        unsigned int seen = atomic_load(&h->data_seq);
+        pos = atomic_load_explicit(&h->head, memory_order_relaxed);
+        s = slot_at(r, pos);
+        uint64_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+        int64_t diff = (int64_t)(seq - (pos + 1));
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak(&h->head, &pos, pos + 1))
+                break;
+        } else if (diff < 0) {
+            /* 비어 있음 */
+            if (atomic_load(&h->closed)) {
+                if (atomic_load_explicit(&h->tail, memory_order_acquire) == pos)
+                    return 0;
+                continue;        /* 예약만 된 메시지가 publish 되기를 기다림 */
+            }
+            if (r->nonblock) {
+                errno = EAGAIN;
+                return -1;
+            }
+            wait_on(&h->data_seq, &h->data_waiters, seen);
+        }
+    }
+
+    size_t n = s->len < len ? s->len : len;
+    memcpy(buf, s->data, n);
+    atomic_store_explicit(&s->seq, pos + r->mask + 1, memory_order_release);
+    notify(&h->space_seq, &h->space_waiters);
+    return (ssize_t)n;
+}
+
+/* ---------------------------------------------------------------- */
+
+ssize_t shm_ring_write(struct shm_ring *r, const void *buf, size_t len) {
+    return r->hdr->mpmc ? mpmc_write(r, buf, len) : spsc_write(r, buf, len);
+}
+
+ssize_t shm_ring_read(struct shm_ring *r, void *buf, size_t len) {
+    return r->hdr->mpmc ? mpmc_read(r, buf, len) : spsc_read(r, buf, len);
+}
+
+void shm_ring_shutdown(struct shm_ring *r) {
+    atomic_store(&r->hdr->closed, 1);
+    /* 잠든 쪽을 대기자 수와 상관없이 모두 깨운다 */
+    atomic_fetch_add(&r->hdr->data_seq, 1);
+    atomic_fetch_add(&r->hdr->space_seq, 1);
+    futex(&r->hdr->data_seq, FUTEX_WAKE, INT_MAX);
+    futex(&r->hdr->space_seq, FUTEX_WAKE, INT_MAX);
+}
+
+int shm_ring_close(struct shm_ring *r) {
+    if (!r)
+        return 0;
+    munmap(r->hdr, r->map_len);
+    int ret = close(r->fd);
+    free(r);
+    return ret;
+}
+
+int shm_ring_unlink(const char *name) {
+    return shm_unlink(name);
+}
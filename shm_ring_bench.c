@@ -0,0 +1,268 @@
+/*
+ * Shared-Memory Ring vs FIFO Benchmark
+ *
+ * fork 한 두 프로세스 사이에서 메시지 크기별로
+ *   throughput - 부모가 N 개를 보내고 자식이 모두 받을 때까지
+ *   latency    - ping-pong 왕복 시간 (p50 / p99)
+ * 을 잰다.
+ *
+ *   fifo - 4.c 처럼 named FIFO
+ *   spsc - shm_ring SPSC (바이트 스트림)
+ *   mpmc - shm_ring MPMC (메시지)
+ *
+ * Output (CSV): kind,test,msg_size,messages,seconds,msgs_per_sec,mbps,p50_us,p99_us
+ *
+ * Build: gcc -O2 -o shm_ring_bench shm_ring_bench.c shm_ring.c
+ * Usage: ./shm_ring_bench [-n messages] [-p pings]
+ */
+
+#define _GNU_SOURCE
+#include "shm_ring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+enum { KIND_FIFO, KIND_SPSC, KIND_MPMC, KIND_COUNT };
+
+static const char *kind_names[KIND_COUNT] = { "fifo", "spsc", "mpmc" };
+
+struct chan {
+    int kind;
+    int fd;
+    struct shm_ring *r;
+    char name[64];
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* 부모에서 만들고, 자식은 fork 후 chan_attach 로 이름으로 다시 연다 */
+static int chan_create(struct chan *c, int kind, const char *tag) {
+    c->kind = kind;
+    c->fd = -1;
+    c->r = NULL;
+    if (kind == KIND_FIFO) {
+        snprintf(c->name, sizeof(c->name), "/tmp/shm_ring_bench_%s_%d", tag, getpid());
+        unlink(c->name);
+        return mkfifo(c->name, 0600);
+    }
+    snprintf(c->name, sizeof(c->name), "/shm_ring_bench_%s_%d", tag, getpid());
+    shm_ring_unlink(c->name);
+    struct shm_ring_params p = { .mpmc = kind == KIND_MPMC };
+    c->r = shm_ring_open(c->name, O_CREAT, &p);
+    return c->r ? 0 : -1;
+}
+
+static int chan_attach(struct chan *c) {
+    if (c->kind == KIND_FIFO) {
+        /* 상대가 아직 열지 않아도 막히지 않도록 O_RDWR */
+        c->fd = open(c->name, O_RDWR);
+        return c->fd < 0 ? -1 : 0;
+    }
+    if (c->r)
+        shm_ring_close(c->r);
+    c->r = shm_ring_open(c->name, 0, NULL);
+    return c->r ? 0 : -1;
+}
+
+static void chan_destroy(struct chan *c) {
+    if (c->fd >= 0)
+        close(c->fd);
+    if (c->r)
+        shm_ring_close(c->r);
+    if (c->kind == KIND_FIFO)
+        unlink(c->name);
+    else
+        shm_ring_unlink(c->name);
+}
+
+static int chan_send(struct chan *c, const char *buf, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = c->kind == KIND_FIFO ? write(c->fd, buf + done, len - done)
+                                         : shm_ring_write(c->r, buf + done, len - done);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        done += n;
+    }
+    return 0;
+}
+
+/* 메시지 하나를 끝까지 받는다 (스트림이면 len 바이트를 모음) */
+static int chan_recv(struct chan *c, char *buf, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = c->kind == KIND_FIFO ? read(c->fd, buf + done, len - done)
+                                         : shm_ring_read(c->r, buf + done, len - done);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (n == 0)
+            return -1;
+        done += n;
+        if (c->kind == KIND_MPMC)
+            break;
+    }
+    return 0;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int run_throughput(int kind, size_t size, long count) {
+    struct chan c;
+    char *buf = malloc(size);
+
+    if (!buf || chan_create(&c, kind, "tp") == -1) {
+        free(buf);
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        uint64_t sum = 0;
+        if (chan_attach(&c) == -1)
+            _exit(1);
+        for (long i = 0; i < count; i++) {
+            if (chan_recv(&c, buf, size) == -1)
+                _exit(1);
+            sum += (unsigned char)buf[0];
+        }
+        /* 순서 확인: 메시지 i 의 첫 바이트는 i % 251 */
+        _exit(sum == (uint64_t)((count / 251) * (250 * 251 / 2) +
+                                (count % 251) * (count % 251 - 1) / 2) ? 0 : 2);
+    }
+    if (pid < 0 || chan_attach(&c) == -1) {
+        chan_destroy(&c);
+        free(buf);
+        return -1;
+    }
+
+    memset(buf, 0, size);
+    double t0 = now_sec();
+    for (long i = 0; i < count; i++) {
+        buf[0] = (char)(i % 251);
+        if (chan_send(&c, buf, size) == -1)
+            break;
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    double secs = now_sec() - t0;
+
+    chan_destroy(&c);
+    free(buf);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "%s: receiver failed (%d)\n", kind_names[kind], WEXITSTATUS(status));
+        return -1;
+    }
+
+    printf("%s,throughput,%zu,%ld,%.4f,%.0f,%.1f,,\n", kind_names[kind], size, count, secs,
+           count / secs, count * (double)size / secs / 1e6);
+    fflush(stdout);
+    return 0;
+}
+
+static int run_latency(int kind, size_t size, long pings) {
+    struct chan ping, pong;
+    char *buf = malloc(size);
+    double *rtt = malloc(pings * sizeof(*rtt));
+
+    if (!buf || !rtt || chan_create(&ping, kind, "ping") == -1) {
+        free(buf);
+        free(rtt);
+        return -1;
+    }
+    if (chan_create(&pong, kind, "pong") == -1) {
+        chan_destroy(&ping);
+        free(buf);
+        free(rtt);
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (chan_attach(&ping) == -1 || chan_attach(&pong) == -1)
+            _exit(1);
+        for (long i = 0; i < pings; i++) {
+            if (chan_recv(&ping, buf, size) == -1 || chan_send(&pong, buf, size) == -1)
+                _exit(1);
+        }
+        _exit(0);
+    }
+
+    int ok = pid > 0 && chan_attach(&ping) == 0 && chan_attach(&pong) == 0;
+    memset(buf, 'p', size);
+    double total = now_sec();
+    for (long i = 0; ok && i < pings; i++) {
+        double t0 = now_sec();
+        if (chan_send(&ping, buf, size) == -1 || chan_recv(&pong, buf, size) == -1)
+            ok = 0;
+        rtt[i] = (now_sec() - t0) * 1e6;
+    }
+    total = now_sec() - total;
+    if (pid > 0)
+        waitpid(pid, NULL, 0);
+
+    if (ok) {
+        qsort(rtt, pings, sizeof(*rtt), cmp_double);
+        printf("%s,latency,%zu,%ld,%.4f,%.0f,,%.2f,%.2f\n", kind_names[kind], size, pings,
+               total, pings / total, rtt[pings / 2], rtt[pings * 99 / 100]);
+        fflush(stdout);
+    }
+
+    chan_destroy(&ping);
+    chan_destroy(&pong);
+    free(buf);
+    free(rtt);
+    return ok ? 0 : -1;
+}
+
+int main(int argc, char *argv[]) {
+    static const size_t sizes[] = { 16, 64, 256, 1024, 4096 };
+    long count = 1000000, pings = 20000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:p:")) != -1) {
+        switch (opt) {
+        case 'n': count = atol(optarg); break;
+        case 'p': pings = atol(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-n messages] [-p pings]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (count < 1 || pings < 1) {
+        fprintf(stderr, "messages and pings must be > 0\n");
+        return 1;
+    }
+
+    printf("kind,test,msg_size,messages,seconds,msgs_per_sec,mbps,p50_us,p99_us\n");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (int kind = 0; kind < KIND_COUNT; kind++) {
+            if (run_throughput(kind, sizes[s], count) == -1 ||
+                run_latency(kind, sizes[s], pings) == -1) {
+                perror(kind_names[kind]);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
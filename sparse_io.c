@@ -0,0 +1,219 @@
+/*
+ * Sparse-File Extents - 구현
+ *
+ * Build: gcc -O2 -c sparse_io.c
+ */
+
+#define _GNU_SOURCE
+#include "sparse_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define ZERO_BUF (64 * 1024)
+
+int sxt_iter_init(struct sxt_iter *it, int fd) {
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+        return -1;
+    it->fd = fd;
+    it->pos = 0;
+    it->size = st.st_size;
+    it->no_seek_data = 0;
+    return 0;
+}
+
+int sxt_iter_next(struct sxt_iter *it, struct sxt_extent *e) {
+    if (it->pos >= it->size)
+        return 0;
+
+    if (!it->no_seek_data) {
+        off_t data = lseek(it->fd, it->pos, SEEK_DATA);
+        if (data == (off_t)-1) {
+            if (errno == ENXIO) {
+                /* 이후는 전부 hole */
+                data = it->size;
+            } else if (errno == EINVAL || errno == EOPNOTSUPP) {
+                it->no_seek_data = 1;
+            } else {
+                return -1;
+            }
+        }
+        if (!it->no_seek_data) {
+            if (data > it->size)
+                data = it->size;
+            if (data > it->pos) {
+                e->off = it->pos;
+                e->len = data - it->pos;
+                e->hole = 1;
+                it->pos = data;
+                return 1;
+            }
+            off_t hole = lseek(it->fd, data, SEEK_HOLE);
+            if (hole == (off_t)-1 || hole > it->size)
+                hole = it->size;
+            e->off = data;
+            e->len = hole - data;
+            e->hole = 0;
+            it->pos = hole;
+            return 1;
+        }
+    }
+
+    e->off = it->pos;
+    e->len = it->size - it->pos;
+    e->hole = 0;
+    it->pos = it->size;
+    return 1;
+}
+
+int sxt_scan(int fd, const struct sxt_scan_options *opts, sxt_data_cb cb, void *arg,
+             struct sxt_stats *stats) {
+    size_t buf_size = opts && opts->buf_size ? opts->buf_size : SXT_DEFAULT_BUF;
+    struct sxt_stats local;
+    struct sxt_iter it;
+    struct sxt_extent e;
+    int ret = 0, r;
+
+    if (!stats)
+        stats = &local;
+    memset(stats, 0, sizeof(*stats));
+    if (sxt_iter_init(&it, fd) == -1)
+        return -1;
+    char *buf = malloc(buf_size);
+    if (!buf)
+        return -1;
+
+    while (ret == 0 && (r = sxt_iter_next(&it, &e)) > 0) {
+        if (e.hole) {
+            stats->hole_bytes += e.len;
+            continue;
+        }
+        stats->data_extents++;
+        uint64_t done = 0;
+        while (ret == 0 && done < e.len) {
+            size_t want = e.len - done < buf_size ? e.len - done : buf_size;
+            ssize_t n = pread(fd, buf, want, e.off + done);
+            if (n == -1) {
+                if (errno == EINTR)
+                    continue;
+                ret = -1;
+                break;
+            }
+            if (n == 0)
+                break;           /* 도중에 파일이 줄었다 */
+            stats->reads++;
+            stats->data_bytes += n;
+            ret = cb(arg, e.off + done, buf, n);
+            done += n;
+        }
+    }
+    if (r == -1)
+        ret = -1;
+
+    int saved = errno;
+    free(buf);
+    errno = saved;
+    return ret;
+}
+
+static int write_zeros(int fd, off_t off, uint64_t len) {
+    static const char zeros[ZERO_BUF];
+    while (len > 0) {
+        size_t want = len < ZERO_BUF ? len : ZERO_BUF;
+        ssize_t n = pwrite(fd, zeros, want, off);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        off += n;
+        len -= n;
+    }
+    return 0;
+}
+
+int sxt_punch(int fd, off_t off, uint64_t len) {
+    if (len == 0)
+        return 0;
+    if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, off, len) == 0)
+        return 0;
+    if (errno != EOPNOTSUPP && errno != ENOSYS)
+        return -1;
+    if (fallocate(fd, FALLOC_FL_ZERO_RANGE | FALLOC_FL_KEEP_SIZE, off, len) == 0)
+        return 1;
+    if (errno != EOPNOTSUPP && errno != ENOSYS)
+        return -1;
+    /* KEEP_SIZE 와 같게: 파일 끝을 넘는 부분은 쓰지 않는다 */
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+        return -1;
+    if (off >= st.st_size)
+        return 1;
+    if ((uint64_t)(st.st_size - off) < len)
+        len = st.st_size - off;
+    return write_zeros(fd, off, len) == -1 ? -1 : 1;
+}
+
+static int all_zero(const char *p, size_t len) {
+    /* 첫 바이트가 0 이고 나머지가 한 칸씩 밀린 자신과 같으면 전부 0 */
+    return len == 0 || (p[0] == 0 && memcmp(p, p + 1, len - 1) == 0);
+}
+
+int64_t sxt_dig(int fd, size_t block) {
+    struct sxt_iter it;
+    struct sxt_extent e;
+    int64_t reclaimed = 0;
+    int r;
+
+    if (block == 0 || sxt_iter_init(&it, fd) == -1)
+        return -1;
+    char *buf = malloc(block);
+    if (!buf)
+        return -1;
+
+    while ((r = sxt_iter_next(&it, &e)) > 0) {
+        if (e.hole)
+            continue;
+        /* block 경계에 맞춘 부분만 본다 (경계 밖 조각은 punch 해도 0 을 쓸 뿐) */
+        off_t start = (e.off + block - 1) / block * block;
+        off_t end = (e.off + (off_t)e.len) / block * block;
+        off_t run = -1;          /* 이어지는 0 block 의 시작 */
+        for (off_t o = start; o <= end; o += block) {
+            int zero = 0;
+            if (o < end) {
+                ssize_t n = pread(fd, buf, block, o);
+                if (n == -1) {
+                    free(buf);
+                    return -1;
+                }
+                zero = n == (ssize_t)block && all_zero(buf, block);
+            }
+            if (zero && run < 0)
+                run = o;
+            if (!zero && run >= 0) {
+                int p = sxt_punch(fd, run, o - run);
+                if (p == -1) {
+                    free(buf);
+                    return -1;
+                }
+                if (p == 0)
+                    reclaimed += o - run;
+                run = -1;
+            }
+        }
+    }
+    free(buf);
+    return r == -1 ? -1 : reclaimed;
+}
+
+int64_t sxt_allocated(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+        return -1;
+    return (int64_t)st.st_blocks * 512;
+}
@@ -0,0 +1,85 @@
+/*
+ * Sparse-File Extents
+ *
+ * mmap_zero_copy_writer 는 ftruncate 로 파일을 키우고 9.c 는 truncate 로
+ * 줄이지만, 그 사이의 hole 은 아무도 모른다. 10GB 중 1GB 만 데이터인 파일도
+ * read() 로 훑으면 커널이 0 으로 채운 페이지 10GB 를 복사해 준다.
+ *
+ *   - 구간 iterator: lseek(SEEK_DATA / SEEK_HOLE) 로 데이터/hole 구간을 차례로.
+ *                    SEEK_DATA 를 지원하지 않는 fs 면 파일 전체를 데이터 하나로
+ *   - scanner: 데이터 구간만 pread 해서 콜백으로 넘긴다 (hole 은 읽지 않음)
+ *   - punch: 다 쓴 구간을 FALLOC_FL_PUNCH_HOLE 로 fs 에 돌려준다 (크기 유지).
+ *            지원하지 않으면 ZERO_RANGE, 그것도 안 되면 0 을 써서 읽기 결과는 같게
+ *   - dig: 데이터 구간 안의 0 으로만 된 block 을 찾아 punch
+ *
+ * 복사는 fcopy (file_copy.h) 의 sparse 옵션이 같은 방식으로 hole 을 건너뛴다.
+ *
+ * 사용 예:
+ *   struct sxt_iter it;
+ *   struct sxt_extent e;
+ *   sxt_iter_init(&it, fd);
+ *   while (sxt_iter_next(&it, &e) > 0)
+ *       printf("%s %lld+%llu\n", e.hole ? "hole" : "data", e.off, e.len);
+ *
+ *   sxt_scan(fd, NULL, on_data, ctx, &st);
+ *   sxt_punch(fd, off, len);
+ *
+ * Build: gcc -O2 -c sparse_io.c
+ */
+
+#ifndef SPARSE_IO_H
+#define SPARSE_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define SXT_DEFAULT_BUF (1024 * 1024)
+
+struct sxt_extent {
+    off_t off;
+    uint64_t len;
+    int hole;
+};
+
+/* 초기화할 때의 파일 크기까지 본다 */
+struct sxt_iter {
+    int fd;
+    off_t pos;
+    off_t size;
+    int no_seek_data;            /* SEEK_DATA 미지원: 나머지는 전부 데이터 */
+};
+
+int sxt_iter_init(struct sxt_iter *it, int fd);
+
+/* 1: e 를 채움, 0: 끝, -1: 실패 */
+int sxt_iter_next(struct sxt_iter *it, struct sxt_extent *e);
+
+struct sxt_scan_options {
+    size_t buf_size;             /* 0 이면 SXT_DEFAULT_BUF */
+};
+
+struct sxt_stats {
+    uint64_t data_bytes;
+    uint64_t hole_bytes;
+    uint64_t data_extents;
+    uint64_t reads;
+};
+
+/* 데이터를 buf_size 이하로 잘라 넘긴다. 콜백이 0 이 아닌 값을 돌려주면 멈추고 그 값을 돌려준다 */
+typedef int (*sxt_data_cb)(void *arg, off_t off, const void *buf, size_t len);
+
+int sxt_scan(int fd, const struct sxt_scan_options *opts, sxt_data_cb cb, void *arg,
+             struct sxt_stats *stats);
+
+/* [off, off+len) 이 0 으로 읽히게 하고 가능하면 블록을 돌려준다.
+ * 0: punch 함, 1: 지원하지 않아 0 으로 채움, -1: 실패 */
+int sxt_punch(int fd, off_t off, uint64_t len);
+
+/* 데이터 구간에서 block 단위로 0 인 곳을 punch. 돌려준 바이트 수, 실패 시 -1 */
+int64_t sxt_dig(int fd, size_t block);
+
+/* 실제로 할당된 바이트 (st_blocks * 512) */
+int64_t sxt_allocated(int fd);
+
+#endif
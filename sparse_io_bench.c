@@ -0,0 +1,299 @@
+/*
+ * Sparse-File Benchmark
+ *
+ * 10MB 마다 1MB 만 데이터인 (90% hole) 파일에서:
+ *
+ *   scan,dense   - read() 로 처음부터 끝까지 (hole 은 0 으로 읽힘)
+ *   scan,sparse  - sxt_scan: 데이터 구간만
+ *   copy,dense   - fcopy_path, sparse = 0 (hole 도 0 으로 써서 대상이 꽉 참)
+ *   copy,sparse  - fcopy_path, sparse = 1
+ *   punch        - 데이터 구간마다 앞 절반을 sxt_punch
+ *   dig          - 파일 가운데 4MB 를 0 으로 쓴 뒤 sxt_dig 으로 되돌림
+ *
+ * 모든 scan/copy 는 같은 checksum 이 나오는지 확인한다.
+ *
+ * Output (CSV): op,variant,size,data_bytes,allocated_bytes,seconds,gb_per_sec
+ *
+ * Build: gcc -O2 -pthread -o sparse_io_bench sparse_io_bench.c sparse_io.c file_copy.c
+ * Usage: ./sparse_io_bench [-f path] [-s size] [-C]
+ *   -C: 매 측정 전 page cache 비우기
+ */
+
+#define _GNU_SOURCE
+#include "sparse_io.h"
+#include "file_copy.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define DATA_LEN (1024 * 1024)
+#define STRIDE (10 * DATA_LEN)           /* 10MB 마다 1MB 데이터 */
+#define DIG_LEN (4 * 1024 * 1024)
+
+static int cold;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    }
+    return v;
+}
+
+static void drop_cache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd != -1) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+/* 0 은 더해도 그대로라 hole 을 읽든 건너뛰든 같은 값 */
+static int sum_cb(void *arg, off_t off, const void *buf, size_t len) {
+    uint64_t *sum = arg;
+    const unsigned char *p = buf;
+    (void)off;
+    for (size_t i = 0; i < len; i++)
+        *sum += p[i];
+    return 0;
+}
+
+static void report(const char *op, const char *variant, const char *path, uint64_t data,
+                   double secs) {
+    struct stat st;
+    uint64_t size = 0, alloc = 0;
+    if (stat(path, &st) == 0) {
+        size = st.st_size;
+        alloc = (uint64_t)st.st_blocks * 512;
+    }
+    printf("%s,%s,%llu,%llu,%llu,%.4f,%.2f\n", op, variant, (unsigned long long)size,
+           (unsigned long long)data, (unsigned long long)alloc, secs,
+           size / secs / (1024.0 * 1024.0 * 1024.0));
+    fflush(stdout);
+}
+
+static int create_sparse(const char *path, uint64_t size, uint64_t *sum) {
+    char *buf = malloc(DATA_LEN);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (!buf || fd < 0 || ftruncate(fd, size) == -1) {
+        free(buf);
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    *sum = 0;
+    for (uint64_t off = 0; off < size; off += STRIDE) {
+        size_t len = size - off < DATA_LEN ? size - off : DATA_LEN;
+        for (size_t i = 0; i < len; i++)
+            buf[i] = (char)(((off / STRIDE + i) % 255) + 1);
+        if (pwrite(fd, buf, len, off) != (ssize_t)len) {
+            free(buf);
+            close(fd);
+            return -1;
+        }
+        sum_cb(sum, off, buf, len);
+    }
+    free(buf);
+    return close(fd);
+}
+
+static int scan_dense(const char *path, uint64_t *sum, uint64_t *bytes) {
+    char *buf = malloc(SXT_DEFAULT_BUF);
+    int fd = open(path, O_RDONLY);
+    ssize_t n;
+
+    if (!buf || fd < 0) {
+        free(buf);
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    *sum = 0;
+    *bytes = 0;
+    while ((n = read(fd, buf, SXT_DEFAULT_BUF)) > 0) {
+        sum_cb(sum, 0, buf, n);
+        *bytes += n;
+    }
+    free(buf);
+    close(fd);
+    return n == 0 ? 0 : -1;
+}
+
+static int scan_sparse(const char *path, uint64_t *sum, struct sxt_stats *st) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    *sum = 0;
+    int ret = sxt_scan(fd, NULL, sum_cb, sum, st);
+    close(fd);
+    return ret;
+}
+
+static int run_scan(const char *path, int sparse, uint64_t expect) {
+    struct sxt_stats st = { 0 };
+    uint64_t sum, bytes = 0;
+
+    if (cold)
+        drop_cache(path);
+    double t0 = now_sec();
+    int ret = sparse ? scan_sparse(path, &sum, &st) : scan_dense(path, &sum, &bytes);
+    double secs = now_sec() - t0;
+    if (ret == -1 || sum != expect) {
+        fprintf(stderr, "scan %s: %s\n", sparse ? "sparse" : "dense",
+                ret == -1 ? strerror(errno) : "checksum mismatch");
+        return -1;
+    }
+    /* dense 는 구멍까지 전부 읽으므로 읽은 바이트가 곧 파일 크기 */
+    report("scan", sparse ? "sparse" : "dense", path, sparse ? st.data_bytes : bytes, secs);
+    return 0;
+}
+
+static int run_copy(const char *src, const char *dst, int sparse, uint64_t expect) {
+    struct fcopy_options o = { .sparse = sparse };
+    struct fcopy_stats fs;
+    struct sxt_stats st;
+    uint64_t sum;
+
+    if (cold)
+        drop_cache(src);
+    unlink(dst);
+    double t0 = now_sec();
+    int ret = fcopy_path(src, dst, &o, &fs);
+    double secs = now_sec() - t0;
+    if (ret == -1 || scan_sparse(dst, &sum, &st) == -1 || sum != expect) {
+        fprintf(stderr, "copy %s: %s\n", sparse ? "sparse" : "dense",
+                ret == -1 ? strerror(errno) : "checksum mismatch");
+        return -1;
+    }
+    report("copy", sparse ? "sparse" : "dense", dst, fs.bytes, secs);
+    return 0;
+}
+
+/* 데이터 구간마다 앞 절반을 punch: 할당량이 줄고 그 부분은 0 으로 읽혀야 한다 */
+static int run_punch(const char *path, uint64_t *expect) {
+    struct sxt_iter it;
+    struct sxt_extent e;
+    int fd = open(path, O_RDWR);
+    if (fd < 0 || sxt_iter_init(&it, fd) == -1)
+        return -1;
+
+    int64_t before = sxt_allocated(fd);
+    uint64_t punched = 0, lost = 0;
+    char *buf = malloc(DATA_LEN);
+    double t0 = now_sec();
+    int ret = 0;
+    while (buf && ret == 0 && sxt_iter_next(&it, &e) > 0) {
+        if (e.hole)
+            continue;
+        uint64_t half = (e.len / 2) & ~(uint64_t)4095;
+        /* 잃게 될 바이트를 checksum 에서 뺀다 */
+        for (uint64_t done = 0; done < half; done += DATA_LEN) {
+            size_t n = half - done < DATA_LEN ? half - done : DATA_LEN;
+            if (pread(fd, buf, n, e.off + done) != (ssize_t)n) {
+                ret = -1;
+                break;
+            }
+            sum_cb(&lost, 0, buf, n);
+        }
+        if (ret == 0 && sxt_punch(fd, e.off, half) == -1)
+            ret = -1;
+        punched += half;
+    }
+    double secs = now_sec() - t0;
+    int64_t after = sxt_allocated(fd);
+    free(buf);
+    close(fd);
+
+    *expect -= lost;
+    uint64_t sum;
+    struct sxt_stats st;
+    if (!buf || ret == -1 || scan_sparse(path, &sum, &st) == -1 || sum != *expect ||
+        before - after < (int64_t)punched / 2) {
+        fprintf(stderr, "punch check failed (allocated %lld -> %lld, punched %llu)\n",
+                (long long)before, (long long)after, (unsigned long long)punched);
+        return -1;
+    }
+    report("punch", "half", path, punched, secs);
+    return 0;
+}
+
+static int run_dig(const char *path, uint64_t size) {
+    int fd = open(path, O_RDWR);
+    if (fd < 0)
+        return -1;
+    /* hole 자리에 0 을 써서 블록이 할당되게 한다 */
+    off_t off = (size / 2 / STRIDE) * STRIDE + DATA_LEN;
+    char *zeros = calloc(1, DIG_LEN);
+    int ok = zeros && off + DIG_LEN <= (off_t)size &&
+             pwrite(fd, zeros, DIG_LEN, off) == DIG_LEN && fdatasync(fd) == 0;
+    free(zeros);
+    int64_t before = sxt_allocated(fd);
+
+    double t0 = now_sec();
+    int64_t reclaimed = ok ? sxt_dig(fd, 4096) : -1;
+    double secs = now_sec() - t0;
+    int64_t after = sxt_allocated(fd);
+    close(fd);
+
+    if (reclaimed < DIG_LEN || before - after < DIG_LEN) {
+        fprintf(stderr, "dig check failed (reclaimed %lld, allocated %lld -> %lld)\n",
+                (long long)reclaimed, (long long)before, (long long)after);
+        return -1;
+    }
+    report("dig", "4k", path, reclaimed, secs);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = "sparse_bench.dat";
+    uint64_t size = 10ULL << 30;
+    char dst[4096];
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:s:C")) != -1) {
+        switch (opt) {
+        case 'f': path = optarg; break;
+        case 's': size = parse_size(optarg); break;
+        case 'C': cold = 1; break;
+        default:
+            fprintf(stderr, "Usage: %s [-f path] [-s size] [-C]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (size < 2 * STRIDE) {
+        fprintf(stderr, "size must be at least %d\n", 2 * STRIDE);
+        return 1;
+    }
+    snprintf(dst, sizeof(dst), "%s.copy", path);
+
+    uint64_t sum;
+    if (create_sparse(path, size, &sum) == -1) {
+        perror(path);
+        return 1;
+    }
+
+    printf("op,variant,size,data_bytes,allocated_bytes,seconds,gb_per_sec\n");
+    int ret = run_scan(path, 0, sum) == -1 || run_scan(path, 1, sum) == -1 ||
+              run_copy(path, dst, 0, sum) == -1 || run_copy(path, dst, 1, sum) == -1 ||
+              run_punch(path, &sum) == -1 || run_dig(path, size) == -1;
+    unlink(dst);
+    unlink(path);
+    return ret;
+}
@@ -0,0 +1,326 @@
+/*
+ * Zero-Copy Pipe Transport (vmsplice / splice)
+ *
+ * Build: gcc -O2 -c splice_pipe.c
+ */
+
+#define _GNU_SOURCE
+#include "splice_pipe.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+struct spipe_writer {
+    int fd;
+    int use_vmsplice;
+    char *ring;                  /* nslots * chunk, page-aligned */
+    size_t chunk;
+    size_t nslots;
+    size_t cur;                  /* spipe_writer_buf 가 내줄 slot */
+    size_t page;
+    size_t pipe_pages;           /* pipe 가 동시에 들고 있을 수 있는 buffer 수 */
+    uint64_t pages;              /* 지금까지 pipe 에 넣은 buffer 수 (하한) */
+    uint64_t bytes;
+    uint64_t *slot_pages;        /* slot 을 commit 한 직후의 pages, 0 이면 미사용 */
+    uint64_t *slot_bytes;        /* 같은 시점의 bytes */
+    struct spipe_stats st;
+};
+
+struct spipe_reader {
+    int in_fd;
+    int out_fd;
+    int use_splice;
+    unsigned int splice_flags;
+    size_t chunk;
+    char *buf;                   /* read/write fallback 용, 처음 필요할 때 할당 */
+    size_t pend_off;
+    size_t pend_len;             /* 읽었지만 아직 못 쓴 바이트 */
+    struct spipe_stats st;
+};
+
+static size_t round_up(size_t v, size_t a) {
+    return (v + a - 1) / a * a;
+}
+
+/* splice 계열이 이 fd 조합을 지원하지 않는다는 뜻의 errno */
+static int unsupported(int err) {
+    return err == EINVAL || err == ENOSYS || err == EOPNOTSUPP || err == EBADF;
+}
+
+static void wait_writable(int fd) {
+    struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+    poll(&pfd, 1, -1);
+}
+
+long spipe_set_size(int pipe_fd, size_t size) {
+    long cur = fcntl(pipe_fd, F_GETPIPE_SZ);
+    if (cur == -1)
+        return -1;
+    if ((size_t)cur >= size)
+        return cur;
+    if (fcntl(pipe_fd, F_SETPIPE_SZ, (int)size) != -1)
+        return fcntl(pipe_fd, F_GETPIPE_SZ);
+    if (errno != EPERM)
+        return -1;
+
+    /* 비특권 프로세스는 pipe-max-size 까지만 키울 수 있다 */
+    long max = 0;
+    FILE *f = fopen("/proc/sys/fs/pipe-max-size", "r");
+    if (f) {
+        if (fscanf(f, "%ld", &max) != 1)
+            max = 0;
+        fclose(f);
+    }
+    if (max > cur)
+        fcntl(pipe_fd, F_SETPIPE_SZ, (int)max);
+    return fcntl(pipe_fd, F_GETPIPE_SZ);
+}
+
+struct spipe_writer *spipe_writer_open(int pipe_wfd, const struct spipe_options *opts) {
+    struct spipe_writer *w = calloc(1, sizeof(*w));
+    if (!w)
+        return NULL;
+
+    w->fd = pipe_wfd;
+    w->page = sysconf(_SC_PAGESIZE);
+    w->chunk = round_up(opts && opts->chunk ? opts->chunk : SPIPE_DEFAULT_CHUNK, w->page);
+    w->use_vmsplice = !(opts && opts->no_splice);
+
+    long cap = spipe_set_size(pipe_wfd, opts && opts->pipe_size ? opts->pipe_size
+                                                                : SPIPE_DEFAULT_PIPE_SIZE);
+    if (cap == -1) {
+        /* pipe 가 아니면 vmsplice 도 못 쓴다 */
+        w->use_vmsplice = 0;
+        cap = w->chunk;
+    }
+    w->st.pipe_size = cap;
+    w->pipe_pages = (cap + w->page - 1) / w->page;
+
+    /*
+     * chunk 를 꽉 채워 commit 하면 나머지 slot 들이 pipe 용량 이상을 채운 뒤에야
+     * 같은 slot 으로 돌아오므로 기다릴 일이 없다.
+     */
+    w->nslots = (cap + w->chunk - 1) / w->chunk + 2;
+    w->ring = mmap(NULL, w->nslots * w->chunk, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    w->slot_pages = calloc(w->nslots, sizeof(*w->slot_pages));
+    w->slot_bytes = calloc(w->nslots, sizeof(*w->slot_bytes));
+    if (w->ring == MAP_FAILED || !w->slot_pages || !w->slot_bytes) {
+        int saved = errno;
+        if (w->ring != MAP_FAILED)
+            munmap(w->ring, w->nslots * w->chunk);
+        free(w->slot_pages);
+        free(w->slot_bytes);
+        free(w);
+        errno = saved;
+        return NULL;
+    }
+    return w;
+}
+
+/* slot 의 페이지가 pipe 를 빠져나갔는가 */
+static int slot_free(struct spipe_writer *w, size_t i) {
+    if (!w->use_vmsplice || w->slot_pages[i] == 0)
+        return 1;
+    /* 그 뒤로 pipe 용량만큼 buffer 를 넣었다면 이미 빠져나갔다 */
+    if (w->pages - w->slot_pages[i] >= w->pipe_pages)
+        return 1;
+    /* pipe 에 남은 바이트는 가장 최근에 넣은 것들이다 */
+    int queued;
+    if (ioctl(w->fd, FIONREAD, &queued) == -1)
+        return 0;
+    return w->bytes - (uint64_t)queued >= w->slot_bytes[i];
+}
+
+void *spipe_writer_buf(struct spipe_writer *w, size_t *cap) {
+    struct timespec ts = { 0, 20000 };
+
+    while (!slot_free(w, w->cur)) {
+        w->st.waits++;
+        nanosleep(&ts, NULL);
+    }
+    if (cap)
+        *cap = w->chunk;
+    return w->ring + w->cur * w->chunk;
+}
+
+int spipe_writer_commit(struct spipe_writer *w, size_t len) {
+    char *p = w->ring + w->cur * w->chunk;
+    size_t done = 0;
+
+    if (len > w->chunk) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    while (done < len) {
+        ssize_t n;
+        if (w->use_vmsplice) {
+            struct iovec iov = { .iov_base = p + done, .iov_len = len - done };
+            n = vmsplice(w->fd, &iov, 1, SPLICE_F_GIFT);
+            if (n == -1 && unsupported(errno)) {
+                w->use_vmsplice = 0;
+                continue;
+            }
+        } else {
+            n = write(w->fd, p + done, len - done);
+        }
+        w->st.calls++;
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN) {
+                wait_writable(w->fd);
+                continue;
+            }
+            return -1;
+        }
+        if (w->use_vmsplice)
+            w->st.zc_bytes += n;
+        else
+            w->st.copy_bytes += n;
+        done += n;
+    }
+
+    /* 페이지마다 pipe buffer 를 적어도 하나 쓴다 (부분 vmsplice 는 더 쓸 뿐) */
+    w->pages += (len + w->page - 1) / w->page;
+    w->bytes += len;
+    w->slot_pages[w->cur] = w->pages;
+    w->slot_bytes[w->cur] = w->bytes;
+    w->cur = (w->cur + 1) % w->nslots;
+    w->st.bytes += len;
+    return 0;
+}
+
+int spipe_writer_write(struct spipe_writer *w, const void *buf, size_t len) {
+    const char *src = buf;
+
+    while (len > 0) {
+        size_t cap;
+        char *dst = spipe_writer_buf(w, &cap);
+        size_t n = len < cap ? len : cap;
+        memcpy(dst, src, n);
+        if (spipe_writer_commit(w, n) == -1)
+            return -1;
+        src += n;
+        len -= n;
+    }
+    return 0;
+}
+
+void spipe_writer_close(struct spipe_writer *w, struct spipe_stats *st) {
+    if (!w)
+        return;
+    if (st)
+        *st = w->st;
+    /*
+     * pipe 가 아직 들고 있는 페이지가 있어도 munmap 해도 된다.
+     * pipe 가 페이지 참조를 갖고 있으므로 consumer 는 그대로 읽는다.
+     */
+    munmap(w->ring, w->nslots * w->chunk);
+    free(w->slot_pages);
+    free(w->slot_bytes);
+    free(w);
+}
+
+struct spipe_reader *spipe_reader_open(int pipe_rfd, int out_fd,
+                                       const struct spipe_options *opts) {
+    struct spipe_reader *r = calloc(1, sizeof(*r));
+    if (!r)
+        return NULL;
+
+    r->in_fd = pipe_rfd;
+    r->out_fd = out_fd;
+    r->use_splice = !(opts && opts->no_splice);
+    r->chunk = opts && opts->chunk ? opts->chunk : SPIPE_DEFAULT_CHUNK;
+
+    long cap = fcntl(pipe_rfd, F_GETPIPE_SZ);
+    if (cap == -1)
+        r->use_splice = 0;
+    r->st.pipe_size = cap == -1 ? 0 : cap;
+
+    int fl = fcntl(pipe_rfd, F_GETFL);
+    r->splice_flags = SPLICE_F_MOVE | (fl != -1 && (fl & O_NONBLOCK) ? SPLICE_F_NONBLOCK : 0);
+    return r;
+}
+
+static ssize_t pump_rw(struct spipe_reader *r, size_t max) {
+    if (!r->buf && !(r->buf = malloc(r->chunk)))
+        return -1;
+
+    if (r->pend_len == 0) {
+        ssize_t n;
+        do {
+            n = read(r->in_fd, r->buf, max < r->chunk ? max : r->chunk);
+        } while (n == -1 && errno == EINTR);
+        r->st.calls++;
+        if (n <= 0)
+            return n;
+        r->pend_off = 0;
+        r->pend_len = n;
+    }
+
+    /* out_fd 가 EAGAIN 이면 남은 것은 다음 pump 에서 쓴다 */
+    size_t moved = 0;
+    while (r->pend_len > 0) {
+        ssize_t n = write(r->out_fd, r->buf + r->pend_off, r->pend_len);
+        r->st.calls++;
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            if (moved)
+                break;
+            return -1;
+        }
+        r->pend_off += n;
+        r->pend_len -= n;
+        moved += n;
+    }
+    r->st.copy_bytes += moved;
+    r->st.bytes += moved;
+    return moved;
+}
+
+ssize_t spipe_reader_pump(struct spipe_reader *r, size_t max) {
+    if (max == 0)
+        return 0;
+
+    /* fallback 으로 읽어 둔 데이터가 있으면 순서를 지키기 위해 그것부터 */
+    if (r->use_splice && r->pend_len == 0) {
+        size_t want = r->st.pipe_size && max > r->st.pipe_size ? r->st.pipe_size : max;
+        while (1) {
+            ssize_t n = splice(r->in_fd, NULL, r->out_fd, NULL, want, r->splice_flags);
+            r->st.calls++;
+            if (n >= 0) {
+                r->st.zc_bytes += n;
+                r->st.bytes += n;
+                return n;
+            }
+            if (errno == EINTR)
+                continue;
+            if (!unsupported(errno))
+                return -1;
+            r->use_splice = 0;
+            break;
+        }
+    }
+    return pump_rw(r, max);
+}
+
+void spipe_reader_close(struct spipe_reader *r, struct spipe_stats *st) {
+    if (!r)
+        return;
+    if (st)
+        *st = r->st;
+    free(r->buf);
+    free(r);
+}
@@ -0,0 +1,97 @@
+/*
+ * Zero-Copy Pipe Transport (vmsplice / splice)
+ *
+ * 4.c 의 FIFO 경로는 데이터 1 바이트마다 CPU 복사를 3 번 한다:
+ *   producer write()  : user buffer -> pipe buffer
+ *   consumer read()   : pipe buffer -> user buffer
+ *   consumer write()  : user buffer -> page cache / socket
+ *
+ * spipe 는 양쪽 끝의 복사를 없앤다:
+ *   producer vmsplice(SPLICE_F_GIFT) : user 페이지를 pipe 에 참조로 넣음 (복사 없음)
+ *   consumer splice()                : pipe -> 파일/소켓 (커널 안에서 1 번 또는 0 번)
+ *
+ * vmsplice 한 페이지는 consumer 가 pipe 에서 꺼낼 때까지 pipe 가 참조하므로
+ * 그 전에 다시 쓰면 안 된다. spipe_writer 는 page-aligned buffer ring 을 갖고,
+ * 이미 pipe 를 빠져나갔다고 보장되는 chunk 만 spipe_writer_buf() 로 내준다
+ * (이후 commit 된 pipe slot 수로 판단, 부족하면 FIONREAD 로 확인).
+ * consumer 가 TCP 소켓으로 splice 하면 전송이 끝날 때까지 소켓이 페이지를
+ * 더 들고 있을 수 있으므로, 그때는 chunk 를 pipe 용량보다 넉넉히 두거나
+ * spipe_writer_write() 대신 복사본을 넘겨야 안전하다.
+ *
+ * vmsplice 가 안 되면 (fd 가 pipe 가 아님 등) write() 로,
+ * splice 가 안 되면 (O_APPEND 파일, 지원하지 않는 fs 등) read()/write() 로 바꾼다.
+ *
+ * 사용 예:
+ *   producer:
+ *     struct spipe_writer *w = spipe_writer_open(fifo_wfd, NULL);
+ *     void *p = spipe_writer_buf(w, &cap);   // 채운 뒤
+ *     spipe_writer_commit(w, len);
+ *   consumer:
+ *     struct spipe_reader *r = spipe_reader_open(fifo_rfd, out_fd, NULL);
+ *     while ((n = spipe_reader_pump(r, SIZE_MAX)) > 0) ...
+ *
+ * Build: gcc -O2 -c splice_pipe.c
+ */
+
+#ifndef SPLICE_PIPE_H
+#define SPLICE_PIPE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define SPIPE_DEFAULT_PIPE_SIZE (1024 * 1024)
+#define SPIPE_DEFAULT_CHUNK (64 * 1024)
+
+struct spipe_options {
+    size_t pipe_size;            /* F_SETPIPE_SZ 요청값, 0 이면 기본값 */
+    size_t chunk;                /* writer buffer / reader 한 번에 옮길 크기 */
+    int no_splice;               /* 1 이면 처음부터 write / read+write */
+};
+
+struct spipe_stats {
+    uint64_t bytes;
+    uint64_t zc_bytes;           /* vmsplice / splice 로 옮긴 바이트 */
+    uint64_t copy_bytes;         /* write / read+write 로 옮긴 바이트 */
+    uint64_t calls;              /* vmsplice/splice/read/write 호출 수 */
+    uint64_t waits;              /* writer: buffer 재사용을 기다린 횟수 */
+    size_t pipe_size;            /* 실제 pipe 용량 */
+};
+
+struct spipe_writer;
+struct spipe_reader;
+
+/*
+ * pipe 용량을 size 이상으로 키운다. 권한 한도 (pipe-max-size) 를 넘으면
+ * 한도까지. 실제 용량을 돌려준다 (-1 + errno).
+ */
+long spipe_set_size(int pipe_fd, size_t size);
+
+/* producer. pipe_wfd 는 pipe 나 FIFO 의 쓰기 끝 */
+struct spipe_writer *spipe_writer_open(int pipe_wfd, const struct spipe_options *opts);
+
+/* 채워서 commit 할 page-aligned buffer. *cap 에 크기 (= chunk) */
+void *spipe_writer_buf(struct spipe_writer *w, size_t *cap);
+
+/* 마지막 spipe_writer_buf 의 앞 len 바이트를 보낸다 (전부 보낼 때까지 block) */
+int spipe_writer_commit(struct spipe_writer *w, size_t len);
+
+/* 임의의 buffer 를 보낸다 (writer buffer 로 복사해서 commit) */
+int spipe_writer_write(struct spipe_writer *w, const void *buf, size_t len);
+
+/* fd 는 닫지 않는다 */
+void spipe_writer_close(struct spipe_writer *w, struct spipe_stats *st);
+
+/* consumer. pipe_rfd 에서 out_fd 로 옮긴다 */
+struct spipe_reader *spipe_reader_open(int pipe_rfd, int out_fd,
+                                       const struct spipe_options *opts);
+
+/*
+ * 최대 max 바이트를 옮긴다. 옮긴 바이트, 0 이면 EOF (모든 writer 가 닫음).
+ * -1 + errno (non-blocking fd 면 EAGAIN)
+ */
+ssize_t spipe_reader_pump(struct spipe_reader *r, size_t max);
+
+void spipe_reader_close(struct spipe_reader *r, struct spipe_stats *st);
+
+#endif
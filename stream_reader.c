@@ -0,0 +1,298 @@
+/*
+ * Adaptive Prefetching Stream Reader - 구현
+ *
+ * 버퍼 2개를 번갈아 쓴다. 각 버퍼는 EMPTY -> (producer 가 채움) -> FULL
+ * -> (소비자가 처리) -> EMPTY 로 돈다. EMPTY 인 버퍼는 producer 만 만지므로
+ * 버퍼를 키우는 realloc 도 lock 없이 producer 쪽에서 한다.
+ *
+ * 크기 적응은 단순한 hill climbing:
+ *   꽉 채운 fill 의 처리량이 이전 크기보다 5% 이상 좋으면 2배로,
+ *   아니면 거기서 고정한다.
+ */
+
+#define _GNU_SOURCE
+#include "stream_reader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+enum { BUF_EMPTY, BUF_FULL, BUF_EOF, BUF_ERROR };
+
+struct sbuf {
+    char *data;
+    size_t cap;
+    size_t len;
+    uint64_t off;
+    int state;
+    int err;
+};
+
+struct sreader {
+    int fd;
+    int own_fd;
+    int hints;
+    size_t max_buf;
+
+    struct sbuf bufs[2];
+    int next_idx;                /* 소비자가 다음에 받을 버퍼 */
+    int held;                    /* 소비자가 들고 있는 버퍼, 없으면 -1 */
+
+    /* producer 전용 */
+    uint64_t read_off;
+    size_t want;                 /* 다음 fill 크기 */
+    double last_tput;
+    int grow_done;
+
+    int threaded;
+    int stop;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    atomic_uint_fast64_t bytes;
+    atomic_uint_fast64_t syscalls;
+    atomic_uint_fast64_t waits;
+    atomic_size_t cur_size;
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void adapt(struct sreader *r, size_t len, double secs) {
+    if (r->grow_done || len < r->want || secs <= 0)
+        return;
+
+    double tput = len / secs;
+    if (r->last_tput == 0 || tput > r->last_tput * 1.05) {
+        r->last_tput = tput;
+        if (r->want * 2 <= r->max_buf) {
+            r->want *= 2;
+            atomic_store(&r->cur_size, r->want);
+        } else {
+            r->grow_done = 1;
+        }
+    } else {
+        r->grow_done = 1;
+    }
+}
+
+/* producer 쪽: 빈 버퍼 b 를 채우고 상태를 돌려준다 */
+static int fill(struct sreader *r, struct sbuf *b) {
+    if (b->cap < r->want) {
+        char *p = realloc(b->data, r->want);
+        if (p) {
+            b->data = p;
+            b->cap = r->want;
+        } else if (!b->data) {
+            b->err = ENOMEM;
+            return BUF_ERROR;
+        }
+    }
+    size_t want = b->cap < r->want ? b->cap : r->want;
+
+    /* 이번 구간 다음 창을 미리 page cache 로 */
+    if (r->hints) {
+        atomic_fetch_add(&r->syscalls, 1);
+        if (readahead(r->fd, (off64_t)(r->read_off + want), want) == -1)
+            r->hints = 0;        /* pipe 등: 이후로는 시도하지 않음 */
+    }
+
+    double t0 = now_sec();
+    size_t len = 0;
+    while (len < want) {
+        ssize_t n = read(r->fd, b->data + len, want - len);
+        atomic_fetch_add(&r->syscalls, 1);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            if (len)
+                break;           /* 읽은 것은 먼저 넘기고 다음 fill 에서 에러 */
+            b->err = errno;
+            return BUF_ERROR;
+        }
+        if (n == 0)
+            break;
+        len += n;
+    }
+    adapt(r, len, now_sec() - t0);
+
+    b->len = len;
+    b->off = r->read_off;
+    r->read_off += len;
+    return len ? BUF_FULL : BUF_EOF;
+}
+
+static void *prefetch_main(void *arg) {
+    struct sreader *r = arg;
+    int idx = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&r->lock);
+        while (r->bufs[idx].state != BUF_EMPTY && !r->stop)
+            pthread_cond_wait(&r->cond, &r->lock);
+        int stop = r->stop;
+        pthread_mutex_unlock(&r->lock);
+        if (stop)
+            break;
+
+        int st = fill(r, &r->bufs[idx]);
+
+        pthread_mutex_lock(&r->lock);
+        r->bufs[idx].state = st;
+        pthread_cond_broadcast(&r->cond);
+        pthread_mutex_unlock(&r->lock);
+
+        if (st != BUF_FULL)
+            break;
+        idx ^= 1;
+    }
+    return NULL;
+}
+
+struct sreader *sreader_from_fd(int fd, const struct sreader_options *opts) {
+    struct sreader_options o = { 0 };
+    if (opts)
+        o = *opts;
+    if (o.min_buf == 0)
+        o.min_buf = SREADER_MIN_BUF;
+    if (o.max_buf == 0)
+        o.max_buf = SREADER_MAX_BUF;
+    if (o.max_buf < o.min_buf)
+        o.max_buf = o.min_buf;
+
+    struct sreader *r = calloc(1, sizeof(*r));
+    if (!r)
+        return NULL;
+
+    r->fd = fd;
+    r->held = -1;
+    r->hints = !o.no_hints;
+    r->max_buf = o.max_buf;
+    r->want = o.min_buf;
+    atomic_init(&r->bytes, 0);
+    atomic_init(&r->syscalls, 0);
+    atomic_init(&r->waits, 0);
+    atomic_init(&r->cur_size, o.min_buf);
+
+    off_t pos = lseek(fd, 0, SEEK_CUR);
+    r->read_off = pos == (off_t)-1 ? 0 : (uint64_t)pos;
+
+    if (r->hints) {
+        atomic_fetch_add(&r->syscalls, 1);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    if (!o.no_prefetch) {
+        pthread_mutex_init(&r->lock, NULL);
+        pthread_cond_init(&r->cond, NULL);
+        int err = pthread_create(&r->thread, NULL, prefetch_main, r);
+        if (err == 0) {
+            r->threaded = 1;
+        } else {
+            /* 스레드를 못 만들면 동기 모드로 동작 */
+            pthread_mutex_destroy(&r->lock);
+            pthread_cond_destroy(&r->cond);
+        }
+    }
+    return r;
+}
+
+struct sreader *sreader_open(const char *path, const struct sreader_options *opts) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct sreader *r = sreader_from_fd(fd, opts);
+    if (!r) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return NULL;
+    }
+    r->own_fd = 1;
+    return r;
+}
+
+int sreader_next(struct sreader *r, struct sreader_chunk *out) {
+    struct sbuf *b;
+    int st;
+
+    if (!r->threaded) {
+        /* 동기 모드: 버퍼 하나를 계속 다시 채운다 */
+        b = &r->bufs[0];
+        if (b->state == BUF_FULL || b->state == BUF_EMPTY)
+            b->state = fill(r, b);
+        st = b->state;
+    } else {
+        if (r->held >= 0) {
+            pthread_mutex_lock(&r->lock);
+            r->bufs[r->held].state = BUF_EMPTY;
+            pthread_cond_broadcast(&r->cond);
+            pthread_mutex_unlock(&r->lock);
+            r->held = -1;
+        }
+
+        b = &r->bufs[r->next_idx];
+        pthread_mutex_lock(&r->lock);
+        if (b->state == BUF_EMPTY) {
+            atomic_fetch_add(&r->waits, 1);
+            while (b->state == BUF_EMPTY)
+                pthread_cond_wait(&r->cond, &r->lock);
+        }
+        st = b->state;
+        pthread_mutex_unlock(&r->lock);
+
+        if (st == BUF_FULL) {
+            r->held = r->next_idx;
+            r->next_idx ^= 1;
+        }
+    }
+
+    if (st == BUF_EOF)
+        return 0;
+    if (st == BUF_ERROR) {
+        errno = b->err;
+        return -1;
+    }
+
+    out->data = b->data;
+    out->len = b->len;
+    out->offset = b->off;
+    atomic_fetch_add(&r->bytes, b->len);
+    return 1;
+}
+
+void sreader_get_stats(struct sreader *r, struct sreader_stats *st) {
+    st->bytes = atomic_load(&r->bytes);
+    st->syscalls = atomic_load(&r->syscalls);
+    st->consumer_waits = atomic_load(&r->waits);
+    st->buf_size = atomic_load(&r->cur_size);
+}
+
+void sreader_close(struct sreader *r) {
+    if (!r)
+        return;
+    if (r->threaded) {
+        pthread_mutex_lock(&r->lock);
+        r->stop = 1;
+        pthread_cond_broadcast(&r->cond);
+        pthread_mutex_unlock(&r->lock);
+        pthread_join(r->thread, NULL);
+        pthread_mutex_destroy(&r->lock);
+        pthread_cond_destroy(&r->cond);
+    }
+    free(r->bufs[0].data);
+    free(r->bufs[1].data);
+    if (r->own_fd)
+        close(r->fd);
+    free(r);
+}
@@ -0,0 +1,70 @@
+/*
+ * Adaptive Prefetching Stream Reader
+ *
+ * 2.c 는 1024 바이트 스택 버퍼 하나에 read() 한다.
+ * 큰 파일이면 KB 마다 syscall 1번이고, 읽는 동안 소비자는 아무것도 못 한다.
+ *
+ * 이 reader 는 파일을 chunk 단위로 흘려보낸다:
+ *
+ *   - 버퍼 크기 적응: min_buf 에서 시작해 처리량이 좋아지는 동안 2배씩 키움
+ *   - 커널 힌트: posix_fadvise(SEQUENTIAL) + 다음 구간 readahead()
+ *   - double buffering: prefetch 스레드가 버퍼 하나를 채우는 동안
+ *     소비자는 다른 버퍼를 처리한다
+ *
+ * 사용 예:
+ *   struct sreader *r = sreader_open("data", NULL);
+ *   struct sreader_chunk c;
+ *   while (sreader_next(r, &c) > 0)
+ *       process(c.data, c.len);
+ *   sreader_close(r);
+ *
+ * chunk 는 다음 sreader_next() 호출 전까지 유효하다.
+ *
+ * Build: gcc -O2 -pthread -c stream_reader.c
+ */
+
+#ifndef STREAM_READER_H
+#define STREAM_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SREADER_MIN_BUF (64 * 1024)
+#define SREADER_MAX_BUF (8 * 1024 * 1024)
+
+struct sreader_options {
+    size_t min_buf;              /* 0 이면 SREADER_MIN_BUF */
+    size_t max_buf;              /* 0 이면 SREADER_MAX_BUF */
+    int no_prefetch;             /* 1 이면 스레드 없이 호출한 쪽에서 read */
+    int no_hints;                /* 1 이면 fadvise/readahead 생략 */
+};
+
+struct sreader_chunk {
+    const char *data;
+    size_t len;
+    uint64_t offset;             /* 파일 안에서의 위치 */
+};
+
+struct sreader_stats {
+    uint64_t bytes;
+    uint64_t syscalls;           /* read + readahead + fadvise */
+    uint64_t consumer_waits;     /* 소비자가 prefetch 를 기다린 횟수 */
+    size_t buf_size;             /* 현재 버퍼 크기 */
+};
+
+struct sreader;
+
+/* 실패 시 NULL, errno 설정. opts 는 NULL 가능 */
+struct sreader *sreader_open(const char *path, const struct sreader_options *opts);
+
+/* fd 는 호출자가 닫는다 */
+struct sreader *sreader_from_fd(int fd, const struct sreader_options *opts);
+
+/* 1: chunk 하나, 0: EOF, -1: 에러 (errno) */
+int sreader_next(struct sreader *r, struct sreader_chunk *out);
+
+void sreader_get_stats(struct sreader *r, struct sreader_stats *st);
+
+void sreader_close(struct sreader *r);
+
+#endif
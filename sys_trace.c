@@ -0,0 +1,462 @@
+/*
+ * Syscall Latency Tracing (per-call-site HDR histograms)
+ *
+ * Build: gcc -O2 -c sys_trace.c
+ */
+
+#define _GNU_SOURCE
+#undef SYSTRACE                  /* 이 파일 안의 read/write 는 진짜 함수 */
+#include "sys_trace.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/syscall.h>
+
+#define MAX_SITES 1024
+#define SUB_BITS 5
+#define SUB (1 << SUB_BITS)
+#define MAX_SHIFT 39             /* 2^44 ns 까지 */
+#define NBUCKETS ((MAX_SHIFT + 2) * SUB)
+
+struct hist {
+    uint64_t calls;
+    uint64_t errors;
+    uint64_t bytes;
+    uint64_t timed;
+    uint64_t max;
+    uint64_t b[NBUCKETS];
+};
+
+/*
+ * 스레드마다 하나. 쓰는 것은 그 스레드뿐이고 dump 는 읽기만 하므로
+ * relaxed atomic load/store 로 충분하다 (read-modify-write 불필요).
+ * 끝난 스레드의 기록도 요약에 남도록 해제하지 않는다.
+ */
+struct tstate {
+    struct tstate *next;
+    unsigned int tick;
+    struct hist *h[MAX_SITES];
+};
+
+static const char *op_names[ST_OP_COUNT] = {
+    "read", "write", "pread", "pwrite", "fsync", "fdatasync", "mmap", "msync", "sendfile"
+};
+
+static struct systrace_site *sites[MAX_SITES];
+static int nsites;
+
+/* 방법 1 (--wrap) 의 주소 -> site 표 (open addressing) */
+static struct {
+    const void *addr;
+    struct systrace_site site;
+    int ready;
+} addr_table[MAX_SITES];
+
+static struct tstate *threads;
+static __thread struct tstate *self;
+static unsigned int sample_every = 1;
+static int out_fd = 2;
+
+#define LOAD(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define BUMP(p, v) STORE((p), LOAD(p) + (v))
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int bucket_of(uint64_t v) {
+    if (v < SUB)
+        return (int)v;
+    int shift = 63 - __builtin_clzll(v) - SUB_BITS;
+    if (shift > MAX_SHIFT)
+        return NBUCKETS - 1;
+    return (shift + 1) * SUB + (int)((v >> shift) - SUB);
+}
+
+/* bucket 에 들어가는 가장 큰 값 (HdrHistogram 의 highest equivalent value) */
+static uint64_t bucket_high(int i) {
+    if (i < SUB)
+        return i;
+    int shift = i / SUB - 1;
+    uint64_t top = i % SUB + SUB;
+    return ((top + 1) << shift) - 1;
+}
+
+static int site_register(struct systrace_site *s) {
+    int id = __atomic_load_n(&s->id, __ATOMIC_ACQUIRE);
+    if (id > 0)
+        return id;
+
+    int zero = 0;
+    if (__atomic_compare_exchange_n(&s->id, &zero, -1, 0, __ATOMIC_ACQ_REL,
+                                    __ATOMIC_ACQUIRE)) {
+        id = __atomic_add_fetch(&nsites, 1, __ATOMIC_ACQ_REL);
+        if (id > MAX_SITES) {
+            /* 자리가 없으면 기록하지 않음 (-1 로 남김) */
+            return -1;
+        }
+        __atomic_store_n(&sites[id - 1], s, __ATOMIC_RELEASE);
+        __atomic_store_n(&s->id, id, __ATOMIC_RELEASE);
+        return id;
+    }
+    /* 다른 스레드가 등록 중 */
+    while ((id = __atomic_load_n(&s->id, __ATOMIC_ACQUIRE)) == -1 &&
+           __atomic_load_n(&nsites, __ATOMIC_ACQUIRE) <= MAX_SITES)
+        ;
+    return id;
+}
+
+static struct tstate *thread_state(void) {
+    if (self)
+        return self;
+    struct tstate *t = calloc(1, sizeof(*t));
+    if (!t)
+        return NULL;
+    t->next = __atomic_load_n(&threads, __ATOMIC_ACQUIRE);
+    while (!__atomic_compare_exchange_n(&threads, &t->next, t, 0, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE))
+        ;
+    self = t;
+    return t;
+}
+
+uint64_t systrace_begin(void) {
+    unsigned int every = LOAD(&sample_every);
+    if (every > 1) {
+        struct tstate *t = thread_state();
+        if (!t || ++t->tick % every != 0)
+            return 0;
+    }
+    return now_ns();
+}
+
+void systrace_end(struct systrace_site *site, uint64_t t0, int ok, uint64_t bytes) {
+    uint64_t t1 = t0 ? now_ns() : 0;
+    int saved = errno;
+
+    struct tstate *t = thread_state();
+    int id = site ? site_register(site) : -1;
+    if (!t || id <= 0)
+        goto out;
+
+    struct hist *h = t->h[id - 1];
+    if (!h) {
+        h = calloc(1, sizeof(*h));
+        if (!h)
+            goto out;
+        __atomic_store_n(&t->h[id - 1], h, __ATOMIC_RELEASE);
+    }
+
+    BUMP(&h->calls, 1);
+    if (!ok)
+        BUMP(&h->errors, 1);
+    BUMP(&h->bytes, bytes);
+    if (t0) {
+        uint64_t d = t1 - t0;
+        BUMP(&h->timed, 1);
+        BUMP(&h->b[bucket_of(d)], 1);
+        if (d > LOAD(&h->max))
+            STORE(&h->max, d);
+    }
+out:
+    errno = saved;
+}
+
+struct systrace_site *systrace_site_at(const void *addr, int op) {
+    size_t i = ((uintptr_t)addr >> 2) * 0x9e3779b97f4a7c15ull % MAX_SITES;
+
+    for (size_t n = 0; n < MAX_SITES; n++, i = (i + 1) % MAX_SITES) {
+        const void *cur = __atomic_load_n(&addr_table[i].addr, __ATOMIC_ACQUIRE);
+        if (!cur) {
+            const void *expected = NULL;
+            if (__atomic_compare_exchange_n(&addr_table[i].addr, &expected, addr, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                addr_table[i].site.addr = addr;
+                addr_table[i].site.op = op;
+                __atomic_store_n(&addr_table[i].ready, 1, __ATOMIC_RELEASE);
+                return &addr_table[i].site;
+            }
+            cur = expected;
+        }
+        if (cur == addr) {
+            while (!__atomic_load_n(&addr_table[i].ready, __ATOMIC_ACQUIRE))
+                ;
+            return &addr_table[i].site;
+        }
+    }
+    return NULL;
+}
+
+ssize_t systrace_read(struct systrace_site *s, int fd, void *buf, size_t n) {
+    uint64_t t0 = systrace_begin();
+    ssize_t ret = read(fd, buf, n);
+    systrace_end(s, t0, ret >= 0, ret > 0 ? ret : 0);
+    return ret;
+}
+
+ssize_t systrace_write(struct systrace_site *s, int fd, const void *buf, size_t n) {
+    uint64_t t0 = systrace_begin();
+    ssize_t ret = write(fd, buf, n);
+    systrace_end(s, t0, ret >= 0, ret > 0 ? ret : 0);
+    return ret;
+}
+
+ssize_t systrace_pread(struct systrace_site *s, int fd, void *buf, size_t n, off_t off) {
+    uint64_t t0 = systrace_begin();
+    ssize_t ret = pread(fd, buf, n, off);
+    systrace_end(s, t0, ret >= 0, ret > 0 ? ret : 0);
+    return ret;
+}
+
+ssize_t systrace_pwrite(struct systrace_site *s, int fd, const void *buf, size_t n,
+                        off_t off) {
+    uint64_t t0 = systrace_begin();
+    ssize_t ret = pwrite(fd, buf, n, off);
+    systrace_end(s, t0, ret >= 0, ret > 0 ? ret : 0);
+    return ret;
+}
+
+int systrace_fsync(struct systrace_site *s, int fd) {
+    uint64_t t0 = systrace_begin();
+    int ret = fsync(fd);
+    systrace_end(s, t0, ret == 0, 0);
+    return ret;
+}
+
+int systrace_fdatasync(struct systrace_site *s, int fd) {
+    uint64_t t0 = systrace_begin();
+    int ret = fdatasync(fd);
+    systrace_end(s, t0, ret == 0, 0);
+    return ret;
+}
+
+void *systrace_mmap(struct systrace_site *s, void *addr, size_t len, int prot, int flags,
+                    int fd, off_t off) {
+    uint64_t t0 = systrace_begin();
+    void *ret = mmap(addr, len, prot, flags, fd, off);
+    systrace_end(s, t0, ret != MAP_FAILED, ret != MAP_FAILED ? len : 0);
+    return ret;
+}
+
+int systrace_msync(struct systrace_site *s, void *addr, size_t len, int flags) {
+    uint64_t t0 = systrace_begin();
+    int ret = msync(addr, len, flags);
+    systrace_end(s, t0, ret == 0, ret == 0 ? len : 0);
+    return ret;
+}
+
+ssize_t systrace_sendfile(struct systrace_site *s, int out, int in, off_t *off, size_t n) {
+    uint64_t t0 = systrace_begin();
+    ssize_t ret = sendfile(out, in, off, n);
+    systrace_end(s, t0, ret >= 0, ret > 0 ? ret : 0);
+    return ret;
+}
+
+void systrace_set_sample(unsigned int every) {
+    STORE(&sample_every, every ? every : 1);
+}
+
+const char *systrace_op_name(int op) {
+    return op >= 0 && op < ST_OP_COUNT ? op_names[op] : "?";
+}
+
+/*
+ * 아래는 signal handler 에서도 불리므로 stdio, malloc 을 쓰지 않는다.
+ * 출력도 syscall() 로 직접 (--wrap=write 로 감싼 write 를 다시 타지 않도록).
+ */
+struct out {
+    char buf[512];
+    size_t len;
+};
+
+static void put_str(struct out *o, const char *s) {
+    while (*s && o->len < sizeof(o->buf))
+        o->buf[o->len++] = *s++;
+}
+
+static void put_u64(struct out *o, uint64_t v) {
+    char tmp[24];
+    int n = 0;
+    do {
+        tmp[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v);
+    while (n > 0 && o->len < sizeof(o->buf))
+        o->buf[o->len++] = tmp[--n];
+}
+
+static void put_hex(struct out *o, uintptr_t v) {
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[n++] = "0123456789abcdef"[v & 15];
+        v >>= 4;
+    } while (v);
+    put_str(o, "0x");
+    while (n > 0 && o->len < sizeof(o->buf))
+        o->buf[o->len++] = tmp[--n];
+}
+
+/* ns 를 소수점 한 자리 us 로 */
+static void put_us(struct out *o, uint64_t ns) {
+    put_u64(o, ns / 1000);
+    put_str(o, ".");
+    put_u64(o, ns % 1000 / 100);
+}
+
+static void flush_out(int fd, struct out *o) {
+    size_t done = 0;
+    while (done < o->len) {
+        long n = syscall(SYS_write, fd, o->buf + done, o->len - done);
+        if (n <= 0) {
+            if (n == -1 && errno == EINTR)
+                continue;
+            break;
+        }
+        done += n;
+    }
+    o->len = 0;
+}
+
+static uint64_t percentile(const struct hist *h, double q) {
+    uint64_t want = (uint64_t)(h->timed * q);
+    uint64_t seen = 0;
+    if (want >= h->timed)
+        want = h->timed - 1;
+    for (int i = 0; i < NBUCKETS; i++) {
+        seen += h->b[i];
+        if (seen > want)
+            return bucket_high(i) < h->max ? bucket_high(i) : h->max;
+    }
+    return h->max;
+}
+
+static void dump_to(int fd, int symbolize) {
+    static struct hist sum;      /* 스택에 두기엔 크다. dump 는 동시에 하나만 */
+    static int busy;
+    struct out o = { .len = 0 };
+    int saved = errno;
+
+    if (__atomic_exchange_n(&busy, 1, __ATOMIC_ACQUIRE))
+        return;
+
+    put_str(&o, "op,site,calls,errors,bytes,timed,p50_us,p99_us,p999_us,max_us\n");
+    flush_out(fd, &o);
+
+    int n = __atomic_load_n(&nsites, __ATOMIC_ACQUIRE);
+    if (n > MAX_SITES)
+        n = MAX_SITES;
+    for (int id = 1; id <= n; id++) {
+        struct systrace_site *s = __atomic_load_n(&sites[id - 1], __ATOMIC_ACQUIRE);
+        if (!s)
+            continue;
+
+        memset(&sum, 0, sizeof(sum));
+        for (struct tstate *t = __atomic_load_n(&threads, __ATOMIC_ACQUIRE); t; t = t->next) {
+            struct hist *h = __atomic_load_n(&t->h[id - 1], __ATOMIC_ACQUIRE);
+            if (!h)
+                continue;
+            sum.calls += LOAD(&h->calls);
+            sum.errors += LOAD(&h->errors);
+            sum.bytes += LOAD(&h->bytes);
+            sum.timed += LOAD(&h->timed);
+            if (LOAD(&h->max) > sum.max)
+                sum.max = LOAD(&h->max);
+            for (int i = 0; i < NBUCKETS; i++)
+                sum.b[i] += LOAD(&h->b[i]);
+        }
+        if (sum.calls == 0)
+            continue;
+
+        put_str(&o, systrace_op_name(s->op));
+        put_str(&o, ",");
+        if (s->file) {
+            put_str(&o, s->file);
+            put_str(&o, ":");
+            put_u64(&o, s->line);
+        } else {
+            Dl_info info;
+            /* dladdr 는 async-signal-safe 가 아니므로 종료 시에만 */
+            if (symbolize && dladdr(s->addr, &info) && info.dli_sname) {
+                put_str(&o, info.dli_sname);
+                put_str(&o, "+");
+                put_hex(&o, (uintptr_t)s->addr - (uintptr_t)info.dli_saddr);
+            } else if (symbolize && dladdr(s->addr, &info) && info.dli_fname) {
+                /* static 함수 등: addr2line -e <파일> <offset> 으로 해석 */
+                const char *base = strrchr(info.dli_fname, '/');
+                put_str(&o, base ? base + 1 : info.dli_fname);
+                put_str(&o, "+");
+                put_hex(&o, (uintptr_t)s->addr - (uintptr_t)info.dli_fbase);
+            } else {
+                put_hex(&o, (uintptr_t)s->addr);
+            }
+        }
+        put_str(&o, ",");
+        put_u64(&o, sum.calls);
+        put_str(&o, ",");
+        put_u64(&o, sum.errors);
+        put_str(&o, ",");
+        put_u64(&o, sum.bytes);
+        put_str(&o, ",");
+        put_u64(&o, sum.timed);
+        if (sum.timed) {
+            put_str(&o, ",");
+            put_us(&o, percentile(&sum, 0.50));
+            put_str(&o, ",");
+            put_us(&o, percentile(&sum, 0.99));
+            put_str(&o, ",");
+            put_us(&o, percentile(&sum, 0.999));
+            put_str(&o, ",");
+            put_us(&o, sum.max);
+        } else {
+            put_str(&o, ",,,,");
+        }
+        put_str(&o, "\n");
+        flush_out(fd, &o);
+    }
+
+    __atomic_store_n(&busy, 0, __ATOMIC_RELEASE);
+    errno = saved;
+}
+
+void systrace_dump(int fd) {
+    dump_to(fd, 0);
+}
+
+static void on_sigusr1(int sig) {
+    (void)sig;
+    dump_to(out_fd, 0);
+}
+
+static void on_exit_dump(void) {
+    dump_to(out_fd, 1);
+}
+
+__attribute__((constructor)) static void systrace_init(void) {
+    const char *s;
+
+    if ((s = getenv("SYSTRACE_SAMPLE")) && atoi(s) > 1)
+        sample_every = atoi(s);
+    if ((s = getenv("SYSTRACE_OUT")) && *s) {
+        int fd = open(s, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd >= 0)
+            out_fd = fd;
+    }
+    if (!((s = getenv("SYSTRACE_SIGNAL")) && strcmp(s, "0") == 0)) {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = on_sigusr1;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGUSR1, &sa, NULL);
+    }
+    atexit(on_exit_dump);
+}
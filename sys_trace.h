@@ -0,0 +1,116 @@
+/*
+ * Syscall Latency Tracing (per-call-site HDR histograms)
+ *
+ * 예제들은 read/write/fsync/... 를 직접 부르고 실패하면 perror 만 한다.
+ * fsync 가 가끔 수백 ms 씩 멈춰도 알 방법이 없다.
+ *
+ * sys_trace 는 호출 지점 (call site) 마다 횟수, 에러 수, 바이트, 지연 시간
+ * 히스토그램을 모은다.
+ *
+ *   - 히스토그램은 스레드마다 따로 (lock 없음, 쓰는 쪽은 자기 스레드뿐)
+ *   - HDR 형식: 2 의 거듭제곱 구간마다 32 칸 (상대 오차 ~3%), 1ns ~ 4.8 시간
+ *   - 프로세스 종료 시, 또는 SIGUSR1 을 받으면 전체 요약을 출력
+ *     (signal handler 안에서는 async-signal-safe 한 함수만 씀)
+ *   - sampling: N 번에 한 번만 시간을 잰다 (횟수/바이트는 항상 셈)
+ *
+ * 두 가지 방법으로 붙인다:
+ *
+ *   1. 소스 수정 없이 링크만 (호출 지점 = 호출한 코드 주소, 종료 시 요약은
+ *      "함수+offset" 또는 "바이너리+offset" 이라 addr2line 으로 바로 해석된다)
+ *        gcc -O2 -o 7 7.c sys_trace.c sys_trace_wrap.c -ldl \
+ *            -Wl,--wrap=read,--wrap=write,--wrap=pread,--wrap=pwrite \
+ *            -Wl,--wrap=fsync,--wrap=fdatasync,--wrap=mmap,--wrap=msync,--wrap=sendfile
+ *
+ *   2. 파일:줄 단위 (모든 #include 뒤에 넣고 -DSYSTRACE 로 빌드)
+ *        #include "sys_trace.h"
+ *
+ * 두 방법을 한 프로그램에서 같이 쓰면 같은 호출이 두 번 기록된다.
+ *
+ * 환경 변수:
+ *   SYSTRACE_OUT=path   요약을 path 에 덧붙임 (기본 stderr)
+ *   SYSTRACE_SAMPLE=N   N 번에 한 번만 시간 측정 (기본 1 = 매번)
+ *   SYSTRACE_SIGNAL=0   SIGUSR1 handler 를 설치하지 않음
+ *
+ * Output (CSV): op,site,calls,errors,bytes,timed,p50_us,p99_us,p999_us,max_us
+ *
+ * Build: gcc -O2 -c sys_trace.c   (링크 시 -ldl)
+ */
+
+#ifndef SYS_TRACE_H
+#define SYS_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+
+enum systrace_op {
+    ST_READ,
+    ST_WRITE,
+    ST_PREAD,
+    ST_PWRITE,
+    ST_FSYNC,
+    ST_FDATASYNC,
+    ST_MMAP,
+    ST_MSYNC,
+    ST_SENDFILE,
+    ST_OP_COUNT
+};
+
+/* 호출 지점 하나. 처음 기록될 때 id 가 붙는다 */
+struct systrace_site {
+    const char *file;            /* 방법 2: __FILE__ */
+    int line;
+    int op;
+    const void *addr;            /* 방법 1: 호출한 코드 주소 */
+    int id;                      /* 0 이면 미등록 */
+};
+
+#define SYSTRACE_SITE(op_) \
+    ({ static struct systrace_site __st_site = { __FILE__, __LINE__, (op_), NULL, 0 }; \
+       &__st_site; })
+
+/* 시간 측정 시작. 이번 호출을 sampling 하지 않으면 0 */
+uint64_t systrace_begin(void);
+
+/* ok: 성공 여부, bytes: 옮긴 바이트. errno 는 바꾸지 않는다 */
+void systrace_end(struct systrace_site *site, uint64_t t0, int ok, uint64_t bytes);
+
+/* 방법 1 용: 주소로 site 를 찾거나 만든다 (lock-free). 가득 차면 NULL */
+struct systrace_site *systrace_site_at(const void *addr, int op);
+
+ssize_t systrace_read(struct systrace_site *s, int fd, void *buf, size_t n);
+ssize_t systrace_write(struct systrace_site *s, int fd, const void *buf, size_t n);
+ssize_t systrace_pread(struct systrace_site *s, int fd, void *buf, size_t n, off_t off);
+ssize_t systrace_pwrite(struct systrace_site *s, int fd, const void *buf, size_t n, off_t off);
+int systrace_fsync(struct systrace_site *s, int fd);
+int systrace_fdatasync(struct systrace_site *s, int fd);
+void *systrace_mmap(struct systrace_site *s, void *addr, size_t len, int prot, int flags,
+                    int fd, off_t off);
+int systrace_msync(struct systrace_site *s, void *addr, size_t len, int flags);
+ssize_t systrace_sendfile(struct systrace_site *s, int out_fd, int in_fd, off_t *off,
+                          size_t n);
+
+/* 1 이면 매번, N 이면 스레드마다 N 번에 한 번 시간 측정 */
+void systrace_set_sample(unsigned int every);
+
+/* 지금까지의 요약을 fd 에 쓴다 (async-signal-safe) */
+void systrace_dump(int fd);
+
+const char *systrace_op_name(int op);
+
+#ifdef SYSTRACE
+#define read(fd, buf, n)          systrace_read(SYSTRACE_SITE(ST_READ), fd, buf, n)
+#define write(fd, buf, n)         systrace_write(SYSTRACE_SITE(ST_WRITE), fd, buf, n)
+#define pread(fd, buf, n, off)    systrace_pread(SYSTRACE_SITE(ST_PREAD), fd, buf, n, off)
+#define pwrite(fd, buf, n, off)   systrace_pwrite(SYSTRACE_SITE(ST_PWRITE), fd, buf, n, off)
+#define fsync(fd)                 systrace_fsync(SYSTRACE_SITE(ST_FSYNC), fd)
+#define fdatasync(fd)             systrace_fdatasync(SYSTRACE_SITE(ST_FDATASYNC), fd)
+#define mmap(a, l, p, f, fd, o)   systrace_mmap(SYSTRACE_SITE(ST_MMAP), a, l, p, f, fd, o)
+#define msync(a, l, f)            systrace_msync(SYSTRACE_SITE(ST_MSYNC), a, l, f)
+#define sendfile(o, i, off, n)    systrace_sendfile(SYSTRACE_SITE(ST_SENDFILE), o, i, off, n)
+#endif
+
+#endif
@@ -0,0 +1,176 @@
+/*
+ * Syscall Tracing Overhead Benchmark
+ *
+ * 같은 호출을 그대로 / sys_trace 로 감싸서 / sampling 하면서 불러 호출당 비용을 비교한다.
+ *
+ *   read_zero - /dev/zero 에서 1 바이트 read (syscall 자체가 가장 싼 경우)
+ *   pwrite_4k - page cache 로 4KB pwrite
+ *
+ * 여러 스레드가 동시에 기록해도 (스레드별 히스토그램) 비용이 늘지 않는지 -t 로 본다.
+ * 마지막으로 fdatasync 를 반복해서, 종료 시 stderr 로 나오는 요약에서
+ * p99.9 를 확인할 수 있게 한다.
+ *
+ * Output (CSV): op,mode,threads,calls,seconds,ns_per_call
+ *               (종료 시 stderr: sys_trace 요약)
+ *
+ * Build: gcc -O2 -pthread -o sys_trace_bench sys_trace_bench.c sys_trace.c -ldl
+ * Usage: ./sys_trace_bench [-f path] [-n calls] [-t threads] [-s sample_every] [-y fdatasyncs]
+ */
+
+#define _GNU_SOURCE
+#include "sys_trace.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+enum { OP_READ_ZERO, OP_PWRITE_4K };
+enum { MODE_RAW, MODE_TRACED, MODE_SAMPLED };
+
+static const char *op_names[] = { "read_zero", "pwrite_4k" };
+static const char *mode_names[] = { "raw", "traced", "sampled" };
+
+struct job {
+    int op;
+    int mode;
+    int fd;
+    long calls;
+    int failed;
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *worker(void *arg) {
+    struct job *j = arg;
+    char buf[4096];
+
+    memset(buf, 'x', sizeof(buf));
+    for (long i = 0; i < j->calls; i++) {
+        ssize_t n;
+        off_t off = (off_t)(i % 256) * sizeof(buf);
+        if (j->op == OP_READ_ZERO)
+            n = j->mode == MODE_RAW ? read(j->fd, buf, 1)
+                                    : systrace_read(SYSTRACE_SITE(ST_READ), j->fd, buf, 1);
+        else
+            n = j->mode == MODE_RAW
+                    ? pwrite(j->fd, buf, sizeof(buf), off)
+                    : systrace_pwrite(SYSTRACE_SITE(ST_PWRITE), j->fd, buf, sizeof(buf), off);
+        if (n < 0) {
+            j->failed = 1;
+            break;
+        }
+    }
+    return NULL;
+}
+
+static int run(int op, int mode, const char *path, int threads, long calls,
+               unsigned int sample) {
+    pthread_t *tids = malloc(threads * sizeof(*tids));
+    struct job *jobs = calloc(threads, sizeof(*jobs));
+    int ret = 0;
+
+    if (!tids || !jobs) {
+        free(tids);
+        free(jobs);
+        return -1;
+    }
+
+    systrace_set_sample(mode == MODE_SAMPLED ? sample : 1);
+    for (int i = 0; i < threads; i++) {
+        jobs[i].op = op;
+        jobs[i].mode = mode;
+        jobs[i].calls = calls;
+        jobs[i].fd = op == OP_READ_ZERO ? open("/dev/zero", O_RDONLY)
+                                        : open(path, O_WRONLY | O_CREAT, 0644);
+        if (jobs[i].fd < 0)
+            ret = -1;
+    }
+
+    double t0 = now_sec();
+    for (int i = 0; ret == 0 && i < threads; i++)
+        pthread_create(&tids[i], NULL, worker, &jobs[i]);
+    for (int i = 0; ret == 0 && i < threads; i++) {
+        pthread_join(tids[i], NULL);
+        if (jobs[i].failed)
+            ret = -1;
+    }
+    double secs = now_sec() - t0;
+
+    for (int i = 0; i < threads; i++)
+        if (jobs[i].fd >= 0)
+            close(jobs[i].fd);
+
+    if (ret == 0) {
+        /* 스레드들이 동시에 돌므로 호출당 시간은 스레드 하나 기준 */
+        printf("%s,%s,%d,%ld,%.4f,%.1f\n", op_names[op], mode_names[mode], threads,
+               calls * threads, secs, secs * 1e9 / calls);
+        fflush(stdout);
+    }
+    free(tids);
+    free(jobs);
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = "systrace_bench.dat";
+    long calls = 1000000;
+    int threads = 1, syncs = 200;
+    unsigned int sample = 64;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:n:t:s:y:")) != -1) {
+        switch (opt) {
+        case 'f': path = optarg; break;
+        case 'n': calls = atol(optarg); break;
+        case 't': threads = atoi(optarg); break;
+        case 's': sample = atoi(optarg); break;
+        case 'y': syncs = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-f path] [-n calls] [-t threads] "
+                    "[-s sample_every] [-y fdatasyncs]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (calls < 1 || threads < 1 || sample < 1 || syncs < 0) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    printf("op,mode,threads,calls,seconds,ns_per_call\n");
+    for (int op = OP_READ_ZERO; op <= OP_PWRITE_4K; op++) {
+        for (int mode = MODE_RAW; mode <= MODE_SAMPLED; mode++) {
+            if (run(op, mode, path, threads, calls, sample) == -1) {
+                perror(op_names[op]);
+                return 1;
+            }
+        }
+    }
+
+    /* fsync 지연 분포: 요약의 fdatasync 행에서 p99.9 를 본다 */
+    systrace_set_sample(1);
+    int fd = open(path, O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) {
+        perror("open");
+        return 1;
+    }
+    char buf[4096];
+    memset(buf, 'y', sizeof(buf));
+    for (int i = 0; i < syncs; i++) {
+        if (pwrite(fd, buf, sizeof(buf), (off_t)i * sizeof(buf)) < 0 ||
+            systrace_fdatasync(SYSTRACE_SITE(ST_FDATASYNC), fd) == -1) {
+            perror("fdatasync");
+            return 1;
+        }
+    }
+    close(fd);
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Syscall Latency Tracing - linker wrappers
+ *
+ * -Wl,--wrap=read 로 링크하면 read 참조가 __wrap_read 로 바뀌고,
+ * 원래 함수는 __real_read 로 불린다. 호출 지점은 return address 로 구분한다.
+ *
+ * Build: gcc -O2 -c sys_trace_wrap.c   (sys_trace.h 의 방법 1 참고)
+ */
+
+#define _GNU_SOURCE
+#undef SYSTRACE
+#include "sys_trace.h"
+
+#define CALLER(op) systrace_site_at(__builtin_return_address(0), (op))
+
+ssize_t __real_read(int fd, void *buf, size_t n);
+ssize_t __real_write(int fd, const void *buf, size_t n);
+ssize_t __real_pread(int fd, void *buf, size_t n, off_t off);
+ssize_t __real_pwrite(int fd, const void *buf, size_t n, off_t off);
+int __real_fsync(int fd);
+int __real_fdatasync(int fd);
+void *__real_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t off);
+int __real_msync(void *addr, size_t len, int flags);
+ssize_t __real_sendfile(int out, int in, off_t *off, size_t n);
+
+ssize_t __wrap_read(int fd, void *buf, size_t n) {
+    struct systrace_site *s = CALLER(ST_READ);
+    uint64_t t0 = systrace_begin();
+    ssize_t ret = __real_read(fd, buf, n);
+    systrace_end(s, t0, ret >= 0, ret > 0 ? ret : 0);
+    return ret;
+}
+
+ssize_t __wrap_write(int fd, const void *buf, size_t n) {
+    struct systrace_site *s = CALLER(ST_WRITE);
+    uint64_t t0 = systrace_begin();
+    ssize_t ret = __real_write(fd, buf, n);
+    systrace_end(s, t0, ret >= 0, ret > 0 ? ret : 0);
+    return ret;
+}
+
+ssize_t __wrap_pread(int fd, void *buf, size_t n, off_t off) {
+    struct systrace_site *s = CALLER(ST_PREAD);
+    uint64_t t0 = systrace_begin();
+    ssize_t ret = __real_pread(fd, buf, n, off);
+    systrace_end(s, t0, ret >= 0, ret > 0 ? ret : 0);
+    return ret;
+}
+
+ssize_t __wrap_pwrite(int fd, const void *buf, size_t n, off_t off) {
+    struct systrace_site *s = CALLER(ST_PWRITE);
+    uint64_t t0 = systrace_begin();
+    ssize_t ret = __real_pwrite(fd, buf, n, off);
+    systrace_end(s, t0, ret >= 0, ret > 0 ? ret : 0);
+    return ret;
+}
+
+int __wrap_fsync(int fd) {
+    struct systrace_site *s = CALLER(ST_FSYNC);
+    uint64_t t0 = systrace_begin();
+    int ret = __real_fsync(fd);
+    systrace_end(s, t0, ret == 0, 0);
+    return ret;
+}
+
+int __wrap_fdatasync(int fd) {
+    struct systrace_site *s = CALLER(ST_FDATASYNC);
+    uint64_t t0 = systrace_begin();
+    int ret = __real_fdatasync(fd);
+    systrace_end(s, t0, ret == 0, 0);
+    return ret;
+}
+
+void *__wrap_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t off) {
+    struct systrace_site *s = CALLER(ST_MMAP);
+    uint64_t t0 = systrace_begin();
+    void *ret = __real_mmap(addr, len, prot, flags, fd, off);
+    systrace_end(s, t0, ret != MAP_FAILED, ret != MAP_FAILED ? len : 0);
+    return ret;
+}
+
+int __wrap_msync(void *addr, size_t len, int flags) {
+    struct systrace_site *s = CALLER(ST_MSYNC);
+    uint64_t t0 = systrace_begin();
+    int ret = __real_msync(addr, len, flags);
+    systrace_end(s, t0, ret == 0, ret == 0 ? len : 0);
+    return ret;
+}
+
+ssize_t __wrap_sendfile(int out, int in, off_t *off, size_t n) {
+    struct systrace_site *s = CALLER(ST_SENDFILE);
+    uint64_t t0 = systrace_begin();
+    ssize_t ret = __real_sendfile(out, in, off, n);
+    systrace_end(s, t0, ret >= 0, ret > 0 ? ret : 0);
+    return ret;
+}
@@ -0,0 +1,225 @@
+/*
+ * Per-Thread Buffered Output Streams - 구현
+ *
+ * Build: gcc -O2 -pthread -c thread_stream.c
+ */
+
+#define _GNU_SOURCE
+#include "thread_stream.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+struct tstr_sink {
+    int fd;
+    pthread_mutex_t lock;        /* hand-off 동안만 */
+    atomic_uint_fast64_t handoffs;
+    atomic_uint_fast64_t bytes;
+    atomic_uint_fast64_t errors;
+    atomic_int error;            /* 처음 실패의 errno */
+};
+
+struct tstr {
+    struct tstr_sink *sink;
+    char *buf;
+    size_t len;
+    size_t cap;
+};
+
+/* 전부 쓰일 때까지 writev (partial write 처리) */
+static int writev_all(int fd, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t n = writev(fd, iov, iovcnt);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+/* short write 의 나머지도 lock 을 쥔 채로 써서 다른 스레드가 끼어들지 못하게 한다 */
+static int handoff(struct tstr_sink *sink, struct iovec *iov, int iovcnt) {
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; i++)
+        total += iov[i].iov_len;
+    if (total == 0)
+        return 0;
+
+    pthread_mutex_lock(&sink->lock);
+    int ret = writev_all(sink->fd, iov, iovcnt);
+    int saved = errno;
+    pthread_mutex_unlock(&sink->lock);
+
+    atomic_fetch_add(&sink->handoffs, 1);
+    if (ret == -1) {
+        int zero = 0;
+        atomic_fetch_add(&sink->errors, 1);
+        atomic_compare_exchange_strong(&sink->error, &zero, saved ? saved : EIO);
+        errno = saved;
+        return -1;
+    }
+    atomic_fetch_add(&sink->bytes, total);
+    return 0;
+}
+
+/* buf[0, upto) 를 넘기고 나머지를 앞으로 당긴다. 실패해도 넘기려던 내용은 버린다
+ * (다시 보내면 일부가 두 번 써질 수 있다) */
+static int handoff_prefix(struct tstr *s, size_t upto) {
+    struct iovec iov = { s->buf, upto };
+    int ret = handoff(s->sink, &iov, 1);
+    int saved = errno;
+    memmove(s->buf, s->buf + upto, s->len - upto);
+    s->len -= upto;
+    errno = saved;
+    return ret;
+}
+
+static size_t whole_lines(const struct tstr *s) {
+    const char *nl = s->len ? memrchr(s->buf, '\n', s->len) : NULL;
+    return nl ? (size_t)(nl - s->buf) + 1 : 0;
+}
+
+/* need 바이트가 들어갈 자리를 만든다: 먼저 완성된 줄을 넘기고, 그래도 모자라면 키운다 */
+static int make_room(struct tstr *s, size_t need) {
+    if (s->cap - s->len >= need)
+        return 0;
+    size_t whole = whole_lines(s);
+    if (whole && handoff_prefix(s, whole) == -1)
+        return -1;
+    if (s->cap - s->len >= need)
+        return 0;
+
+    size_t ncap = s->cap * 2;
+    while (ncap - s->len < need)
+        ncap *= 2;
+    char *p = realloc(s->buf, ncap);
+    if (!p)
+        return -1;
+    s->buf = p;
+    s->cap = ncap;
+    return 0;
+}
+
+struct tstr_sink *tstr_sink_open(int fd) {
+    struct tstr_sink *sink = calloc(1, sizeof(*sink));
+    if (!sink)
+        return NULL;
+    sink->fd = fd;
+    pthread_mutex_init(&sink->lock, NULL);
+    return sink;
+}
+
+void tstr_sink_get_stats(struct tstr_sink *sink, struct tstr_stats *out) {
+    out->handoffs = atomic_load(&sink->handoffs);
+    out->bytes = atomic_load(&sink->bytes);
+    out->errors = atomic_load(&sink->errors);
+}
+
+int tstr_sink_close(struct tstr_sink *sink) {
+    if (!sink)
+        return 0;
+    int err = atomic_load(&sink->error);
+    pthread_mutex_destroy(&sink->lock);
+    free(sink);
+    if (err) {
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+struct tstr *tstr_open(struct tstr_sink *sink, size_t buf_size) {
+    struct tstr *s = calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+    s->sink = sink;
+    s->cap = buf_size ? buf_size : TSTR_DEFAULT_BUF;
+    s->buf = malloc(s->cap);
+    if (!s->buf) {
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+int tstr_vprintf(struct tstr *s, const char *fmt, va_list ap) {
+    for (;;) {
+        size_t space = s->cap - s->len;
+        va_list cp;
+        va_copy(cp, ap);
+        int n = vsnprintf(s->buf + s->len, space, fmt, cp);
+        va_end(cp);
+        if (n < 0)
+            return -1;
+        if ((size_t)n < space) {
+            s->len += n;
+            return n;
+        }
+        /* 안 들어갔다: 자리를 만들고 다시 포맷 (vsnprintf 는 '\0' 까지 쓴다) */
+        if (make_room(s, (size_t)n + 1) == -1)
+            return -1;
+    }
+}
+
+int tstr_printf(struct tstr *s, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = tstr_vprintf(s, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+int tstr_write(struct tstr *s, const void *buf, size_t len) {
+    if (len >= s->cap && ((const char *)buf)[len - 1] == '\n') {
+        /* buffer 보다 큰 레코드가 줄로 끝나면 복사하지 않고 buffer 와 함께 넘긴다 */
+        struct iovec iov[2] = { { s->buf, s->len }, { (void *)buf, len } };
+        int ret = handoff(s->sink, iov, 2);
+        s->len = 0;
+        return ret == -1 ? -1 : (int)len;
+    }
+    if (make_room(s, len) == -1)
+        return -1;
+    memcpy(s->buf + s->len, buf, len);
+    s->len += len;
+    return (int)len;
+}
+
+int tstr_putc(struct tstr *s, int c) {
+    if (s->len == s->cap && make_room(s, 1) == -1)
+        return -1;
+    s->buf[s->len++] = (char)c;
+    return (unsigned char)c;
+}
+
+int tstr_flush(struct tstr *s) {
+    size_t whole = whole_lines(s);
+    return whole ? handoff_prefix(s, whole) : 0;
+}
+
+int tstr_close(struct tstr *s) {
+    if (!s)
+        return 0;
+    int ret = s->len ? handoff_prefix(s, s->len) : 0;
+    int saved = errno;
+    free(s->buf);
+    free(s);
+    errno = saved;
+    return ret;
+}
@@ -0,0 +1,80 @@
+/*
+ * Per-Thread Buffered Output Streams
+ *
+ * flockfile_example.c 의 safe_printf 는 flockfile() 을 잡고 printf 를 부르는데,
+ * printf 도 안에서 같은 FILE lock 을 다시 잡는다. eof_example.c 의 putchar 도
+ * 바이트마다 lock 을 잡는다. 모든 스레드가 글자 하나, 줄 하나마다 lock 하나를
+ * 두고 다툰다.
+ *
+ * tstr 는 스레드마다 자기 buffer 를 가진다:
+ *
+ *   - 포맷: vsnprintf 가 buffer 끝에 바로 쓴다 (중간 복사 없음, lock 없음)
+ *   - hand-off: buffer 가 차면 완성된 줄 (마지막 '\n' 까지) 전체를
+ *               write 한 번으로 공유 fd 에 넘긴다. 큰 레코드는 buffer 에
+ *               복사하지 않고 writev 로 buffer 와 함께 넘긴다
+ *   - 줄 단위: 쓰다 만 줄은 buffer 에 남겨 다음 hand-off 로 보낸다. 그래서
+ *              다른 스레드의 줄이 한 줄 중간에 끼어드는 일이 없다.
+ *              buffer 보다 긴 줄이면 buffer 를 키운다
+ *
+ * sink 의 lock 은 hand-off (write 호출과 short write 재시도) 동안만 잡는다.
+ * 64KB buffer 면 줄 수백 개에 한 번이다.
+ *
+ * mpsc_log.h 와 달리 flusher 스레드가 없다. buffer 를 채운 스레드가 직접 쓴다.
+ *
+ * 한 tstr 는 만든 스레드만 쓴다. 스레드가 끝나기 전에 tstr_close() 로
+ * 남은 내용을 넘긴다. 읽기 쪽 (fgetc 루프) 은 line_iter.h 를 쓴다.
+ *
+ * 사용 예:
+ *   struct tstr_sink *sink = tstr_sink_open(fd);
+ *   // 각 스레드에서
+ *   struct tstr *s = tstr_open(sink, 0);
+ *   tstr_printf(s, "Thread %d: message %d\n", id, i);
+ *   tstr_close(s);
+ *   // 모든 스레드가 끝난 뒤
+ *   tstr_sink_close(sink);
+ *
+ * Build: gcc -O2 -pthread -c thread_stream.c
+ */
+
+#ifndef THREAD_STREAM_H
+#define THREAD_STREAM_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TSTR_DEFAULT_BUF (64 * 1024)
+
+struct tstr_sink;
+struct tstr;
+
+struct tstr_stats {
+    uint64_t handoffs;           /* write/writev 호출 수 (short write 재시도 제외) */
+    uint64_t bytes;
+    uint64_t errors;             /* 실패한 hand-off (그 내용은 버려짐) */
+};
+
+/* fd 는 호출자가 소유 (close 하지 않음). 파일이면 O_APPEND 를 권장 */
+struct tstr_sink *tstr_sink_open(int fd);
+
+void tstr_sink_get_stats(struct tstr_sink *sink, struct tstr_stats *out);
+
+/* 모든 tstr 가 닫힌 뒤에 부른다. 실패한 hand-off 가 있었으면 -1 과 그 errno */
+int tstr_sink_close(struct tstr_sink *sink);
+
+/* buf_size 가 0 이면 TSTR_DEFAULT_BUF */
+struct tstr *tstr_open(struct tstr_sink *sink, size_t buf_size);
+
+/* 쓴 바이트 수, hand-off 가 실패했으면 -1 */
+int tstr_printf(struct tstr *s, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+int tstr_vprintf(struct tstr *s, const char *fmt, va_list ap);
+int tstr_write(struct tstr *s, const void *buf, size_t len);
+int tstr_putc(struct tstr *s, int c);
+
+/* 완성된 줄을 모두 넘긴다 (쓰다 만 줄은 남김) */
+int tstr_flush(struct tstr *s);
+
+/* 쓰다 만 줄까지 모두 넘기고 해제 */
+int tstr_close(struct tstr *s);
+
+#endif
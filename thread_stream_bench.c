@@ -0,0 +1,267 @@
+/*
+ * Per-Thread Stream Benchmark
+ *
+ * 스레드 1..-t 개가 각각 -n 줄을 같은 파일에 쓴다.
+ *
+ *   stdio     - 공유 FILE 에 fprintf (stdio 내부 lock 만)
+ *   flockfile - safe_printf (flockfile_example.c) 처럼 flockfile + fprintf + funlockfile
+ *   tstr      - 스레드마다 tstr, 가득 차면 완성된 줄을 write 한 번으로 hand-off
+ *
+ * 끝나면 파일을 다시 읽어 모든 줄이 온전하고 (중간에 끼어든 것 없음)
+ * 스레드마다 순서대로 빠짐없이 있는지 확인한다.
+ *
+ * Output (CSV): method,threads,lines,seconds,lines_per_sec,mb_per_sec,writes
+ *
+ * Build: gcc -O2 -pthread -o thread_stream_bench thread_stream_bench.c thread_stream.c
+ * Usage: ./thread_stream_bench [-f path] [-n lines_per_thread] [-t max_threads] [-b buf_size]
+ */
+
+#define _GNU_SOURCE
+#include "thread_stream.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+enum { M_STDIO, M_FLOCKFILE, M_TSTR, M_COUNT };
+
+static const char *method_names[M_COUNT] = { "stdio", "flockfile", "tstr" };
+
+struct ctx {
+    int method;
+    long lines;
+    size_t buf_size;
+    FILE *fp;
+    struct tstr_sink *sink;
+    pthread_barrier_t start;
+};
+
+struct worker {
+    struct ctx *c;
+    int id;
+    int failed;
+    double t_start;              /* barrier 를 지난 시각 */
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    }
+    return v;
+}
+
+static uint32_t line_value(int id, long i) {
+    return (uint32_t)((id * 1000003UL + i) * 2654435761UL);
+}
+
+static void *worker_main(void *arg) {
+    struct worker *w = arg;
+    struct ctx *c = w->c;
+    struct tstr *s = NULL;
+
+    if (c->method == M_TSTR && !(s = tstr_open(c->sink, c->buf_size)))
+        w->failed = 1;
+    pthread_barrier_wait(&c->start);
+    w->t_start = now_sec();
+    if (w->failed)
+        return NULL;
+
+    for (long i = 0; i < c->lines; i++) {
+        uint32_t v = line_value(w->id, i);
+        int n;
+        switch (c->method) {
+        case M_STDIO:
+            n = fprintf(c->fp, "Thread %d: message %ld value %08x\n", w->id, i, v);
+            break;
+        case M_FLOCKFILE:
+            flockfile(c->fp);
+            n = fprintf(c->fp, "Thread %d: message %ld value %08x\n", w->id, i, v);
+            funlockfile(c->fp);
+            break;
+        default:
+            n = tstr_printf(s, "Thread %d: message %ld value %08x\n", w->id, i, v);
+            break;
+        }
+        if (n < 0) {
+            w->failed = 1;
+            break;
+        }
+    }
+    if (s && tstr_close(s) == -1)
+        w->failed = 1;
+    return NULL;
+}
+
+/* 모든 줄이 "Thread <id>: message <i> value <v>\n" 이고 스레드별로 i 가 0 부터 이어지는지 */
+static int verify(const char *path, int threads, long lines) {
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) == -1) {
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    long *next = calloc(threads, sizeof(*next));
+    char *p = st.st_size ? mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    close(fd);
+    if (!next || p == MAP_FAILED) {
+        free(next);
+        return -1;
+    }
+
+    int ok = 1;
+    const char *q = p, *end = p + st.st_size;
+    while (ok && q < end) {
+        const char *nl = memchr(q, '\n', end - q);
+        char line[96];
+        size_t len = nl ? (size_t)(nl - q) : 0;
+        int id, used = 0;
+        long i;
+        unsigned v;
+        if (!nl || len >= sizeof(line)) {
+            ok = 0;
+            break;
+        }
+        memcpy(line, q, len);
+        line[len] = '\0';
+        if (sscanf(line, "Thread %d: message %ld value %8x%n", &id, &i, &v, &used) != 3 ||
+            (size_t)used != len || id < 0 || id >= threads || i != next[id] ||
+            v != line_value(id, i))
+            ok = 0;
+        else
+            next[id]++;
+        q = nl + 1;
+    }
+    for (int t = 0; ok && t < threads; t++)
+        if (next[t] != lines)
+            ok = 0;
+    if (p)
+        munmap(p, st.st_size);
+    free(next);
+    return ok ? 0 : -1;
+}
+
+static int run(const char *path, int method, int threads, long lines, size_t buf_size) {
+    struct ctx c = { .method = method, .lines = lines, .buf_size = buf_size };
+    struct worker *w = calloc(threads, sizeof(*w));
+    pthread_t *tids = calloc(threads, sizeof(*tids));
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    int ret = -1;
+    uint64_t writes = 0;
+
+    if (!w || !tids || fd < 0)
+        goto out;
+    if (method == M_TSTR) {
+        if (!(c.sink = tstr_sink_open(fd)))
+            goto out;
+    } else if (!(c.fp = fdopen(fd, "a"))) {
+        goto out;
+    }
+    pthread_barrier_init(&c.start, NULL, threads + 1);
+
+    int started = 0;
+    for (; started < threads; started++) {
+        w[started] = (struct worker){ &c, started, 0, 0 };
+        if (pthread_create(&tids[started], NULL, worker_main, &w[started]) != 0)
+            break;
+    }
+    if (started < threads) {
+        /* barrier 를 채울 수 없으니 여기서 끝낸다 */
+        fprintf(stderr, "pthread_create failed at %d threads\n", started);
+        exit(1);
+    }
+    pthread_barrier_wait(&c.start);
+    for (int i = 0; i < threads; i++)
+        pthread_join(tids[i], NULL);
+    int err = 0;
+    if (c.fp) {
+        err = fflush(c.fp) != 0;
+    } else {
+        struct tstr_stats st;
+        tstr_sink_get_stats(c.sink, &st);
+        writes = st.handoffs;
+        err = tstr_sink_close(c.sink) == -1;
+    }
+    /* 가장 먼저 시작한 worker 부터 마지막 내용이 fd 로 넘어갈 때까지 */
+    double t0 = w[0].t_start;
+    for (int i = 1; i < threads; i++)
+        if (w[i].t_start < t0)
+            t0 = w[i].t_start;
+    double secs = now_sec() - t0;
+    pthread_barrier_destroy(&c.start);
+
+    for (int i = 0; i < threads; i++)
+        err |= w[i].failed;
+    if (err || verify(path, threads, lines) == -1) {
+        fprintf(stderr, "%s/%d: %s\n", method_names[method], threads,
+                err ? strerror(errno) : "output check failed");
+        goto out;
+    }
+    struct stat sb;
+    stat(path, &sb);
+    printf("%s,%d,%ld,%.4f,%.0f,%.1f,%llu\n", method_names[method], threads, lines * threads,
+           secs, lines * threads / secs, sb.st_size / secs / (1024.0 * 1024.0),
+           (unsigned long long)writes);
+    fflush(stdout);
+    ret = 0;
+
+out:
+    if (c.fp)
+        fclose(c.fp);
+    else if (fd >= 0)
+        close(fd);
+    free(tids);
+    free(w);
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = "tstr_bench.txt";
+    long lines = 100000;
+    int max_threads = 32, opt;
+    size_t buf_size = TSTR_DEFAULT_BUF;
+
+    while ((opt = getopt(argc, argv, "f:n:t:b:")) != -1) {
+        switch (opt) {
+        case 'f': path = optarg; break;
+        case 'n': lines = atol(optarg); break;
+        case 't': max_threads = atoi(optarg); break;
+        case 'b': buf_size = parse_size(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-f path] [-n lines_per_thread] [-t max_threads] "
+                    "[-b buf_size]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (lines < 1 || max_threads < 1 || buf_size < 1) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    printf("method,threads,lines,seconds,lines_per_sec,mb_per_sec,writes\n");
+    int ret = 0;
+    for (int t = 1; ret == 0 && t <= max_threads; t *= 2)
+        for (int m = 0; ret == 0 && m < M_COUNT; m++)
+            if (run(path, m, t, lines, buf_size) == -1)
+                ret = 1;
+    unlink(path);
+    return ret;
+}
@@ -0,0 +1,271 @@
+/*
+ * io_uring Queue-Depth Benchmark
+ *
+ * 같은 파일을 block 단위로 순차 읽기 하면서 비교한다:
+ *
+ *   read     - 2.c 의 read() 루프 (queue depth 1)
+ *   uring    - uring_io.c, depth 개의 read 를 동시에 제출
+ *   fixed    - uring + registered buffers + fixed file
+ *   sqpoll   - fixed + SQPOLL (제출에 syscall 없음)
+ *   sync     - uring_io.c 의 동기 fallback (force_sync)
+ *
+ * -D 를 주면 O_DIRECT 로 열어서 page cache 없이 장치 queue depth 효과를 본다.
+ * 그렇지 않으면 매 측정 전에 POSIX_FADV_DONTNEED 로 캐시를 비운다.
+ *
+ * Output (CSV): method,depth,block,bytes,seconds,gbps,async
+ *
+ * Build: gcc -O2 -o uring_bench uring_bench.c uring_io.c
+ * Usage: ./uring_bench [-f path] [-s file_size] [-b block] [-q max_depth] [-D]
+ */
+
+#define _GNU_SOURCE
+#include "uring_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MB (1024ULL * 1024)
+#define ALIGN 4096
+
+enum variant { V_READ, V_URING, V_FIXED, V_SQPOLL, V_SYNC, V_COUNT };
+
+static const char *variant_names[V_COUNT] = { "read", "uring", "fixed", "sqpoll", "sync" };
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t parse_size(const char *s) {
+    char *end;
+    uint64_t v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    default: break;
+    }
+    return v;
+}
+
+static int prepare_file(const char *path, uint64_t size) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        perror("open");
+        return -1;
+    }
+    char *chunk = malloc(MB);
+    if (!chunk) {
+        close(fd);
+        return -1;
+    }
+    memset(chunk, 'u', MB);
+    for (uint64_t done = 0; done < size;) {
+        size_t want = size - done < MB ? size - done : MB;
+        ssize_t ret = write(fd, chunk, want);
+        if (ret == -1) {
+            perror("write");
+            free(chunk);
+            close(fd);
+            return -1;
+        }
+        done += ret;
+    }
+    free(chunk);
+    fsync(fd);
+    close(fd);
+    return 0;
+}
+
+static void drop_cache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd != -1) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+/* 2.c 의 read() 루프를 파일 끝까지 */
+static int64_t bench_read(int fd, char *buf, size_t block) {
+    int64_t total = 0;
+    ssize_t ret;
+    while ((ret = read(fd, buf, block)) != 0) {
+        if (ret == -1) {
+            if (errno == EINTR)
+                continue;
+            perror("read");
+            return -1;
+        }
+        total += ret;
+    }
+    return total;
+}
+
+/*
+ * depth 개의 slot 을 돌려 쓰면서 순차 offset 을 계속 제출.
+ * user_data = slot 번호.
+ */
+static int64_t bench_uring(struct uio_engine *e, int fd, char *bufs, size_t block,
+                           unsigned int depth, uint64_t file_size, int fixed) {
+    struct uio_cqe cqes[depth];
+    unsigned int stack[depth];
+    unsigned int free_top = depth;
+    uint64_t next = 0;
+    int64_t total = 0;
+    unsigned int active = 0;
+    int flags = fixed ? (UIO_FIXED_FILE | UIO_FIXED_BUF) : 0;
+    int target = fixed ? 0 : fd;
+
+    for (unsigned int i = 0; i < depth; i++)
+        stack[i] = depth - 1 - i;
+
+    while (active > 0 || next < file_size) {
+        while (next < file_size && free_top > 0) {
+            unsigned int s = stack[--free_top];
+            size_t want = file_size - next < block ? file_size - next : block;
+            if (uio_prep_read(e, target, bufs + (size_t)s * block, (unsigned int)want,
+                              (off_t)next, flags, s, s) == -1) {
+                stack[free_top++] = s;
+                break;
+            }
+            next += want;
+            active++;
+        }
+        if (uio_submit(e) < 0) {
+            perror("uio_submit");
+            return -1;
+        }
+
+        int n = uio_wait(e, cqes, depth, 1);
+        if (n < 0) {
+            perror("uio_wait");
+            return -1;
+        }
+        for (int i = 0; i < n; i++) {
+            if (cqes[i].res < 0) {
+                fprintf(stderr, "read: %s\n", strerror(-cqes[i].res));
+                return -1;
+            }
+            total += cqes[i].res;
+            stack[free_top++] = (unsigned int)cqes[i].user_data;
+            active--;
+        }
+    }
+    return total;
+}
+
+static int run(enum variant v, const char *path, uint64_t file_size, size_t block,
+               unsigned int depth, int direct) {
+    int flags = O_RDONLY | (direct ? O_DIRECT : 0);
+    char *bufs = NULL;
+    struct uio_engine *e = NULL;
+    int64_t total = -1;
+    int async = 0;
+
+    if (!direct)
+        drop_cache(path);
+
+    int fd = open(path, flags);
+    if (fd == -1) {
+        perror("open");
+        return -1;
+    }
+
+    if (posix_memalign((void **)&bufs, ALIGN, block * depth) != 0) {
+        fprintf(stderr, "posix_memalign failed\n");
+        close(fd);
+        return -1;
+    }
+    memset(bufs, 0, block * depth);
+
+    uint64_t t0 = now_ns();
+    if (v == V_READ) {
+        total = bench_read(fd, bufs, block);
+    } else {
+        struct uio_params params = { .entries = depth };
+        params.sqpoll = (v == V_SQPOLL);
+        params.force_sync = (v == V_SYNC);
+        e = uio_open(&params);
+        if (!e) {
+            perror("uio_open");
+            goto out;
+        }
+        async = uio_is_async(e);
+
+        int fixed = (v == V_FIXED || v == V_SQPOLL);
+        if (fixed) {
+            struct iovec iov[depth];
+            for (unsigned int i = 0; i < depth; i++) {
+                iov[i].iov_base = bufs + (size_t)i * block;
+                iov[i].iov_len = block;
+            }
+            if (uio_register_files(e, &fd, 1) < 0 || uio_register_buffers(e, iov, depth) < 0) {
+                perror("uio_register");
+                goto out;
+            }
+        }
+        total = bench_uring(e, fd, bufs, block, depth, file_size, fixed);
+    }
+    double secs = (now_ns() - t0) / 1e9;
+
+    if (total >= 0) {
+        printf("%s,%u,%zu,%lld,%.4f,%.3f,%d\n", variant_names[v], depth, block,
+               (long long)total, secs, total / secs / 1e9, v == V_READ ? 0 : async);
+        fflush(stdout);
+    }
+
+out:
+    if (e)
+        uio_close(e);
+    free(bufs);
+    close(fd);
+    return total >= 0 ? 0 : -1;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = "uring_bench.dat";
+    uint64_t file_size = 256 * MB;
+    size_t block = 128 * 1024;
+    unsigned int max_depth = 128;
+    int direct = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:s:b:q:D")) != -1) {
+        switch (opt) {
+        case 'f': path = optarg; break;
+        case 's': file_size = parse_size(optarg); break;
+        case 'b': block = parse_size(optarg); break;
+        case 'q': max_depth = (unsigned int)atoi(optarg); break;
+        case 'D': direct = 1; break;
+        default:
+            fprintf(stderr, "Usage: %s [-f path] [-s file_size] [-b block] "
+                            "[-q max_depth] [-D]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (block == 0 || max_depth == 0 || (direct && block % ALIGN)) {
+        fprintf(stderr, "invalid block size or depth\n");
+        return 1;
+    }
+
+    if (prepare_file(path, file_size))
+        return 1;
+
+    printf("method,depth,block,bytes,seconds,gbps,async\n");
+    if (run(V_READ, path, file_size, block, 1, direct))
+        return 1;
+    for (unsigned int depth = 1; depth <= max_depth; depth *= 2) {
+        for (int v = V_URING; v < V_COUNT; v++)
+            run(v, path, file_size, block, depth, direct);
+    }
+
+    unlink(path);
+    return 0;
+}
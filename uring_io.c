@@ -0,0 +1,664 @@
+/*
+ * io_uring File I/O Engine - 구현
+ *
+ * Ring 구조 (커널과 공유하는 메모리):
+ *   SQ ring : head/tail/array - 우리가 tail 을 올리고, 커널이 head 를 올림
+ *   SQEs    : 실제 요청 내용
+ *   CQ ring : head/tail/cqes  - 커널이 tail 을 올리고, 우리가 head 를 올림
+ *
+ * tail/head 갱신에는 acquire/release 순서가 필요하다.
+ */
+
+#define _GNU_SOURCE
+#include "uring_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#define DEFAULT_ENTRIES 64
+
+/* 동기 fallback 에서 큐에 쌓아두는 요청 */
+struct sync_op {
+    int opcode;
+    int fd;
+    void *buf;
+    unsigned int len;
+    off_t offset;
+    int flags;
+    int datasync;
+    uint64_t user_data;
+};
+
+struct uio_engine {
+    int async;
+    int ring_fd;
+    unsigned int setup_flags;
+    unsigned int entries;
+
+    /* SQ */
+    unsigned int *sq_head, *sq_tail, *sq_mask, *sq_flags, *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned int sq_local_tail;
+    void *sq_ring;
+    size_t sq_ring_sz;
+    size_t sqes_sz;
+
+    /* CQ */
+    unsigned int *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+    void *cq_ring;
+    size_t cq_ring_sz;
+
+    unsigned int inflight;
+
+    /* fallback */
+    struct sync_op *ops;
+    unsigned int nops;
+    struct uio_cqe *done;
+    unsigned int done_head, done_count;
+    int *files;
+    unsigned int nfiles;
+
+    /* 편의 함수가 기다리다 받은 호출자의 CQE. 다음 uio_wait 가 먼저 돌려준다 */
+    struct uio_cqe *stash;
+    unsigned int stash_n, stash_cap;
+};
+
+static int sys_io_uring_setup(unsigned int entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete,
+                              unsigned int flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_io_uring_register(int fd, unsigned int opcode, const void *arg,
+                                 unsigned int nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static int ring_setup(struct uio_engine *e, const struct uio_params *params) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    if (params && params->sqpoll) {
+        p.flags |= IORING_SETUP_SQPOLL;
+        p.sq_thread_idle = params->sqpoll_idle_ms ? params->sqpoll_idle_ms : 1000;
+    }
+
+    int fd = sys_io_uring_setup(e->entries, &p);
+    if (fd < 0)
+        return -1;
+
+    e->ring_fd = fd;
+    e->setup_flags = p.flags;
+    e->entries = p.sq_entries;
+
+    e->sq_ring_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+    e->cq_ring_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (e->cq_ring_sz > e->sq_ring_sz)
+            e->sq_ring_sz = e->cq_ring_sz;
+        e->cq_ring_sz = e->sq_ring_sz;
+    }
+
+    e->sq_ring = mmap(NULL, e->sq_ring_sz, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (e->sq_ring == MAP_FAILED)
+        goto fail;
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        e->cq_ring = e->sq_ring;
+    } else {
+        e->cq_ring = mmap(NULL, e->cq_ring_sz, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (e->cq_ring == MAP_FAILED) {
+            munmap(e->sq_ring, e->sq_ring_sz);
+            goto fail;
+        }
+    }
+
+    e->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+    e->sqes = mmap(NULL, e->sqes_sz, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (e->sqes == MAP_FAILED) {
+        if (e->cq_ring != e->sq_ring)
+            munmap(e->cq_ring, e->cq_ring_sz);
+        munmap(e->sq_ring, e->sq_ring_sz);
+        goto fail;
+    }
+
+    char *sq = e->sq_ring, *cq = e->cq_ring;
+    e->sq_head = (unsigned int *)(sq + p.sq_off.head);
+    e->sq_tail = (unsigned int *)(sq + p.sq_off.tail);
+    e->sq_mask = (unsigned int *)(sq + p.sq_off.ring_mask);
+    e->sq_flags = (unsigned int *)(sq + p.sq_off.flags);
+    e->sq_array = (unsigned int *)(sq + p.sq_off.array);
+    e->cq_head = (unsigned int *)(cq + p.cq_off.head);
+    e->cq_tail = (unsigned int *)(cq + p.cq_off.tail);
+    e->cq_mask = (unsigned int *)(cq + p.cq_off.ring_mask);
+    e->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    e->sq_local_tail = *e->sq_tail;
+    return 0;
+
+fail:
+    close(fd);
+    return -1;
+}
+
+struct uio_engine *uio_open(const struct uio_params *params) {
+    struct uio_engine *e = calloc(1, sizeof(*e));
+    if (!e)
+        return NULL;
+
+    e->ring_fd = -1;
+    e->entries = (params && params->entries) ? params->entries : DEFAULT_ENTRIES;
+
+    if (!(params && params->force_sync) && ring_setup(e, params) == 0) {
+        e->async = 1;
+        return e;
+    }
+
+    /* io_uring 을 쓸 수 없음 - 동기 fallback */
+    e->async = 0;
+    e->ops = calloc(e->entries, sizeof(*e->ops));
+    e->done = calloc(e->entries, sizeof(*e->done));
+    if (!e->ops || !e->done) {
+        free(e->ops);
+        free(e->done);
+        free(e);
+        return NULL;
+    }
+    return e;
+}
+
+void uio_close(struct uio_engine *e) {
+    if (e->async) {
+        munmap(e->sqes, e->sqes_sz);
+        if (e->cq_ring != e->sq_ring)
+            munmap(e->cq_ring, e->cq_ring_sz);
+        munmap(e->sq_ring, e->sq_ring_sz);
+        close(e->ring_fd);
+    }
+    free(e->ops);
+    free(e->done);
+    free(e->files);
+    free(e->stash);
+    free(e);
+}
+
+int uio_is_async(const struct uio_engine *e) {
+    return e->async;
+}
+
+int uio_register_files(struct uio_engine *e, const int *fds, unsigned int n) {
+    /* fallback 에서도 index -> fd 변환이 필요하므로 복사해 둔다 */
+    int *copy = malloc(sizeof(int) * n);
+    if (!copy)
+        return -1;
+    memcpy(copy, fds, sizeof(int) * n);
+    free(e->files);
+    e->files = copy;
+    e->nfiles = n;
+
+    if (!e->async)
+        return 0;
+    return sys_io_uring_register(e->ring_fd, IORING_REGISTER_FILES, fds, n);
+}
+
+int uio_register_buffers(struct uio_engine *e, const struct iovec *iov, unsigned int n) {
+    if (!e->async)
+        return 0;
+    return sys_io_uring_register(e->ring_fd, IORING_REGISTER_BUFFERS, iov, n);
+}
+
+/* ---------------------------------------------------------------- */
+
+static struct io_uring_sqe *get_sqe(struct uio_engine *e) {
+    unsigned int head = __atomic_load_n(e->sq_head, __ATOMIC_ACQUIRE);
+    if (e->sq_local_tail - head >= e->entries) {
+        errno = EBUSY;
+        return NULL;
+    }
+    unsigned int idx = e->sq_local_tail & *e->sq_mask;
+    struct io_uring_sqe *sqe = &e->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    e->sq_array[idx] = idx;
+    e->sq_local_tail++;
+    return sqe;
+}
+
+static struct sync_op *get_op(struct uio_engine *e) {
+    if (e->nops + e->done_count + e->inflight >= e->entries) {
+        errno = EBUSY;
+        return NULL;
+    }
+    struct sync_op *op = &e->ops[e->nops++];
+    memset(op, 0, sizeof(*op));
+    return op;
+}
+
+static int prep_rw(struct uio_engine *e, int opcode, int fd, const void *buf,
+                   unsigned int len, off_t offset, int flags, unsigned int buf_index,
+                   uint64_t user_data) {
+    if (!e->async) {
+        struct sync_op *op = get_op(e);
+        if (!op)
+            return -1;
+        op->opcode = opcode;
+        op->fd = fd;
+        op->buf = (void *)buf;
+        op->len = len;
+        op->offset = offset;
+        op->flags = flags;
+        op->user_data = user_data;
+        return 0;
+    }
+
+    struct io_uring_sqe *sqe = get_sqe(e);
+    if (!sqe)
+        return -1;
+
+    if (flags & UIO_FIXED_BUF) {
+        sqe->opcode = opcode == IORING_OP_READ ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+        sqe->buf_index = (uint16_t)buf_index;
+    } else {
+        sqe->opcode = (uint8_t)opcode;
+    }
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = len;
+    sqe->off = (uint64_t)offset;
+    sqe->user_data = user_data;
+    if (flags & UIO_FIXED_FILE)
+        sqe->flags |= IOSQE_FIXED_FILE;
+    if (flags & UIO_LINK)
+        sqe->flags |= IOSQE_IO_LINK;
+    return 0;
+}
+
+int uio_prep_read(struct uio_engine *e, int fd, void *buf, unsigned int len,
+                  off_t offset, int flags, unsigned int buf_index, uint64_t user_data) {
+    return prep_rw(e, IORING_OP_READ, fd, buf, len, offset, flags, buf_index, user_data);
+}
+
+int uio_prep_write(struct uio_engine *e, int fd, const void *buf, unsigned int len,
+                   off_t offset, int flags, unsigned int buf_index, uint64_t user_data) {
+    return prep_rw(e, IORING_OP_WRITE, fd, buf, len, offset, flags, buf_index, user_data);
+}
+
+int uio_prep_fsync(struct uio_engine *e, int fd, int datasync, int flags,
+                   uint64_t user_data) {
+    if (!e->async) {
+        struct sync_op *op = get_op(e);
+        if (!op)
+            return -1;
+        op->opcode = IORING_OP_FSYNC;
+        op->fd = fd;
+        op->flags = flags;
+        op->datasync = datasync;
+        op->user_data = user_data;
+        return 0;
+    }
+
+    struct io_uring_sqe *sqe = get_sqe(e);
+    if (!sqe)
+        return -1;
+    sqe->opcode = IORING_OP_FSYNC;
+    sqe->fd = fd;
+    sqe->fsync_flags = datasync ? IORING_FSYNC_DATASYNC : 0;
+    sqe->user_data = user_data;
+    if (flags & UIO_FIXED_FILE)
+        sqe->flags |= IOSQE_FIXED_FILE;
+    if (flags & UIO_LINK)
+        sqe->flags |= IOSQE_IO_LINK;
+    return 0;
+}
+
+/* ---------------------------------------------------------------- */
+
+static int run_sync_op(struct uio_engine *e, const struct sync_op *op) {
+    int fd = op->fd;
+    ssize_t ret;
+
+    if (op->flags & UIO_FIXED_FILE) {
+        if ((unsigned int)fd >= e->nfiles)
+            return -EBADF;
+        fd = e->files[fd];
+    }
+
+    do {
+        switch (op->opcode) {
+        case IORING_OP_READ:
+            ret = op->offset == -1 ? read(fd, op->buf, op->len)
+                                   : pread(fd, op->buf, op->len, op->offset);
+            break;
+        case IORING_OP_WRITE:
+            ret = op->offset == -1 ? write(fd, op->buf, op->len)
+                                   : pwrite(fd, op->buf, op->len, op->offset);
+            break;
+        case IORING_OP_FSYNC:
+            ret = op->datasync ? fdatasync(fd) : fsync(fd);
+            break;
+        default:
+            errno = EINVAL;
+            ret = -1;
+            break;
+        }
+    } while (ret == -1 && errno == EINTR);
+
+    return ret == -1 ? -errno : (int)ret;
+}
+
+static void push_done(struct uio_engine *e, uint64_t user_data, int res) {
+    unsigned int idx = (e->done_head + e->done_count) % e->entries;
+    e->done[idx].user_data = user_data;
+    e->done[idx].res = res;
+    e->done_count++;
+}
+
+/* io_uring 과 같은 link 의미: 실패하거나 짧게 끝나면 이후 link 는 취소 */
+static int submit_sync(struct uio_engine *e) {
+    int broken = 0;
+    unsigned int n = e->nops;
+
+    for (unsigned int i = 0; i < n; i++) {
+        const struct sync_op *op = &e->ops[i];
+        int res;
+        if (broken) {
+            res = -ECANCELED;
+        } else {
+            res = run_sync_op(e, op);
+            if (res < 0 || (op->opcode != IORING_OP_FSYNC && (unsigned int)res < op->len))
+                broken = 1;
+        }
+        push_done(e, op->user_data, res);
+        if (!(op->flags & UIO_LINK))
+            broken = 0;
+    }
+    e->nops = 0;
+    return (int)n;
+}
+
+int uio_submit(struct uio_engine *e) {
+    if (!e->async)
+        return submit_sync(e);
+
+    unsigned int to_submit = e->sq_local_tail - *e->sq_tail;
+    __atomic_store_n(e->sq_tail, e->sq_local_tail, __ATOMIC_RELEASE);
+    if (to_submit == 0)
+        return 0;
+    e->inflight += to_submit;
+
+    if (e->setup_flags & IORING_SETUP_SQPOLL) {
+        /* 커널 SQ 스레드가 idle 로 잠들었을 때만 깨운다 - 평소에는 syscall 0회 */
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(e->sq_flags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP) {
+            if (sys_io_uring_enter(e->ring_fd, 0, 0, IORING_ENTER_SQ_WAKEUP) < 0)
+                return -1;
+        }
+        return (int)to_submit;
+    }
+
+    int ret;
+    do {
+        ret = sys_io_uring_enter(e->ring_fd, to_submit, 0, 0);
+    } while (ret < 0 && errno == EINTR);
+    return ret;
+}
+
+static unsigned int reap(struct uio_engine *e, struct uio_cqe *out, unsigned int max) {
+    unsigned int head = *e->cq_head;
+    unsigned int tail = __atomic_load_n(e->cq_tail, __ATOMIC_ACQUIRE);
+    unsigned int n = 0;
+
+    while (head != tail && n < max) {
+        struct io_uring_cqe *cqe = &e->cqes[head & *e->cq_mask];
+        out[n].user_data = cqe->user_data;
+        out[n].res = cqe->res;
+        n++;
+        head++;
+    }
+    __atomic_store_n(e->cq_head, head, __ATOMIC_RELEASE);
+    e->inflight -= n;
+    return n;
+}
+
+static int wait_cqes(struct uio_engine *e, struct uio_cqe *out, unsigned int max,
+                     unsigned int min_complete) {
+    if (!e->async) {
+        unsigned int n = 0;
+        while (e->done_count > 0 && n < max) {
+            out[n++] = e->done[e->done_head];
+            e->done_head = (e->done_head + 1) % e->entries;
+            e->done_count--;
+        }
+        return (int)n;
+    }
+
+    if (min_complete > max)
+        min_complete = max;
+
+    unsigned int got = reap(e, out, max);
+    while (got < min_complete && e->inflight > 0) {
+        unsigned int want = min_complete - got;
+        if (want > e->inflight)
+            want = e->inflight;
+        if (sys_io_uring_enter(e->ring_fd, 0, want, IORING_ENTER_GETEVENTS) < 0 &&
+            errno != EINTR)
+            return -1;
+        got += reap(e, out + got, max - got);
+    }
+    return (int)got;
+}
+
+int uio_wait(struct uio_engine *e, struct uio_cqe *out, unsigned int max,
+             unsigned int min_complete) {
+    unsigned int n = e->stash_n < max ? e->stash_n : max;
+    if (n > 0) {
+        memcpy(out, e->stash, n * sizeof(*out));
+        memmove(e->stash, e->stash + n, (e->stash_n - n) * sizeof(*out));
+        e->stash_n -= n;
+    }
+    if (n >= min_complete && n > 0)
+        return (int)n;
+    int got = wait_cqes(e, out + n, max - n, min_complete - n);
+    return got < 0 ? (n ? (int)n : -1) : (int)n + got;
+}
+
+static int stash_push(struct uio_engine *e, const struct uio_cqe *c) {
+    if (e->stash_n == e->stash_cap) {
+        unsigned int ncap = e->stash_cap ? e->stash_cap * 2 : 16;
+        struct uio_cqe *p = realloc(e->stash, ncap * sizeof(*p));
+        if (!p)
+            return -1;
+        e->stash = p;
+        e->stash_cap = ncap;
+    }
+    e->stash[e->stash_n++] = *c;
+    return 0;
+}
+
+/* 편의 함수용: UIO_TAG_INTERNAL 이 붙은 CQE 만 min_complete 개 이상 모은다.
+ * 같은 ring 에서 호출자가 띄워 둔 요청의 CQE 는 stash 에 넣어 두고 넘긴다 */
+static int wait_own(struct uio_engine *e, struct uio_cqe *out, unsigned int max,
+                    unsigned int min_complete) {
+    unsigned int got = 0;
+    while (got < min_complete) {
+        int n = wait_cqes(e, out + got, max - got, 1);
+        if (n < 0)
+            return got ? (int)got : -1;
+        if (n == 0)
+            break;
+        unsigned int base = got;
+        for (int i = 0; i < n; i++) {
+            struct uio_cqe c = out[base + i];
+            if (c.user_data & UIO_TAG_INTERNAL)
+                out[got++] = c;
+            else if (stash_push(e, &c) == -1)
+                return -1;
+        }
+    }
+    return (int)got;
+}
+
+/* ---------------------------------------------------------------- */
+
+struct read_slot {
+    off_t offset;
+    unsigned int len;
+};
+
+ssize_t uio_read_all(struct uio_engine *e, int fd, void *buf, size_t len,
+                     off_t offset, size_t chunk, unsigned int depth) {
+    if (depth > e->entries)
+        depth = e->entries;
+    if (depth == 0 || chunk == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct read_slot *slots = calloc(depth, sizeof(*slots));
+    struct uio_cqe *cqes = calloc(depth, sizeof(*cqes));
+    if (!slots || !cqes) {
+        free(slots);
+        free(cqes);
+        return -1;
+    }
+
+    size_t issued = 0, total = 0;
+    unsigned int active = 0, free_top = depth;
+    unsigned int stack[depth];      /* 비어있는 slot 번호 */
+    int eof = 0, err = 0;
+
+    for (unsigned int i = 0; i < depth; i++)
+        stack[i] = i;
+
+    while (!err && (active > 0 || (!eof && issued < len))) {
+        /* 빈 slot 만큼 다음 chunk 를 준비 */
+        while (!eof && issued < len && free_top > 0) {
+            unsigned int s = stack[--free_top];
+            size_t want = len - issued < chunk ? len - issued : chunk;
+            slots[s].offset = offset + (off_t)issued;
+            slots[s].len = (unsigned int)want;
+            if (uio_prep_read(e, fd, (char *)buf + issued, slots[s].len,
+                              slots[s].offset, 0, 0, UIO_TAG_INTERNAL | s) == -1) {
+                stack[free_top++] = s;
+                break;
+            }
+            issued += want;
+            active++;
+        }
+        if (uio_submit(e) < 0) {
+            err = errno;
+            break;
+        }
+
+        int n = wait_own(e, cqes, depth, 1);
+        if (n < 0) {
+            err = errno;
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            unsigned int s = (unsigned int)(cqes[i].user_data & ~UIO_TAG_INTERNAL);
+            int res = cqes[i].res;
+            if (res < 0) {
+                err = -res;
+                active--;
+                continue;
+            }
+            total += res;
+            if (res == 0) {
+                eof = 1;
+            } else if (!err && (unsigned int)res < slots[s].len) {
+                /* short read - 남은 부분을 같은 slot 으로 다시 요청 */
+                slots[s].offset += res;
+                slots[s].len -= res;
+                if (uio_prep_read(e, fd, (char *)buf + (slots[s].offset - offset),
+                                  slots[s].len, slots[s].offset, 0, 0,
+                                  UIO_TAG_INTERNAL | s) == 0)
+                    continue;
+                err = errno;
+            }
+            active--;
+            stack[free_top++] = s;
+        }
+    }
+
+    /*
+     * 실패 시에도 요청을 모두 회수해야 buf 를 안전하게 돌려줄 수 있다.
+     * 에러 CQE 와 같은 batch 에서 short read 를 다시 prep 했을 수 있으므로
+     * 아직 제출하지 않은 SQE 도 먼저 제출한다 (남겨두면 다음 uio_submit 이
+     * 호출자가 이미 해제한 buf 로 읽는다).
+     */
+    if (active > 0 && uio_submit(e) < 0 && !err)
+        err = errno;
+    while (active > 0) {
+        int n = wait_own(e, cqes, depth, 1);
+        if (n <= 0)
+            break;
+        active -= n;
+    }
+
+    free(slots);
+    free(cqes);
+    if (err) {
+        errno = err;
+        return -1;
+    }
+    return (ssize_t)total;
+}
+
+ssize_t uio_append_durable(struct uio_engine *e, int fd, const void *buf,
+                           size_t len, int datasync) {
+    struct uio_cqe cqes[2];
+    size_t done = 0;
+
+    /* write 가 짧게 끝나면 fsync 가 취소되므로 남은 부분으로 다시 시도 */
+    while (done < len) {
+        unsigned int want = len - done > 0x7ffff000 ? 0x7ffff000 : (unsigned int)(len - done);
+        if (uio_prep_write(e, fd, (const char *)buf + done, want, -1, UIO_LINK, 0,
+                           UIO_TAG_INTERNAL | 0) == -1)
+            return -1;
+        if (uio_prep_fsync(e, fd, datasync, 0, UIO_TAG_INTERNAL | 1) == -1)
+            return -1;
+        if (uio_submit(e) < 0)
+            return -1;
+
+        int got = 0, wres = 0, fres = 0;
+        while (got < 2) {
+            int n = wait_own(e, cqes, 2 - got, 2 - got);
+            if (n <= 0) {
+                if (n == 0)
+                    errno = EIO;
+                return -1;
+            }
+            for (int i = 0; i < n; i++) {
+                if (cqes[i].user_data == UIO_TAG_INTERNAL)
+                    wres = cqes[i].res;
+                else
+                    fres = cqes[i].res;
+            }
+            got += n;
+        }
+
+        if (wres <= 0) {
+            /* 0 이면 done 이 늘지 않아 끝없이 돈다: 동기 경로처럼 EIO */
+            errno = wres < 0 ? -wres : EIO;
+            return -1;
+        }
+        done += wres;
+        if (done == len && fres < 0) {
+            errno = -fres;
+            return -1;
+        }
+    }
+    return (ssize_t)done;
+}
@@ -0,0 +1,92 @@
+/*
+ * io_uring File I/O Engine
+ *
+ * 2.c/3.c 의 read() 루프, 5.c/8.c 의 append write 는 syscall 한 번에
+ * I/O 하나씩만 처리한다. 이 엔진은 여러 요청을 SQ 에 쌓아서 한 번의
+ * io_uring_enter() 로 제출하고, 장치의 queue depth 를 채운다.
+ *
+ *   - batched submission : uio_prep_*() 여러 번 후 uio_submit() 한 번
+ *   - registered buffers : uio_register_buffers() + UIO_FIXED_BUF
+ *   - fixed files        : uio_register_files() + UIO_FIXED_FILE
+ *   - SQPOLL             : uio_params.sqpoll (커널 스레드가 SQ 를 polling)
+ *   - linked chains      : UIO_LINK (예: write -> fdatasync)
+ *
+ * liburing 없이 <linux/io_uring.h> 와 raw syscall 만 사용한다.
+ * io_uring 을 쓸 수 없는 커널(ENOSYS, EPERM 등)에서는 같은 API 가
+ * pread/pwrite/fsync 를 동기적으로 호출하는 fallback 으로 동작한다.
+ *
+ * Build: gcc -O2 -c uring_io.c
+ */
+
+#ifndef URING_IO_H
+#define URING_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+/* uio_prep_*() flags */
+#define UIO_FIXED_FILE 0x1   /* fd 인자가 등록된 file index */
+#define UIO_FIXED_BUF  0x2   /* buf 가 등록된 buffer 안에 있음 (buf_index 사용) */
+#define UIO_LINK       0x4   /* 다음 요청은 이 요청이 성공해야 실행됨 */
+
+/* user_data 의 최상위 bit 는 uio_read_all / uio_append_durable 이 자기 요청에 붙인다.
+ * 호출자는 쓰지 않는다. 그 사이 끝난 호출자의 요청은 다음 uio_wait 가 돌려준다 */
+#define UIO_TAG_INTERNAL (1ULL << 63)
+
+struct uio_params {
+    unsigned int entries;        /* SQ 크기 (2의 거듭제곱으로 올림) */
+    int sqpoll;                  /* 1 이면 IORING_SETUP_SQPOLL */
+    unsigned int sqpoll_idle_ms;
+    int force_sync;              /* 1 이면 io_uring 을 쓰지 않음 (비교용) */
+};
+
+struct uio_cqe {
+    uint64_t user_data;
+    int res;                     /* 성공: 바이트 수 / 0, 실패: -errno */
+};
+
+struct uio_engine;
+
+/* params 가 NULL 이면 기본값 (entries=64, SQPOLL 없음) */
+struct uio_engine *uio_open(const struct uio_params *params);
+void uio_close(struct uio_engine *e);
+
+/* io_uring 으로 동작 중이면 1, 동기 fallback 이면 0 */
+int uio_is_async(const struct uio_engine *e);
+
+int uio_register_files(struct uio_engine *e, const int *fds, unsigned int n);
+int uio_register_buffers(struct uio_engine *e, const struct iovec *iov, unsigned int n);
+
+/*
+ * 요청 준비. SQ 가 가득 차면 -1 (errno = EBUSY) - uio_submit() 후 재시도.
+ * offset 이 -1 이면 현재 파일 위치 (O_APPEND fd 에서는 append).
+ */
+int uio_prep_read(struct uio_engine *e, int fd, void *buf, unsigned int len,
+                  off_t offset, int flags, unsigned int buf_index, uint64_t user_data);
+int uio_prep_write(struct uio_engine *e, int fd, const void *buf, unsigned int len,
+                   off_t offset, int flags, unsigned int buf_index, uint64_t user_data);
+int uio_prep_fsync(struct uio_engine *e, int fd, int datasync, int flags,
+                   uint64_t user_data);
+
+/* 준비된 요청을 제출. 제출한 개수, 실패 시 -1 */
+int uio_submit(struct uio_engine *e);
+
+/* 최소 min_complete 개가 끝날 때까지 기다려서 최대 max 개 회수 */
+int uio_wait(struct uio_engine *e, struct uio_cqe *out, unsigned int max,
+             unsigned int min_complete);
+
+/*
+ * 편의 함수
+ *
+ * uio_read_all: [offset, offset+len) 을 chunk 단위로 최대 depth 개씩
+ *               동시에 읽는다. 읽은 바이트 수, 실패 시 -1.
+ * uio_append_durable: write + fsync/fdatasync 를 link 로 묶어서 한 번에 제출.
+ */
+ssize_t uio_read_all(struct uio_engine *e, int fd, void *buf, size_t len,
+                     off_t offset, size_t chunk, unsigned int depth);
+ssize_t uio_append_durable(struct uio_engine *e, int fd, const void *buf,
+                           size_t len, int datasync);
+
+#endif
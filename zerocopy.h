@@ -0,0 +1,33 @@
+/*
+ * Zero-Copy Helpers
+ *
+ * zerocopy_example.c 와 file_server.c 가 같이 쓰는 sendfile 래퍼.
+ * zerocopy_example.c 는 main 이 있어 링크할 수 없으므로 header 에 둔다.
+ *
+ * Build: header only
+ */
+
+#ifndef ZEROCOPY_H
+#define ZEROCOPY_H
+
+#include <sys/sendfile.h>
+#include <sys/types.h>
+
+static inline ssize_t sendfile_zero_copy(int out_fd, int in_fd, off_t *offset, size_t count) {
+    /* sendfile() 시스템콜:
+     * - in_fd에서 out_fd로 데이터 직접 전송
+     * - 사용자 버퍼를 전혀 사용하지 않음!
+     * - 완전히 커널 공간에서 처리
+     *
+     * 전통적 방식:
+     *   read(in_fd, buf, n) + write(out_fd, buf, n)  -> 2번 복사
+     *
+     * sendfile 방식:
+     *   sendfile(out_fd, in_fd, &offset, n)          -> 0번 복사
+     *
+     * 짧게 끝날 수 있으므로 호출자가 남은 만큼 다시 부른다.
+     */
+    return sendfile(out_fd, in_fd, offset, count);
+}
+
+#endif
@@ -8,8 +8,10 @@
  * Solution: Zero-copy eliminates intermediate user buffer copy
  *   - mmap(): returns pointer directly to kernel buffer
  *   - sendfile(): transfers directly between kernel buffers
+ *   - vmsplice()/splice(): pipe producer/consumer, see splice_pipe.h
  */
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,6 +22,8 @@
 #include <sys/sendfile.h>
 #include <pthread.h>
 
+#include "zerocopy.h"
+
 #define FILE_SIZE (4 * 1024)  /* 4KB test file */
 #define NUM_THREADS 4
 
@@ -115,15 +119,19 @@ void* mmap_zero_copy_writer(void *arg) {
     printf("[Thread %d] mmap() 쓰기 모드 매핑 완료\n", thread_id);
 
     /* 직접 메모리에 쓰기 - 복사 없음! */
-    snprintf(mapped, file_size,
+    int written = snprintf(mapped, file_size,
         "[Thread %d] Zero-Copy 데이터 쓰기\n"
         "이 데이터는 사용자 버퍼를 거치지 않고\n"
         "커널 버퍼에 직접 기록됩니다.\n"
         "timestamp: %ld\n",
         thread_id, (long)time(NULL));
 
-    /* msync로 디스크에 동기화 (필요시) */
-    msync(mapped, file_size, MS_SYNC);
+    /* msync로 디스크에 동기화 (필요시)
+     * 매핑 전체가 아니라 실제로 쓴 페이지만 - 큰 매핑은 mmap_region.h 참고 */
+    /* snprintf 는 실패하면 음수, 잘리면 file_size 보다 큰 값을 돌려준다 */
+    size_t dirty = written < 0 ? 0 : (size_t)written > file_size ? file_size : (size_t)written;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    msync(mapped, (dirty + page - 1) / page * page, MS_SYNC);
 
     printf("[Thread %d] 쓰기 완료 - 직접 메모리 접근\n", thread_id);
 
@@ -138,23 +146,8 @@ void* mmap_zero_copy_writer(void *arg) {
  *
  * sendfile()은 두 파일 기술자 간의 데이터를 직접 전송:
  *   in_fd (파일) -> kernel buffer -> out_fd (파일/소켓)
- * 사용자 공간을 거치지 않음!
+ * 사용자 공간을 거치지 않음! (래퍼 sendfile_zero_copy 는 zerocopy.h)
  */
-ssize_t sendfile_zero_copy(int out_fd, int in_fd, off_t *offset, size_t count) {
-    /* sendfile() 시스템콜:
-     * - in_fd에서 out_fd로 데이터 직접 전송
-     * - 사용자 버퍼를 전혀 사용하지 않음!
-     * - 완전히 커널 공간에서 처리
-     *
-     * 전통적 방식:
-     *   read(in_fd, buf, n) + write(out_fd, buf, n)  -> 2번 복사
-     *
-     * sendfile 방식:
-     *   sendfile(out_fd, in_fd, &offset, n)          -> 0번 복사
-     */
-    return sendfile(out_fd, in_fd, offset, count);
-}
-
 void test_sendfile(void) {
     int in_fd, out_fd;
     off_t offset = 0;
@@ -180,8 +173,21 @@ void test_sendfile(void) {
     printf("\n=== sendfile() Zero-Copy 전송 ===\n");
     printf("파일 크기: %ld 바이트\n", (long)st.st_size);
 
-    /* sendfile으로 직접 전송 - 복사 없음! */
-    ssize_t sent = sendfile_zero_copy(out_fd, in_fd, &offset, st.st_size);
+    /* sendfile으로 직접 전송 - 복사 없음!
+     * 한 번에 다 보내지 못할 수 있으므로 (큰 파일, 시그널) 남은 만큼 반복 */
+    ssize_t sent = 0;
+    while (offset < st.st_size) {
+        ssize_t n = sendfile_zero_copy(out_fd, in_fd, &offset, st.st_size - offset);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            perror("sendfile");
+            break;
+        }
+        if (n == 0)
+            break;
+        sent += n;
+    }
     printf("전송 완료: %zd 바이트 (사용자 버퍼 미사용)\n", sent);
 
     close(in_fd);